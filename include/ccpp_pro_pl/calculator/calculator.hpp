@@ -0,0 +1,712 @@
+#pragma once
+#ifndef CCPP_PRO_PL_CALCULATOR_HPP
+#define CCPP_PRO_PL_CALCULATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+/*
+科学计算器的 C++ 头文件实现，语法与 src/calculator/parser/parser.c 相同：
+
+expression → term { ('+' | '-') term }        // 加减运算（左结合）
+term → factor { ('*' | '/') factor }          // 乘除运算（左结合）
+factor → [ '-' ] base [ '^' factor ] [ '!' ]  // 负号、幂（右结合）、阶乘（后缀）
+base → number | '(' expression ')' | function_call
+function_call → function '(' arguments ')'
+arguments → expression { ',' expression }
+
+设计要点：
+- 解析器与求值全部是 constexpr，字符串字面量可以在编译期解析成表达式树并求值，运行时不再有任何解析开销
+- 表达式树是扁平的节点数组，子节点用下标引用，节点存储由模板参数决定：
+  编译期使用定长的 fixed_nodes<N>，运行时字符串使用 std::vector<node>，两者共用同一套解析与求值模板
+- 语法错误抛出 std::invalid_argument，数学定义域错误抛出 std::domain_error；
+  在常量表达式中遇到 throw 会直接变成编译错误
+- sin/cos/log 等标准库函数不是 constexpr，这里用级数展开实现，精度在几个 ulp 以内；
+  |x| 超过 2^20 * pi/2 时三角函数改用对 double 的 2*pi 取精确余数（fmod 语义）再缩放，
+  结果与 libm 的完整精度缩放（Payne-Hanek）不同，x 为无穷或 NaN 时结果为 NaN
+- 可调用的函数与 function.c 相同：sin cos tan sqrt log pow；exp 只在内部用于 pow 的非整数次幂
+- 数值的有效数字先累积在 64 位整数中（最多 19 位，多出的位按 0 处理），再乘以 10 的幂，
+  10 的幂由快速幂求得，相对误差在 10 ulp 以内，不保证与 strtod 的正确舍入一致；
+  比 DBL_MAX 大但在误差范围内的输入得到 DBL_MAX 而不是 inf
+*/
+
+namespace calculator {
+
+// 节点类型
+enum class op : unsigned char {
+    num,    // 数值
+    add,    // +
+    sub,    // -
+    mul,    // *
+    div,    // /
+    pow,    // ^ 右结合
+    fact,   // ! 后缀阶乘
+    negate, // 一元负号
+    func    // 函数调用
+};
+
+// 支持的函数
+enum class func_id : unsigned char { sin, cos, tan, sqrt, log, pow };
+
+// 表达式树节点，lhs/rhs 为子节点在节点数组中的下标，函数参数同样放在 lhs/rhs
+struct node {
+    op kind = op::num;
+    func_id fn = func_id::sin;
+    double value = 0;
+    int lhs = -1;
+    int rhs = -1;
+};
+
+// 编译期可用的定长节点存储
+template <std::size_t N>
+class fixed_nodes {
+public:
+    constexpr void push_back(const node& n) {
+        if (count == N) {
+            throw std::length_error("表达式节点个数超出容量");
+        }
+        nodes[count++] = n;
+    }
+    constexpr auto operator[](std::size_t i) const -> const node& { return nodes[i]; }
+    constexpr auto size() const -> std::size_t { return count; }
+
+private:
+    std::array<node, N> nodes{};
+    std::size_t count = 0;
+};
+
+namespace detail {
+
+constexpr double pi = 3.14159265358979323846;
+constexpr double ln2 = 0.69314718055994530942;
+// Cody-Waite 拆分常数（取自 fdlibm），高位部分与整数相乘无舍入误差
+constexpr double ln2_hi = 6.93147180369123816490e-01;
+constexpr double ln2_lo = 1.90821492927058770002e-10;
+constexpr double pio2_hi = 1.57079632673412561417e+00;
+constexpr double pio2_lo = 6.07710050650619224932e-11;
+
+constexpr auto nan() -> double { return std::numeric_limits<double>::quiet_NaN(); }
+
+constexpr auto is_integer(double x) -> bool {
+    // 超出 long long 范围的转换是未定义行为，常量表达式中会报错
+    return x > -9.2e18 && x < 9.2e18 && x == static_cast<double>(static_cast<long long>(x));
+}
+
+// 整数次幂，快速幂
+constexpr auto ipow(double base, long long exp) -> double {
+    bool negative = exp < 0;
+    unsigned long long e = negative ? 0ull - static_cast<unsigned long long>(exp)
+                                    : static_cast<unsigned long long>(exp);
+    double result = 1;
+    while (e) {
+        if (e & 1u) {
+            result *= base;
+        }
+        // 最高位用完后不再平方，否则 10^256 这样结果不溢出的幂也会多算一次溢出
+        e >>= 1u;
+        if (e) {
+            base *= base;
+        }
+    }
+    return negative ? 1 / result : result;
+}
+
+constexpr auto sqrt(double x) -> double {
+    if (x < 0 || x != x) {
+        return nan();
+    }
+    if (x == 0 || x == std::numeric_limits<double>::infinity()) {
+        return x;
+    }
+    // 牛顿迭代，先把初值缩放到同一数量级
+    double guess = x;
+    double scale = 1;
+    while (guess > 4) {
+        guess /= 4;
+        scale *= 2;
+    }
+    while (guess < 0.25) {
+        guess *= 4;
+        scale /= 2;
+    }
+    guess = scale;
+    for (int i = 0; i < 64; i++) {
+        double next = 0.5 * (guess + x / guess);
+        if (next == guess) {
+            break;
+        }
+        guess = next;
+    }
+    return guess;
+}
+
+// ln(x) = k*ln2 + 2*atanh((m-1)/(m+1))，m 缩放到 [sqrt(0.5), sqrt(2))
+constexpr auto log(double x) -> double {
+    if (x < 0 || x != x) {
+        return nan();
+    }
+    if (x == 0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    if (x == std::numeric_limits<double>::infinity()) {
+        return x;
+    }
+    int k = 0;
+    while (x >= 1.41421356237309504880) {
+        x /= 2;
+        k++;
+    }
+    while (x < 0.70710678118654752440) {
+        x *= 2;
+        k--;
+    }
+    double t = (x - 1) / (x + 1);
+    double t2 = t * t;
+    double term = t;
+    double sum = 0;
+    for (int i = 1; i < 60; i += 2) {
+        sum += term / i;
+        term *= t2;
+    }
+    return k * ln2 + 2 * sum;
+}
+
+// e^x = 2^k * e^r，|r| <= ln2/2
+constexpr auto exp(double x) -> double {
+    if (x != x) {
+        return x;
+    }
+    if (x > 709.8) {
+        return std::numeric_limits<double>::infinity();
+    }
+    if (x < -745.2) {
+        return 0;
+    }
+    long long k = static_cast<long long>(x / ln2 + (x < 0 ? -0.5 : 0.5));
+    double r = (x - static_cast<double>(k) * ln2_hi) - static_cast<double>(k) * ln2_lo;
+    double term = 1;
+    double sum = 1;
+    for (int i = 1; i < 30; i++) {
+        term *= r / i;
+        sum += term;
+    }
+    return sum * ipow(2, k);
+}
+
+// 泰勒展开，输入已缩放到 [-pi/4, pi/4]
+constexpr auto sin_kernel(double x) -> double {
+    double x2 = x * x;
+    double term = x;
+    double sum = x;
+    for (int i = 1; i < 12; i++) {
+        term *= -x2 / ((2 * i) * (2 * i + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr auto cos_kernel(double x) -> double {
+    double x2 = x * x;
+    double term = 1;
+    double sum = 1;
+    for (int i = 1; i < 12; i++) {
+        term *= -x2 / ((2 * i - 1) * (2 * i));
+        sum += term;
+    }
+    return sum;
+}
+
+// x 除以 y 的精确余数，符号与 x 相同（fmod 语义），y 为正的有限数、x 为有限数
+// 每步减去不超过 |x| 的最大的 y * 2^k，两者之比在 [1, 2) 内，减法没有舍入误差
+constexpr auto fmod(double x, double y) -> double {
+    double a = x < 0 ? -x : x;
+    if (a < y) {
+        return x;
+    }
+    double m = y;
+    while (m <= a / 2) {
+        m *= 2;
+    }
+    for (; m >= y; m /= 2) {
+        if (a >= m) {
+            a -= m;
+        }
+    }
+    return x < 0 ? -a : a;
+}
+
+// 按 pi/2 划分象限：quadrant 为 x 所在象限，返回象限内的余量
+// pio2_hi 只有 33 位有效数字，n 不超过 2^20 时 n * pio2_hi 是精确的；更大的 x 先对 2*pi 取余，
+// 同时避免 n 超出 long long 范围时转换的未定义行为
+constexpr auto reduce_quadrant(double x, int& quadrant) -> double {
+    if (x != x || x - x != 0) {
+        quadrant = 0;
+        return nan();
+    }
+    if (x > 1647099.0 || x < -1647099.0) {
+        x = fmod(x, 2 * pi);
+    }
+    double q = x / (pi / 2);
+    long long n = static_cast<long long>(q + (q < 0 ? -0.5 : 0.5));
+    quadrant = static_cast<int>(((n % 4) + 4) % 4);
+    return (x - static_cast<double>(n) * pio2_hi) - static_cast<double>(n) * pio2_lo;
+}
+
+constexpr auto sin(double x) -> double {
+    int quadrant = 0;
+    double r = reduce_quadrant(x, quadrant);
+    switch (quadrant) {
+    case 0:
+        return sin_kernel(r);
+    case 1:
+        return cos_kernel(r);
+    case 2:
+        return -sin_kernel(r);
+    default:
+        return -cos_kernel(r);
+    }
+}
+
+constexpr auto cos(double x) -> double {
+    int quadrant = 0;
+    double r = reduce_quadrant(x, quadrant);
+    switch (quadrant) {
+    case 0:
+        return cos_kernel(r);
+    case 1:
+        return -sin_kernel(r);
+    case 2:
+        return -cos_kernel(r);
+    default:
+        return sin_kernel(r);
+    }
+}
+
+constexpr auto tan(double x) -> double { return sin(x) / cos(x); }
+
+constexpr auto pow(double base, double exponent) -> double {
+    if (is_integer(exponent)) {
+        return ipow(base, static_cast<long long>(exponent));
+    }
+    if (base < 0) {
+        return nan();
+    }
+    if (base == 0) {
+        return exponent > 0 ? 0 : std::numeric_limits<double>::infinity();
+    }
+    return exp(exponent * log(base));
+}
+
+constexpr auto factorial(double number) -> double {
+    if (number < 0 || !is_integer(number)) {
+        throw std::domain_error("阶乘要求非负整数");
+    }
+    // 171! 已超出 double 范围
+    if (number > 170) {
+        return std::numeric_limits<double>::infinity();
+    }
+    double result = 1;
+    for (long long i = 2; i <= static_cast<long long>(number); i++) {
+        result *= static_cast<double>(i);
+    }
+    return result;
+}
+
+constexpr auto is_space(char c) -> bool {
+    return c == ' ' || c == '\t' || c == '\v' || c == '\f';
+}
+constexpr auto is_digit(char c) -> bool { return c >= '0' && c <= '9'; }
+constexpr auto is_alpha(char c) -> bool {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// 递归下降解析器，Nodes 为节点存储类型
+template <typename Nodes>
+class parser {
+public:
+    constexpr parser(std::string_view expr, Nodes& nodes) : input(expr), nodes(nodes) {}
+
+    // 解析整个表达式，返回根节点下标
+    constexpr auto parse() -> int {
+        int root = expression();
+        skip_space();
+        if (!at_end()) {
+            throw std::invalid_argument("解析未完成，存在多余字符");
+        }
+        return root;
+    }
+
+private:
+    std::string_view input;
+    std::size_t pos = 0;
+    Nodes& nodes;
+
+    // 换行符与 '\0' 和 C 版本一样视为表达式结束
+    constexpr auto at_end() const -> bool {
+        return pos >= input.size() || input[pos] == '\0' || input[pos] == '\n' ||
+               input[pos] == '\r';
+    }
+
+    constexpr void skip_space() {
+        while (pos < input.size() && is_space(input[pos])) {
+            pos++;
+        }
+    }
+
+    // 跳过空白后，下一个字符是 c 则消费掉
+    constexpr auto accept(char c) -> bool {
+        skip_space();
+        if (!at_end() && input[pos] == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    constexpr auto add_node(op kind, int lhs = -1, int rhs = -1, double value = 0,
+                            func_id fn = func_id::sin) -> int {
+        node n;
+        n.kind = kind;
+        n.fn = fn;
+        n.value = value;
+        n.lhs = lhs;
+        n.rhs = rhs;
+        nodes.push_back(n);
+        return static_cast<int>(nodes.size()) - 1;
+    }
+
+    // expression → term { ('+' | '-') term }
+    constexpr auto expression() -> int {
+        int left = term();
+        while (true) {
+            if (accept('+')) {
+                left = add_node(op::add, left, term());
+            } else if (accept('-')) {
+                left = add_node(op::sub, left, term());
+            } else {
+                return left;
+            }
+        }
+    }
+
+    // term → factor { ('*' | '/') factor }
+    constexpr auto term() -> int {
+        int left = factor();
+        while (true) {
+            if (accept('*')) {
+                left = add_node(op::mul, left, factor());
+            } else if (accept('/')) {
+                left = add_node(op::div, left, factor());
+            } else {
+                return left;
+            }
+        }
+    }
+
+    // factor → [ '-' ] base [ '^' factor ] [ '!' ]
+    constexpr auto factor() -> int {
+        bool negative = accept('-');
+        int value = base();
+        if (negative) {
+            value = add_node(op::negate, value);
+        }
+        // 计算 2^(3!)、(4!)!、2^(3^2) 多个组合
+        while (true) {
+            if (accept('!')) {
+                value = add_node(op::fact, value);
+            } else if (accept('^')) {
+                value = add_node(op::pow, value, factor());
+            } else {
+                return value;
+            }
+        }
+    }
+
+    // base → number | '(' expression ')' | function_call
+    constexpr auto base() -> int {
+        skip_space();
+        if (at_end()) {
+            throw std::invalid_argument("表达式不完整");
+        }
+        char c = input[pos];
+        if (is_digit(c) || c == '.') {
+            return add_node(op::num, -1, -1, number());
+        }
+        if (accept('(')) {
+            int value = expression();
+            if (!accept(')')) {
+                throw std::invalid_argument("右括号缺失，括号不匹配");
+            }
+            return value;
+        }
+        if (is_alpha(c)) {
+            return function_call();
+        }
+        throw std::invalid_argument("未知的 base 项");
+    }
+
+    // 十进制数，支持小数与科学计数法 1.23e-4
+    // 有效数字在整数中精确累积，最多 19 位（小于 2^64），之后的整数位只增加指数、小数位直接舍去
+    constexpr auto number() -> double {
+        unsigned long long mantissa = 0;
+        int significant = 0;
+        int exponent = 0;
+        bool digits = false;
+        while (pos < input.size() && is_digit(input[pos])) {
+            if (significant < 19) {
+                mantissa = mantissa * 10 + static_cast<unsigned>(input[pos] - '0');
+                significant += mantissa != 0;
+            } else {
+                exponent++;
+            }
+            pos++;
+            digits = true;
+        }
+        if (pos < input.size() && input[pos] == '.') {
+            pos++;
+            while (pos < input.size() && is_digit(input[pos])) {
+                if (significant < 19) {
+                    mantissa = mantissa * 10 + static_cast<unsigned>(input[pos] - '0');
+                    significant += mantissa != 0;
+                    exponent--;
+                }
+                pos++;
+                digits = true;
+            }
+        }
+        if (!digits) {
+            throw std::invalid_argument("数值格式错误");
+        }
+        if (pos < input.size() && (input[pos] == 'e' || input[pos] == 'E')) {
+            std::size_t mark = pos++;
+            bool negative = false;
+            if (pos < input.size() && (input[pos] == '+' || input[pos] == '-')) {
+                negative = input[pos++] == '-';
+            }
+            if (pos < input.size() && is_digit(input[pos])) {
+                int e = 0;
+                while (pos < input.size() && is_digit(input[pos])) {
+                    e = e * 10 + (input[pos++] - '0');
+                    if (e > 100000) {
+                        throw std::invalid_argument("数值指数过大");
+                    }
+                }
+                exponent += negative ? -e : e;
+            } else {
+                // 不是指数，回退 'e'
+                pos = mark;
+            }
+        }
+        // 有效数字小于 10^19：指数大于 308 必然溢出，小于 -343 必然小于最小的次正规数
+        if (mantissa == 0 || exponent < -343) {
+            return 0;
+        }
+        if (exponent > 308) {
+            return std::numeric_limits<double>::infinity();
+        }
+        // 负指数用除法，避免 10^-k 无法精确表示带来的额外误差；10^309 已溢出，超出的部分先除掉
+        double value = static_cast<double>(mantissa);
+        if (exponent < -308) {
+            value /= ipow(10, -308 - exponent);
+            exponent = -308;
+        }
+        // 指数大于 288 时结果可能接近 DBL_MAX，10 的幂的几个 ulp 误差会把 1.7976931348623157e308 这样的合法输入推成 inf：
+        // 先乘 10^(e-16)，乘 1e16 之前判断是否越界（编译期求值时溢出不是常量表达式），只差误差范围内越界时取 DBL_MAX
+        if (exponent > 288) {
+            constexpr double max = std::numeric_limits<double>::max();
+            constexpr double limit = max / 1e16;
+            static_assert(limit * 1e16 <= max, "limit 乘回 1e16 不溢出");
+            value *= ipow(10, exponent - 16);
+            if (value > limit) {
+                return value <= limit * (1 + 16 * std::numeric_limits<double>::epsilon())
+                           ? max
+                           : std::numeric_limits<double>::infinity();
+            }
+            return value * 1e16;
+        }
+        return exponent < 0 ? value / ipow(10, -exponent) : value * ipow(10, exponent);
+    }
+
+    // function_call → function '(' arguments ')'
+    constexpr auto function_call() -> int {
+        std::size_t start = pos;
+        while (pos < input.size() && is_alpha(input[pos])) {
+            pos++;
+        }
+        std::string_view name = input.substr(start, pos - start);
+
+        if (!accept('(')) {
+            throw std::invalid_argument("函数左括号匹配失败");
+        }
+        // arguments → expression { ',' expression }
+        int args[2] = {-1, -1};
+        int count = 0;
+        if (!accept(')')) {
+            do {
+                if (count == 2) {
+                    throw std::invalid_argument("函数参数超出了最大个数");
+                }
+                args[count++] = expression();
+            } while (accept(','));
+            if (!accept(')')) {
+                throw std::invalid_argument("函数右括号匹配失败");
+            }
+        }
+
+        if (count == 1) {
+            if (name == "sin") {
+                return add_node(op::func, args[0], -1, 0, func_id::sin);
+            }
+            if (name == "cos") {
+                return add_node(op::func, args[0], -1, 0, func_id::cos);
+            }
+            if (name == "tan") {
+                return add_node(op::func, args[0], -1, 0, func_id::tan);
+            }
+            if (name == "sqrt") {
+                return add_node(op::func, args[0], -1, 0, func_id::sqrt);
+            }
+            if (name == "log") {
+                return add_node(op::func, args[0], -1, 0, func_id::log);
+            }
+        }
+        if (count == 2 && name == "pow") {
+            return add_node(op::func, args[0], args[1], 0, func_id::pow);
+        }
+        throw std::invalid_argument("未知的函数匹配失败");
+    }
+};
+
+} // namespace detail
+
+// 表达式树：解析一次，可反复求值；Nodes 为 fixed_nodes<N> 时可整体作为 constexpr 常量
+template <typename Nodes>
+class basic_expr_tree {
+public:
+    constexpr explicit basic_expr_tree(std::string_view expr) : nodes(), root(-1) {
+        root = detail::parser<Nodes>(expr, nodes).parse();
+    }
+
+    constexpr auto eval() const -> double { return eval_node(root); }
+    constexpr auto size() const -> std::size_t { return nodes.size(); }
+    constexpr auto operator[](std::size_t i) const -> const node& { return nodes[i]; }
+
+private:
+    Nodes nodes;
+    int root;
+
+    constexpr auto eval_node(int index) const -> double {
+        const node& n = nodes[static_cast<std::size_t>(index)];
+        switch (n.kind) {
+        case op::num:
+            return n.value;
+        case op::add:
+            return eval_node(n.lhs) + eval_node(n.rhs);
+        case op::sub:
+            return eval_node(n.lhs) - eval_node(n.rhs);
+        case op::mul:
+            return eval_node(n.lhs) * eval_node(n.rhs);
+        case op::div: {
+            double right = eval_node(n.rhs);
+            if (right == 0) {
+                throw std::domain_error("被除数不能为 0");
+            }
+            return eval_node(n.lhs) / right;
+        }
+        case op::pow:
+            return detail::pow(eval_node(n.lhs), eval_node(n.rhs));
+        case op::fact:
+            return detail::factorial(eval_node(n.lhs));
+        case op::negate:
+            return -eval_node(n.lhs);
+        case op::func:
+            return eval_function(n);
+        }
+        throw std::invalid_argument("未知的节点类型");
+    }
+
+    constexpr auto eval_function(const node& n) const -> double {
+        double arg = eval_node(n.lhs);
+        switch (n.fn) {
+        case func_id::sin:
+            return detail::sin(arg);
+        case func_id::cos:
+            return detail::cos(arg);
+        case func_id::tan:
+            return detail::tan(arg);
+        case func_id::sqrt:
+            return detail::sqrt(arg);
+        case func_id::log:
+            if (arg < 0) {
+                throw std::domain_error("log 参数不能为负数");
+            }
+            return detail::log(arg);
+        case func_id::pow: {
+            double value = detail::pow(arg, eval_node(n.rhs));
+            if (value != value) {
+                throw std::domain_error("pow 结果不是数值");
+            }
+            return value;
+        }
+        }
+        throw std::invalid_argument("未知的函数");
+    }
+};
+
+// 编译期表达式树，节点容量 N
+template <std::size_t N>
+using expr_tree = basic_expr_tree<fixed_nodes<N>>;
+
+// 运行时表达式树，节点容量不限
+using dynamic_expr_tree = basic_expr_tree<std::vector<node>>;
+
+/**
+* @brief             解析字符串字面量，节点个数不会超过字符个数，容量由字面量长度推导
+* @param   expr      表达式字面量
+* @return            constexpr 表达式树，例如 constexpr auto tree = calculator::parse("2^3^2");
+*
+* @note              Revision History
+*/
+template <std::size_t N>
+constexpr auto parse(const char (&expr)[N]) -> expr_tree<N> {
+    return expr_tree<N>(std::string_view(expr, N - 1));
+}
+
+/**
+* @brief             解析运行时字符串
+* @param   expr      表达式
+* @return            运行时表达式树
+*
+* @note              Revision History
+*/
+inline auto parse(std::string_view expr) -> dynamic_expr_tree {
+    return dynamic_expr_tree(expr);
+}
+
+/**
+* @brief             解析并求值
+*
+* @note              字面量在常量表达式中调用时整个计算在编译期完成
+*/
+template <std::size_t N>
+constexpr auto evaluate(const char (&expr)[N]) -> double {
+    return parse(expr).eval();
+}
+
+inline auto evaluate(std::string_view expr) -> double { return parse(expr).eval(); }
+
+#if defined(__cpp_consteval)
+// C++20：强制编译期求值，表达式错误直接编译失败
+template <std::size_t N>
+consteval auto evaluate_ct(const char (&expr)[N]) -> double {
+    return parse(expr).eval();
+}
+#endif
+
+} // namespace calculator
+
+#endif // CCPP_PRO_PL_CALCULATOR_HPP
@@ -0,0 +1,388 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hashalg.h"
+#include "lsh.h"
+#include "minhash.h"
+
+/*
+一、为什么要分段
+（1）千万级文档两两比较是 10^14 次，不可行；LSH 让相似的签名以高概率落进同一个桶，只比较同桶的文档
+（2）段数多、每段行数少时阈值低，召回高但候选多；反之阈值高、候选少但漏判多，lsh_params 在两者间取平衡
+
+二、实现要点
+（1）桶键已经是 xxh3 的输出，哈希表直接用它作为哈希值，不再重复哈希
+（2）桶内链表只存编号，插入是"新文档指向旧链表头，表中的头换成新文档"，不申请内存（next 数组按批扩容）
+（3）批量插入分两步：调用线程先把 next 数组扩到足够大，然后各线程按段并行插入，一张表只被一个线程修改
+*/
+
+static uint64_t band_key_hash(const void *key, size_t len, uint64_t seed) {
+    (void)len;
+    (void)seed;
+    uint64_t k;
+    memcpy(&k, key, sizeof(k));
+    return k;
+}
+
+static inline uint64_t band_key(const lsh_index *idx, const uint32_t *sig, size_t band) {
+    return xxh3Hash64(sig + band * idx->rows, idx->rows * sizeof(uint32_t), band);
+}
+
+// Jaccard 为 s 时成为候选对的概率
+static inline double candidate_probability(double s, size_t bands, size_t rows) {
+    return 1.0 - pow(1.0 - pow(s, (double)rows), (double)bands);
+}
+
+void lsh_params(size_t sig_len, double threshold, size_t *bands, size_t *rows) {
+    const int steps = 100;
+    double best = INFINITY;
+    *bands = sig_len ? sig_len : 1;
+    *rows = 1;
+    for (size_t b = 1; b <= sig_len; b++) {
+        for (size_t r = 1; b * r <= sig_len; r++) {
+            // 假阳性：阈值以下成为候选的概率；假阴性：阈值以上没有成为候选的概率，梯形积分
+            double fp = 0, fn = 0;
+            for (int i = 0; i <= steps; i++) {
+                double w = (i == 0 || i == steps) ? 0.5 : 1.0;
+                double lo = threshold * i / steps;
+                double hi = threshold + (1.0 - threshold) * i / steps;
+                fp += w * candidate_probability(lo, b, r) * threshold / steps;
+                fn += w * (1.0 - candidate_probability(hi, b, r)) * (1.0 - threshold) / steps;
+            }
+            if (fp + fn < best) {
+                best = fp + fn;
+                *bands = b;
+                *rows = r;
+            }
+        }
+    }
+}
+
+bool lsh_init(lsh_index *idx, size_t bands, size_t rows, size_t sig_len) {
+    memset(idx, 0, sizeof(*idx));
+    if (bands == 0 || rows == 0 || bands * rows > sig_len) {
+        return false;
+    }
+    idx->tables = calloc(bands, sizeof(hasht));
+    idx->next = calloc(bands, sizeof(uint32_t *));
+    if (!idx->tables || !idx->next) {
+        free(idx->tables);
+        free(idx->next);
+        return false;
+    }
+    for (size_t b = 0; b < bands; b++) {
+        hasht_init(&idx->tables[b], sizeof(uint64_t), sizeof(uint32_t), band_key_hash, 0);
+    }
+    idx->bands = bands;
+    idx->rows = rows;
+    idx->sig_len = sig_len;
+    return true;
+}
+
+void lsh_free(lsh_index *idx) {
+    for (size_t b = 0; b < idx->bands; b++) {
+        hasht_free(&idx->tables[b]);
+        free(idx->next[b]);
+    }
+    free(idx->tables);
+    free(idx->next);
+    memset(idx, 0, sizeof(*idx));
+}
+
+// next 数组扩到至少 need 个，按两倍增长
+static bool reserve_docs(lsh_index *idx, size_t need) {
+    if (need <= idx->capacity) {
+        return true;
+    }
+    if (need > LSH_NIL) {
+        return false;
+    }
+    size_t capacity = idx->capacity ? idx->capacity : 1024;
+    while (capacity < need) {
+        capacity *= 2;
+    }
+    for (size_t b = 0; b < idx->bands; b++) {
+        uint32_t *next = realloc(idx->next[b], capacity * sizeof(uint32_t));
+        if (!next) {
+            return false;
+        }
+        idx->next[b] = next;
+    }
+    idx->capacity = capacity;
+    return true;
+}
+
+// 从第 band 段撤销编号为 first 起的 n 份文档：倒序撤销时每份都在所在链表的表头
+static void rollback_band(lsh_index *idx, size_t band, const uint32_t *sigs, uint32_t first, size_t n) {
+    hasht *t = &idx->tables[band];
+    uint32_t *next = idx->next[band];
+    for (size_t i = n; i-- > 0;) {
+        uint32_t doc = first + (uint32_t)i;
+        uint64_t key = band_key(idx, sigs + i * idx->sig_len, band);
+        uint32_t *head = hasht_find_hash(t, &key, key);
+        if (next[doc] == LSH_NIL) {
+            hasht_erase_hash(t, &key, key);
+        } else {
+            *head = next[doc];
+        }
+    }
+}
+
+// 把编号为 first 起的 n 份文档插入第 band 段，失败时撤销本段已插入的，本段不变
+static bool insert_band(lsh_index *idx, size_t band, const uint32_t *sigs, uint32_t first, size_t n) {
+    hasht *t = &idx->tables[band];
+    uint32_t *next = idx->next[band];
+    for (size_t i = 0; i < n; i++) {
+        uint32_t doc = first + (uint32_t)i;
+        uint64_t key = band_key(idx, sigs + i * idx->sig_len, band);
+        uint32_t *head = hasht_find_hash(t, &key, key);
+        if (head) {
+            next[doc] = *head;
+            *head = doc;
+        } else {
+            next[doc] = LSH_NIL;
+            if (!hasht_insert_hash(t, &key, &doc, key)) {
+                rollback_band(idx, band, sigs, first, i);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+uint32_t lsh_insert(lsh_index *idx, const uint32_t *sig) {
+    uint32_t doc = (uint32_t)idx->count;
+    if (!lsh_insert_batch(idx, sig, 1, 1)) {
+        return LSH_NIL;
+    }
+    return doc;
+}
+
+typedef struct {
+    lsh_index *idx;
+    const uint32_t *sigs;
+    uint32_t first;
+    size_t n;
+    size_t band_begin;
+    size_t band_step;
+    size_t band_end;    // 第一个没有插入的段，全部成功时不小于 bands
+    bool ok;
+} insert_job;
+
+static void *insert_worker(void *arg) {
+    insert_job *job = (insert_job *)arg;
+    job->ok = true;
+    size_t b = job->band_begin;
+    for (; b < job->idx->bands; b += job->band_step) {
+        if (!insert_band(job->idx, b, job->sigs, job->first, job->n)) {
+            job->ok = false;
+            break;
+        }
+    }
+    job->band_end = b;
+    return NULL;
+}
+
+bool lsh_insert_batch(lsh_index *idx, const uint32_t *sigs, size_t n, unsigned threads) {
+    if (!reserve_docs(idx, idx->count + n)) {
+        return false;
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+    if (threads > idx->bands) {
+        threads = (unsigned)idx->bands;
+    }
+    insert_job *jobs = malloc(threads * sizeof(insert_job));
+    pthread_t *tids = malloc(threads * sizeof(pthread_t));
+    if (!jobs || !tids) {
+        free(jobs);
+        free(tids);
+        return false;
+    }
+    // 线程创建失败时步长仍按 threads 划分，未启动的那几份由调用线程依次完成
+    bool *started = calloc(threads, sizeof(bool));
+    for (unsigned t = 0; t < threads; t++) {
+        jobs[t] = (insert_job){idx, sigs, (uint32_t)idx->count, n, t, threads, t, false};
+        if (t > 0 && started) {
+            started[t] = pthread_create(&tids[t], NULL, insert_worker, &jobs[t]) == 0;
+        }
+    }
+    bool ok = true;
+    for (unsigned t = 0; t < threads; t++) {
+        if (t > 0 && started && started[t]) {
+            pthread_join(tids[t], NULL);
+        } else {
+            insert_worker(&jobs[t]);
+        }
+        ok &= jobs[t].ok;
+    }
+    // 有一段失败时撤销其他段已插入的这一批，索引回到调用前的状态，可以重试
+    for (unsigned t = 0; !ok && t < threads; t++) {
+        for (size_t b = jobs[t].band_begin; b < jobs[t].band_end; b += threads) {
+            rollback_band(idx, b, sigs, (uint32_t)idx->count, n);
+        }
+    }
+    free(started);
+    free(jobs);
+    free(tids);
+    if (ok) {
+        idx->count += n;
+    }
+    return ok;
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static bool candidates_push(lsh_candidates *c, uint32_t id) {
+    if (c->count == c->capacity) {
+        size_t capacity = c->capacity ? c->capacity * 2 : 64;
+        uint32_t *ids = realloc(c->ids, capacity * sizeof(uint32_t));
+        if (!ids) {
+            return false;
+        }
+        c->ids = ids;
+        c->capacity = capacity;
+    }
+    c->ids[c->count++] = id;
+    return true;
+}
+
+bool lsh_query(const lsh_index *idx, const uint32_t *sig, lsh_candidates *out) {
+    out->count = 0;
+    for (size_t b = 0; b < idx->bands; b++) {
+        uint64_t key = band_key(idx, sig, b);
+        const uint32_t *head = hasht_find_hash(&idx->tables[b], &key, key);
+        for (uint32_t doc = head ? *head : LSH_NIL; doc != LSH_NIL; doc = idx->next[b][doc]) {
+            if (!candidates_push(out, doc)) {
+                return false;
+            }
+        }
+    }
+    // 多段命中同一文档，排序去重
+    qsort(out->ids, out->count, sizeof(uint32_t), compare_u32);
+    size_t unique = 0;
+    for (size_t i = 0; i < out->count; i++) {
+        if (unique == 0 || out->ids[i] != out->ids[unique - 1]) {
+            out->ids[unique++] = out->ids[i];
+        }
+    }
+    out->count = unique;
+    return true;
+}
+
+void lsh_candidates_free(lsh_candidates *c) {
+    free(c->ids);
+    memset(c, 0, sizeof(*c));
+}
+
+size_t lsh_pairs(const lsh_index *idx, const uint32_t *sigs, double threshold, lsh_pair_fn fn, void *ctx) {
+    // 已回调的文档对，同一对在多段相撞时只报告一次
+    hasht seen;
+    hasht_init(&seen, sizeof(uint64_t), 0, hasht_hash_xxh3, 0);
+    size_t reported = 0;
+    bool ok = true;
+    for (size_t b = 0; ok && b < idx->bands; b++) {
+        size_t pos = 0;
+        void *value;
+        while (ok && hasht_next(&idx->tables[b], &pos, NULL, &value)) {
+            uint32_t head = *(uint32_t *)value;
+            for (uint32_t i = head; ok && i != LSH_NIL; i = idx->next[b][i]) {
+                for (uint32_t j = idx->next[b][i]; j != LSH_NIL; j = idx->next[b][j]) {
+                    // 链表从新到旧，j < i
+                    uint64_t pair = (uint64_t)j << 32 | i;
+                    if (hasht_find(&seen, &pair)) {
+                        continue;
+                    }
+                    if (!hasht_insert(&seen, &pair, NULL)) {
+                        ok = false;
+                        break;
+                    }
+                    double similarity = -1;
+                    if (sigs) {
+                        // 用完整的签名估计，比只用分段的 bands * rows 个值更准
+                        similarity = minhash_jaccard(sigs + (size_t)j * idx->sig_len, sigs + (size_t)i * idx->sig_len,
+                                                     idx->sig_len);
+                        if (similarity < threshold) {
+                            continue;
+                        }
+                    }
+                    fn(j, i, similarity, ctx);
+                    reported++;
+                }
+            }
+        }
+    }
+    hasht_free(&seen);
+    return ok ? reported : SIZE_MAX;
+}
+
+#ifdef LSH_MAIN
+// 随机单词拼成的文档
+static size_t random_doc(uint64_t *state, char *buf, size_t cap, size_t words) {
+    size_t len = 0;
+    for (size_t w = 0; w < words && len + 8 < cap; w++) {
+        *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+        len += (size_t)snprintf(buf + len, cap - len, "w%u ", (unsigned)(*state >> 33) % 5000);
+    }
+    return len;
+}
+
+static void count_pair(uint32_t a, uint32_t b, double similarity, void *ctx) {
+    (void)similarity;
+    // 第 i 份（i >= 1000）是第 i - 1000 份的近似副本
+    size_t *planted = (size_t *)ctx;
+    planted[0] += b >= 1000 && a == b - 1000;
+    planted[1]++;
+}
+
+int main(void) {
+
+    // 示例1：1000 份随机文档，另有 1000 份各改动两个单词的近似副本，签名长度 128、阈值 0.7
+    enum { BASE = 1000, WORDS = 60, GRAM = 8 };
+    static char text[2 * BASE][1024];
+    static size_t lens[2 * BASE];
+    uint64_t state = 7;
+    for (size_t i = 0; i < BASE; i++) {
+        lens[i] = random_doc(&state, text[i], sizeof(text[i]), WORDS);
+        memcpy(text[BASE + i], text[i], lens[i]);
+        lens[BASE + i] = lens[i];
+        memcpy(text[BASE + i] + lens[i] / 3, "edit", 4);
+        memcpy(text[BASE + i] + lens[i] * 2 / 3, "edit", 4);
+    }
+    minhash mh;
+    minhash_init(&mh, 128, 1);
+    uint32_t *sigs = malloc(2 * BASE * mh.k * sizeof(uint32_t));
+    uint64_t features[1024];
+    for (size_t i = 0; i < 2 * BASE; i++) {
+        size_t n = minhash_shingles(text[i], lens[i], GRAM, features);
+        minhash_sign(&mh, features, n, sigs + i * mh.k);
+    }
+    size_t bands, rows;
+    lsh_params(mh.k, 0.7, &bands, &rows);
+    lsh_index idx;
+    lsh_init(&idx, bands, rows, mh.k);
+    bool ok = lsh_insert_batch(&idx, sigs, 2 * BASE, 4);
+
+    // 示例2：枚举候选对，副本的 Jaccard 约 0.88，成为候选的概率约 99.5%，按 S 曲线应找到绝大多数
+    size_t planted[2] = {0, 0};
+    ok &= lsh_pairs(&idx, sigs, 0.5, count_pair, planted) != SIZE_MAX;
+    lsh_candidates c = {0};
+    lsh_query(&idx, sigs + (BASE + 1) * mh.k, &c);
+    ok &= planted[0] >= BASE * 98 / 100;
+    printf("bands %zu x rows %zu, pairs %zu, planted found %zu/%d, query candidates %zu, check %s\n", bands, rows,
+           planted[1], planted[0], BASE, c.count, ok ? "ok" : "FAILED");
+
+    lsh_candidates_free(&c);
+    lsh_free(&idx);
+    minhash_free(&mh);
+    free(sigs);
+    return ok ? 0 : 1;
+}
+#endif
@@ -0,0 +1,119 @@
+#ifndef DSA_DEDUP_LSH_H
+#define DSA_DEDUP_LSH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hasht.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+MinHash 签名的 LSH 分段（banding）索引
+（1）签名的前 bands * rows 个值分成 bands 段，每段 rows 个值哈希成一个 64 位桶键
+（2）两份文档只要有一段完全相同就成为候选对，Jaccard 为 s 时成为候选的概率为 1 - (1 - s^rows)^bands，
+    是一条以 (1/bands)^(1/rows) 附近为阈值的 S 形曲线，低于阈值的文档对很少进入候选，不需要两两比较
+（3）每段一张 hasht，桶键映射到桶内最后插入的文档编号，桶内文档用 next 数组串成链表，每份文档每段只占 4 字节
+（4）文档编号按插入顺序从 0 开始；批量插入时每个线程负责若干段，各段互不相交，不需要加锁
+*/
+
+// 链表结束标记，也是插入失败的返回值
+#define LSH_NIL UINT32_MAX
+
+typedef struct {
+    size_t bands;
+    size_t rows;
+    size_t sig_len;     // 签名长度（步长），不小于 bands * rows
+    hasht *tables;      // bands 张表：桶键 -> 链表头
+    uint32_t **next;    // bands 个数组：next[band][doc] 为同一桶内的上一份文档
+    size_t count;       // 文档数
+    size_t capacity;    // next 数组的容量
+} lsh_index;
+
+// 查询结果，按文档编号升序、不重复
+typedef struct {
+    uint32_t *ids;
+    size_t count;
+    size_t capacity;
+} lsh_candidates;
+
+// 候选对回调，a < b，similarity 为签名估计的 Jaccard，未验证时为 -1
+typedef void (*lsh_pair_fn)(uint32_t a, uint32_t b, double similarity, void *ctx);
+
+/**
+* @brief             按签名长度与相似度阈值选择分段参数
+* @param   sig_len   签名长度
+* @param   threshold 相似度阈值，0~1
+* @param   bands     输出段数
+* @param   rows      输出每段行数
+*
+* @note              最小化阈值两侧误判（假阳性）与漏判（假阴性）概率曲线下面积之和，与 datasketch 的做法相同
+*/
+void lsh_params(size_t sig_len, double threshold, size_t *bands, size_t *rows);
+
+/**
+* @brief             初始化空索引
+* @param   bands     段数
+* @param   rows      每段行数
+* @param   sig_len   签名长度，每份签名从 sig + i * sig_len 开始
+* @return  bool      参数非法或申请内存失败返回 false
+*
+* @note              Revision History
+*/
+bool lsh_init(lsh_index *idx, size_t bands, size_t rows, size_t sig_len);
+
+/**
+* @brief             释放
+*
+* @note              Revision History
+*/
+void lsh_free(lsh_index *idx);
+
+/**
+* @brief             插入一份文档
+* @param   sig       签名
+* @return  uint32_t  文档编号，申请内存失败返回 LSH_NIL
+*
+* @note              Revision History
+*/
+uint32_t lsh_insert(lsh_index *idx, const uint32_t *sig);
+
+/**
+* @brief             批量插入，可以分多批流式调用
+* @param   sigs      n 份签名，编号依次为 idx->count, idx->count + 1, ...
+* @param   threads   线程数（含调用线程），按段划分
+* @return  bool      申请内存失败返回 false，此时这一批已插入的段全部撤销，索引与调用前相同
+*
+* @note              Revision History
+*/
+bool lsh_insert_batch(lsh_index *idx, const uint32_t *sigs, size_t n, unsigned threads);
+
+/**
+* @brief             查询与 sig 至少有一段相同的文档
+* @param   out       输出，先清空再追加，用 lsh_candidates_free 释放
+* @return  bool      申请内存失败返回 false
+*
+* @note              查询只读，多线程可以同时查询
+*/
+bool lsh_query(const lsh_index *idx, const uint32_t *sig, lsh_candidates *out);
+
+void lsh_candidates_free(lsh_candidates *c);
+
+/**
+* @brief             枚举所有候选对，每对只回调一次
+* @param   sigs      全部签名（按编号排列），用于验证；NULL 时不验证
+* @param   threshold 估计的 Jaccard（按完整签名 sig_len 个值计算）低于阈值的候选对不回调
+* @return  size_t    回调的次数；申请内存失败时停止枚举，返回 SIZE_MAX
+*
+* @note              同一桶内 m 份文档产生 m(m-1)/2 对，大量完全相同的文档应先按签名精确去重
+*/
+size_t lsh_pairs(const lsh_index *idx, const uint32_t *sigs, double threshold, lsh_pair_fn fn, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_DEDUP_LSH_H
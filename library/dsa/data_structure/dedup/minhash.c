@@ -0,0 +1,222 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "hashalg.h"
+#include "minhash.h"
+
+/*
+一、MinHash 的原理
+（1）对随机排列 π，两个集合 A、B 的最小元素相同的概率 P[min π(A) = min π(B)] = |A∩B| / |A∪B|，即 Jaccard 相似度
+（2）用 K 个哈希函数模拟 K 个排列，签名相同位置相等的比例就是 Jaccard 的估计
+（3）近似重复检测只比较签名，一份文档无论多长都压缩成 K 个 32 位整数
+
+二、一次计算多个哈希函数
+（1）h_i(x) = (a_i * x + b_i) >> 32 是 multiply-add-shift 泛哈希族，32 位输入时两两独立，输出分布足够接近随机排列
+（2）64 位乘 32 位用两次 32x32→64 乘法（_mm256_mul_epu32）拼出，一个 AVX2 寄存器算 4 个，两个寄存器算一组 8 个
+（3）一组放偶数号函数，另一组放奇数号函数：偶数组的结果右移 32 位，奇数组的结果本来就在高 32 位，
+    一条 blend 即得到按顺序排列的 8 个 32 位哈希值，再用一条 min_epu32 更新最小值
+（4）外层循环遍历函数组、内层遍历特征，8 个最小值与系数一直留在寄存器里，特征数组反复读取但在 L1 中
+
+三、SimHash
+（1）每个特征的哈希值逐位投票：该位为 1 加权重，为 0 减权重，最后符号为正的位置 1
+（2）相似文档大部分特征相同，投票结果只在少数位上翻转，汉明距离小
+*/
+
+// 每组 8 个函数的系数存放顺序：前 4 个为第 0、2、4、6 号，后 4 个为第 1、3、5、7 号
+static inline size_t lane_of(size_t slot) {
+    return slot < 4 ? 2 * slot : 2 * (slot - 4) + 1;
+}
+
+bool minhash_init(minhash *mh, size_t k, uint64_t seed) {
+    k = (k + MINHASH_LANES - 1) / MINHASH_LANES * MINHASH_LANES;
+    if (k == 0) {
+        k = MINHASH_LANES;
+    }
+    mh->a = aligned_alloc(32, k * sizeof(uint64_t));
+    mh->b = aligned_alloc(32, k * sizeof(uint64_t));
+    if (!mh->a || !mh->b) {
+        minhash_free(mh);
+        return false;
+    }
+    mh->k = k;
+    uint64_t state = seed;
+    for (size_t i = 0; i < k; i++) {
+        mh->a[i] = splitmix64(&state) | 1;
+        mh->b[i] = splitmix64(&state);
+    }
+    return true;
+}
+
+void minhash_free(minhash *mh) {
+    free(mh->a);
+    free(mh->b);
+    mh->a = NULL;
+    mh->b = NULL;
+    mh->k = 0;
+}
+
+#if defined(__AVX2__)
+void minhash_sign(const minhash *mh, const uint64_t *features, size_t n, uint32_t *sig) {
+    for (size_t g = 0; g < mh->k; g += MINHASH_LANES) {
+        const __m256i a0 = _mm256_load_si256((const __m256i *)(mh->a + g));
+        const __m256i a1 = _mm256_load_si256((const __m256i *)(mh->a + g + 4));
+        const __m256i a0_hi = _mm256_srli_epi64(a0, 32);
+        const __m256i a1_hi = _mm256_srli_epi64(a1, 32);
+        const __m256i b0 = _mm256_load_si256((const __m256i *)(mh->b + g));
+        const __m256i b1 = _mm256_load_si256((const __m256i *)(mh->b + g + 4));
+        __m256i min = _mm256_set1_epi32(-1);
+        for (size_t i = 0; i < n; i++) {
+            const __m256i x = _mm256_set1_epi64x((long long)(uint32_t)features[i]);
+            __m256i p0 = _mm256_add_epi64(_mm256_mul_epu32(a0, x), _mm256_slli_epi64(_mm256_mul_epu32(a0_hi, x), 32));
+            __m256i p1 = _mm256_add_epi64(_mm256_mul_epu32(a1, x), _mm256_slli_epi64(_mm256_mul_epu32(a1_hi, x), 32));
+            p0 = _mm256_srli_epi64(_mm256_add_epi64(p0, b0), 32);
+            p1 = _mm256_add_epi64(p1, b1);
+            min = _mm256_min_epu32(min, _mm256_blend_epi32(p0, p1, 0xAA));
+        }
+        _mm256_storeu_si256((__m256i *)(sig + g), min);
+    }
+}
+#else
+void minhash_sign(const minhash *mh, const uint64_t *features, size_t n, uint32_t *sig) {
+    for (size_t g = 0; g < mh->k; g += MINHASH_LANES) {
+        uint32_t min[MINHASH_LANES];
+        for (size_t s = 0; s < MINHASH_LANES; s++) {
+            min[s] = MINHASH_EMPTY;
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint64_t x = (uint32_t)features[i];
+            for (size_t s = 0; s < MINHASH_LANES; s++) {
+                uint32_t h = (uint32_t)((mh->a[g + s] * x + mh->b[g + s]) >> 32);
+                min[s] = h < min[s] ? h : min[s];
+            }
+        }
+        for (size_t s = 0; s < MINHASH_LANES; s++) {
+            sig[g + lane_of(s)] = min[s];
+        }
+    }
+}
+#endif
+
+// 文档长短不一，线程每次领取一小段，避免静态划分时某个线程拿到的都是长文档
+#define MINHASH_BATCH_CHUNK 64
+
+typedef struct {
+    const minhash *mh;
+    const minhash_doc *docs;
+    size_t n;
+    uint32_t *sigs;
+    size_t next;    // 下一段的起点，原子递增
+} sign_job;
+
+static void *sign_worker(void *arg) {
+    sign_job *job = (sign_job *)arg;
+    for (;;) {
+        size_t begin = __atomic_fetch_add(&job->next, MINHASH_BATCH_CHUNK, __ATOMIC_RELAXED);
+        if (begin >= job->n) {
+            return NULL;
+        }
+        size_t end = begin + MINHASH_BATCH_CHUNK < job->n ? begin + MINHASH_BATCH_CHUNK : job->n;
+        for (size_t i = begin; i < end; i++) {
+            minhash_sign(job->mh, job->docs[i].features, job->docs[i].count, job->sigs + i * job->mh->k);
+        }
+    }
+}
+
+bool minhash_sign_batch(const minhash *mh, const minhash_doc *docs, size_t n, uint32_t *sigs, unsigned threads) {
+    sign_job job = {mh, docs, n, sigs, 0};
+    if (threads <= 1) {
+        sign_worker(&job);
+        return true;
+    }
+    // 调用线程算作其中一个，线程没有全部创建成功时由它兜底做完
+    pthread_t *tids = malloc((threads - 1) * sizeof(pthread_t));
+    unsigned started = 0;
+    while (tids && started < threads - 1 && pthread_create(&tids[started], NULL, sign_worker, &job) == 0) {
+        started++;
+    }
+    sign_worker(&job);
+    for (unsigned i = 0; i < started; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    free(tids);
+    return started == threads - 1;
+}
+
+double minhash_jaccard(const uint32_t *sig1, const uint32_t *sig2, size_t k) {
+    size_t same = 0;
+    for (size_t i = 0; i < k; i++) {
+        same += sig1[i] == sig2[i];
+    }
+    return k ? (double)same / (double)k : 0;
+}
+
+size_t minhash_shingles(const char *text, size_t len, size_t gram, uint64_t *out) {
+    if (len <= gram) {
+        out[0] = xxh3Hash64(text, len, 0);
+        return 1;
+    }
+    for (size_t i = 0; i + gram <= len; i++) {
+        out[i] = xxh3Hash64(text + i, gram, 0);
+    }
+    return len - gram + 1;
+}
+
+uint64_t simhash64(const uint64_t *features, const uint32_t *weights, size_t n) {
+    int64_t votes[64] = {0};
+    for (size_t i = 0; i < n; i++) {
+        int64_t w = weights ? (int64_t)weights[i] : 1;
+        uint64_t h = features[i];
+        for (int b = 0; b < 64; b++) {
+            votes[b] += (h >> b & 1) ? w : -w;
+        }
+    }
+    uint64_t fp = 0;
+    for (int b = 0; b < 64; b++) {
+        fp |= (uint64_t)(votes[b] > 0) << b;
+    }
+    return fp;
+}
+
+#ifdef MINHASH_MAIN
+int main(void) {
+
+    // 示例1：两段只差一个词的文本，估计的 Jaccard 相似度接近按 shingle 集合算出的真实值
+    const char *doc1 = "the quick brown fox jumps over the lazy dog near the river bank at dawn";
+    const char *doc2 = "the quick brown fox leaps over the lazy dog near the river bank at dawn";
+    uint64_t f1[128], f2[128];
+    size_t n1 = minhash_shingles(doc1, strlen(doc1), 5, f1);
+    size_t n2 = minhash_shingles(doc2, strlen(doc2), 5, f2);
+    size_t inter = 0, uni = n1;
+    for (size_t j = 0; j < n2; j++) {
+        bool found = false;
+        for (size_t i = 0; i < n1 && !found; i++) {
+            found = f1[i] == f2[j];
+        }
+        inter += found;
+        uni += !found;
+    }
+    minhash mh;
+    minhash_init(&mh, 256, 1);
+    uint32_t s1[256], s2[256];
+    minhash_sign(&mh, f1, n1, s1);
+    minhash_sign(&mh, f2, n2, s2);
+    printf("jaccard: exact %.3f, minhash (k=%zu) %.3f\n", (double)inter / (double)uni, mh.k,
+           minhash_jaccard(s1, s2, mh.k));
+
+    // 示例2：SimHash 的汉明距离，近似文本远小于无关文本的约 32
+    const char *doc3 = "a completely different sentence about hash tables and cache lines";
+    uint64_t f3[128];
+    size_t n3 = minhash_shingles(doc3, strlen(doc3), 5, f3);
+    printf("simhash distance: similar %d, unrelated %d\n", simhash_distance(simhash64(f1, NULL, n1), simhash64(f2, NULL, n2)),
+           simhash_distance(simhash64(f1, NULL, n1), simhash64(f3, NULL, n3)));
+
+    minhash_free(&mh);
+    return 0;
+}
+#endif
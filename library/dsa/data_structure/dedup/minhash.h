@@ -0,0 +1,111 @@
+#ifndef DSA_DEDUP_MINHASH_H
+#define DSA_DEDUP_MINHASH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+文档指纹，用于近似重复检测
+（1）MinHash：K 个独立哈希函数各取文档全部特征（shingle）哈希值的最小值，两份文档签名中相同位置相等的比例
+    是 Jaccard 相似度的无偏估计，标准差约 sqrt(J(1-J)/K)；配合 lsh.h 的分段索引找候选对
+（2）SimHash：每个特征的 64 位哈希按位投票，得到的 64 位指纹的汉明距离反映余弦相似度，适合海明距离 ≤ 3 的网页去重
+（3）特征由调用者决定，minhash_shingles 提供按字节 k-gram 切分并用 xxh3 哈希的默认做法
+*/
+
+// 签名长度须为 8 的倍数，AVX2 一次计算 8 个哈希函数
+#define MINHASH_LANES 8
+// 签名中的空值：没有任何特征的文档
+#define MINHASH_EMPTY UINT32_MAX
+
+// K 个哈希函数 h_i(x) = (a_i * x + b_i) >> 32，x 为特征哈希的低 32 位，a_i、b_i 为 64 位随机数
+typedef struct {
+    uint64_t *a;    // 按 SIMD 布局存放，见 minhash.c
+    uint64_t *b;
+    size_t k;
+} minhash;
+
+// 一份文档的特征哈希
+typedef struct {
+    const uint64_t *features;
+    size_t count;
+} minhash_doc;
+
+/**
+* @brief             初始化 k 个哈希函数
+* @param   k         签名长度，向上取整为 MINHASH_LANES 的倍数
+* @param   seed      相同种子生成的签名可以互相比较
+* @return  bool      申请内存失败返回 false
+*
+* @note              Revision History
+*/
+bool minhash_init(minhash *mh, size_t k, uint64_t seed);
+
+/**
+* @brief             释放
+*
+* @note              Revision History
+*/
+void minhash_free(minhash *mh);
+
+/**
+* @brief             计算一份文档的签名
+* @param   features  特征哈希，可以有重复
+* @param   n         特征个数，为 0 时签名全部为 MINHASH_EMPTY
+* @param   sig       输出，k 个 32 位值
+*
+* @note              按 8 个哈希函数一组遍历特征，一组的 8 个最小值留在一个 AVX2 寄存器里
+*/
+void minhash_sign(const minhash *mh, const uint64_t *features, size_t n, uint32_t *sig);
+
+/**
+* @brief             多线程计算一批文档的签名
+* @param   docs      n 份文档
+* @param   sigs      输出，n * k 个，第 i 份文档的签名从 sigs + i * k 开始
+* @param   threads   线程数（含调用线程），0 或 1 时只在调用线程计算
+* @return  bool      创建线程失败返回 false，此时已在调用线程完成计算
+*
+* @note              Revision History
+*/
+bool minhash_sign_batch(const minhash *mh, const minhash_doc *docs, size_t n, uint32_t *sigs, unsigned threads);
+
+// 两个签名估计的 Jaccard 相似度
+double minhash_jaccard(const uint32_t *sig1, const uint32_t *sig2, size_t k);
+
+/**
+* @brief             按字节 k-gram 切分文本并哈希
+* @param   text      文本
+* @param   len       字节数
+* @param   gram      每个 shingle 的字节数，文本短于 gram 时整段作为一个 shingle
+* @param   out       输出，至少 len - gram + 1 个（len < gram 时 1 个）
+* @return  size_t    输出的个数
+*
+* @note              Revision History
+*/
+size_t minhash_shingles(const char *text, size_t len, size_t gram, uint64_t *out);
+
+/**
+* @brief             SimHash 指纹
+* @param   features  特征哈希
+* @param   weights   每个特征的权重（如词频），NULL 时权重均为 1
+* @param   n         特征个数
+* @return  uint64_t  64 位指纹
+*
+* @note              Revision History
+*/
+uint64_t simhash64(const uint64_t *features, const uint32_t *weights, size_t n);
+
+// 两个 SimHash 指纹的汉明距离
+static inline int simhash_distance(uint64_t a, uint64_t b) {
+    return __builtin_popcountll(a ^ b);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_DEDUP_MINHASH_H
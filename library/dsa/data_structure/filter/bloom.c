@@ -0,0 +1,184 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "bloom.h"
+
+/*
+一、标准布隆过滤器的问题
+（1）k 个哈希位散布在整个位数组上，过滤器大于缓存时一次查询有 k 次缓存未命中
+（2）uthash 的 HASH_BLOOM 每个键只置 1 位，误判率高，且只能跟随哈希表使用
+
+二、分块布隆过滤器
+（1）先用哈希值选一个 64 字节的块，k 个位都在块内，查询只有一次缓存未命中
+（2）块内再分 8 个 64 位字，每个字恰好置 1 位，8 个位置互不冲突，AVX2 两条指令即可完成测试
+（3）代价：块间负载有随机波动，相同每键位数下误判率略高于标准布隆过滤器，
+    10 位/键时标准布隆约 0.8%，分块约 1%；16 位/键时约 0.05% 与 0.09%
+
+三、误判率估算
+（1）每块平均 λ = 512 / bits_per_key 个键，每个字被某键置 1 位的概率 1/64
+（2）单块内 m 个键时误判率 (1 - (1 - 1/64)^m)^8，按泊松分布对 m 求平均
+*/
+
+// 8 个奇数常数，与 Impala / Parquet 的分块布隆过滤器相同
+static const uint32_t bloom_salts[BLOOM_K] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+};
+
+// 高 32 位乘块数取高位，等价于取模但没有除法
+static inline size_t block_index(const bloom *b, uint64_t hash) {
+    return (size_t)(((hash >> 32) * (uint64_t)b->nblocks) >> 32);
+}
+
+bool bloom_init(bloom *b, size_t expected, double bits_per_key) {
+    double bits = (double)(expected ? expected : 1) * (bits_per_key > 0 ? bits_per_key : 10);
+    size_t nblocks = (size_t)ceil(bits / (BLOOM_BLOCK_BYTES * 8));
+    b->blocks = aligned_alloc(BLOOM_BLOCK_BYTES, nblocks * sizeof(bloom_block));
+    if (!b->blocks) {
+        b->nblocks = 0;
+        return false;
+    }
+    b->nblocks = nblocks;
+    bloom_clear(b);
+    return true;
+}
+
+void bloom_free(bloom *b) {
+    free(b->blocks);
+    b->blocks = NULL;
+    b->nblocks = 0;
+}
+
+void bloom_clear(bloom *b) {
+    memset(b->blocks, 0, b->nblocks * sizeof(bloom_block));
+}
+
+#if defined(__AVX2__)
+// 8 个 32 位乘法一次完成，取高 6 位作为 8 个字内的位移，再扩展为两组 4 个 64 位掩码
+static inline void block_masks(uint32_t lo, __m256i *m0, __m256i *m1) {
+    const __m256i salts = _mm256_loadu_si256((const __m256i *)bloom_salts);
+    __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32((int)lo), salts), 26);
+    const __m256i one = _mm256_set1_epi64x(1);
+    *m0 = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(shifts)));
+    *m1 = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(shifts, 1)));
+}
+
+static inline void block_add(bloom_block *blk, uint32_t lo) {
+    __m256i m0, m1;
+    block_masks(lo, &m0, &m1);
+    __m256i *w = (__m256i *)blk->words;
+    _mm256_store_si256(w, _mm256_or_si256(_mm256_load_si256(w), m0));
+    _mm256_store_si256(w + 1, _mm256_or_si256(_mm256_load_si256(w + 1), m1));
+}
+
+// testc 判断 (~block & mask) 是否全 0，即掩码的位在块中都已置 1
+static inline bool block_contains(const bloom_block *blk, uint32_t lo) {
+    __m256i m0, m1;
+    block_masks(lo, &m0, &m1);
+    const __m256i *w = (const __m256i *)blk->words;
+    return _mm256_testc_si256(_mm256_load_si256(w), m0) & _mm256_testc_si256(_mm256_load_si256(w + 1), m1);
+}
+#else
+static inline void block_add(bloom_block *blk, uint32_t lo) {
+    for (int i = 0; i < BLOOM_K; i++) {
+        blk->words[i] |= 1ULL << ((lo * bloom_salts[i]) >> 26);
+    }
+}
+
+static inline bool block_contains(const bloom_block *blk, uint32_t lo) {
+    uint64_t missing = 0;
+    for (int i = 0; i < BLOOM_K; i++) {
+        uint64_t mask = 1ULL << ((lo * bloom_salts[i]) >> 26);
+        missing |= mask & ~blk->words[i];
+    }
+    return missing == 0;
+}
+#endif
+
+void bloom_add(bloom *b, uint64_t hash) {
+    block_add(&b->blocks[block_index(b, hash)], (uint32_t)hash);
+}
+
+bool bloom_contains(const bloom *b, uint64_t hash) {
+    return block_contains(&b->blocks[block_index(b, hash)], (uint32_t)hash);
+}
+
+// 预取距离：约等于一次内存访问延迟内能处理的键数
+#define BLOOM_PREFETCH_DISTANCE 16
+
+void bloom_add_batch(bloom *b, const uint64_t *hashes, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (i + BLOOM_PREFETCH_DISTANCE < n) {
+            __builtin_prefetch(&b->blocks[block_index(b, hashes[i + BLOOM_PREFETCH_DISTANCE])], 1);
+        }
+        bloom_add(b, hashes[i]);
+    }
+}
+
+size_t bloom_contains_batch(const bloom *b, const uint64_t *hashes, size_t n, bool *out) {
+    size_t found = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (i + BLOOM_PREFETCH_DISTANCE < n) {
+            __builtin_prefetch(&b->blocks[block_index(b, hashes[i + BLOOM_PREFETCH_DISTANCE])], 0);
+        }
+        out[i] = bloom_contains(b, hashes[i]);
+        found += out[i];
+    }
+    return found;
+}
+
+bool bloom_merge(bloom *dst, const bloom *src) {
+    if (dst->nblocks != src->nblocks) {
+        return false;
+    }
+    uint64_t *d = dst->blocks[0].words;
+    const uint64_t *s = src->blocks[0].words;
+    for (size_t i = 0; i < dst->nblocks * (BLOOM_BLOCK_BYTES / 8); i++) {
+        d[i] |= s[i];
+    }
+    return true;
+}
+
+#ifdef BLOOM_MAIN
+#include "hashalg.h"
+
+int main(void) {
+
+    // 示例1：插入 100 万个字符串键，10 位/键
+    const size_t n = 1000000;
+    bloom b;
+    bloom_init(&b, n, 10);
+    char key[32];
+    for (size_t i = 0; i < n; i++) {
+        size_t len = (size_t)snprintf(key, sizeof(key), "user:%zu", i);
+        bloom_add(&b, xxh3Hash64(key, len, 0));
+    }
+
+    // 示例2：已插入的键必须全部命中，未插入的键统计误判率
+    int failed = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t len = (size_t)snprintf(key, sizeof(key), "user:%zu", i);
+        if (!bloom_contains(&b, xxh3Hash64(key, len, 0))) {
+            printf("false negative: %s\n", key);
+            failed = 1;
+            break;
+        }
+    }
+    size_t fp = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t len = (size_t)snprintf(key, sizeof(key), "guest:%zu", i);
+        fp += bloom_contains(&b, xxh3Hash64(key, len, 0));
+    }
+    printf("blocks %zu (%.1f KB), false positive rate %.3f%%, check %s\n", b.nblocks,
+           (double)b.nblocks * BLOOM_BLOCK_BYTES / 1024, 100.0 * (double)fp / (double)n, failed ? "FAILED" : "ok");
+
+    bloom_free(&b);
+    return failed;
+}
+#endif
@@ -0,0 +1,100 @@
+#ifndef DSA_FILTER_BLOOM_H
+#define DSA_FILTER_BLOOM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+分块布隆过滤器（split block Bloom filter）
+（1）位数组按 64 字节（一条缓存行）分块，一个键的全部 BLOOM_K 个位都落在同一块内，查询只访问一次内存
+（2）块内 8 个 64 位字，每个字置 1 位，8 个位的位置由哈希值低 32 位乘 8 个奇数常数得到，AVX2 下一次计算 8 个位置
+（3）输入是调用者计算好的 64 位哈希值，高 32 位选块，低 32 位定块内位置，可配合 hashalg.h 中的 xxh3Hash64
+*/
+
+// 每块字节数，等于缓存行大小
+#define BLOOM_BLOCK_BYTES 64
+// 每个键置位的个数
+#define BLOOM_K 8
+
+typedef struct {
+    uint64_t words[BLOOM_BLOCK_BYTES / 8];
+} bloom_block;
+
+typedef struct {
+    bloom_block *blocks;    // 64 字节对齐
+    size_t nblocks;
+} bloom;
+
+/**
+* @brief             按预计元素数与每键位数分配过滤器
+* @param   expected  预计插入的元素数
+* @param   bits_per_key 每个元素占用的位数，10 位时误判率约 1%
+* @return  bool      申请内存失败返回 false
+*
+* @note              Revision History
+*/
+bool bloom_init(bloom *b, size_t expected, double bits_per_key);
+
+/**
+* @brief             释放过滤器
+*
+* @note              Revision History
+*/
+void bloom_free(bloom *b);
+
+/**
+* @brief             清空全部位，保留容量
+*
+* @note              Revision History
+*/
+void bloom_clear(bloom *b);
+
+/**
+* @brief             插入一个哈希值
+*
+* @note              Revision History
+*/
+void bloom_add(bloom *b, uint64_t hash);
+
+/**
+* @brief             查询一个哈希值
+* @return  bool      false 表示一定不存在，true 表示可能存在
+*
+* @note              Revision History
+*/
+bool bloom_contains(const bloom *b, uint64_t hash);
+
+/**
+* @brief             批量插入
+*
+* @note              提前预取后续键所在的块，掩盖缓存未命中
+*/
+void bloom_add_batch(bloom *b, const uint64_t *hashes, size_t n);
+
+/**
+* @brief             批量查询
+* @param   out       输出数组，n 个，可能存在为 true
+* @return  size_t    可能存在的个数
+*
+* @note              提前预取后续键所在的块，过滤器大于缓存时比逐个查询快
+*/
+size_t bloom_contains_batch(const bloom *b, const uint64_t *hashes, size_t n, bool *out);
+
+/**
+* @brief             合并：dst |= src，两者块数必须相同
+* @return  bool      块数不同返回 false
+*
+* @note              分布式场景下各分片分别构建后合并
+*/
+bool bloom_merge(bloom *dst, const bloom *src);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_FILTER_BLOOM_H
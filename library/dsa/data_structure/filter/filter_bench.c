@@ -0,0 +1,112 @@
+// 近似成员过滤器性能测试：分块布隆过滤器与异或过滤器
+// （1）误判率与每键位数的关系，附同等位数下标准布隆过滤器（最优 k）的理论误判率作对照
+// （2）构建速度，逐个查询与批量查询（预取）的吞吐
+// 用法：./filter_bench [键数]，默认 10M；查询全部为未插入的键
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "bloom.h"
+#include "hashalg.h"
+#include "xorfilter.h"
+
+static inline double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// 标准布隆过滤器取最优 k 时的理论误判率
+static double standard_bloom_fpr(double bits_per_key) {
+    double k = round(bits_per_key * log(2.0));
+    if (k < 1) {
+        k = 1;
+    }
+    return pow(1.0 - exp(-k / bits_per_key), k);
+}
+
+static void print_row(const char *name, double bits, double fpr, double reference, double build, double single,
+                      double batch) {
+    printf("%-14s %8.2f %10.4f%% %10.4f%% %10.2f %10.2f %10.2f\n", name, bits, fpr * 100, reference * 100, build,
+           single, batch);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+    size_t queries = n;
+    uint64_t state = 1;
+    uint64_t *keys = malloc(n * sizeof(uint64_t));
+    uint64_t *probes = malloc(queries * sizeof(uint64_t));
+    bool *out = malloc(queries * sizeof(bool));
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = splitmix64(&state);
+    }
+    for (size_t i = 0; i < queries; i++) {
+        probes[i] = splitmix64(&state);
+    }
+
+    printf("%zu keys, %zu negative queries\n", n, queries);
+    printf("%-14s %8s %11s %11s %10s %10s %10s\n", "filter", "bits/key", "fpr", "std bloom", "build M/s",
+           "query M/s", "batch M/s");
+
+    static const double bits_per_key[] = {6, 8, 10, 12, 16, 20};
+    for (size_t b = 0; b < sizeof(bits_per_key) / sizeof(bits_per_key[0]); b++) {
+        bloom filter;
+        bloom_init(&filter, n, bits_per_key[b]);
+
+        double start = now_sec();
+        bloom_add_batch(&filter, keys, n);
+        double build = (double)n / (now_sec() - start) / 1e6;
+
+        start = now_sec();
+        size_t fp = 0;
+        for (size_t i = 0; i < queries; i++) {
+            fp += bloom_contains(&filter, probes[i]);
+        }
+        double single = (double)queries / (now_sec() - start) / 1e6;
+
+        start = now_sec();
+        size_t fp_batch = bloom_contains_batch(&filter, probes, queries, out);
+        double batch = (double)queries / (now_sec() - start) / 1e6;
+        if (fp != fp_batch) {
+            printf("batch mismatch\n");
+            return 1;
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "bloom/%g", bits_per_key[b]);
+        double actual_bits = (double)filter.nblocks * BLOOM_BLOCK_BYTES * 8 / (double)n;
+        print_row(name, actual_bits, (double)fp / (double)queries, standard_bloom_fpr(actual_bits), build, single,
+                  batch);
+        bloom_free(&filter);
+    }
+
+    xorfilter xf;
+    double start = now_sec();
+    xorfilter_build(&xf, keys, n);
+    double build = (double)n / (now_sec() - start) / 1e6;
+
+    start = now_sec();
+    size_t fp = 0;
+    for (size_t i = 0; i < queries; i++) {
+        fp += xorfilter_contains(&xf, probes[i]);
+    }
+    double single = (double)queries / (now_sec() - start) / 1e6;
+
+    start = now_sec();
+    size_t fp_batch = xorfilter_contains_batch(&xf, probes, queries, out);
+    double batch = (double)queries / (now_sec() - start) / 1e6;
+    if (fp != fp_batch) {
+        printf("batch mismatch\n");
+        return 1;
+    }
+    double bits = xorfilter_bits_per_key(&xf);
+    print_row("xor8", bits, (double)fp / (double)queries, standard_bloom_fpr(bits), build, single, batch);
+    xorfilter_free(&xf);
+
+    free(keys);
+    free(probes);
+    free(out);
+    return 0;
+}
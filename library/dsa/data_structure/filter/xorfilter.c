@@ -0,0 +1,289 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hashalg.h"
+#include "xorfilter.h"
+
+/*
+一、构造原理
+（1）每个键 x 对应三个位置 h0(x)、h1(x)、h2(x)，分别落在指纹数组的三段中，要求 F[h0] ^ F[h1] ^ F[h2] = fp(x)
+（2）这是一个 3-超图的线性方程组，超图可"剥离"（peel）时有解：反复找只被一个键占用的位置，
+    记下（键，位置），把该键从超图中删掉，直到所有键都被记下
+（3）按记录的逆序赋值：轮到键 x 时它独占的位置 i 之后不会再被改写，令 F[i] = fp(x) ^ 另外两个位置的值
+（4）数组大小约 1.23n 时剥离成功的概率很高，失败则换种子重来；连续 XORFILTER_MAX_SEEDS 个种子都失败时
+    几乎只可能是输入有问题，返回失败而不是一直重试
+
+二、实现要点
+（1）每个位置保存占用它的键的异或和与个数，个数为 1 时异或和就是那个键，不需要邻接表
+（2）重复的键会使剥离永远失败，构建前先基数排序去重
+*/
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// 32 位值映射到 [0, n)，乘法取高位代替取模
+static inline uint32_t reduce(uint32_t x, uint32_t n) {
+    return (uint32_t)(((uint64_t)x * n) >> 32);
+}
+
+static inline uint8_t fingerprint(uint64_t h) {
+    return (uint8_t)(h ^ (h >> 32));
+}
+
+// 键的三个位置，第 k 个位于第 k 段
+static inline void positions(uint64_t h, uint32_t block_length, uint32_t pos[3]) {
+    pos[0] = reduce((uint32_t)h, block_length);
+    pos[1] = reduce((uint32_t)rotl64(h, 21), block_length) + block_length;
+    pos[2] = reduce((uint32_t)rotl64(h, 42), block_length) + 2 * block_length;
+}
+
+// 换种子重试的上限，单次剥离失败的概率很小，100 次都失败的概率可以忽略
+#define XORFILTER_MAX_SEEDS 100
+
+// LSD 基数排序，每轮 16 位共 4 轮，比 qsort 的比较排序快数倍，tmp 为同样大小的辅助数组
+// 申请计数数组失败返回 false，keys 不变
+static bool radix_sort_u64(uint64_t *keys, uint64_t *tmp, size_t n) {
+    size_t *count = malloc(65536 * sizeof(size_t));
+    if (!count) {
+        return false;
+    }
+    for (int shift = 0; shift < 64; shift += 16) {
+        memset(count, 0, 65536 * sizeof(size_t));
+        for (size_t i = 0; i < n; i++) {
+            count[(keys[i] >> shift) & 0xffff]++;
+        }
+        size_t sum = 0;
+        for (size_t d = 0; d < 65536; d++) {
+            size_t c = count[d];
+            count[d] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < n; i++) {
+            tmp[count[(keys[i] >> shift) & 0xffff]++] = keys[i];
+        }
+        uint64_t *swap = keys;
+        keys = tmp;
+        tmp = swap;
+    }
+    // 轮数为偶数，结果回到原数组
+    free(count);
+    return true;
+}
+
+typedef struct {
+    uint64_t xormask;
+    uint32_t count;
+} xor_set;
+
+typedef struct {
+    uint64_t hash;
+    uint32_t index;
+} xor_keyindex;
+
+bool xorfilter_build(xorfilter *f, const uint64_t *hashes, size_t n) {
+    memset(f, 0, sizeof(*f));
+
+    // 排序去重
+    uint64_t *keys = malloc((n ? n : 1) * sizeof(uint64_t));
+    uint64_t *tmp = malloc((n ? n : 1) * sizeof(uint64_t));
+    if (!keys || !tmp) {
+        free(keys);
+        free(tmp);
+        return false;
+    }
+    memcpy(keys, hashes, n * sizeof(uint64_t));
+    bool sorted = radix_sort_u64(keys, tmp, n);
+    free(tmp);
+    if (!sorted) {
+        free(keys);
+        return false;
+    }
+    size_t size = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (size == 0 || keys[i] != keys[size - 1]) {
+            keys[size++] = keys[i];
+        }
+    }
+
+    size_t capacity = 32 + (size_t)(1.23 * (double)size + 1);
+    uint32_t block_length = (uint32_t)(capacity / 3);
+    capacity = (size_t)block_length * 3;
+
+    uint8_t *fps = calloc(capacity, 1);
+    xor_set *sets = malloc(capacity * sizeof(xor_set));
+    uint32_t *queue = malloc(capacity * sizeof(uint32_t));
+    xor_keyindex *stack = malloc((size ? size : 1) * sizeof(xor_keyindex));
+    if (!fps || !sets || !queue || !stack) {
+        free(keys);
+        free(fps);
+        free(sets);
+        free(queue);
+        free(stack);
+        return false;
+    }
+
+    uint64_t rng = 0x726b2b9d438b9d4dULL;
+    uint64_t seed;
+    size_t stack_size;
+    int attempts = 0;
+    do {
+        seed = splitmix64(&rng);
+        memset(sets, 0, capacity * sizeof(xor_set));
+        for (size_t i = 0; i < size; i++) {
+            uint64_t h = fmix64(keys[i] + seed);
+            uint32_t pos[3];
+            positions(h, block_length, pos);
+            for (int k = 0; k < 3; k++) {
+                sets[pos[k]].xormask ^= h;
+                sets[pos[k]].count++;
+            }
+        }
+
+        // 剥离：队列中是只被一个键占用的位置
+        size_t qsize = 0;
+        for (uint32_t i = 0; i < capacity; i++) {
+            if (sets[i].count == 1) {
+                queue[qsize++] = i;
+            }
+        }
+        stack_size = 0;
+        while (qsize > 0) {
+            uint32_t index = queue[--qsize];
+            // 入队后可能又被其他键的剥离减到 0
+            if (sets[index].count != 1) {
+                continue;
+            }
+            uint64_t h = sets[index].xormask;
+            stack[stack_size++] = (xor_keyindex){h, index};
+            uint32_t pos[3];
+            positions(h, block_length, pos);
+            for (int k = 0; k < 3; k++) {
+                xor_set *s = &sets[pos[k]];
+                s->xormask ^= h;
+                s->count--;
+                if (s->count == 1) {
+                    queue[qsize++] = pos[k];
+                }
+            }
+        }
+    } while (stack_size != size && ++attempts < XORFILTER_MAX_SEEDS);
+    if (stack_size != size) {
+        free(keys);
+        free(fps);
+        free(sets);
+        free(queue);
+        free(stack);
+        return false;
+    }
+
+    // 逆序赋值
+    while (stack_size > 0) {
+        xor_keyindex ki = stack[--stack_size];
+        uint32_t pos[3];
+        positions(ki.hash, block_length, pos);
+        fps[ki.index] = 0;
+        fps[ki.index] = fingerprint(ki.hash) ^ fps[pos[0]] ^ fps[pos[1]] ^ fps[pos[2]];
+    }
+
+    free(keys);
+    free(sets);
+    free(queue);
+    free(stack);
+    f->fingerprints = fps;
+    f->block_length = block_length;
+    f->seed = seed;
+    f->size = size;
+    return true;
+}
+
+void xorfilter_free(xorfilter *f) {
+    free(f->fingerprints);
+    memset(f, 0, sizeof(*f));
+}
+
+bool xorfilter_contains(const xorfilter *f, uint64_t hash) {
+    uint64_t h = fmix64(hash + f->seed);
+    uint32_t pos[3];
+    positions(h, (uint32_t)f->block_length, pos);
+    const uint8_t *fp = f->fingerprints;
+    return fingerprint(h) == (fp[pos[0]] ^ fp[pos[1]] ^ fp[pos[2]]);
+}
+
+// 批量查询分组大小：先算一组键的位置并预取，再逐个比较，组内的缓存未命中可以并行
+#define XORFILTER_BATCH 32
+
+size_t xorfilter_contains_batch(const xorfilter *f, const uint64_t *hashes, size_t n, bool *out) {
+    size_t found = 0;
+    uint64_t h[XORFILTER_BATCH];
+    uint32_t pos[XORFILTER_BATCH][3];
+    const uint8_t *fp = f->fingerprints;
+    for (size_t base = 0; base < n; base += XORFILTER_BATCH) {
+        size_t m = n - base < XORFILTER_BATCH ? n - base : XORFILTER_BATCH;
+        for (size_t i = 0; i < m; i++) {
+            h[i] = fmix64(hashes[base + i] + f->seed);
+            positions(h[i], (uint32_t)f->block_length, pos[i]);
+            __builtin_prefetch(&fp[pos[i][0]]);
+            __builtin_prefetch(&fp[pos[i][1]]);
+            __builtin_prefetch(&fp[pos[i][2]]);
+        }
+        for (size_t i = 0; i < m; i++) {
+            out[base + i] = fingerprint(h[i]) == (fp[pos[i][0]] ^ fp[pos[i][1]] ^ fp[pos[i][2]]);
+            found += out[base + i];
+        }
+    }
+    return found;
+}
+
+double xorfilter_bits_per_key(const xorfilter *f) {
+    return f->size ? 8.0 * 3.0 * (double)f->block_length / (double)f->size : 0;
+}
+
+#ifdef XORFILTER_MAIN
+int main(void) {
+
+    // 示例1：100 万个字符串键构建静态过滤器
+    const size_t n = 1000000;
+    uint64_t *hashes = malloc(n * sizeof(uint64_t));
+    char key[32];
+    for (size_t i = 0; i < n; i++) {
+        size_t len = (size_t)snprintf(key, sizeof(key), "url:%zu", i);
+        hashes[i] = xxh3Hash64(key, len, 0);
+    }
+    xorfilter f;
+    if (!xorfilter_build(&f, hashes, n)) {
+        printf("build failed, check FAILED\n");
+        free(hashes);
+        return 1;
+    }
+
+    // 示例2：已构建的键全部命中，统计未插入键的误判率
+    bool *out = malloc(n * sizeof(bool));
+    int failed = xorfilter_contains_batch(&f, hashes, n, out) != n;
+    for (size_t i = 0; i < n; i++) {
+        size_t len = (size_t)snprintf(key, sizeof(key), "miss:%zu", i);
+        hashes[i] = xxh3Hash64(key, len, 0);
+    }
+    size_t fp = xorfilter_contains_batch(&f, hashes, n, out);
+    printf("bits/key %.2f, false positive rate %.3f%%, check %s\n", xorfilter_bits_per_key(&f),
+           100.0 * (double)fp / (double)n, failed ? "FAILED" : "ok");
+
+    xorfilter_free(&f);
+
+    // 示例3：空输入与全部重复的键，去重后剥离必须一次成功
+    xorfilter g;
+    failed |= !xorfilter_build(&g, hashes, 0);
+    xorfilter_free(&g);
+    for (size_t i = 0; i < 1000; i++) {
+        hashes[i] = 42;
+    }
+    failed |= !xorfilter_build(&g, hashes, 1000) || g.size != 1 || !xorfilter_contains(&g, 42);
+    xorfilter_free(&g);
+    printf("empty and duplicate input, check %s\n", failed ? "FAILED" : "ok");
+
+    free(hashes);
+    free(out);
+    return failed;
+}
+#endif
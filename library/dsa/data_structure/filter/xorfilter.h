@@ -0,0 +1,67 @@
+#ifndef DSA_FILTER_XORFILTER_H
+#define DSA_FILTER_XORFILTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+异或过滤器（Xor8，Graf & Lemire 2020），用于构建后不再变化的集合
+（1）指纹数组分三段，每个键在三段中各对应一个位置，三个位置的指纹异或等于键的 8 位指纹
+（2）约 9.84 位/键，误判率约 1/256（0.39%），比同等误判率的布隆过滤器省约 20% 空间
+（3）查询固定访问 3 个字节，不能增删，构建需要全部键，输入为 64 位哈希值，重复值会被去掉
+*/
+
+typedef struct {
+    uint8_t *fingerprints;  // 3 * block_length 个
+    size_t block_length;
+    uint64_t seed;
+    size_t size;            // 去重后的键数
+} xorfilter;
+
+/**
+* @brief             由全部键的哈希值构建过滤器
+* @param   hashes    键的 64 位哈希值，可以有重复
+* @param   n         个数
+* @return  bool      申请内存失败，或换 XORFILTER_MAX_SEEDS 个种子仍无法剥离时返回 false
+*
+* @note              构建时间为基数排序去重加期望 O(n) 的剥离过程
+*/
+bool xorfilter_build(xorfilter *f, const uint64_t *hashes, size_t n);
+
+/**
+* @brief             释放过滤器
+*
+* @note              Revision History
+*/
+void xorfilter_free(xorfilter *f);
+
+/**
+* @brief             查询
+* @return  bool      false 表示一定不存在，true 表示可能存在
+*
+* @note              Revision History
+*/
+bool xorfilter_contains(const xorfilter *f, uint64_t hash);
+
+/**
+* @brief             批量查询
+* @param   out       输出数组，n 个，可能存在为 true
+* @return  size_t    可能存在的个数
+*
+* @note              每组先计算位置并预取，再比较指纹
+*/
+size_t xorfilter_contains_batch(const xorfilter *f, const uint64_t *hashes, size_t n, bool *out);
+
+// 实际占用的位数 / 键数
+double xorfilter_bits_per_key(const xorfilter *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_FILTER_XORFILTER_H
@@ -0,0 +1,221 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conhash.h"
+#include "hashalg.h"
+
+/*
+一、为什么不用 hash % n
+（1）取模分片在节点数从 n 变为 n+1 时，约 n/(n+1) 的键换节点，缓存集群扩容一次几乎全部失效
+（2）一致性哈希的目标：增加一个节点只移动约 1/(n+1) 的键，删除一个节点只移动原本属于它的键
+
+二、三种做法的取舍
+（1）Ketama 环（memcached 客户端）：节点名哈希到 32 位环上的多个位置（虚拟节点），键顺时针找第一个位置
+    虚拟节点越多负载越均匀，每节点 160 个时负载标准差约为平均值的 8%，代价是 n * 160 个点的内存与 O(log) 查找
+（2）Jump Consistent Hash（Google）：用键作随机数种子，模拟键在桶数从 1 增长到 n 过程中的跳跃，
+    不需要内存，负载几乎完全均匀，但桶必须连续编号，只适合在末尾增删（如数据分片副本数固定的存储）
+（3）Rendezvous / HRW：键对每个节点算一个分数取最大，节点可以任意增删，加权版本按 -ln(u) 变换使选中概率与权重成正比，
+    代价是查找为 O(n)，适合节点数在几十以内的场景
+
+三、实现要点
+（1）构建阶段申请内存，查找阶段只读、不申请内存，多线程可以同时查找
+（2）键哈希：Ketama 用 murmurHash3_32；Jump 与 HRW 需要 64 位，用 murmurHash3_32 与 fnvHash 拼接
+*/
+
+// 键的 64 位哈希：高 32 位 murmur3，低 32 位 FNV-1a
+static inline uint64_t key_hash64(const void *key, size_t len) {
+    return ((uint64_t)murmurHash3_32(key, len, 0) << 32) | fnvHash((const char *)key, len);
+}
+
+static int compare_point(const void *a, const void *b) {
+    const conhash_point *x = a;
+    const conhash_point *y = b;
+    if (x->hash != y->hash) {
+        return x->hash < y->hash ? -1 : 1;
+    }
+    return (x->node > y->node) - (x->node < y->node);
+}
+
+bool conhash_ring_init(conhash_ring *ring, const conhash_node *nodes, size_t n, unsigned vnodes) {
+    ring->points = NULL;
+    ring->count = 0;
+    if (n == 0) {
+        return false;
+    }
+    if (vnodes == 0) {
+        vnodes = CONHASH_DEFAULT_VNODES;
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < n; i++) {
+        total += (size_t)vnodes * (nodes[i].weight ? nodes[i].weight : 1);
+    }
+    conhash_point *points = malloc(total * sizeof(conhash_point));
+    if (!points) {
+        return false;
+    }
+
+    // 第 r 个虚拟节点的位置只由节点名和 r 决定，种子取 r
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t len = strlen(nodes[i].name);
+        size_t replicas = (size_t)vnodes * (nodes[i].weight ? nodes[i].weight : 1);
+        for (size_t r = 0; r < replicas; r++) {
+            points[k].hash = murmurHash3_32(nodes[i].name, len, (uint32_t)r);
+            points[k].node = (uint32_t)i;
+            k++;
+        }
+    }
+    qsort(points, total, sizeof(conhash_point), compare_point);
+
+    ring->points = points;
+    ring->count = total;
+    return true;
+}
+
+void conhash_ring_free(conhash_ring *ring) {
+    free(ring->points);
+    ring->points = NULL;
+    ring->count = 0;
+}
+
+uint32_t conhash_ring_lookup(const conhash_ring *ring, const void *key, size_t len) {
+    uint32_t hash = murmurHash3_32(key, len, 0);
+    // 第一个 hash >= 键哈希的点，超过末尾时回到环首
+    size_t lo = 0;
+    size_t hi = ring->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (ring->points[mid].hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return ring->points[lo == ring->count ? 0 : lo].node;
+}
+
+/*
+Jump Hash：b 为当前所在桶，j 为下一次跳跃的目标
+桶数从 j 增长到 j+1 时键以 1/(j+1) 的概率跳到新桶，用线性同余生成器产生跳跃间隔，期望迭代 ln(n) 次
+*/
+uint32_t conhash_jump(uint64_t key, uint32_t buckets) {
+    int64_t b = -1;
+    int64_t j = 0;
+    while (j < (int64_t)buckets) {
+        b = j;
+        key = key * 2862933555777941757ULL + 1;
+        j = (int64_t)((double)(b + 1) * ((double)(1LL << 31) / (double)((key >> 33) + 1)));
+    }
+    return (uint32_t)b;
+}
+
+uint32_t conhash_jump_key(const void *key, size_t len, uint32_t buckets) {
+    return conhash_jump(key_hash64(key, len), buckets);
+}
+
+bool conhash_hrw_init(conhash_hrw *hrw, const conhash_node *nodes, size_t n) {
+    hrw->seeds = NULL;
+    hrw->weights = NULL;
+    hrw->count = 0;
+    if (n == 0) {
+        return false;
+    }
+    hrw->seeds = malloc(n * sizeof(uint64_t));
+    hrw->weights = malloc(n * sizeof(double));
+    if (!hrw->seeds || !hrw->weights) {
+        conhash_hrw_free(hrw);
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        hrw->seeds[i] = key_hash64(nodes[i].name, strlen(nodes[i].name));
+        hrw->weights[i] = nodes[i].weight ? (double)nodes[i].weight : 1.0;
+    }
+    hrw->count = n;
+    return true;
+}
+
+void conhash_hrw_free(conhash_hrw *hrw) {
+    free(hrw->seeds);
+    free(hrw->weights);
+    hrw->seeds = NULL;
+    hrw->weights = NULL;
+    hrw->count = 0;
+}
+
+/*
+-ln(u) 服从参数为 1 的指数分布，除以权重 w 后服从参数为 w 的指数分布，
+n 个独立指数分布中最小者落在节点 i 的概率为 w_i / Σw，所以取 -ln(u) / w 最小的节点
+*/
+uint32_t conhash_hrw_lookup(const conhash_hrw *hrw, const void *key, size_t len) {
+    uint64_t kh = key_hash64(key, len);
+    uint32_t best = 0;
+    double best_score = INFINITY;
+    for (size_t i = 0; i < hrw->count; i++) {
+        uint64_t x = fmix64(kh ^ hrw->seeds[i]);
+        // 取高 53 位映射到 (0,1)，加 0.5 避免 ln(0)
+        double u = ((double)(x >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+        double score = -log(u) / hrw->weights[i];
+        if (score < best_score) {
+            best_score = score;
+            best = (uint32_t)i;
+        }
+    }
+    return best;
+}
+
+#ifdef CONHASH_MAIN
+int main(void) {
+
+    // 示例1：5 个缓存节点，cache-c 权重为 2
+    conhash_node nodes[] = {
+        {"cache-a:11211", 1}, {"cache-b:11211", 1}, {"cache-c:11211", 2},
+        {"cache-d:11211", 1}, {"cache-e:11211", 1},
+    };
+    const size_t n = sizeof(nodes) / sizeof(nodes[0]);
+    conhash_ring ring;
+    conhash_hrw hrw;
+    conhash_ring_init(&ring, nodes, n, 0);
+    conhash_hrw_init(&hrw, nodes, n);
+
+    const char *keys[] = {"user:1001", "user:1002", "session:abc", "page:/index.html", "img:logo.png"};
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        size_t len = strlen(keys[i]);
+        printf("%-18s ketama %s  jump %u  hrw %s\n", keys[i], nodes[conhash_ring_lookup(&ring, keys[i], len)].name,
+               conhash_jump_key(keys[i], len, (uint32_t)n), nodes[conhash_hrw_lookup(&hrw, keys[i], len)].name);
+    }
+
+    // 示例2：删除 cache-b 后，原本不在 cache-b 上的键都不移动
+    conhash_node removed[] = {nodes[0], nodes[2], nodes[3], nodes[4]};
+    conhash_ring ring2;
+    conhash_hrw hrw2;
+    conhash_ring_init(&ring2, removed, 4, 0);
+    conhash_hrw_init(&hrw2, removed, 4);
+    int failed = 0;
+    size_t moved = 0;
+    const size_t total = 100000;
+    for (size_t i = 0; i < total; i++) {
+        char key[32];
+        size_t len = (size_t)snprintf(key, sizeof(key), "key:%zu", i);
+        const char *before = nodes[conhash_ring_lookup(&ring, key, len)].name;
+        const char *after = removed[conhash_ring_lookup(&ring2, key, len)].name;
+        const char *hrw_before = nodes[conhash_hrw_lookup(&hrw, key, len)].name;
+        const char *hrw_after = removed[conhash_hrw_lookup(&hrw2, key, len)].name;
+        if ((before != nodes[1].name && before != after) ||
+            (hrw_before != nodes[1].name && hrw_before != hrw_after)) {
+            failed = 1;
+        }
+        moved += before != after;
+    }
+    printf("remove cache-b: ketama moved %.1f%% of keys (cache-b owned ~%.1f%%), check %s\n",
+           100.0 * (double)moved / (double)total, 100.0 / 6, failed ? "FAILED" : "ok");
+
+    conhash_ring_free(&ring);
+    conhash_ring_free(&ring2);
+    conhash_hrw_free(&hrw);
+    conhash_hrw_free(&hrw2);
+    return failed;
+}
+#endif
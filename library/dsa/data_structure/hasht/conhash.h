@@ -0,0 +1,116 @@
+#ifndef DSA_HASHT_CONHASH_H
+#define DSA_HASHT_CONHASH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+一致性哈希：把键分配到 n 个节点，节点增删时只有少量键换节点
+（1）Ketama 环：每个节点按权重放置若干虚拟节点，键顺时针落到第一个虚拟节点，查找为有序数组上的二分
+（2）Jump Consistent Hash：无需任何内存，O(ln n) 次迭代，但节点只能编号为 0..n-1，只能在末尾增删
+（3）加权 Rendezvous（HRW）：每个节点对键打分取最高者，O(n) 查找，可以任意增删节点、权重任意
+三种查找都不申请内存；键的哈希使用 hashalg.c 中的 murmurHash3_32 与 fnvHash
+*/
+
+// 虚拟节点默认个数（权重为 1 时）
+#define CONHASH_DEFAULT_VNODES 160
+
+// 节点描述：名称决定虚拟节点与打分的位置，节点列表顺序变化不影响分配结果
+typedef struct {
+    const char *name;
+    uint32_t weight;    // 权重，0 按 1 处理
+} conhash_node;
+
+// 环上的一个虚拟节点
+typedef struct {
+    uint32_t hash;
+    uint32_t node;      // 节点在构建时列表中的下标
+} conhash_point;
+
+typedef struct {
+    conhash_point *points;  // 按 hash 升序
+    size_t count;
+} conhash_ring;
+
+/**
+* @brief             构建 Ketama 环
+* @param   nodes     节点列表
+* @param   n         节点数
+* @param   vnodes    权重为 1 的节点的虚拟节点数，0 时使用 CONHASH_DEFAULT_VNODES
+* @return  bool      申请内存失败或 n 为 0 返回 false
+*
+* @note              增删节点后重新构建，未变化节点的虚拟节点位置不变
+*/
+bool conhash_ring_init(conhash_ring *ring, const conhash_node *nodes, size_t n, unsigned vnodes);
+
+/**
+* @brief             释放环
+*
+* @note              Revision History
+*/
+void conhash_ring_free(conhash_ring *ring);
+
+/**
+* @brief             查找键所属节点
+* @return  uint32_t  节点下标
+*
+* @note              Revision History
+*/
+uint32_t conhash_ring_lookup(const conhash_ring *ring, const void *key, size_t len);
+
+/**
+* @brief             Jump Consistent Hash（Lamping & Veach 2014）
+* @param   key       64 位键
+* @param   buckets   桶数，大于 0
+* @return  uint32_t  桶编号，0..buckets-1
+*
+* @note              桶数从 n 变为 n+1 时约 1/(n+1) 的键移到新桶，其余不动
+*/
+uint32_t conhash_jump(uint64_t key, uint32_t buckets);
+
+// 任意字节键的 Jump Hash：murmurHash3_32 与 fnvHash 拼成 64 位
+uint32_t conhash_jump_key(const void *key, size_t len, uint32_t buckets);
+
+// 加权 Rendezvous 的节点表，预先计算节点名的哈希
+typedef struct {
+    uint64_t *seeds;
+    double *weights;
+    size_t count;
+} conhash_hrw;
+
+/**
+* @brief             构建加权 Rendezvous 节点表
+* @param   nodes     节点列表
+* @param   n         节点数
+* @return  bool      申请内存失败或 n 为 0 返回 false
+*
+* @note              Revision History
+*/
+bool conhash_hrw_init(conhash_hrw *hrw, const conhash_node *nodes, size_t n);
+
+/**
+* @brief             释放节点表
+*
+* @note              Revision History
+*/
+void conhash_hrw_free(conhash_hrw *hrw);
+
+/**
+* @brief             加权 Rendezvous 哈希
+* @return  uint32_t  得分最高的节点下标
+*
+* @note              得分 weight / -ln(u)，u 为键与节点联合哈希映射到 (0,1) 的值，
+*                    节点被选中的概率与权重成正比，删除节点只影响原本落在该节点的键
+*/
+uint32_t conhash_hrw_lookup(const conhash_hrw *hrw, const void *key, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_HASHT_CONHASH_H
@@ -0,0 +1,176 @@
+// 一致性哈希性能测试：Ketama 环、Jump Hash、加权 Rendezvous
+// （1）查找耗时（ns/lookup）
+// （2）负载均衡：各节点键数的最大值 / 平均值
+// （3）增加一个节点、删除一个节点时移动的键比例，理想值分别为 1/(n+1) 与 1/n
+// 用法：./conhash_bench [键数]，默认 1M
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "conhash.h"
+
+static inline double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+enum { METHOD_KETAMA, METHOD_JUMP, METHOD_HRW, METHOD_COUNT };
+static const char *method_names[] = {"ketama", "jump", "hrw"};
+
+// 一组节点上的查找器，三种方法共用
+typedef struct {
+    int method;
+    uint32_t n;
+    conhash_ring ring;
+    conhash_hrw hrw;
+} router;
+
+static void router_init(router *r, int method, const conhash_node *nodes, uint32_t n) {
+    r->method = method;
+    r->n = n;
+    if (method == METHOD_KETAMA) {
+        conhash_ring_init(&r->ring, nodes, n, 0);
+    } else if (method == METHOD_HRW) {
+        conhash_hrw_init(&r->hrw, nodes, n);
+    }
+}
+
+static void router_free(router *r) {
+    if (r->method == METHOD_KETAMA) {
+        conhash_ring_free(&r->ring);
+    } else if (r->method == METHOD_HRW) {
+        conhash_hrw_free(&r->hrw);
+    }
+}
+
+static inline uint32_t router_lookup(const router *r, const char *key, size_t len) {
+    switch (r->method) {
+    case METHOD_KETAMA:
+        return conhash_ring_lookup(&r->ring, key, len);
+    case METHOD_JUMP:
+        return conhash_jump_key(key, len, r->n);
+    default:
+        return conhash_hrw_lookup(&r->hrw, key, len);
+    }
+}
+
+// 键集合，每个键 24 字节定长槽位
+typedef struct {
+    char *data;
+    size_t *lens;
+    size_t count;
+} key_list;
+
+static void make_keys(key_list *keys, size_t count) {
+    keys->data = malloc(count * 24);
+    keys->lens = malloc(count * sizeof(size_t));
+    keys->count = count;
+    for (size_t i = 0; i < count; i++) {
+        keys->lens[i] = (size_t)snprintf(keys->data + i * 24, 24, "key:%zu", i);
+    }
+}
+
+// 返回每个键所在节点的名称，移动判断按名称比较，与节点下标无关
+static void assign(const router *r, const conhash_node *nodes, const key_list *keys, size_t count,
+                   const char **out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = nodes[router_lookup(r, keys->data + i * 24, keys->lens[i])].name;
+    }
+}
+
+static double moved_fraction(const char **a, const char **b, size_t count) {
+    size_t moved = 0;
+    for (size_t i = 0; i < count; i++) {
+        moved += a[i] != b[i];
+    }
+    return (double)moved / (double)count;
+}
+
+static void bench_nodes(uint32_t n, const key_list *keys) {
+    // 多一个节点供增加节点的测试使用
+    conhash_node *nodes = malloc((n + 1) * sizeof(conhash_node));
+    conhash_node *removed = malloc(n * sizeof(conhash_node));
+    char (*names)[32] = malloc((n + 1) * sizeof(*names));
+    for (uint32_t i = 0; i <= n; i++) {
+        snprintf(names[i], sizeof(names[i]), "10.0.%u.%u:6379", i / 256, i % 256);
+        nodes[i] = (conhash_node){names[i], 1};
+    }
+
+    const char **b = malloc(keys->count * sizeof(char *));
+    const char **a = malloc(keys->count * sizeof(char *));
+    uint32_t *load = calloc(n, sizeof(uint32_t));
+
+    for (int m = 0; m < METHOD_COUNT; m++) {
+        // HRW 为 O(n) 查找，节点多时减少键数
+        size_t keys_used = keys->count;
+        if (m == METHOD_HRW && keys_used > 20000000 / n) {
+            keys_used = 20000000 / n;
+        }
+
+        router r;
+        router_init(&r, m, nodes, n);
+        double start = now_ns();
+        assign(&r, nodes, keys, keys_used, b);
+        double ns = (now_ns() - start) / (double)keys_used;
+
+        memset(load, 0, n * sizeof(uint32_t));
+        for (size_t i = 0; i < keys_used; i++) {
+            load[router_lookup(&r, keys->data + i * 24, keys->lens[i])]++;
+        }
+        uint32_t max_load = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            max_load = load[i] > max_load ? load[i] : max_load;
+        }
+        double balance = (double)max_load / ((double)keys_used / n);
+
+        // 增加节点 n
+        router grown;
+        router_init(&grown, m, nodes, n + 1);
+        assign(&grown, nodes, keys, keys_used, a);
+        double add = moved_fraction(b, a, keys_used);
+        router_free(&grown);
+
+        // 删除节点：Jump Hash 只能删除最后一个，其余删除中间的节点
+        uint32_t victim = m == METHOD_JUMP ? n - 1 : n / 2;
+        for (uint32_t i = 0, k = 0; i < n; i++) {
+            if (i != victim) {
+                removed[k++] = nodes[i];
+            }
+        }
+        router shrunk;
+        router_init(&shrunk, m, removed, n - 1);
+        assign(&shrunk, removed, keys, keys_used, a);
+        double del = moved_fraction(b, a, keys_used);
+        router_free(&shrunk);
+        router_free(&r);
+
+        printf("%6u %-8s %10.1f %10.3f %10.4f %10.4f %10.4f\n", n, method_names[m], ns, balance, add,
+               del, 1.0 / (n + 1));
+    }
+
+    free(b);
+    free(a);
+    free(load);
+    free(nodes);
+    free(removed);
+    free(names);
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+    key_list keys;
+    make_keys(&keys, count);
+
+    printf("%6s %-8s %10s %10s %10s %10s %10s\n", "nodes", "method", "ns/lookup", "max/mean", "add moved",
+           "del moved", "1/(n+1)");
+    uint32_t node_counts[] = {4, 16, 64, 256, 1024};
+    for (size_t i = 0; i < sizeof(node_counts) / sizeof(node_counts[0]); i++) {
+        bench_nodes(node_counts[i], &keys);
+    }
+
+    free(keys.data);
+    free(keys.lens);
+    return 0;
+}
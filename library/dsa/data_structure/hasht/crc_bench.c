@@ -0,0 +1,112 @@
+// CRC 吞吐测试：硬件实现（SSE4.2 crc32 三路交错 / PCLMULQDQ 折叠）与查表实现（slicing-by-8）对比
+// （1）先在随机长度、随机切分的输入上核对两种实现的结果一致
+// （2）64B~16MB 各长度的吞吐（GB/s），16MB 超出缓存，反映内存带宽的限制
+// 用法：./crc_bench
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hashalg.h"
+
+#define MAX_LEN (16u << 20)
+
+static volatile uint64_t bench_sink;
+
+static inline double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+typedef uint64_t (*crc_fn)(const void *data, size_t len, uint64_t crc);
+
+static uint64_t run_crc32(const void *d, size_t n, uint64_t c) { return crc32Hash(d, n, (uint32_t)c); }
+static uint64_t run_crc32_table(const void *d, size_t n, uint64_t c) { return crc32HashPortable(d, n, (uint32_t)c); }
+static uint64_t run_crc32c(const void *d, size_t n, uint64_t c) { return crc32cHash(d, n, (uint32_t)c); }
+static uint64_t run_crc32c_table(const void *d, size_t n, uint64_t c) { return crc32cHashPortable(d, n, (uint32_t)c); }
+static uint64_t run_crc64(const void *d, size_t n, uint64_t c) { return crc64Hash(d, n, c); }
+static uint64_t run_crc64_table(const void *d, size_t n, uint64_t c) { return crc64HashPortable(d, n, c); }
+
+typedef struct {
+    const char *name;
+    crc_fn fast;
+    crc_fn table;
+} crc_pair;
+
+static const crc_pair crcs[] = {
+    {"crc32c", run_crc32c, run_crc32c_table},
+    {"crc32", run_crc32, run_crc32_table},
+    {"crc64", run_crc64, run_crc64_table},
+};
+#define NCRCS (sizeof(crcs) / sizeof(crcs[0]))
+
+// 随机起点（覆盖非对齐）、随机长度，快速实现分两段计算，与查表一次性计算比较
+static bool check(const unsigned char *buf) {
+    uint64_t state = 42;
+    for (int iter = 0; iter < 20000; iter++) {
+        size_t len = iter < 10000 ? splitmix64(&state) % 2048 : splitmix64(&state) % 100000;
+        size_t offset = splitmix64(&state) % 64;
+        size_t split = len ? splitmix64(&state) % (len + 1) : 0;
+        const unsigned char *p = buf + offset;
+        for (size_t c = 0; c < NCRCS; c++) {
+            uint64_t expect = crcs[c].table(p, len, 0);
+            uint64_t got = crcs[c].fast(p + split, len - split, crcs[c].fast(p, split, 0));
+            if (got != expect) {
+                printf("%s mismatch: len %zu offset %zu split %zu\n", crcs[c].name, len, offset, split);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static double throughput(crc_fn fn, const unsigned char *buf, size_t len) {
+    // 每个长度至少处理 256MB，短输入循环调用，前一次结果作为下一次的 crc 参数
+    size_t reps = (256u << 20) / len;
+    uint64_t c = 0;
+    fn(buf, len, 0);
+    double start = now_sec();
+    for (size_t r = 0; r < reps; r++) {
+        c = fn(buf, len, c);
+    }
+    double elapsed = now_sec() - start;
+    bench_sink = c;
+    return (double)len * (double)reps / elapsed / 1e9;
+}
+
+int main(void) {
+    unsigned char *buf = malloc(MAX_LEN + 64);
+    uint64_t state = 1;
+    for (size_t i = 0; i < MAX_LEN + 64; i += 8) {
+        uint64_t v = splitmix64(&state);
+        memcpy(buf + i, &v, 8);
+    }
+
+    bool ok = check(buf);
+    printf("implementation %s, check %s\n", crcImplName(), ok ? "ok" : "FAILED");
+
+    static const size_t sizes[] = {64, 256, 1024, 4096, 16384, 65536, 1u << 20, MAX_LEN};
+    printf("%-8s", "GB/s");
+    for (size_t c = 0; c < NCRCS; c++) {
+        printf(" %10s %10s", crcs[c].name, "table");
+    }
+    printf("\n");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        if (sizes[s] >= (1u << 20)) {
+            printf("%-8s", sizes[s] >= MAX_LEN ? "16MB" : "1MB");
+        } else {
+            char label[16];
+            snprintf(label, sizeof(label), "%zuB", sizes[s]);
+            printf("%-8s", label);
+        }
+        for (size_t c = 0; c < NCRCS; c++) {
+            printf(" %10.2f %10.2f", throughput(crcs[c].fast, buf, sizes[s]), throughput(crcs[c].table, buf, sizes[s]));
+        }
+        printf("\n");
+    }
+
+    free(buf);
+    return ok ? 0 : 1;
+}
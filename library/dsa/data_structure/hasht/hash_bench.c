@@ -0,0 +1,490 @@
+// hashalg.c 中哈希函数的速度与质量测试（SMHasher 的精简版）
+// （1）速度：4B~1MB 各长度的吞吐（bytes/cycle），以及 4~64 字节短键的延迟（cycles/hash，前一次结果参与下一次输入）
+// （2）雪崩：翻转输入的 1 位，每个输出位翻转的概率应为 1/2，报告最大偏差
+// （3）位独立：翻转输入的 1 位时，任意两个输出位的翻转应互不相关，报告最大相关系数
+// （4）批量：murmurHash3_32Batch / murmurHash3_32BatchVar 与逐个调用的每键耗时对比
+// （5）碰撞与分布：连续整数、URL、单词三类键，统计 32 位碰撞数（与随机函数的期望值对比）和低 16 位分桶的卡方偏差
+// 用法：./hash_bench [碰撞测试键数]，默认 1M
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <x86intrin.h>
+
+#include "hashalg.h"
+
+// 统一的函数形式，32 位哈希高位补 0；以 '\0' 结尾的算法忽略 len，调用者保证 key[len] == '\0'
+typedef uint64_t (*bench_hash_fn)(const void *key, size_t len, uint64_t seed);
+
+typedef struct {
+    const char *name;
+    bench_hash_fn fn;
+    int bits;           // 输出位数，质量测试只检查这些位
+    bool nul_terminated;
+} bench_hash;
+
+static uint64_t bench_times33(const void *key, size_t len, uint64_t seed) {
+    (void)len;
+    (void)seed;
+    return times33Hash((const char *)key);
+}
+
+static uint64_t bench_murmur3(const void *key, size_t len, uint64_t seed) {
+    return murmurHash3_32(key, len, (uint32_t)seed);
+}
+
+static uint64_t bench_sax(const void *key, size_t len, uint64_t seed) {
+    (void)len;
+    (void)seed;
+    return saxHash((const char *)key);
+}
+
+static uint64_t bench_fnv(const void *key, size_t len, uint64_t seed) {
+    (void)seed;
+    return fnvHash((const char *)key, len);
+}
+
+static uint64_t bench_oat(const void *key, size_t len, uint64_t seed) {
+    (void)seed;
+    return oatHash((const char *)key, len);
+}
+
+static uint64_t bench_jenkins(const void *key, size_t len, uint64_t seed) {
+    return jenHash((const char *)key, len, (uint32_t)seed);
+}
+
+static uint64_t bench_xxh3_64(const void *key, size_t len, uint64_t seed) {
+    return xxh3Hash64(key, len, seed);
+}
+
+// 128 位结果只取低 64 位参与质量测试
+static uint64_t bench_xxh3_128(const void *key, size_t len, uint64_t seed) {
+    return xxh3Hash128(key, len, seed).low;
+}
+
+static const bench_hash hashes[] = {
+    {"times33", bench_times33, 32, true},
+    {"murmur3_32", bench_murmur3, 32, false},
+    {"sax", bench_sax, 32, true},
+    {"fnv1a_32", bench_fnv, 32, false},
+    {"oat", bench_oat, 32, false},
+    {"jenkins", bench_jenkins, 32, false},
+    {"xxh3_64", bench_xxh3_64, 64, false},
+    {"xxh3_128", bench_xxh3_128, 64, false},
+};
+#define HASH_COUNT (sizeof(hashes) / sizeof(hashes[0]))
+
+static inline double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// 随机填充且不含 0 字节，使以 '\0' 结尾的算法与其他算法处理相同长度
+static void fill_nonzero(unsigned char *p, size_t len, uint64_t *state) {
+    for (size_t i = 0; i < len; i++) {
+        p[i] = (unsigned char)(splitmix64(state) % 255 + 1);
+    }
+}
+
+/* 一、速度 */
+
+// 写入 volatile 变量，防止编译器把结果未使用的哈希计算优化掉
+static volatile uint64_t bench_sink;
+
+// 吞吐：同一段输入重复计算，调用之间没有依赖，CPU 可以重叠执行；cycles 为 TSC 计数
+static void speed_bench(void) {
+    static const size_t sizes[] = {4, 16, 64, 256, 1024, 4096, 65536, 1 << 20};
+    const size_t nsizes = sizeof(sizes) / sizeof(sizes[0]);
+    const size_t max_size = 1 << 20;
+    const double budget = 32.0 * 1024 * 1024;   // 每项约处理 32MB
+    unsigned char *buf = malloc(max_size + 1);
+    uint64_t state = 1;
+    fill_nonzero(buf, max_size, &state);
+    uint64_t sink = 0;
+
+    printf("throughput (bytes/cycle, TSC)\n%-12s", "hash");
+    for (size_t s = 0; s < nsizes; s++) {
+        if (sizes[s] >= 1024) {
+            printf(" %8zuK", sizes[s] / 1024);
+        } else {
+            printf(" %8zuB", sizes[s]);
+        }
+    }
+    printf("\n");
+
+    for (size_t h = 0; h < HASH_COUNT; h++) {
+        bench_hash_fn fn = hashes[h].fn;
+        printf("%-12s", hashes[h].name);
+        for (size_t s = 0; s < nsizes; s++) {
+            size_t len = sizes[s];
+            size_t iters = (size_t)(budget / (double)len);
+            if (iters < 16) {
+                iters = 16;
+            }
+            // 以 '\0' 结尾的算法需要在 len 处截断
+            unsigned char saved = buf[len];
+            buf[len] = 0;
+            uint64_t start = __rdtsc();
+            for (size_t i = 0; i < iters; i++) {
+                sink += fn(buf, len, i);
+            }
+            uint64_t cycles = __rdtsc() - start;
+            buf[len] = saved;
+            printf(" %9.3f", (double)len * (double)iters / (double)cycles);
+        }
+        printf("\n");
+    }
+
+    // 延迟：上一次结果异或进下一次输入的前 4 字节，调用串行执行，接近哈希表查找时的实际耗时
+    static const size_t short_sizes[] = {4, 8, 16, 32, 64};
+    const size_t nshort = sizeof(short_sizes) / sizeof(short_sizes[0]);
+    const size_t iters = 4000000;
+    printf("\nsmall key latency (cycles/hash, TSC)\n%-12s", "hash");
+    for (size_t s = 0; s < nshort; s++) {
+        printf(" %8zuB", short_sizes[s]);
+    }
+    printf("\n");
+    for (size_t h = 0; h < HASH_COUNT; h++) {
+        bench_hash_fn fn = hashes[h].fn;
+        printf("%-12s", hashes[h].name);
+        for (size_t s = 0; s < nshort; s++) {
+            size_t len = short_sizes[s];
+            unsigned char key[72];
+            fill_nonzero(key, len, &state);
+            key[len] = 0;
+            uint64_t prev = 0;
+            uint64_t start = __rdtsc();
+            for (size_t i = 0; i < iters; i++) {
+                uint32_t head;
+                memcpy(&head, key, 4);
+                // 或上 0x01010101 保证不产生 0 字节
+                head = (head ^ (uint32_t)prev) | 0x01010101u;
+                memcpy(key, &head, 4);
+                prev = fn(key, len, 0);
+            }
+            uint64_t cycles = __rdtsc() - start;
+            sink += prev;
+            printf(" %9.1f", (double)cycles / (double)iters);
+        }
+        printf("\n");
+    }
+    free(buf);
+    bench_sink = sink;
+}
+
+// 批量哈希：定长键（SIMD）与变长键（交错）对比逐个调用，每键周期数
+static void batch_bench(void) {
+    enum { KEYS = 4096, ROUNDS = 500 };
+    static const size_t fixed_sizes[] = {4, 8, 16, 32};
+    unsigned char *buf = malloc(KEYS * 64 + 64);
+    uint32_t *out = malloc(KEYS * sizeof(uint32_t));
+    uint64_t state = 3;
+    fill_nonzero(buf, KEYS * 64 + 64, &state);
+    uint64_t sink = 0;
+
+    printf("\nmurmur3 batch (cycles/key, TSC, %d keys per call)\n%-12s %10s %10s %8s\n", KEYS, "keys", "single",
+           "batch", "speedup");
+    for (size_t s = 0; s < sizeof(fixed_sizes) / sizeof(fixed_sizes[0]); s++) {
+        size_t len = fixed_sizes[s];
+        uint64_t start = __rdtsc();
+        for (int r = 0; r < ROUNDS; r++) {
+            for (size_t i = 0; i < KEYS; i++) {
+                out[i] = murmurHash3_32(buf + i * len, len, (uint32_t)r);
+            }
+            sink += out[r];
+        }
+        double single = (double)(__rdtsc() - start) / (double)(KEYS * ROUNDS);
+        start = __rdtsc();
+        for (int r = 0; r < ROUNDS; r++) {
+            murmurHash3_32Batch(buf, len, KEYS, (uint32_t)r, out);
+            sink += out[r];
+        }
+        double batch = (double)(__rdtsc() - start) / (double)(KEYS * ROUNDS);
+        char name[16];
+        snprintf(name, sizeof(name), "fixed %zuB", len);
+        printf("%-12s %10.2f %10.2f %7.2fx\n", name, single, batch, single / batch);
+    }
+
+    // 变长键：长度 1~48 随机，近似 URL 路径、单词等混合长度的键
+    const void **keys = malloc(KEYS * sizeof(void *));
+    size_t *lens = malloc(KEYS * sizeof(size_t));
+    for (size_t i = 0; i < KEYS; i++) {
+        lens[i] = 1 + splitmix64(&state) % 48;
+        keys[i] = buf + splitmix64(&state) % (KEYS * 64 - 48);
+    }
+    uint64_t start = __rdtsc();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < KEYS; i++) {
+            out[i] = murmurHash3_32(keys[i], lens[i], (uint32_t)r);
+        }
+        sink += out[r];
+    }
+    double single = (double)(__rdtsc() - start) / (double)(KEYS * ROUNDS);
+    start = __rdtsc();
+    for (int r = 0; r < ROUNDS; r++) {
+        murmurHash3_32BatchVar(keys, lens, KEYS, (uint32_t)r, out);
+        sink += out[r];
+    }
+    double batch = (double)(__rdtsc() - start) / (double)(KEYS * ROUNDS);
+    printf("%-12s %10.2f %10.2f %7.2fx\n", "var 1~48B", single, batch, single / batch);
+
+    free(keys);
+    free(lens);
+    free(buf);
+    free(out);
+    bench_sink = sink;
+}
+
+/* 二、雪崩与位独立 */
+
+// 翻转 key 的第 bit 位；以 '\0' 结尾的算法若翻出 0 字节则该样本无效
+static bool flip_bit(unsigned char *key, size_t bit, bool nul_terminated) {
+    key[bit / 8] ^= (unsigned char)(1u << (bit % 8));
+    return !nul_terminated || key[bit / 8] != 0;
+}
+
+/*
+对每个输入位 i 与输出位 j，统计翻转 i 后 j 翻转的比例 p，偏差为 |2p - 1|，理想值为 0，样本数 n 时噪声约 1/sqrt(n)
+对每个输入位 i 与输出位对 (j, k)，统计两位翻转指示量的相关系数，理想值为 0
+*/
+static void quality_bench(size_t key_len, size_t samples) {
+    const size_t in_bits = key_len * 8;
+    uint64_t *flips = malloc(in_bits * 64 * sizeof(uint64_t));   // [i][j]
+    uint32_t *pairs = malloc(64 * 64 * sizeof(uint32_t));        // 单个输入位的 [j][k]
+    uint64_t *valid = malloc(in_bits * sizeof(uint64_t));
+
+    printf("\n%zu-byte keys, %zu samples per input bit\n", key_len, samples);
+    printf("%-12s %12s %12s\n", "hash", "avalanche", "bic corr");
+    for (size_t h = 0; h < HASH_COUNT; h++) {
+        const bench_hash *bh = &hashes[h];
+        const int out_bits = bh->bits;
+        memset(flips, 0, in_bits * 64 * sizeof(uint64_t));
+        memset(valid, 0, in_bits * sizeof(uint64_t));
+        double worst_bic = 0;
+        uint64_t state = 12345;
+        unsigned char key[64];
+
+        for (size_t i = 0; i < in_bits; i++) {
+            memset(pairs, 0, 64 * 64 * sizeof(uint32_t));
+            uint64_t *row = flips + i * 64;
+            for (size_t n = 0; n < samples; n++) {
+                fill_nonzero(key, key_len, &state);
+                key[key_len] = 0;
+                uint64_t base = bh->fn(key, key_len, 0);
+                if (!flip_bit(key, i, bh->nul_terminated)) {
+                    continue;
+                }
+                uint64_t diff = base ^ bh->fn(key, key_len, 0);
+                valid[i]++;
+                for (uint64_t d = diff; d; d &= d - 1) {
+                    int j = __builtin_ctzll(d);
+                    row[j]++;
+                    // 只统计 j < k 的一半
+                    for (uint64_t e = d & (d - 1); e; e &= e - 1) {
+                        pairs[j * 64 + __builtin_ctzll(e)]++;
+                    }
+                }
+            }
+            double n = (double)valid[i];
+            for (int j = 0; j < out_bits; j++) {
+                double pj = (double)row[j] / n;
+                for (int k = j + 1; k < out_bits; k++) {
+                    double pk = (double)row[k] / n;
+                    double denom = sqrt(pj * (1 - pj) * pk * (1 - pk));
+                    double pjk = (double)pairs[j * 64 + k] / n;
+                    // 某一位从不翻转或总是翻转时相关系数无定义，按最差计
+                    double corr = denom > 0 ? fabs(pjk - pj * pk) / denom : 1.0;
+                    if (corr > worst_bic) {
+                        worst_bic = corr;
+                    }
+                }
+            }
+        }
+
+        double worst_avalanche = 0;
+        for (size_t i = 0; i < in_bits; i++) {
+            for (int j = 0; j < out_bits; j++) {
+                double bias = fabs(2.0 * (double)flips[i * 64 + j] / (double)valid[i] - 1.0);
+                if (bias > worst_avalanche) {
+                    worst_avalanche = bias;
+                }
+            }
+        }
+        printf("%-12s %11.2f%% %12.3f\n", bh->name, worst_avalanche * 100, worst_bic);
+    }
+    free(flips);
+    free(pairs);
+    free(valid);
+}
+
+/* 三、碰撞与分布 */
+
+// 键集合：offsets[i] 到 offsets[i + 1] - 1 为第 i 个键，每个键后跟一个 '\0'
+typedef struct {
+    const char *name;
+    char *data;
+    size_t *offsets;
+    size_t count;
+    bool binary;        // 二进制键可能含 0 字节，以 '\0' 结尾的算法跳过
+} key_set;
+
+static void key_set_alloc(key_set *ks, const char *name, size_t count, size_t bytes, bool binary) {
+    ks->name = name;
+    ks->data = malloc(bytes);
+    ks->offsets = malloc((count + 1) * sizeof(size_t));
+    ks->count = count;
+    ks->binary = binary;
+    ks->offsets[0] = 0;
+}
+
+static void key_set_free(key_set *ks) {
+    free(ks->data);
+    free(ks->offsets);
+}
+
+// 连续整数，4 字节小端二进制，哈希表最常见的键
+static void make_ints(key_set *ks, size_t count) {
+    key_set_alloc(ks, "seq int32", count, count * 5, true);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t v = (uint32_t)i;
+        memcpy(ks->data + i * 5, &v, 4);
+        ks->data[i * 5 + 4] = 0;
+        ks->offsets[i + 1] = (i + 1) * 5;
+    }
+}
+
+// 由音节拼成的不重复单词，长度 2~12 字节
+static void word_of(size_t i, char *out) {
+    static const char *syllables[] = {"ka", "lo", "mi", "ne", "ru", "sa", "ti", "vo", "zen", "dar",
+                                      "qui", "el", "on", "ist", "ba", "gor"};
+    size_t n = 0;
+    // 16 进制展开，每一位选一个音节，保证不同的 i 得到不同的单词
+    do {
+        const char *s = syllables[i & 15];
+        size_t l = strlen(s);
+        memcpy(out + n, s, l);
+        n += l;
+        i >>= 4;
+    } while (i);
+    out[n] = 0;
+}
+
+static void make_words(key_set *ks, size_t count) {
+    key_set_alloc(ks, "words", count, count * 24, false);
+    size_t pos = 0;
+    for (size_t i = 0; i < count; i++) {
+        word_of(i, ks->data + pos);
+        pos += strlen(ks->data + pos) + 1;
+        ks->offsets[i + 1] = pos;
+    }
+}
+
+// 同一批站点下的 URL，前缀高度重复，只有路径与参数不同
+static void make_urls(key_set *ks, size_t count) {
+    key_set_alloc(ks, "urls", count, count * 96, false);
+    size_t pos = 0;
+    char word[32];
+    for (size_t i = 0; i < count; i++) {
+        word_of(i / 7, word);
+        pos += (size_t)sprintf(ks->data + pos, "https://www.site%zu.example.com/%s/item?id=%zu",
+                               i % 50, word, i) + 1;
+        ks->offsets[i + 1] = pos;
+    }
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+32 位碰撞：n 个键互不相同，随机函数的期望碰撞数约为 n^2 / 2^33
+64 位输出另外统计全 64 位碰撞，期望为 0
+分布：按低 16 位分到 65536 个桶（hasht 用低位选组），卡方统计量换算为 z 值，|z| 超过 3 说明分布明显不均匀
+*/
+static void collision_bench(size_t count) {
+    key_set sets[3];
+    make_ints(&sets[0], count);
+    make_urls(&sets[1], count);
+    make_words(&sets[2], count);
+
+    uint32_t *h32 = malloc(count * sizeof(uint32_t));
+    uint64_t *h64 = malloc(count * sizeof(uint64_t));
+    uint32_t *buckets = malloc(65536 * sizeof(uint32_t));
+    double expected = (double)count * (double)count / 8589934592.0;
+
+    printf("\n%zu keys per set, expected 32-bit collisions %.1f\n", count, expected);
+    printf("%-12s %-10s %10s %10s %10s\n", "hash", "keys", "coll32", "coll64", "low16 z");
+    for (size_t h = 0; h < HASH_COUNT; h++) {
+        const bench_hash *bh = &hashes[h];
+        for (int s = 0; s < 3; s++) {
+            key_set *ks = &sets[s];
+            if (ks->binary && bh->nul_terminated) {
+                printf("%-12s %-10s %10s %10s %10s\n", bh->name, ks->name, "-", "-", "-");
+                continue;
+            }
+            memset(buckets, 0, 65536 * sizeof(uint32_t));
+            for (size_t i = 0; i < ks->count; i++) {
+                size_t len = ks->offsets[i + 1] - ks->offsets[i] - 1;
+                uint64_t v = bh->fn(ks->data + ks->offsets[i], len, 0);
+                h32[i] = (uint32_t)v;
+                h64[i] = v;
+                buckets[v & 0xffff]++;
+            }
+
+            qsort(h32, ks->count, sizeof(uint32_t), compare_u32);
+            size_t coll32 = 0;
+            for (size_t i = 1; i < ks->count; i++) {
+                coll32 += h32[i] == h32[i - 1];
+            }
+            char coll64[16] = "-";
+            if (bh->bits == 64) {
+                qsort(h64, ks->count, sizeof(uint64_t), compare_u64);
+                size_t c = 0;
+                for (size_t i = 1; i < ks->count; i++) {
+                    c += h64[i] == h64[i - 1];
+                }
+                snprintf(coll64, sizeof(coll64), "%zu", c);
+            }
+
+            double mean = (double)ks->count / 65536.0;
+            double chi2 = 0;
+            for (size_t b = 0; b < 65536; b++) {
+                double d = (double)buckets[b] - mean;
+                chi2 += d * d / mean;
+            }
+            double z = (chi2 - 65535.0) / sqrt(2.0 * 65535.0);
+            printf("%-12s %-10s %10zu %10s %10.1f\n", bh->name, ks->name, coll32, coll64, z);
+        }
+    }
+
+    for (int s = 0; s < 3; s++) {
+        key_set_free(&sets[s]);
+    }
+    free(h32);
+    free(h64);
+    free(buckets);
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+
+    double start = now_sec();
+    speed_bench();
+    batch_bench();
+    quality_bench(4, 20000);
+    quality_bench(16, 4000);
+    collision_bench(count);
+    printf("\ntotal %.1f s\n", now_sec() - start);
+    return 0;
+}
@@ -1,7 +1,14 @@
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "hashalg.h"
 /*
 一、哈希函数的作用：
 （1）核心功能：将任意长度的输入数据（如字符串、二进制流）映射为一个固定长度的整数值
@@ -148,7 +155,7 @@ uint32_t murmurHash3_32(const void *key, size_t len, uint32_t seed) {
         // 乘法混淆数据
         k *= c1;               
         // 循环左移15位，原理：将 k 左移 r1 位，同时将溢出的高位补到低位，形成循环效果。作用：增强位级扩散，避免简单的位移导致信息丢失           
-        k *= (k << r1) | (k >> (32 - r1));
+        k = (k << r1) | (k >> (32 - r1));
         // 再次乘法混淆
         k *= c2;
 
@@ -170,7 +177,7 @@ uint32_t murmurHash3_32(const void *key, size_t len, uint32_t seed) {
         case 2: k1 ^= tail[1] << 8;   // 处理第2字节
         case 1: k1 ^= tail[0];        // 处理第1字节
                 k1 *= c1;             // 与分块相同的混淆操作
-                k1 *= (k1 << r1) | (k1 >> (32 - r1));
+                k1 = (k1 << r1) | (k1 >> (32 - r1));
                 k1 *= c2;
                 hash ^= k1;           // 合并到哈希值
     }
@@ -208,22 +215,8 @@ uint32_t murmurHash3_32(const void *key, size_t len, uint32_t seed) {
  - 区块链（比特币的区块哈希）
  - 密码存储（配合盐值）
  算法实现：
- - SHA-256：使用 OpenSSL 库实现，成熟且高效 https://github.com/openssl/openssl.git
-*/
-/**
-* @brief             计算输入数据的 SHA-256 哈希值
-* @param   data      data：输入数据的指针（const void*），支持任意二进制数据（字符串、字节流等）
-* @param   len       len：输入数据的长度（size_t），单位为字节
-* @param   hash      hash：输出缓冲区（unsigned char[]），固定为 SHA256_DIGEST_LENGTH（即 32 字节）
-*
-* @note              调用 OpenSSL 的 SHA256 函数，将输入数据转换为 const unsigned char* 类型，确保二进制兼容性，计算结果直接写入 hash 数组
+ - 不依赖 OpenSSL，便携实现与 SHA-NI、AVX2 多缓冲实现见（12）
 */
-#ifdef OPENSSL
-#include <openssl/sha.h>
-void sha256Hash(const void* data, size_t len, unsigned char hash[SHA256_DIGEST_LENGTH]) {
-    SHA256((const unsigned char*)data, len, hash);
-}
-#endif
 
 /*
 （4）SHA-3
@@ -254,7 +247,7 @@ void sha256Hash(const void* data, size_t len, unsigned char hash[SHA256_DIGEST_L
 * @note              调用第三方库 tiny_sha3 的 sha3 函数，参数 256 表示生成 256 位（32 字节）的哈希值
 */
 #ifdef SHA3
-#include "../../tiny_lib/tiny_sha3/sha3.h"
+#include "../../../tiny_soft/tiny_sha3/sha3.h"
 void sha3_256Hash(const void* input, size_t len, void* output) {
     sha3(input, len, output, 256); 
 }
@@ -496,7 +489,1949 @@ uint32_t jenHash(const char* key, size_t len, uint32_t seed) {
     return c;
 }
 
+/*
+（9）XXH3
+ 算法特点：
+ - 高吞吐：长输入每次处理 64 字节条带，8 个 64 位累加器互不依赖，可直接映射到 SSE2（2 路）、AVX2（4 路）的 32x32→64 乘法
+ - 短键快：0~16、17~128、129~240 字节各有专门路径，不进入循环，哈希表的短键只需几次乘法
+ - 64/128 位输出：表项超过 2^32 时 32 位哈希必然大量碰撞，128 位可作为校验和
+ - 密钥：192 字节的默认密钥与种子混合，每个条带使用密钥的不同偏移
+ 核心步骤（长输入）：
+ - 累加：acc[i ^ 1] += data[i]；acc[i] += lo32(data[i] ^ key[i]) * hi32(data[i] ^ key[i])
+ - 打散：每处理 16 个条带（一块，消耗完密钥）后 acc ^= acc >> 47，异或密钥后乘 PRIME32_1
+ - 合并：8 个累加器两两异或密钥后做 64x64→128 乘法并折叠，最后雪崩
+ 使用场景：
+ - 大容量哈希表、去重、分片
+ - GB/s 级别的数据校验和（非安全性场景）
+ 注意事项：
+ - 按小端序读取输入，结果与官方实现在 x86/ARM 小端平台上一致
+ - 非加密哈希，不能抵御刻意构造的碰撞
+*/
+#define XXH_PRIME32_1 0x9E3779B1U
+#define XXH_PRIME32_2 0x85EBCA77U
+#define XXH_PRIME32_3 0xC2B2AE3DU
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+#define XXH_PRIME_MX1 0x165667919E3779F9ULL
+#define XXH_PRIME_MX2 0x9FB21C651E98DF25ULL
+
+#define XXH3_STRIPE_LEN        64                                            // 条带字节数
+#define XXH3_SECRET_RATE       8                                             // 每个条带密钥前移的字节数
+#define XXH3_BLOCK_STRIPES     ((XXH3_SECRET_SIZE - XXH3_STRIPE_LEN) / XXH3_SECRET_RATE)
+#define XXH3_SECRET_SIZE_MIN   136
+#define XXH3_MIDSIZE_MAX       240
+#define XXH3_MIDSIZE_START     3
+#define XXH3_MIDSIZE_LAST      17
+#define XXH3_LASTACC_START     7
+#define XXH3_MERGEACCS_START   11
+
+static const unsigned char xxh3_kSecret[XXH3_SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+// 小端读取，memcpy 避免未对齐访问
+static inline uint32_t xxh_read32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t xxh_read64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t xxh_rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint32_t xxh_rotl32(uint32_t x, int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+// 64x64→128 乘法
+static inline xxh3_128 xxh_mul128(uint64_t a, uint64_t b) {
+    unsigned __int128 product = (unsigned __int128)a * b;
+    xxh3_128 r = {(uint64_t)product, (uint64_t)(product >> 64)};
+    return r;
+}
+
+// 乘积高低 64 位异或折叠
+static inline uint64_t xxh_mul128_fold64(uint64_t a, uint64_t b) {
+    xxh3_128 r = xxh_mul128(a, b);
+    return r.low ^ r.high;
+}
+
+// XXH64 的最终混合
+static inline uint64_t xxh64_avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+static inline uint64_t xxh3_avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= XXH_PRIME_MX1;
+    h ^= h >> 32;
+    return h;
+}
+
+// 4~8 字节输入的混合，比 avalanche 多一轮
+static inline uint64_t xxh3_rrmxmx(uint64_t h, uint64_t len) {
+    h ^= xxh_rotl64(h, 49) ^ xxh_rotl64(h, 24);
+    h *= XXH_PRIME_MX2;
+    h ^= (h >> 35) + len;
+    h *= XXH_PRIME_MX2;
+    h ^= h >> 28;
+    return h;
+}
+
+// 16 字节输入与 16 字节密钥混合
+static inline uint64_t xxh3_mix16(const unsigned char *in, const unsigned char *secret, uint64_t seed) {
+    return xxh_mul128_fold64(xxh_read64(in) ^ (xxh_read64(secret) + seed),
+                             xxh_read64(in + 8) ^ (xxh_read64(secret + 8) - seed));
+}
+
+// 128 位版本每次混合 32 字节，两半交叉影响高低 64 位
+static inline xxh3_128 xxh3_mix32(xxh3_128 acc, const unsigned char *in1, const unsigned char *in2,
+                                  const unsigned char *secret, uint64_t seed) {
+    acc.low += xxh3_mix16(in1, secret, seed);
+    acc.low ^= xxh_read64(in2) + xxh_read64(in2 + 8);
+    acc.high += xxh3_mix16(in2, secret + 16, seed);
+    acc.high ^= xxh_read64(in1) + xxh_read64(in1 + 8);
+    return acc;
+}
+
+/* 短输入：0~240 字节，直接使用默认密钥，种子参与每一次混合 */
+
+static uint64_t xxh3_len_0to16_64(const unsigned char *in, size_t len, const unsigned char *secret,
+                                  uint64_t seed) {
+    if (len > 8) {
+        uint64_t lo = xxh_read64(in) ^ ((xxh_read64(secret + 24) ^ xxh_read64(secret + 32)) + seed);
+        uint64_t hi = xxh_read64(in + len - 8) ^ ((xxh_read64(secret + 40) ^ xxh_read64(secret + 48)) - seed);
+        uint64_t acc = len + __builtin_bswap64(lo) + hi + xxh_mul128_fold64(lo, hi);
+        return xxh3_avalanche(acc);
+    }
+    if (len >= 4) {
+        seed ^= (uint64_t)__builtin_bswap32((uint32_t)seed) << 32;
+        uint64_t input = xxh_read32(in + len - 4) + ((uint64_t)xxh_read32(in) << 32);
+        uint64_t bitflip = (xxh_read64(secret + 8) ^ xxh_read64(secret + 16)) - seed;
+        return xxh3_rrmxmx(input ^ bitflip, len);
+    }
+    if (len > 0) {
+        // 首、中、尾三个字节和长度拼成 32 位
+        uint32_t combined = ((uint32_t)in[0] << 16) | ((uint32_t)in[len >> 1] << 24) |
+                            (uint32_t)in[len - 1] | ((uint32_t)len << 8);
+        uint64_t bitflip = (xxh_read32(secret) ^ xxh_read32(secret + 4)) + seed;
+        return xxh64_avalanche(combined ^ bitflip);
+    }
+    return xxh64_avalanche(seed ^ (xxh_read64(secret + 56) ^ xxh_read64(secret + 64)));
+}
+
+static uint64_t xxh3_len_17to128_64(const unsigned char *in, size_t len, const unsigned char *secret,
+                                    uint64_t seed) {
+    uint64_t acc = len * XXH_PRIME64_1;
+    // 从两端向中间取 16 字节块，短于 32 字节时两块重叠
+    if (len > 32) {
+        if (len > 64) {
+            if (len > 96) {
+                acc += xxh3_mix16(in + 48, secret + 96, seed);
+                acc += xxh3_mix16(in + len - 64, secret + 112, seed);
+            }
+            acc += xxh3_mix16(in + 32, secret + 64, seed);
+            acc += xxh3_mix16(in + len - 48, secret + 80, seed);
+        }
+        acc += xxh3_mix16(in + 16, secret + 32, seed);
+        acc += xxh3_mix16(in + len - 32, secret + 48, seed);
+    }
+    acc += xxh3_mix16(in, secret, seed);
+    acc += xxh3_mix16(in + len - 16, secret + 16, seed);
+    return xxh3_avalanche(acc);
+}
+
+static uint64_t xxh3_len_129to240_64(const unsigned char *in, size_t len, const unsigned char *secret,
+                                     uint64_t seed) {
+    uint64_t acc = len * XXH_PRIME64_1;
+    size_t rounds = len / 16;
+    for (size_t i = 0; i < 8; i++) {
+        acc += xxh3_mix16(in + 16 * i, secret + 16 * i, seed);
+    }
+    uint64_t acc_end = xxh3_mix16(in + len - 16, secret + XXH3_SECRET_SIZE_MIN - XXH3_MIDSIZE_LAST, seed);
+    acc = xxh3_avalanche(acc);
+    // 密钥只有 136 字节可用于 16 字节一组的混合，第 8 组起错开 3 字节重新使用
+    for (size_t i = 8; i < rounds; i++) {
+        acc_end += xxh3_mix16(in + 16 * i, secret + 16 * (i - 8) + XXH3_MIDSIZE_START, seed);
+    }
+    return xxh3_avalanche(acc + acc_end);
+}
+
+static xxh3_128 xxh3_len_0to16_128(const unsigned char *in, size_t len, const unsigned char *secret,
+                                   uint64_t seed) {
+    xxh3_128 h;
+    if (len > 8) {
+        uint64_t bitflipl = (xxh_read64(secret + 32) ^ xxh_read64(secret + 40)) - seed;
+        uint64_t bitfliph = (xxh_read64(secret + 48) ^ xxh_read64(secret + 56)) + seed;
+        uint64_t input_lo = xxh_read64(in);
+        uint64_t input_hi = xxh_read64(in + len - 8);
+        xxh3_128 m = xxh_mul128(input_lo ^ input_hi ^ bitflipl, XXH_PRIME64_1);
+        m.low += (uint64_t)(len - 1) << 54;
+        input_hi ^= bitfliph;
+        m.high += input_hi + (uint64_t)(uint32_t)input_hi * (XXH_PRIME32_2 - 1);
+        m.low ^= __builtin_bswap64(m.high);
+        // 128x64 乘法：h = m * PRIME64_2
+        h = xxh_mul128(m.low, XXH_PRIME64_2);
+        h.high += m.high * XXH_PRIME64_2;
+        h.low = xxh3_avalanche(h.low);
+        h.high = xxh3_avalanche(h.high);
+        return h;
+    }
+    if (len >= 4) {
+        seed ^= (uint64_t)__builtin_bswap32((uint32_t)seed) << 32;
+        uint64_t input = xxh_read32(in) + ((uint64_t)xxh_read32(in + len - 4) << 32);
+        uint64_t bitflip = (xxh_read64(secret + 16) ^ xxh_read64(secret + 24)) + seed;
+        h = xxh_mul128(input ^ bitflip, XXH_PRIME64_1 + (len << 2));
+        h.high += h.low << 1;
+        h.low ^= h.high >> 3;
+        h.low ^= h.low >> 35;
+        h.low *= XXH_PRIME_MX2;
+        h.low ^= h.low >> 28;
+        h.high = xxh3_avalanche(h.high);
+        return h;
+    }
+    if (len > 0) {
+        uint32_t combinedl = ((uint32_t)in[0] << 16) | ((uint32_t)in[len >> 1] << 24) |
+                             (uint32_t)in[len - 1] | ((uint32_t)len << 8);
+        uint32_t combinedh = xxh_rotl32(__builtin_bswap32(combinedl), 13);
+        uint64_t bitflipl = (xxh_read32(secret) ^ xxh_read32(secret + 4)) + seed;
+        uint64_t bitfliph = (xxh_read32(secret + 8) ^ xxh_read32(secret + 12)) - seed;
+        h.low = xxh64_avalanche(combinedl ^ bitflipl);
+        h.high = xxh64_avalanche(combinedh ^ bitfliph);
+        return h;
+    }
+    h.low = xxh64_avalanche(seed ^ xxh_read64(secret + 64) ^ xxh_read64(secret + 72));
+    h.high = xxh64_avalanche(seed ^ xxh_read64(secret + 80) ^ xxh_read64(secret + 88));
+    return h;
+}
+
+// 17~240 字节共用的 128 位收尾
+static inline xxh3_128 xxh3_finish_mid128(xxh3_128 acc, size_t len, uint64_t seed) {
+    xxh3_128 h;
+    h.low = xxh3_avalanche(acc.low + acc.high);
+    h.high = 0 - xxh3_avalanche(acc.low * XXH_PRIME64_1 + acc.high * XXH_PRIME64_4 +
+                                (len - seed) * XXH_PRIME64_2);
+    return h;
+}
+
+static xxh3_128 xxh3_len_17to128_128(const unsigned char *in, size_t len, const unsigned char *secret,
+                                     uint64_t seed) {
+    xxh3_128 acc = {len * XXH_PRIME64_1, 0};
+    if (len > 32) {
+        if (len > 64) {
+            if (len > 96) {
+                acc = xxh3_mix32(acc, in + 48, in + len - 64, secret + 96, seed);
+            }
+            acc = xxh3_mix32(acc, in + 32, in + len - 48, secret + 64, seed);
+        }
+        acc = xxh3_mix32(acc, in + 16, in + len - 32, secret + 32, seed);
+    }
+    acc = xxh3_mix32(acc, in, in + len - 16, secret, seed);
+    return xxh3_finish_mid128(acc, len, seed);
+}
+
+static xxh3_128 xxh3_len_129to240_128(const unsigned char *in, size_t len, const unsigned char *secret,
+                                      uint64_t seed) {
+    xxh3_128 acc = {len * XXH_PRIME64_1, 0};
+    for (size_t i = 32; i < 160; i += 32) {
+        acc = xxh3_mix32(acc, in + i - 32, in + i - 16, secret + i - 32, seed);
+    }
+    acc.low = xxh3_avalanche(acc.low);
+    acc.high = xxh3_avalanche(acc.high);
+    for (size_t i = 160; i <= len; i += 32) {
+        acc = xxh3_mix32(acc, in + i - 32, in + i - 16, secret + XXH3_MIDSIZE_START + i - 160, seed);
+    }
+    acc = xxh3_mix32(acc, in + len - 16, in + len - 32,
+                     secret + XXH3_SECRET_SIZE_MIN - XXH3_MIDSIZE_LAST - 16, 0 - seed);
+    return xxh3_finish_mid128(acc, len, seed);
+}
+
+/*
+长输入：超过 240 字节
+accumulate 处理 nb 个连续条带，第 n 个条带使用 secret + 8n；scramble 在每块结束时打散累加器
+标量、SSE2、AVX2 三套实现结果完全相同，运行时选择一次
+*/
+
+typedef struct {
+    void (*accumulate)(uint64_t *acc, const unsigned char *in, const unsigned char *secret, size_t nb);
+    void (*scramble)(uint64_t *acc, const unsigned char *secret);
+} xxh3_kernel;
+
+static inline void xxh3_accumulate512_scalar(uint64_t *acc, const unsigned char *in,
+                                             const unsigned char *secret) {
+    for (size_t i = 0; i < 8; i++) {
+        uint64_t data = xxh_read64(in + 8 * i);
+        uint64_t key = data ^ xxh_read64(secret + 8 * i);
+        // 原始数据加到相邻累加器，乘法结果为 0 时输入信息也不会丢失
+        acc[i ^ 1] += data;
+        acc[i] += (uint64_t)(uint32_t)key * (key >> 32);
+    }
+}
+
+static void xxh3_accumulate_scalar(uint64_t *acc, const unsigned char *in, const unsigned char *secret,
+                                   size_t nb) {
+    for (size_t n = 0; n < nb; n++) {
+        xxh3_accumulate512_scalar(acc, in + n * XXH3_STRIPE_LEN, secret + n * XXH3_SECRET_RATE);
+    }
+}
+
+static void xxh3_scramble_scalar(uint64_t *acc, const unsigned char *secret) {
+    for (size_t i = 0; i < 8; i++) {
+        uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= xxh_read64(secret + 8 * i);
+        acc[i] = a * XXH_PRIME32_1;
+    }
+}
+
+#if defined(__SSE2__)
+// SSE2：每个寄存器 2 个累加器，_mm_mul_epu32 取每个 64 位通道的低 32 位相乘
+static void xxh3_accumulate_sse2(uint64_t *acc, const unsigned char *in, const unsigned char *secret,
+                                 size_t nb) {
+    __m128i a[4];
+    for (int i = 0; i < 4; i++) {
+        a[i] = _mm_loadu_si128((const __m128i *)(acc + 2 * i));
+    }
+    for (size_t n = 0; n < nb; n++) {
+        const unsigned char *p = in + n * XXH3_STRIPE_LEN;
+        const unsigned char *s = secret + n * XXH3_SECRET_RATE;
+        for (int i = 0; i < 4; i++) {
+            __m128i data = _mm_loadu_si128((const __m128i *)(p + 16 * i));
+            __m128i key = _mm_xor_si128(data, _mm_loadu_si128((const __m128i *)(s + 16 * i)));
+            __m128i product = _mm_mul_epu32(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+            // 交换通道内的两个 64 位数据，对应标量的 acc[i ^ 1] += data
+            __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+            a[i] = _mm_add_epi64(a[i], _mm_add_epi64(product, swapped));
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        _mm_storeu_si128((__m128i *)(acc + 2 * i), a[i]);
+    }
+}
+
+static void xxh3_scramble_sse2(uint64_t *acc, const unsigned char *secret) {
+    const __m128i prime = _mm_set1_epi32((int)XXH_PRIME32_1);
+    for (int i = 0; i < 4; i++) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(acc + 2 * i));
+        a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+        a = _mm_xor_si128(a, _mm_loadu_si128((const __m128i *)(secret + 16 * i)));
+        // 没有 64x32 乘法，拆成高低 32 位分别乘再合并
+        __m128i lo = _mm_mul_epu32(a, prime);
+        __m128i hi = _mm_mul_epu32(_mm_shuffle_epi32(a, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+        _mm_storeu_si128((__m128i *)(acc + 2 * i), _mm_add_epi64(lo, _mm_slli_epi64(hi, 32)));
+    }
+}
+
+// AVX2：每个寄存器 4 个累加器，用 target 属性单独编译，未开启 -mavx2 时也可以在运行时选用
+__attribute__((target("avx2")))
+static void xxh3_accumulate_avx2(uint64_t *acc, const unsigned char *in, const unsigned char *secret,
+                                 size_t nb) {
+    __m256i a[2];
+    for (int i = 0; i < 2; i++) {
+        a[i] = _mm256_loadu_si256((const __m256i *)(acc + 4 * i));
+    }
+    for (size_t n = 0; n < nb; n++) {
+        const unsigned char *p = in + n * XXH3_STRIPE_LEN;
+        const unsigned char *s = secret + n * XXH3_SECRET_RATE;
+        for (int i = 0; i < 2; i++) {
+            __m256i data = _mm256_loadu_si256((const __m256i *)(p + 32 * i));
+            __m256i key = _mm256_xor_si256(data, _mm256_loadu_si256((const __m256i *)(s + 32 * i)));
+            __m256i product = _mm256_mul_epu32(key, _mm256_srli_epi64(key, 32));
+            __m256i swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+            a[i] = _mm256_add_epi64(a[i], _mm256_add_epi64(product, swapped));
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        _mm256_storeu_si256((__m256i *)(acc + 4 * i), a[i]);
+    }
+}
+
+__attribute__((target("avx2")))
+static void xxh3_scramble_avx2(uint64_t *acc, const unsigned char *secret) {
+    const __m256i prime = _mm256_set1_epi32((int)XXH_PRIME32_1);
+    for (int i = 0; i < 2; i++) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(acc + 4 * i));
+        a = _mm256_xor_si256(a, _mm256_srli_epi64(a, 47));
+        a = _mm256_xor_si256(a, _mm256_loadu_si256((const __m256i *)(secret + 32 * i)));
+        __m256i lo = _mm256_mul_epu32(a, prime);
+        __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), prime);
+        _mm256_storeu_si256((__m256i *)(acc + 4 * i), _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32)));
+    }
+}
+#endif
+
+static const xxh3_kernel xxh3_kernel_scalar = {xxh3_accumulate_scalar, xxh3_scramble_scalar};
+#if defined(__SSE2__)
+static const xxh3_kernel xxh3_kernel_sse2 = {xxh3_accumulate_sse2, xxh3_scramble_sse2};
+static const xxh3_kernel xxh3_kernel_avx2 = {xxh3_accumulate_avx2, xxh3_scramble_avx2};
+#endif
+
+// 按 CPU 支持情况选择实现，结果缓存，多线程重复选择得到的是同一个值
+static const xxh3_kernel *xxh3_select_kernel(void) {
+    static const xxh3_kernel *selected = NULL;
+    const xxh3_kernel *k = __atomic_load_n(&selected, __ATOMIC_RELAXED);
+    if (k) {
+        return k;
+    }
+    k = &xxh3_kernel_scalar;
+#if defined(__SSE2__)
+    __builtin_cpu_init();
+    k = __builtin_cpu_supports("avx2") ? &xxh3_kernel_avx2 : &xxh3_kernel_sse2;
+#endif
+    __atomic_store_n(&selected, k, __ATOMIC_RELAXED);
+    return k;
+}
+
+static inline void xxh3_init_acc(uint64_t *acc) {
+    acc[0] = XXH_PRIME32_3;
+    acc[1] = XXH_PRIME64_1;
+    acc[2] = XXH_PRIME64_2;
+    acc[3] = XXH_PRIME64_3;
+    acc[4] = XXH_PRIME64_4;
+    acc[5] = XXH_PRIME32_2;
+    acc[6] = XXH_PRIME64_5;
+    acc[7] = XXH_PRIME32_1;
+}
+
+// 种子派生密钥：每 16 字节低半加种子、高半减种子
+static void xxh3_init_secret(unsigned char *secret, uint64_t seed) {
+    for (size_t i = 0; i < XXH3_SECRET_SIZE; i += 16) {
+        uint64_t lo = xxh_read64(xxh3_kSecret + i) + seed;
+        uint64_t hi = xxh_read64(xxh3_kSecret + i + 8) - seed;
+        memcpy(secret + i, &lo, 8);
+        memcpy(secret + i + 8, &hi, 8);
+    }
+}
+
+static void xxh3_hash_long(uint64_t *acc, const unsigned char *in, size_t len, const unsigned char *secret) {
+    const xxh3_kernel *k = xxh3_select_kernel();
+    const size_t block_len = XXH3_STRIPE_LEN * XXH3_BLOCK_STRIPES;
+    // 最后一个条带单独处理，所以按 len - 1 计算，恰好整块时最后一块也留到尾部
+    size_t blocks = (len - 1) / block_len;
+
+    xxh3_init_acc(acc);
+    for (size_t n = 0; n < blocks; n++) {
+        k->accumulate(acc, in + n * block_len, secret, XXH3_BLOCK_STRIPES);
+        k->scramble(acc, secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN);
+    }
+    size_t stripes = ((len - 1) - block_len * blocks) / XXH3_STRIPE_LEN;
+    k->accumulate(acc, in + blocks * block_len, secret, stripes);
+    // 最后 64 字节（可能与前一条带重叠）
+    xxh3_accumulate512_scalar(acc, in + len - XXH3_STRIPE_LEN,
+                              secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN - XXH3_LASTACC_START);
+}
+
+static uint64_t xxh3_merge_accs(const uint64_t *acc, const unsigned char *secret, uint64_t start) {
+    for (size_t i = 0; i < 4; i++) {
+        start += xxh_mul128_fold64(acc[2 * i] ^ xxh_read64(secret + 16 * i),
+                                   acc[2 * i + 1] ^ xxh_read64(secret + 16 * i + 8));
+    }
+    return xxh3_avalanche(start);
+}
+
+static inline uint64_t xxh3_long_64(const uint64_t *acc, const unsigned char *secret, uint64_t len) {
+    return xxh3_merge_accs(acc, secret + XXH3_MERGEACCS_START, len * XXH_PRIME64_1);
+}
+
+static inline xxh3_128 xxh3_long_128(const uint64_t *acc, const unsigned char *secret, uint64_t len) {
+    xxh3_128 h;
+    h.low = xxh3_merge_accs(acc, secret + XXH3_MERGEACCS_START, len * XXH_PRIME64_1);
+    h.high = xxh3_merge_accs(acc, secret + XXH3_SECRET_SIZE - 64 - XXH3_MERGEACCS_START,
+                             ~(len * XXH_PRIME64_2));
+    return h;
+}
+
+/**
+* @brief             XXH3 64 位哈希
+* @param   key       输入数据，任意二进制
+* @param   len       输入字节数
+* @param   seed      种子，0 与官方 XXH3_64bits 一致
+* @return  uint64_t  哈希值
+*
+* @note              长输入且种子非 0 时先在栈上派生 192 字节密钥
+*/
+uint64_t xxh3Hash64(const void *key, size_t len, uint64_t seed) {
+    const unsigned char *in = (const unsigned char *)key;
+    if (len <= 16) {
+        return xxh3_len_0to16_64(in, len, xxh3_kSecret, seed);
+    }
+    if (len <= 128) {
+        return xxh3_len_17to128_64(in, len, xxh3_kSecret, seed);
+    }
+    if (len <= XXH3_MIDSIZE_MAX) {
+        return xxh3_len_129to240_64(in, len, xxh3_kSecret, seed);
+    }
+    unsigned char custom[XXH3_SECRET_SIZE];
+    const unsigned char *secret = xxh3_kSecret;
+    if (seed) {
+        xxh3_init_secret(custom, seed);
+        secret = custom;
+    }
+    uint64_t acc[8];
+    xxh3_hash_long(acc, in, len, secret);
+    return xxh3_long_64(acc, secret, len);
+}
+
+/**
+* @brief             XXH3 128 位哈希
+* @param   key       输入数据，任意二进制
+* @param   len       输入字节数
+* @param   seed      种子
+* @return  xxh3_128  哈希值，low 为低 64 位
+*
+* @note              长输入与 64 位版本共用累加过程，只是合并时多取一组密钥
+*/
+xxh3_128 xxh3Hash128(const void *key, size_t len, uint64_t seed) {
+    const unsigned char *in = (const unsigned char *)key;
+    if (len <= 16) {
+        return xxh3_len_0to16_128(in, len, xxh3_kSecret, seed);
+    }
+    if (len <= 128) {
+        return xxh3_len_17to128_128(in, len, xxh3_kSecret, seed);
+    }
+    if (len <= XXH3_MIDSIZE_MAX) {
+        return xxh3_len_129to240_128(in, len, xxh3_kSecret, seed);
+    }
+    unsigned char custom[XXH3_SECRET_SIZE];
+    const unsigned char *secret = xxh3_kSecret;
+    if (seed) {
+        xxh3_init_secret(custom, seed);
+        secret = custom;
+    }
+    uint64_t acc[8];
+    xxh3_hash_long(acc, in, len, secret);
+    return xxh3_long_128(acc, secret, len);
+}
+
+/**
+* @brief             初始化流式计算状态
+* @param   state     调用者分配的状态
+* @param   seed      种子
+*
+* @note              Revision History
+*/
+void xxh3Init(xxh3_state *state, uint64_t seed) {
+    xxh3_init_acc(state->acc);
+    if (seed) {
+        xxh3_init_secret(state->secret, seed);
+    } else {
+        memcpy(state->secret, xxh3_kSecret, XXH3_SECRET_SIZE);
+    }
+    state->buffered = 0;
+    state->stripes = 0;
+    state->total_len = 0;
+    state->seed = seed;
+}
+
+// 处理 nb 个条带，接着上次在块内的位置继续，跨块时打散
+static const unsigned char *xxh3_consume(const xxh3_kernel *k, xxh3_state *state, const unsigned char *in,
+                                         size_t nb) {
+    size_t left = XXH3_BLOCK_STRIPES - state->stripes;
+    if (nb >= left) {
+        const unsigned char *secret = state->secret + state->stripes * XXH3_SECRET_RATE;
+        do {
+            k->accumulate(state->acc, in, secret, left);
+            k->scramble(state->acc, state->secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN);
+            in += left * XXH3_STRIPE_LEN;
+            nb -= left;
+            left = XXH3_BLOCK_STRIPES;
+            secret = state->secret;
+        } while (nb >= XXH3_BLOCK_STRIPES);
+        state->stripes = 0;
+    }
+    if (nb > 0) {
+        k->accumulate(state->acc, in, state->secret + state->stripes * XXH3_SECRET_RATE, nb);
+        in += nb * XXH3_STRIPE_LEN;
+        state->stripes += nb;
+    }
+    return in;
+}
+
+/**
+* @brief             追加输入
+* @param   state     xxh3Init 初始化过的状态
+* @param   data      输入数据
+* @param   len       输入字节数
+*
+* @note              缓冲区满时才处理，且总保留最后至少 1 字节，使最后一个条带留给 xxh3Final 单独处理
+*/
+void xxh3Update(xxh3_state *state, const void *data, size_t len) {
+    const unsigned char *in = (const unsigned char *)data;
+    const unsigned char *end = in + len;
+    state->total_len += len;
+
+    if (len <= XXH3_BUFFER_SIZE - state->buffered) {
+        memcpy(state->buffer + state->buffered, in, len);
+        state->buffered += len;
+        return;
+    }
+
+    const xxh3_kernel *k = xxh3_select_kernel();
+    // 先补满缓冲区并处理，此后输入一定还有剩余
+    if (state->buffered) {
+        size_t fill = XXH3_BUFFER_SIZE - state->buffered;
+        memcpy(state->buffer + state->buffered, in, fill);
+        in += fill;
+        xxh3_consume(k, state, state->buffer, XXH3_BUFFER_SIZE / XXH3_STRIPE_LEN);
+        state->buffered = 0;
+    }
+    // 大段输入直接处理，不经过缓冲区
+    if (end - in > XXH3_BUFFER_SIZE) {
+        size_t nb = (size_t)(end - 1 - in) / XXH3_STRIPE_LEN;
+        in = xxh3_consume(k, state, in, nb);
+        // 保存最后一个已处理条带，结束时剩余不足一个条带要用它补齐
+        memcpy(state->buffer + XXH3_BUFFER_SIZE - XXH3_STRIPE_LEN, in - XXH3_STRIPE_LEN, XXH3_STRIPE_LEN);
+    }
+    memcpy(state->buffer, in, (size_t)(end - in));
+    state->buffered = (size_t)(end - in);
+}
+
+// 在状态副本上处理缓冲区剩余数据和最后一个条带
+static void xxh3_digest_long(const xxh3_state *state, uint64_t *acc) {
+    xxh3_state copy;
+    memcpy(copy.acc, state->acc, sizeof(copy.acc));
+    memcpy(copy.secret, state->secret, XXH3_SECRET_SIZE);
+    copy.stripes = state->stripes;
+
+    unsigned char last[XXH3_STRIPE_LEN];
+    const unsigned char *last_ptr;
+    if (state->buffered >= XXH3_STRIPE_LEN) {
+        size_t nb = (state->buffered - 1) / XXH3_STRIPE_LEN;
+        xxh3_consume(xxh3_select_kernel(), &copy, state->buffer, nb);
+        last_ptr = state->buffer + state->buffered - XXH3_STRIPE_LEN;
+    } else {
+        // 剩余不足一个条带，用缓冲区末尾保存的上一条带补齐 64 字节
+        size_t catchup = XXH3_STRIPE_LEN - state->buffered;
+        memcpy(last, state->buffer + XXH3_BUFFER_SIZE - catchup, catchup);
+        memcpy(last + catchup, state->buffer, state->buffered);
+        last_ptr = last;
+    }
+    xxh3_accumulate512_scalar(copy.acc, last_ptr,
+                              copy.secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN - XXH3_LASTACC_START);
+    memcpy(acc, copy.acc, sizeof(copy.acc));
+}
+
+/**
+* @brief             取当前 64 位结果
+* @param   state     流式计算状态
+* @return  uint64_t  与对全部输入调用 xxh3Hash64 的结果相同
+*
+* @note              Revision History
+*/
+uint64_t xxh3Final64(const xxh3_state *state) {
+    if (state->total_len > XXH3_MIDSIZE_MAX) {
+        uint64_t acc[8];
+        xxh3_digest_long(state, acc);
+        return xxh3_long_64(acc, state->secret, state->total_len);
+    }
+    return xxh3Hash64(state->buffer, (size_t)state->total_len, state->seed);
+}
+
+/**
+* @brief             取当前 128 位结果
+* @param   state     流式计算状态
+* @return  xxh3_128  与对全部输入调用 xxh3Hash128 的结果相同
+*
+* @note              Revision History
+*/
+xxh3_128 xxh3Final128(const xxh3_state *state) {
+    if (state->total_len > XXH3_MIDSIZE_MAX) {
+        uint64_t acc[8];
+        xxh3_digest_long(state, acc);
+        return xxh3_long_128(acc, state->secret, state->total_len);
+    }
+    return xxh3Hash128(state->buffer, (size_t)state->total_len, state->seed);
+}
+
+/*
+（10）CRC
+ 算法特点：
+ - 把输入看作 GF(2) 上的多项式，除以生成多项式 P 取余数；运算是线性的，能检出全部奇数个位错误和长度不超过 CRC 位数的突发错误
+ - CRC32（IEEE，zlib/以太网）、CRC32C（Castagnoli，iSCSI/ext4/RocksDB）、CRC64（ECMA-182，xz）都按反射位序（低位先入）计算
+ - 是校验和而不是均匀哈希：雪崩效应差，用作哈希表的哈希值时要再做一次 fmix
+ 实现：
+ - 查表（slicing-by-8）：8 张 256 项的表，每次查 8 次表处理 8 字节，不依赖任何指令集，作为兜底实现
+ - CRC32C：SSE4.2 的 crc32 指令每周期可以发射一条（8 字节），但延迟 3 个周期，单条依赖链只能跑到峰值的 1/3；
+   把一段输入切成等长的三份各跑一条链，最后用 PCLMULQDQ 把前两份的余数"移过"后面的字节（乘 x^(8L) mod P）再异或合并
+ - CRC32/CRC64：没有专用指令，用 PCLMULQDQ 折叠：128 位累加值 X 越过后面 D 位数据等价于 X·x^D mod P，
+   把 X 拆成两个 64 位半分别与预先算好的常数做无进位乘法，结果仍不超过 128 位，与 D 位之后的 16 字节异或即可继续；
+   4 个累加器同时折叠（D = 512）隐藏乘法延迟，最后并成一个 16 字节的值，连同不足 16 字节的尾部交给查表
+ - 第一次调用时构建查表并检测 CPU，只有 SSE4.2 时 CRC32C 单链计算，缺少 SSE4.2/PCLMULQDQ 时使用查表实现
+ 使用场景：
+ - 存储与网络的数据校验：块/页校验和、日志记录、压缩文件尾
+ 注意事项：
+ - crc 参数传入前一段的结果，首段传 0；分段计算的结果与一次性计算相同
+ - 结果与 zlib crc32()、Linux crc32c()、xz 的 CRC64 一致，"123456789" 的校验值分别为 0xcbf43926、0xe3069283、0x995dc9bbdf1939fa
+*/
+
+// 反射位序的生成多项式
+#define CRC32_POLY  0xedb88320U
+#define CRC32C_POLY 0x82f63b78U
+#define CRC64_POLY  0xc96c5795d7870f42ULL
+
+static uint32_t crc32_table[8][256];
+static uint32_t crc32c_table[8][256];
+static uint64_t crc64_table[8][256];
+
+// table[k][b]：字节 b 后面再跟 k 个 0 字节时的余数，slicing-by-8 用它一次处理 8 个字节
+static void crc32_build_table(uint32_t table[8][256], uint32_t poly) {
+    for (uint32_t b = 0; b < 256; b++) {
+        uint32_t c = b;
+        for (int i = 0; i < 8; i++) {
+            c = (c >> 1) ^ (poly & (0U - (c & 1)));
+        }
+        table[0][b] = c;
+    }
+    for (int k = 1; k < 8; k++) {
+        for (int b = 0; b < 256; b++) {
+            table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xff];
+        }
+    }
+}
+
+static void crc64_build_table(uint64_t table[8][256], uint64_t poly) {
+    for (uint64_t b = 0; b < 256; b++) {
+        uint64_t c = b;
+        for (int i = 0; i < 8; i++) {
+            c = (c >> 1) ^ (poly & (0ULL - (c & 1)));
+        }
+        table[0][b] = c;
+    }
+    for (int k = 1; k < 8; k++) {
+        for (int b = 0; b < 256; b++) {
+            table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xff];
+        }
+    }
+}
+
+static inline uint64_t crc_read64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 以下查表函数处理的都是寄存器值（不含首尾取反）
+static uint32_t crc32_update_table(const uint32_t table[8][256], uint32_t crc, const unsigned char *p, size_t len) {
+    while (len >= 8) {
+        uint64_t v = crc_read64(p) ^ crc;
+        crc = table[7][v & 0xff] ^ table[6][(v >> 8) & 0xff] ^ table[5][(v >> 16) & 0xff] ^
+              table[4][(v >> 24) & 0xff] ^ table[3][(v >> 32) & 0xff] ^ table[2][(v >> 40) & 0xff] ^
+              table[1][(v >> 48) & 0xff] ^ table[0][v >> 56];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = (crc >> 8) ^ table[0][(crc ^ *p++) & 0xff];
+    }
+    return crc;
+}
+
+static uint64_t crc64_update_table(const uint64_t table[8][256], uint64_t crc, const unsigned char *p, size_t len) {
+    while (len >= 8) {
+        uint64_t v = crc_read64(p) ^ crc;
+        crc = table[7][v & 0xff] ^ table[6][(v >> 8) & 0xff] ^ table[5][(v >> 16) & 0xff] ^
+              table[4][(v >> 24) & 0xff] ^ table[3][(v >> 32) & 0xff] ^ table[2][(v >> 40) & 0xff] ^
+              table[1][(v >> 48) & 0xff] ^ table[0][v >> 56];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = (crc >> 8) ^ table[0][(crc ^ *p++) & 0xff];
+    }
+    return crc;
+}
+
+// 第一次调用时建表，查表实现在表建好之后才能使用
+typedef struct crc_kernel crc_kernel;
+static const crc_kernel *crc_select_kernel(void);
+
+uint32_t crc32HashPortable(const void *data, size_t len, uint32_t crc) {
+    crc_select_kernel();
+    return ~crc32_update_table(crc32_table, ~crc, (const unsigned char *)data, len);
+}
+
+uint32_t crc32cHashPortable(const void *data, size_t len, uint32_t crc) {
+    crc_select_kernel();
+    return ~crc32_update_table(crc32c_table, ~crc, (const unsigned char *)data, len);
+}
+
+uint64_t crc64HashPortable(const void *data, size_t len, uint64_t crc) {
+    crc_select_kernel();
+    return ~crc64_update_table(crc64_table, ~crc, (const unsigned char *)data, len);
+}
+
+#if defined(__SSE2__)
+/*
+折叠常数：反射位序下 64 位字的第 b 位对应 x^(63-b)，两个这样的字做无进位乘法，
+结果第 c 位对应 x^(126-c)，而 16 字节输入的第 c 位对应 x^(127-c)，差一个 x，所以指数都减 1：
+X = A·x^64 + B（A 为低 8 字节），X·x^D ≡ A·(x^(D+63) mod P) + B·(x^(D-1) mod P)
+*/
+typedef struct {
+    uint64_t fold4[2];  // D = 512：x^575 mod P、x^511 mod P
+    uint64_t fold1[2];  // D = 128：x^191 mod P、x^127 mod P
+} crc_fold_keys;
+
+static const crc_fold_keys crc32_fold_keys = {
+    {0x653d982200000000ULL, 0xcad38e8f00000000ULL},
+    {0x65673b4600000000ULL, 0x9ba54c6f00000000ULL},
+};
+
+static const crc_fold_keys crc64_fold_keys = {
+    {0x6ae3efbb9dd441f3ULL, 0x081f6054a7842df4ULL},
+    {0xe05dd497ca393ae4ULL, 0xdabe95afc7875f40ULL},
+};
+
+// 少于这么多字节时折叠的准备与收尾开销不划算，直接查表
+#define CRC_FOLD_MIN 128
+
+__attribute__((target("pclmul,sse2")))
+static inline __m128i crc_fold16(__m128i x, __m128i keys, __m128i next) {
+    __m128i lo = _mm_clmulepi64_si128(x, keys, 0x00);
+    __m128i hi = _mm_clmulepi64_si128(x, keys, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(lo, hi), next);
+}
+
+// 把 len（>= 64）中 16 的整数倍部分折叠为 16 字节写入 out，返回折叠掉的字节数；crc 为寄存器值
+__attribute__((target("pclmul,sse2")))
+static size_t crc_fold_pclmul(const crc_fold_keys *keys, uint64_t crc, const unsigned char *p, size_t len,
+                              unsigned char out[16]) {
+    const __m128i k4 = _mm_loadu_si128((const __m128i *)keys->fold4);
+    const __m128i k1 = _mm_loadu_si128((const __m128i *)keys->fold1);
+    // 初值异或进最前面的字节，之后按初值为 0 计算
+    __m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)p), _mm_cvtsi64_si128((long long)crc));
+    __m128i x1 = _mm_loadu_si128((const __m128i *)(p + 16));
+    __m128i x2 = _mm_loadu_si128((const __m128i *)(p + 32));
+    __m128i x3 = _mm_loadu_si128((const __m128i *)(p + 48));
+    size_t done = 64;
+    for (; done + 64 <= len; done += 64) {
+        x0 = crc_fold16(x0, k4, _mm_loadu_si128((const __m128i *)(p + done)));
+        x1 = crc_fold16(x1, k4, _mm_loadu_si128((const __m128i *)(p + done + 16)));
+        x2 = crc_fold16(x2, k4, _mm_loadu_si128((const __m128i *)(p + done + 32)));
+        x3 = crc_fold16(x3, k4, _mm_loadu_si128((const __m128i *)(p + done + 48)));
+    }
+    x0 = crc_fold16(x0, k1, x1);
+    x0 = crc_fold16(x0, k1, x2);
+    x0 = crc_fold16(x0, k1, x3);
+    for (; done + 16 <= len; done += 16) {
+        x0 = crc_fold16(x0, k1, _mm_loadu_si128((const __m128i *)(p + done)));
+    }
+    _mm_storeu_si128((__m128i *)out, x0);
+    return done;
+}
+
+static uint32_t crc32_pclmul(const void *data, size_t len, uint32_t crc) {
+    const unsigned char *p = (const unsigned char *)data;
+    uint32_t c = ~crc;
+    if (len >= CRC_FOLD_MIN) {
+        unsigned char folded[16];
+        size_t done = crc_fold_pclmul(&crc32_fold_keys, c, p, len, folded);
+        c = crc32_update_table(crc32_table, 0, folded, 16);
+        p += done;
+        len -= done;
+    }
+    return ~crc32_update_table(crc32_table, c, p, len);
+}
+
+static uint64_t crc64_pclmul(const void *data, size_t len, uint64_t crc) {
+    const unsigned char *p = (const unsigned char *)data;
+    uint64_t c = ~crc;
+    if (len >= CRC_FOLD_MIN) {
+        unsigned char folded[16];
+        size_t done = crc_fold_pclmul(&crc64_fold_keys, c, p, len, folded);
+        c = crc64_update_table(crc64_table, 0, folded, 16);
+        p += done;
+        len -= done;
+    }
+    return ~crc64_update_table(crc64_table, c, p, len);
+}
+
+/*
+CRC32C 三路交错：长段每份 4096 字节，剩余部分每份 256 字节
+余数移过 L 个 0 字节：crc32 指令对 8 字节输入 V 算的是 V·x^32 mod P，两个 32 位反射值相乘又多出一个 x，
+所以 crc·x^(8L) mod P = crc32(0, clmul(crc, x^(8L-33) mod P))
+*/
+#define CRC32C_LONG  4096
+#define CRC32C_SHORT 256
+#define CRC32C_SHIFT_LONG    0x82f89c77U  // x^(8*4096-33) mod P
+#define CRC32C_SHIFT_LONG2   0x54a86326U  // x^(8*8192-33) mod P
+#define CRC32C_SHIFT_SHORT   0xb9e02b86U  // x^(8*256-33) mod P
+#define CRC32C_SHIFT_SHORT2  0xdd7e3b0cU  // x^(8*512-33) mod P
+
+__attribute__((target("sse4.2,pclmul")))
+static inline uint32_t crc32c_shift(uint32_t crc, uint32_t key) {
+    __m128i prod = _mm_clmulepi64_si128(_mm_cvtsi32_si128((int)crc), _mm_cvtsi32_si128((int)key), 0x00);
+    return (uint32_t)_mm_crc32_u64(0, (uint64_t)_mm_cvtsi128_si64(prod));
+}
+
+// 每次处理 3 * block 字节，三条依赖链互不等待
+__attribute__((target("sse4.2,pclmul")))
+static inline uint32_t crc32c_3way(uint32_t crc, const unsigned char **pp, size_t *len, size_t block, uint32_t shift1,
+                                   uint32_t shift2) {
+    const unsigned char *p = *pp;
+    while (*len >= 3 * block) {
+        uint64_t c0 = crc, c1 = 0, c2 = 0;
+        for (size_t i = 0; i < block; i += 8) {
+            c0 = _mm_crc32_u64(c0, crc_read64(p + i));
+            c1 = _mm_crc32_u64(c1, crc_read64(p + block + i));
+            c2 = _mm_crc32_u64(c2, crc_read64(p + 2 * block + i));
+        }
+        crc = crc32c_shift((uint32_t)c0, shift2) ^ crc32c_shift((uint32_t)c1, shift1) ^ (uint32_t)c2;
+        p += 3 * block;
+        *len -= 3 * block;
+    }
+    *pp = p;
+    return crc;
+}
+
+__attribute__((target("sse4.2,pclmul")))
+static uint32_t crc32c_sse42(const void *data, size_t len, uint32_t crc) {
+    const unsigned char *p = (const unsigned char *)data;
+    uint32_t c = ~crc;
+    c = crc32c_3way(c, &p, &len, CRC32C_LONG, CRC32C_SHIFT_LONG, CRC32C_SHIFT_LONG2);
+    c = crc32c_3way(c, &p, &len, CRC32C_SHORT, CRC32C_SHIFT_SHORT, CRC32C_SHIFT_SHORT2);
+    uint64_t c64 = c;
+    for (; len >= 8; p += 8, len -= 8) {
+        c64 = _mm_crc32_u64(c64, crc_read64(p));
+    }
+    c = (uint32_t)c64;
+    while (len--) {
+        c = _mm_crc32_u8(c, *p++);
+    }
+    return ~c;
+}
+
+// 只有 SSE4.2、没有 PCLMUL 时 crc32 指令逐 8 字节串行计算，三路交错的合并需要无进位乘法
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42_serial(const void *data, size_t len, uint32_t crc) {
+    const unsigned char *p = (const unsigned char *)data;
+    uint64_t c64 = ~crc;
+    for (; len >= 8; p += 8, len -= 8) {
+        c64 = _mm_crc32_u64(c64, crc_read64(p));
+    }
+    uint32_t c = (uint32_t)c64;
+    while (len--) {
+        c = _mm_crc32_u8(c, *p++);
+    }
+    return ~c;
+}
+#endif
+
+struct crc_kernel {
+    uint32_t (*crc32)(const void *, size_t, uint32_t);
+    uint32_t (*crc32c)(const void *, size_t, uint32_t);
+    uint64_t (*crc64)(const void *, size_t, uint64_t);
+    const char *name;
+};
+
+static const crc_kernel crc_kernel_table = {crc32HashPortable, crc32cHashPortable, crc64HashPortable, "table"};
+#if defined(__SSE2__)
+static const crc_kernel crc_kernel_sse42 = {crc32HashPortable, crc32c_sse42_serial, crc64HashPortable, "sse4.2"};
+static const crc_kernel crc_kernel_pclmul = {crc32_pclmul, crc32cHashPortable, crc64_pclmul, "pclmul"};
+static const crc_kernel crc_kernel_sse42_pclmul = {crc32_pclmul, crc32c_sse42, crc64_pclmul, "sse4.2+pclmul"};
+#endif
+
+/*
+按 CPU 支持情况选择实现，结果缓存，与 xxh3_select_kernel 相同
+查表实现和 PCLMUL 的收尾都要用到查找表，表只能建一次：抢到 building 的线程建表并选择实现，
+以 release 语义发布结果，其余线程以 acquire 语义等到结果后再读表
+*/
+static const crc_kernel *crc_select_kernel(void) {
+    static const crc_kernel *selected = NULL;
+    static int building = 0;
+    const crc_kernel *k = __atomic_load_n(&selected, __ATOMIC_ACQUIRE);
+    if (k) {
+        return k;
+    }
+    if (__atomic_exchange_n(&building, 1, __ATOMIC_ACQUIRE) != 0) {
+        while (!(k = __atomic_load_n(&selected, __ATOMIC_ACQUIRE))) {
+        }
+        return k;
+    }
+    crc32_build_table(crc32_table, CRC32_POLY);
+    crc32_build_table(crc32c_table, CRC32C_POLY);
+    crc64_build_table(crc64_table, CRC64_POLY);
+    k = &crc_kernel_table;
+#if defined(__SSE2__)
+    __builtin_cpu_init();
+    bool sse42 = __builtin_cpu_supports("sse4.2");
+    bool pclmul = __builtin_cpu_supports("pclmul");
+    if (sse42 && pclmul) {
+        k = &crc_kernel_sse42_pclmul;
+    } else if (pclmul) {
+        k = &crc_kernel_pclmul;
+    } else if (sse42) {
+        k = &crc_kernel_sse42;
+    }
+#endif
+    __atomic_store_n(&selected, k, __ATOMIC_RELEASE);
+    return k;
+}
+
+/**
+* @brief             CRC32（IEEE 802.3，与 zlib 的 crc32 相同）
+* @param   data      输入
+* @param   len       字节数
+* @param   crc       前一段的结果，首段传 0
+* @return  uint32_t  到本段为止的校验值
+*
+* @note              Revision History
+*/
+uint32_t crc32Hash(const void *data, size_t len, uint32_t crc) {
+    return crc_select_kernel()->crc32(data, len, crc);
+}
+
+/**
+* @brief             CRC32C（Castagnoli）
+* @param   data      输入
+* @param   len       字节数
+* @param   crc       前一段的结果，首段传 0
+* @return  uint32_t  到本段为止的校验值
+*
+* @note              Revision History
+*/
+uint32_t crc32cHash(const void *data, size_t len, uint32_t crc) {
+    return crc_select_kernel()->crc32c(data, len, crc);
+}
+
+/**
+* @brief             CRC64（ECMA-182 反射位序，即 CRC-64/XZ）
+* @param   data      输入
+* @param   len       字节数
+* @param   crc       前一段的结果，首段传 0
+* @return  uint64_t  到本段为止的校验值
+*
+* @note              Revision History
+*/
+uint64_t crc64Hash(const void *data, size_t len, uint64_t crc) {
+    return crc_select_kernel()->crc64(data, len, crc);
+}
+
+/**
+* @brief             当前使用的 CRC 实现
+* @return  const char*  "sse4.2+pclmul"、"pclmul"、"sse4.2" 或 "table"
+*
+* @note              Revision History
+*/
+const char *crcImplName(void) {
+    return crc_select_kernel()->name;
+}
+
+/*
+（11）批量哈希
+ 问题：
+ - 哈希表查找常常一次来一批键，逐个调用 murmurHash3_32 时每个键的乘法链前后依赖，CPU 大部分时间在等乘法结果
+ - 循环次数随键长变化，分支预测失败又会清空流水线，同一批键之间本来没有依赖，却没有重叠执行
+ 做法：
+ - 定长键：8 个键放进一个 AVX2 寄存器的 8 个 32 位通道，每条指令同时推进 8 条哈希链；
+   键连续存放，8 个键各取 32 字节后做 8x8 转置，得到 8 个键的同一块；4 字节键直接整块加载
+ - 变长键：8 个（AVX2）或 4 个（标量）一组交错计算，每轮推进所有键的一个块，已结束的键用掩码丢弃结果，
+   循环次数按组内最长的键算，不再每个键预测失败一次循环出口
+ - 结果与逐个调用 murmurHash3_32 完全相同，调用方可以随意混用
+ 使用场景：
+ - 配合 hasht_find_batch：先算出一批键的哈希并预取对应的组，再逐个探测，缓存未命中也能重叠
+*/
+
+static inline uint32_t murmur3_rotl32(uint32_t x, int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+// 一个 4 字节块混入哈希值
+static inline uint32_t murmur3_mix_block(uint32_t hash, uint32_t k) {
+    k *= 0xcc9e2d51;
+    k = murmur3_rotl32(k, 15);
+    k *= 0x1b873593;
+    hash ^= k;
+    hash = murmur3_rotl32(hash, 13);
+    return hash * 5 + 0xe6546b64;
+}
+
+static inline uint32_t murmur3_read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static void murmur3_batch_scalar(const uint8_t *keys, size_t key_len, size_t n, uint32_t seed, uint32_t *out) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = murmurHash3_32(keys + i * key_len, key_len, seed);
+    }
+}
+
+#if defined(__SSE2__)
+__attribute__((target("avx2")))
+static inline __m256i murmur3_rotl_avx2(__m256i x, int r) {
+    return _mm256_or_si256(_mm256_slli_epi32(x, r), _mm256_srli_epi32(x, 32 - r));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i murmur3_mix_avx2(__m256i hash, __m256i k) {
+    k = _mm256_mullo_epi32(k, _mm256_set1_epi32((int)0xcc9e2d51));
+    k = murmur3_rotl_avx2(k, 15);
+    k = _mm256_mullo_epi32(k, _mm256_set1_epi32(0x1b873593));
+    hash = murmur3_rotl_avx2(_mm256_xor_si256(hash, k), 13);
+    // hash * 5 = (hash << 2) + hash，比 mullo 的 10 周期延迟短
+    hash = _mm256_add_epi32(_mm256_slli_epi32(hash, 2), hash);
+    return _mm256_add_epi32(hash, _mm256_set1_epi32((int)0xe6546b64));
+}
+
+// 8 个寄存器各存一个键的 8 个块，转置后第 j 个寄存器是 8 个键的第 j 个块
+__attribute__((target("avx2")))
+static inline void murmur3_transpose8(__m256i r[8]) {
+    __m256i t[8], u[8];
+    for (int i = 0; i < 8; i += 2) {
+        t[i] = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4) {
+        u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+        u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+        u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+        u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    for (int i = 0; i < 4; i++) {
+        r[i] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+        r[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+    }
+}
+
+/*
+每 8 个键一组，每个键每次取 32 字节（8 个块），转置后逐块混合；键长不足 32 字节时多读的是后面键的字节，
+只混合属于本键的块，靠近输入末尾时改用 maskload，未选中的字节不会被访问
+没有用 gather：它在许多 CPU 上（包括打了 GDS 微码补丁的 Intel）每个元素要好几个周期，比转置慢得多
+尾部不足 4 字节时所在的 4 字节会多读 1~3 字节，键长小于 4 时后面的键补不满这几个字节，
+所以只有组内最后一个键的最后一个字整体落在输入范围内时才走向量路径，其余的组交给标量，不越过输入末尾
+*/
+__attribute__((target("avx2")))
+static void murmur3_batch_avx2(const uint8_t *keys, size_t key_len, size_t n, uint32_t seed, uint32_t *out) {
+    const size_t nblocks = key_len / 4;
+    const size_t tail = key_len & 3;
+    // 含尾部在内需要读取的 4 字节字数
+    const size_t words = nblocks + (tail != 0);
+    const __m256i tail_mask = _mm256_set1_epi32((int)((1U << (8 * tail)) - 1));
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const uint8_t *end = keys + n * key_len;
+    size_t i = 0;
+    for (; i + 8 <= n && (size_t)(end - (keys + (i + 7) * key_len)) >= 4 * words; i += 8) {
+        const uint8_t *base = keys + i * key_len;
+        __m256i hash = _mm256_set1_epi32((int)seed);
+        if (key_len == 4) {
+            hash = murmur3_mix_avx2(hash, _mm256_loadu_si256((const __m256i *)base));
+        } else if (key_len == 8) {
+            // 8 个键恰好 64 字节，两次加载后分出偶数字与奇数字
+            __m256 v0 = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i *)base));
+            __m256 v1 = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i *)(base + 32)));
+            __m256i b0 = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(v0, v1, 0x88)), 0xD8);
+            __m256i b1 = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(v0, v1, 0xDD)), 0xD8);
+            hash = murmur3_mix_avx2(murmur3_mix_avx2(hash, b0), b1);
+        } else {
+            for (size_t w = 0; w < words; w += 8) {
+                size_t count = words - w < 8 ? words - w : 8;
+                const __m256i load_mask = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)count), lane);
+                __m256i r[8];
+                for (int l = 0; l < 8; l++) {
+                    const uint8_t *p = base + l * key_len + 4 * w;
+                    // 多读到后面键的字节不影响结果，只有靠近输入末尾时才需要 maskload
+                    r[l] = p + 32 <= end ? _mm256_loadu_si256((const __m256i *)p)
+                                         : _mm256_maskload_epi32((const int *)p, load_mask);
+                }
+                murmur3_transpose8(r);
+                size_t full = nblocks - w < count ? nblocks - w : count;
+                for (size_t b = 0; b < full; b++) {
+                    hash = murmur3_mix_avx2(hash, r[b]);
+                }
+                if (full < count) {
+                    __m256i k = _mm256_and_si256(r[full], tail_mask);
+                    k = _mm256_mullo_epi32(k, _mm256_set1_epi32((int)0xcc9e2d51));
+                    k = murmur3_rotl_avx2(k, 15);
+                    k = _mm256_mullo_epi32(k, _mm256_set1_epi32(0x1b873593));
+                    hash = _mm256_xor_si256(hash, k);
+                }
+            }
+        }
+        hash = _mm256_xor_si256(hash, _mm256_set1_epi32((int)key_len));
+        hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 16));
+        hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32((int)0x85ebca6b));
+        hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 13));
+        hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32((int)0xc2b2ae35));
+        hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 16));
+        _mm256_storeu_si256((__m256i *)(out + i), hash);
+    }
+    murmur3_batch_scalar(keys + i * key_len, key_len, n - i, seed, out + i);
+}
+#endif
+
+// 按 CPU 支持情况选择实现，结果缓存，与 xxh3_select_kernel 相同
+typedef void (*murmur3_batch_fn)(const uint8_t *, size_t, size_t, uint32_t, uint32_t *);
+
+static murmur3_batch_fn murmur3_select_batch(void) {
+    static murmur3_batch_fn selected = NULL;
+    murmur3_batch_fn fn = __atomic_load_n(&selected, __ATOMIC_RELAXED);
+    if (fn) {
+        return fn;
+    }
+    fn = murmur3_batch_scalar;
+#if defined(__SSE2__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        fn = murmur3_batch_avx2;
+    }
+#endif
+    __atomic_store_n(&selected, fn, __ATOMIC_RELAXED);
+    return fn;
+}
+
+/**
+* @brief             定长键的批量 MurmurHash3 32 位哈希
+* @param   keys      n 个键连续存放，每个 key_len 字节
+* @param   key_len   键长
+* @param   n         键数
+* @param   seed      种子
+* @param   out       输出 n 个哈希值，与逐个调用 murmurHash3_32 相同
+*
+* @note              Revision History
+*/
+void murmurHash3_32Batch(const void *keys, size_t key_len, size_t n, uint32_t seed, uint32_t *out) {
+    murmur3_select_batch()((const uint8_t *)keys, key_len, n, seed, out);
+}
+
+/*
+变长键：一组键按组内最长的块数循环，每一轮所有通道都取一个块，已经处理完的通道读一个全 0 的占位块，
+混合结果按"块号 < 本键块数"的掩码选择是否采用；循环次数每组只判断一次，不会每个键都预测失败一次
+尾部不足 4 字节的部分：键长不小于 4 时读最后 4 个字节再右移，不需要按剩余字节数分支
+*/
+static const uint8_t murmur3_zero_block[4];
+
+// active 时返回 block，否则返回占位块；用位运算选择，编译器不会生成每个通道一次的条件分支
+static inline const uint8_t *murmur3_select_block(bool active, const uint8_t *block) {
+    uintptr_t mask = 0 - (uintptr_t)active;
+    return (const uint8_t *)(((uintptr_t)block & mask) | ((uintptr_t)murmur3_zero_block & ~mask));
+}
+
+// 尾部 1~3 个字节按小端拼成的字，没有尾部时为 0（混合 0 不改变哈希值）
+static inline uint32_t murmur3_tail_word(const uint8_t *p, size_t len) {
+    size_t tail = len & 3;
+    if (len >= 4) {
+        return (uint32_t)((uint64_t)murmur3_read32(p + len - 4) >> (32 - 8 * tail));
+    }
+    uint32_t k = 0;
+    for (size_t i = 0; i < len; i++) {
+        k |= (uint32_t)p[i] << (8 * i);
+    }
+    return k;
+}
+
+static inline uint32_t murmur3_mix_tail(uint32_t hash, uint32_t k) {
+    k *= 0xcc9e2d51;
+    k = murmur3_rotl32(k, 15);
+    k *= 0x1b873593;
+    return hash ^ k;
+}
+
+static inline uint32_t murmur3_fmix(uint32_t hash, size_t len) {
+    hash ^= (uint32_t)len;
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+// 交错的路数：4 条链足以填满标量乘法单元，再多寄存器不够用
+#define MURMUR3_INTERLEAVE 4
+
+static void murmur3_batch_var_scalar(const void *const *keys, const size_t *lens, size_t n, uint32_t seed,
+                                     uint32_t *out) {
+    size_t i = 0;
+    // 4 条链写成 4 组独立变量，编译器才会全部放进寄存器
+    for (; i + MURMUR3_INTERLEAVE <= n; i += MURMUR3_INTERLEAVE) {
+        const uint8_t *p0 = keys[i], *p1 = keys[i + 1], *p2 = keys[i + 2], *p3 = keys[i + 3];
+        size_t n0 = lens[i] / 4, n1 = lens[i + 1] / 4, n2 = lens[i + 2] / 4, n3 = lens[i + 3] / 4;
+        size_t max_blocks = n0 > n1 ? n0 : n1;
+        max_blocks = n2 > max_blocks ? n2 : max_blocks;
+        max_blocks = n3 > max_blocks ? n3 : max_blocks;
+        uint32_t h0 = seed, h1 = seed, h2 = seed, h3 = seed;
+        for (size_t b = 0; b < max_blocks; b++) {
+            uint32_t m0 = murmur3_mix_block(h0, murmur3_read32(murmur3_select_block(b < n0, p0 + 4 * b)));
+            uint32_t m1 = murmur3_mix_block(h1, murmur3_read32(murmur3_select_block(b < n1, p1 + 4 * b)));
+            uint32_t m2 = murmur3_mix_block(h2, murmur3_read32(murmur3_select_block(b < n2, p2 + 4 * b)));
+            uint32_t m3 = murmur3_mix_block(h3, murmur3_read32(murmur3_select_block(b < n3, p3 + 4 * b)));
+            h0 = b < n0 ? m0 : h0;
+            h1 = b < n1 ? m1 : h1;
+            h2 = b < n2 ? m2 : h2;
+            h3 = b < n3 ? m3 : h3;
+        }
+        out[i] = murmur3_fmix(murmur3_mix_tail(h0, murmur3_tail_word(p0, lens[i])), lens[i]);
+        out[i + 1] = murmur3_fmix(murmur3_mix_tail(h1, murmur3_tail_word(p1, lens[i + 1])), lens[i + 1]);
+        out[i + 2] = murmur3_fmix(murmur3_mix_tail(h2, murmur3_tail_word(p2, lens[i + 2])), lens[i + 2]);
+        out[i + 3] = murmur3_fmix(murmur3_mix_tail(h3, murmur3_tail_word(p3, lens[i + 3])), lens[i + 3]);
+    }
+    for (; i < n; i++) {
+        out[i] = murmurHash3_32(keys[i], lens[i], seed);
+    }
+}
+
+#if defined(__SSE2__)
+/*
+AVX2 版本每个键每次用 maskload 取最多 8 个完整块（只取属于本键的块，不会越界），转置后逐块混合；
+8 个键的长度、尾部字直接拼成向量，不经过数组中转，避免"8 次 4 字节写、1 次 32 字节读"的存储转发失败
+*/
+__attribute__((target("avx2")))
+static void murmur3_batch_var_avx2(const void *const *keys, const size_t *lens, size_t n, uint32_t seed,
+                                   uint32_t *out) {
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const uint8_t *const *p = (const uint8_t *const *)(keys + i);
+        const size_t *len = lens + i;
+        // 8 个 64 位长度取低 32 位
+        __m256 l0 = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i *)len));
+        __m256 l1 = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i *)(len + 4)));
+        const __m256i len32 = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(l0, l1, 0x88)), 0xD8);
+        const __m256i nblocks = _mm256_srli_epi32(len32, 2);
+        size_t max_len = 0;
+        for (int l = 0; l < 8; l++) {
+            max_len = len[l] > max_len ? len[l] : max_len;
+        }
+        const size_t max_blocks = max_len / 4;
+
+        __m256i hash = _mm256_set1_epi32((int)seed);
+        for (size_t w = 0; w < max_blocks; w += 8) {
+            __m256i r[8];
+            for (int l = 0; l < 8; l++) {
+                // 本键在 [w, w + 8) 中的完整块数，小于等于 0 时 maskload 什么也不读
+                __m256i remain = _mm256_set1_epi32((int)(len[l] / 4) - (int)w);
+                r[l] = _mm256_maskload_epi32((const int *)(p[l] + 4 * w), _mm256_cmpgt_epi32(remain, lane));
+            }
+            murmur3_transpose8(r);
+            size_t rounds = max_blocks - w < 8 ? max_blocks - w : 8;
+            for (size_t b = 0; b < rounds; b++) {
+                __m256i active = _mm256_cmpgt_epi32(nblocks, _mm256_set1_epi32((int)(w + b)));
+                hash = _mm256_blendv_epi8(hash, murmur3_mix_avx2(hash, r[b]), active);
+            }
+        }
+
+        __m256i k = _mm256_setr_epi32((int)murmur3_tail_word(p[0], len[0]), (int)murmur3_tail_word(p[1], len[1]),
+                                      (int)murmur3_tail_word(p[2], len[2]), (int)murmur3_tail_word(p[3], len[3]),
+                                      (int)murmur3_tail_word(p[4], len[4]), (int)murmur3_tail_word(p[5], len[5]),
+                                      (int)murmur3_tail_word(p[6], len[6]), (int)murmur3_tail_word(p[7], len[7]));
+        k = _mm256_mullo_epi32(k, _mm256_set1_epi32((int)0xcc9e2d51));
+        k = murmur3_rotl_avx2(k, 15);
+        k = _mm256_mullo_epi32(k, _mm256_set1_epi32(0x1b873593));
+        hash = _mm256_xor_si256(hash, k);
+        hash = _mm256_xor_si256(hash, len32);
+        hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 16));
+        hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32((int)0x85ebca6b));
+        hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 13));
+        hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32((int)0xc2b2ae35));
+        hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 16));
+        _mm256_storeu_si256((__m256i *)(out + i), hash);
+    }
+    murmur3_batch_var_scalar(keys + i, lens + i, n - i, seed, out + i);
+}
+#endif
+
+typedef void (*murmur3_batch_var_fn)(const void *const *, const size_t *, size_t, uint32_t, uint32_t *);
+
+static murmur3_batch_var_fn murmur3_select_batch_var(void) {
+    static murmur3_batch_var_fn selected = NULL;
+    murmur3_batch_var_fn fn = __atomic_load_n(&selected, __ATOMIC_RELAXED);
+    if (fn) {
+        return fn;
+    }
+    fn = murmur3_batch_var_scalar;
+#if defined(__SSE2__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        fn = murmur3_batch_var_avx2;
+    }
+#endif
+    __atomic_store_n(&selected, fn, __ATOMIC_RELAXED);
+    return fn;
+}
+
+/**
+* @brief             变长键的批量 MurmurHash3 32 位哈希
+* @param   keys      n 个键的地址
+* @param   lens      n 个键的长度
+* @param   n         键数
+* @param   seed      种子
+* @param   out       输出 n 个哈希值，与逐个调用 murmurHash3_32 相同
+*
+* @note              Revision History
+*/
+void murmurHash3_32BatchVar(const void *const *keys, const size_t *lens, size_t n, uint32_t seed, uint32_t *out) {
+    murmur3_select_batch_var()(keys, lens, n, seed, out);
+}
+
+/*
+（12）SHA-256 实现
+ 算法说明见（3），这里是三种压缩函数与填充、流式、批量接口
+ - 便携实现：按 FIPS 180-4 逐轮计算，消息扩展用 16 个字的环形缓冲，不依赖任何指令集
+ - SHA-NI：sha256rnds2 一条指令做 2 轮，sha256msg1/msg2 完成消息扩展，状态按 ABEF/CDGH 两个 128 位寄存器排列；
+   单个消息的 64 轮前后相依，无法并行，约 2 周期/字节，比便携实现快 5~8 倍
+ - AVX2 多缓冲：8 个互不相关的消息各占一个 32 位通道，一组指令同时做 8 条消息的同一轮；
+   每条消息仍是串行的，但 8 条一起算，适合大量小对象（键、块、交易）各自求摘要的场景；
+   某条消息结束时取出它的摘要，通道立即换上下一条消息，长短不一的消息也不会让通道空等
+ - 第一次调用时检测 CPU 选择实现，单条消息优先 SHA-NI，都不支持时使用便携实现；
+   批量接口有 AVX2 时使用多缓冲，但 CPU 同时支持 SHA-NI 时只把短消息交给多缓冲：
+   SHA-NI 单条消息的填充、字节序转换等固定开销相对短消息较大，8 通道在 256 字节以下更快，更长的消息逐条 SHA-NI 更快
+ 注意事项：
+ - 结果与 OpenSSL SHA256() / sha256sum 相同，"abc" 的摘要为 ba7816bf...f20015ad
+ - 流式接口 sha256Final 不改变状态，可以继续追加输入
+*/
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+// 初始哈希值：前 8 个素数平方根小数部分的前 32 位
+static const uint32_t sha256_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static inline uint32_t sha256_rotr(uint32_t x, int r) {
+    return (x >> r) | (x << (32 - r));
+}
+
+static inline uint32_t sha256_load_be32(const unsigned char *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void sha256_store_be32(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)v;
+}
+
+typedef void (*sha256_compress_fn)(uint32_t state[8], const unsigned char *blocks, size_t nblocks);
+
+static void sha256_compress_portable(uint32_t state[8], const unsigned char *blocks, size_t nblocks) {
+    for (; nblocks > 0; nblocks--, blocks += 64) {
+        uint32_t w[16];
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int t = 0; t < 64; t++) {
+            uint32_t wt;
+            if (t < 16) {
+                wt = sha256_load_be32(blocks + 4 * t);
+            } else {
+                uint32_t w15 = w[(t - 15) & 15], w2 = w[(t - 2) & 15];
+                uint32_t s0 = sha256_rotr(w15, 7) ^ sha256_rotr(w15, 18) ^ (w15 >> 3);
+                uint32_t s1 = sha256_rotr(w2, 17) ^ sha256_rotr(w2, 19) ^ (w2 >> 10);
+                wt = w[t & 15] + s0 + w[(t - 7) & 15] + s1;
+            }
+            w[t & 15] = wt;
+            uint32_t t1 = h + (sha256_rotr(e, 6) ^ sha256_rotr(e, 11) ^ sha256_rotr(e, 25)) + (g ^ (e & (f ^ g))) +
+                          sha256_k[t] + wt;
+            uint32_t t2 = (sha256_rotr(a, 2) ^ sha256_rotr(a, 13) ^ sha256_rotr(a, 22)) + ((a & b) | (c & (a | b)));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if defined(__SSE2__)
+/*
+SHA-NI 每 4 轮一组：msg 为这 4 轮的 W+K，rnds2 用低 64 位做 2 轮，移高 64 位下来再做 2 轮；
+同时为 4 组之后的消息字做扩展：msg1 算 σ0 部分，alignr 取出 W[t-7]，msg2 算 σ1 部分
+*/
+#define SHA256_NI_ROUNDS(i, cur)                                                         \
+    do {                                                                                 \
+        msg = _mm_add_epi32(cur, _mm_loadu_si128((const __m128i *)&sha256_k[4 * (i)])); \
+        s1 = _mm_sha256rnds2_epu32(s1, s0, msg);                                         \
+        msg = _mm_shuffle_epi32(msg, 0x0e);                                              \
+        s0 = _mm_sha256rnds2_epu32(s0, s1, msg);                                         \
+    } while (0)
+
+#define SHA256_NI_SCHEDULE(cur, next, prev)                              \
+    do {                                                                 \
+        next = _mm_add_epi32(next, _mm_alignr_epi8(cur, prev, 4));       \
+        next = _mm_sha256msg2_epu32(next, cur);                          \
+    } while (0)
+
+__attribute__((target("sha,sse4.1")))
+static void sha256_compress_shani(uint32_t state[8], const unsigned char *blocks, size_t nblocks) {
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+    // state 的 ABCD / EFGH 重排为 rnds2 要求的 ABEF / CDGH
+    __m128i t = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xb1);
+    __m128i s1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1b);
+    __m128i s0 = _mm_alignr_epi8(t, s1, 8);
+    s1 = _mm_blend_epi16(s1, t, 0xf0);
+
+    for (; nblocks > 0; nblocks--, blocks += 64) {
+        const __m128i abef = s0, cdgh = s1;
+        __m128i msg;
+        __m128i m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(blocks + 0)), bswap);
+        __m128i m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(blocks + 16)), bswap);
+        __m128i m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(blocks + 32)), bswap);
+        __m128i m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(blocks + 48)), bswap);
+
+        SHA256_NI_ROUNDS(0, m0);
+        SHA256_NI_ROUNDS(1, m1);
+        m0 = _mm_sha256msg1_epu32(m0, m1);
+        SHA256_NI_ROUNDS(2, m2);
+        m1 = _mm_sha256msg1_epu32(m1, m2);
+        SHA256_NI_ROUNDS(3, m3);
+        SHA256_NI_SCHEDULE(m3, m0, m2);
+        m2 = _mm_sha256msg1_epu32(m2, m3);
+        for (int i = 4; i < 12; i += 4) {
+            SHA256_NI_ROUNDS(i, m0);
+            SHA256_NI_SCHEDULE(m0, m1, m3);
+            m3 = _mm_sha256msg1_epu32(m3, m0);
+            SHA256_NI_ROUNDS(i + 1, m1);
+            SHA256_NI_SCHEDULE(m1, m2, m0);
+            m0 = _mm_sha256msg1_epu32(m0, m1);
+            SHA256_NI_ROUNDS(i + 2, m2);
+            SHA256_NI_SCHEDULE(m2, m3, m1);
+            m1 = _mm_sha256msg1_epu32(m1, m2);
+            SHA256_NI_ROUNDS(i + 3, m3);
+            SHA256_NI_SCHEDULE(m3, m0, m2);
+            m2 = _mm_sha256msg1_epu32(m2, m3);
+        }
+        SHA256_NI_ROUNDS(12, m0);
+        SHA256_NI_SCHEDULE(m0, m1, m3);
+        m3 = _mm_sha256msg1_epu32(m3, m0);
+        SHA256_NI_ROUNDS(13, m1);
+        SHA256_NI_SCHEDULE(m1, m2, m0);
+        SHA256_NI_ROUNDS(14, m2);
+        SHA256_NI_SCHEDULE(m2, m3, m1);
+        SHA256_NI_ROUNDS(15, m3);
+
+        s0 = _mm_add_epi32(s0, abef);
+        s1 = _mm_add_epi32(s1, cdgh);
+    }
+
+    // 还原为 ABCD / EFGH
+    t = _mm_shuffle_epi32(s0, 0x1b);
+    s1 = _mm_shuffle_epi32(s1, 0xb1);
+    s0 = _mm_blend_epi16(t, s1, 0xf0);
+    s1 = _mm_alignr_epi8(s1, t, 8);
+    _mm_storeu_si128((__m128i *)&state[0], s0);
+    _mm_storeu_si128((__m128i *)&state[4], s1);
+}
+#undef SHA256_NI_ROUNDS
+#undef SHA256_NI_SCHEDULE
+#endif
+
+// 同时支持 SHA-NI 时，不短于这个字节数的消息不进多缓冲，逐条用 SHA-NI
+#define SHA256_BATCH_SHANI_MIN 256
+
+typedef struct {
+    sha256_compress_fn compress;
+    bool batch_avx2;          // 批量接口是否使用 AVX2 多缓冲
+    size_t batch_max_len;     // 交给多缓冲的最长消息，更长的逐条计算
+    const char *name;
+} sha256_kernel;
+
+static const sha256_kernel sha256_kernel_portable = {sha256_compress_portable, false, 0, "portable"};
+#if defined(__SSE2__)
+static const sha256_kernel sha256_kernel_portable_avx2 = {sha256_compress_portable, true, SIZE_MAX, "portable+avx2"};
+static const sha256_kernel sha256_kernel_shani = {sha256_compress_shani, false, 0, "sha-ni"};
+static const sha256_kernel sha256_kernel_shani_avx2 = {sha256_compress_shani, true, SHA256_BATCH_SHANI_MIN - 1,
+                                                       "sha-ni+avx2"};
+#endif
+
+// 按 CPU 支持情况选择实现，结果缓存，与 xxh3_select_kernel 相同
+static const sha256_kernel *sha256_select_kernel(void) {
+    static const sha256_kernel *selected = NULL;
+    const sha256_kernel *k = __atomic_load_n(&selected, __ATOMIC_RELAXED);
+    if (k) {
+        return k;
+    }
+    k = &sha256_kernel_portable;
+#if defined(__SSE2__)
+    __builtin_cpu_init();
+    bool shani = __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+    if (__builtin_cpu_supports("avx2")) {
+        k = shani ? &sha256_kernel_shani_avx2 : &sha256_kernel_portable_avx2;
+    } else if (shani) {
+        k = &sha256_kernel_shani;
+    }
+#endif
+    __atomic_store_n(&selected, k, __ATOMIC_RELAXED);
+    return k;
+}
+
+/*
+填充后的末尾：剩余 rem（< 64）字节，加 0x80、补 0 到模 64 余 56，再加 64 位大端位长，共 1 或 2 块
+返回块数，tail 至少 128 字节
+*/
+static size_t sha256_pad(unsigned char tail[128], const unsigned char *rem, size_t rem_len, uint64_t total_len) {
+    size_t nblocks = rem_len < 56 ? 1 : 2;
+    memcpy(tail, rem, rem_len);
+    tail[rem_len] = 0x80;
+    memset(tail + rem_len + 1, 0, nblocks * 64 - 8 - rem_len - 1);
+    uint64_t bits = total_len * 8;
+    for (int i = 0; i < 8; i++) {
+        tail[nblocks * 64 - 1 - i] = (unsigned char)(bits >> (8 * i));
+    }
+    return nblocks;
+}
+
+static void sha256_digest(const uint32_t state[8], unsigned char hash[SHA256_DIGEST_SIZE]) {
+    for (int i = 0; i < 8; i++) {
+        sha256_store_be32(hash + 4 * i, state[i]);
+    }
+}
+
+static void sha256_oneshot(sha256_compress_fn compress, const void *data, size_t len,
+                           unsigned char hash[SHA256_DIGEST_SIZE]) {
+    const unsigned char *p = (const unsigned char *)data;
+    uint32_t state[8];
+    memcpy(state, sha256_iv, sizeof(state));
+    size_t full = len / 64;
+    compress(state, p, full);
+    unsigned char tail[128];
+    compress(state, tail, sha256_pad(tail, p + full * 64, len - full * 64, len));
+    sha256_digest(state, hash);
+}
+
+/**
+* @brief             计算输入数据的 SHA-256 哈希值
+* @param   data      输入数据，任意二进制
+* @param   len       字节数
+* @param   hash      输出 32 字节摘要
+*
+* @note              CPU 支持时使用 SHA-NI，否则使用便携实现
+*/
+void sha256Hash(const void *data, size_t len, unsigned char hash[SHA256_DIGEST_SIZE]) {
+    sha256_oneshot(sha256_select_kernel()->compress, data, len, hash);
+}
+
+/**
+* @brief             便携实现的 SHA-256，结果与 sha256Hash 相同，用于对照测试
+*
+* @note              Revision History
+*/
+void sha256HashPortable(const void *data, size_t len, unsigned char hash[SHA256_DIGEST_SIZE]) {
+    sha256_oneshot(sha256_compress_portable, data, len, hash);
+}
+
+/**
+* @brief             初始化流式计算状态
+*
+* @note              Revision History
+*/
+void sha256Init(sha256_state *state) {
+    memcpy(state->h, sha256_iv, sizeof(state->h));
+    state->buffered = 0;
+    state->total_len = 0;
+}
+
+/**
+* @brief             追加输入
+* @param   data      输入数据
+* @param   len       字节数
+*
+* @note              先补满内部缓冲区，其余整块直接压缩，不足一块的部分留在缓冲区
+*/
+void sha256Update(sha256_state *state, const void *data, size_t len) {
+    sha256_compress_fn compress = sha256_select_kernel()->compress;
+    const unsigned char *p = (const unsigned char *)data;
+    state->total_len += len;
+    if (state->buffered > 0) {
+        size_t take = SHA256_BLOCK_SIZE - state->buffered < len ? SHA256_BLOCK_SIZE - state->buffered : len;
+        memcpy(state->buffer + state->buffered, p, take);
+        state->buffered += take;
+        p += take;
+        len -= take;
+        if (state->buffered < SHA256_BLOCK_SIZE) {
+            return;
+        }
+        compress(state->h, state->buffer, 1);
+        state->buffered = 0;
+    }
+    size_t full = len / SHA256_BLOCK_SIZE;
+    compress(state->h, p, full);
+    p += full * SHA256_BLOCK_SIZE;
+    len -= full * SHA256_BLOCK_SIZE;
+    memcpy(state->buffer, p, len);
+    state->buffered = len;
+}
+
+/**
+* @brief             输出目前全部输入的摘要
+* @param   hash      输出 32 字节摘要
+*
+* @note              在状态的副本上填充，不改变 state
+*/
+void sha256Final(const sha256_state *state, unsigned char hash[SHA256_DIGEST_SIZE]) {
+    uint32_t h[8];
+    memcpy(h, state->h, sizeof(h));
+    unsigned char tail[128];
+    sha256_select_kernel()->compress(h, tail, sha256_pad(tail, state->buffer, state->buffered, state->total_len));
+    sha256_digest(h, hash);
+}
+
+#if defined(__SSE2__)
+__attribute__((target("avx2")))
+static inline __m256i sha256_rotr_avx2(__m256i x, int r) {
+    return _mm256_or_si256(_mm256_srli_epi32(x, r), _mm256_slli_epi32(x, 32 - r));
+}
+
+/*
+8 通道一轮：w 为 8 条消息各自的 W[t]，与便携实现逐行对应
+变量不轮换，而是每轮把 8 个状态字的角色循环移一位（宏参数的顺序轮换），省掉 8 次寄存器复制
+*/
+#define SHA256_AVX2_ROUND(a, b, c, d, e, f, g, h, t, w)                                                          \
+    do {                                                                                                     \
+        __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(sha256_rotr_avx2(e, 6), sha256_rotr_avx2(e, 11)),     \
+                                      sha256_rotr_avx2(e, 25));                                              \
+        __m256i ch = _mm256_xor_si256(g, _mm256_and_si256(e, _mm256_xor_si256(f, g)));                       \
+        __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, s1),                                               \
+                                      _mm256_add_epi32(ch, _mm256_add_epi32(w, _mm256_set1_epi32((int)sha256_k[t])))); \
+        __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(sha256_rotr_avx2(a, 2), sha256_rotr_avx2(a, 13)),     \
+                                      sha256_rotr_avx2(a, 22));                                              \
+        __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));   \
+        d = _mm256_add_epi32(d, t1);                                                                         \
+        h = _mm256_add_epi32(t1, _mm256_add_epi32(s0, maj));                                                 \
+    } while (0)
+
+// W[t] = σ1(W[t-2]) + W[t-7] + σ0(W[t-15]) + W[t-16]，w 为 16 个字的环形缓冲
+__attribute__((target("avx2")))
+static inline __m256i sha256_schedule_avx2(__m256i w[16], int t) {
+    __m256i w15 = w[(t - 15) & 15], w2 = w[(t - 2) & 15];
+    __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(sha256_rotr_avx2(w15, 7), sha256_rotr_avx2(w15, 18)),
+                                  _mm256_srli_epi32(w15, 3));
+    __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(sha256_rotr_avx2(w2, 17), sha256_rotr_avx2(w2, 19)),
+                                  _mm256_srli_epi32(w2, 10));
+    w[t & 15] = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0), _mm256_add_epi32(w[(t - 7) & 15], s1));
+    return w[t & 15];
+}
+
+// 8 条消息各压缩一块，blocks[l] 为通道 l 的 64 字节块；转置后第 i 个向量为 8 条消息的第 i 个字
+__attribute__((target("avx2")))
+static void sha256_compress_avx2x8(__m256i s[8], const unsigned char *const blocks[8]) {
+    const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                           3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    __m256i w[16];
+    for (int half = 0; half < 2; half++) {
+        for (int l = 0; l < 8; l++) {
+            w[8 * half + l] = _mm256_loadu_si256((const __m256i *)(blocks[l] + 32 * half));
+        }
+        murmur3_transpose8(w + 8 * half);
+    }
+    for (int i = 0; i < 16; i++) {
+        w[i] = _mm256_shuffle_epi8(w[i], bswap);
+    }
+
+    __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+    for (int t = 0; t < 16; t += 8) {
+        SHA256_AVX2_ROUND(a, b, c, d, e, f, g, h, t, w[t]);
+        SHA256_AVX2_ROUND(h, a, b, c, d, e, f, g, t + 1, w[t + 1]);
+        SHA256_AVX2_ROUND(g, h, a, b, c, d, e, f, t + 2, w[t + 2]);
+        SHA256_AVX2_ROUND(f, g, h, a, b, c, d, e, t + 3, w[t + 3]);
+        SHA256_AVX2_ROUND(e, f, g, h, a, b, c, d, t + 4, w[t + 4]);
+        SHA256_AVX2_ROUND(d, e, f, g, h, a, b, c, t + 5, w[t + 5]);
+        SHA256_AVX2_ROUND(c, d, e, f, g, h, a, b, t + 6, w[t + 6]);
+        SHA256_AVX2_ROUND(b, c, d, e, f, g, h, a, t + 7, w[t + 7]);
+    }
+    for (int t = 16; t < 64; t += 8) {
+        SHA256_AVX2_ROUND(a, b, c, d, e, f, g, h, t, sha256_schedule_avx2(w, t));
+        SHA256_AVX2_ROUND(h, a, b, c, d, e, f, g, t + 1, sha256_schedule_avx2(w, t + 1));
+        SHA256_AVX2_ROUND(g, h, a, b, c, d, e, f, t + 2, sha256_schedule_avx2(w, t + 2));
+        SHA256_AVX2_ROUND(f, g, h, a, b, c, d, e, t + 3, sha256_schedule_avx2(w, t + 3));
+        SHA256_AVX2_ROUND(e, f, g, h, a, b, c, d, t + 4, sha256_schedule_avx2(w, t + 4));
+        SHA256_AVX2_ROUND(d, e, f, g, h, a, b, c, t + 5, sha256_schedule_avx2(w, t + 5));
+        SHA256_AVX2_ROUND(c, d, e, f, g, h, a, b, t + 6, sha256_schedule_avx2(w, t + 6));
+        SHA256_AVX2_ROUND(b, c, d, e, f, g, h, a, t + 7, sha256_schedule_avx2(w, t + 7));
+    }
+    s[0] = _mm256_add_epi32(s[0], a);
+    s[1] = _mm256_add_epi32(s[1], b);
+    s[2] = _mm256_add_epi32(s[2], c);
+    s[3] = _mm256_add_epi32(s[3], d);
+    s[4] = _mm256_add_epi32(s[4], e);
+    s[5] = _mm256_add_epi32(s[5], f);
+    s[6] = _mm256_add_epi32(s[6], g);
+    s[7] = _mm256_add_epi32(s[7], h);
+}
+#undef SHA256_AVX2_ROUND
+
+// 一个通道上正在计算的消息：先走原数据的整块，再走 tail 中填充后的 1~2 块
+typedef struct {
+    const unsigned char *next;  // 下一块的地址
+    size_t data_blocks;         // 剩余的原数据整块数
+    size_t tail_blocks;         // 剩余的填充块数
+    size_t index;               // 消息序号，SIZE_MAX 表示空闲
+    unsigned char tail[128];
+} sha256_lane;
+
+static const unsigned char sha256_zero_block[64];
+
+static void sha256_lane_load(sha256_lane *lane, const void *data, size_t len, size_t index) {
+    const unsigned char *p = (const unsigned char *)data;
+    size_t full = len / 64;
+    lane->index = index;
+    lane->data_blocks = full;
+    lane->tail_blocks = sha256_pad(lane->tail, p + full * 64, len - full * 64, len);
+    lane->next = full ? p : lane->tail;
+}
+
+/*
+调度：长于 max_len 的消息跳过，由调用者另行计算；每轮 8 个通道各取一块压缩；哪个通道的消息算完了，就把状态写回内存取出摘要、重置为初始值并装入下一条消息，
+状态只在有消息结束的那一轮才写回，其余轮次一直留在寄存器里；消息取完后通道空闲，压缩全 0 块，结果丢弃
+*/
+__attribute__((target("avx2")))
+static void sha256_batch_avx2x8(const void *const *data, const size_t *lens, size_t n, size_t max_len,
+                                unsigned char *hashes) {
+    sha256_lane lanes[8];
+    size_t taken = 0;
+    int busy = 0;
+    for (int l = 0; l < 8; l++) {
+        while (taken < n && lens[taken] > max_len) {
+            taken++;
+        }
+        if (taken < n) {
+            sha256_lane_load(&lanes[l], data[taken], lens[taken], taken);
+            taken++;
+            busy++;
+        } else {
+            lanes[l].index = SIZE_MAX;
+        }
+    }
+    __m256i s[8];
+    for (int i = 0; i < 8; i++) {
+        s[i] = _mm256_set1_epi32((int)sha256_iv[i]);
+    }
+
+    while (busy > 0) {
+        const unsigned char *blocks[8];
+        bool finished = false;
+        for (int l = 0; l < 8; l++) {
+            sha256_lane *lane = &lanes[l];
+            if (lane->index == SIZE_MAX) {
+                blocks[l] = sha256_zero_block;
+                continue;
+            }
+            blocks[l] = lane->next;
+            if (lane->data_blocks > 0) {
+                lane->data_blocks--;
+                lane->next = lane->data_blocks > 0 ? lane->next + 64 : lane->tail;
+            } else {
+                lane->tail_blocks--;
+                lane->next += 64;
+            }
+            finished |= lane->data_blocks == 0 && lane->tail_blocks == 0;
+        }
+        sha256_compress_avx2x8(s, blocks);
+        if (!finished) {
+            continue;
+        }
+
+        uint32_t st[8][8];
+        for (int i = 0; i < 8; i++) {
+            _mm256_storeu_si256((__m256i *)st[i], s[i]);
+        }
+        for (int l = 0; l < 8; l++) {
+            sha256_lane *lane = &lanes[l];
+            if (lane->index == SIZE_MAX || lane->data_blocks > 0 || lane->tail_blocks > 0) {
+                continue;
+            }
+            for (int i = 0; i < 8; i++) {
+                sha256_store_be32(hashes + lane->index * SHA256_DIGEST_SIZE + 4 * i, st[i][l]);
+                st[i][l] = sha256_iv[i];
+            }
+            while (taken < n && lens[taken] > max_len) {
+                taken++;
+            }
+            if (taken < n) {
+                sha256_lane_load(lane, data[taken], lens[taken], taken);
+                taken++;
+            } else {
+                lane->index = SIZE_MAX;
+                busy--;
+            }
+        }
+        for (int i = 0; i < 8; i++) {
+            s[i] = _mm256_loadu_si256((const __m256i *)st[i]);
+        }
+    }
+}
+#endif
+
+/**
+* @brief             批量计算多条独立消息的 SHA-256
+* @param   data      n 条消息的地址
+* @param   lens      n 条消息的字节数
+* @param   n         消息数
+* @param   hashes    输出 n * 32 字节，第 i 条消息的摘要在 hashes + 32 * i
+*
+* @note              支持 AVX2 时 8 条消息同时计算，同时支持 SHA-NI 时长消息逐条计算，结果与逐条调用 sha256Hash 相同
+*/
+void sha256HashBatch(const void *const *data, const size_t *lens, size_t n, unsigned char *hashes) {
+    const sha256_kernel *k = sha256_select_kernel();
+#if defined(__SSE2__)
+    if (k->batch_avx2) {
+        sha256_batch_avx2x8(data, lens, n, k->batch_max_len, hashes);
+    }
+#endif
+    for (size_t i = 0; i < n; i++) {
+        if (!k->batch_avx2 || lens[i] > k->batch_max_len) {
+            sha256Hash(data[i], lens[i], hashes + i * SHA256_DIGEST_SIZE);
+        }
+    }
+}
+
+// 当前使用的实现
+const char *sha256ImplName(void) {
+    return sha256_select_kernel()->name;
+}
+
+#ifdef HASHALG_MAIN
+#include <sys/mman.h>
+#include <unistd.h>
+
 int main(void) {
+    int failed = 0;
 
     // 示例1：计算字符串 "abcd" 的哈希值
     const char* str = "abcd";
@@ -516,11 +2451,11 @@ int main(void) {
     printf("murmur Hash of \"%s\": 0x%08x\n", murstr1, murhash1); // 输出 0x248bfa47
     // 示例2：验证相同输入不同种子结果不同
     uint32_t murhash2 = murmurHash3_32((const void*)murstr1, strlen(murstr1), 42);
-    printf("murmur Hash of \"%s\" (seed=42): 0x%08x\n", murstr1, murhash2); // 输出 0x5e928f0f
+    printf("murmur Hash of \"%s\" (seed=42): 0x%08x\n", murstr1, murhash2); // 输出 0xe2dbd2e1
     // 示例3：验证不同输入结果不同
     const char* murstr2 = "world";
     uint32_t murhash3 = murmurHash3_32((const void*)murstr2, strlen(murstr2), 0);
-    printf("murmur Hash of \"%s\": 0x%08x\n", murstr2, murhash3); // 输出 0x5ba3c492
+    printf("murmur Hash of \"%s\": 0x%08x\n", murstr2, murhash3); // 输出 0xfb963cfb
 
     // 示例1：计算字符串 "hello" 的哈希值
     const char* saxstr = "hello";
@@ -542,5 +2477,99 @@ int main(void) {
     uint32_t jenhash = jenHash(jenstr, strlen(jenstr), 0);
     printf("jenkins hash of \"%s\": 0x%08x\n", jenstr, jenhash);
 
-    return 0;
-}
\ No newline at end of file
+    // 示例1：计算字符串 "hello" 的 64/128 位 XXH3
+    const char* xxhstr = "hello";
+    uint64_t xxh64 = xxh3Hash64(xxhstr, strlen(xxhstr), 0);
+    printf("xxh3 64 hash of \"%s\": 0x%016llx\n", xxhstr, (unsigned long long)xxh64); // 输出 0x9555e8555c62dcfd
+    xxh3_128 xxh128 = xxh3Hash128(xxhstr, strlen(xxhstr), 0);
+    printf("xxh3 128 hash of \"%s\": 0x%016llx%016llx\n", xxhstr, (unsigned long long)xxh128.high,
+           (unsigned long long)xxh128.low); // 输出 0xb5e9c1ad071b3e7fc779cfaa5e523818
+    // 示例2：流式接口分段输入，结果与一次性计算相同
+    unsigned char block[1000];
+    for (int i = 0; i < 1000; i++) {
+        block[i] = (unsigned char)i;
+    }
+    xxh3_state state;
+    xxh3Init(&state, 0);
+    for (int i = 0; i < 1000; i += 300) {
+        xxh3Update(&state, block + i, i + 300 <= 1000 ? 300 : 1000 - i);
+    }
+    printf("xxh3 64 hash of 1000 bytes: one-shot 0x%016llx, streaming 0x%016llx\n",
+           (unsigned long long)xxh3Hash64(block, sizeof(block), 0),
+           (unsigned long long)xxh3Final64(&state)); // 输出 0xd33dd80b46f60e50
+
+    // 示例1：标准校验串 "123456789" 的 CRC32 / CRC32C / CRC64
+    const char* crcstr = "123456789";
+    printf("crc32 of \"%s\": 0x%08x\n", crcstr, crc32Hash(crcstr, strlen(crcstr), 0));   // 输出 0xcbf43926
+    printf("crc32c of \"%s\": 0x%08x\n", crcstr, crc32cHash(crcstr, strlen(crcstr), 0)); // 输出 0xe3069283
+    printf("crc64 of \"%s\": 0x%016llx\n", crcstr,
+           (unsigned long long)crc64Hash(crcstr, strlen(crcstr), 0)); // 输出 0x995dc9bbdf1939fa
+    // 示例2：长输入分两段计算，结果与查表实现一次性计算相同
+    static unsigned char crcbuf[100000];
+    for (size_t i = 0; i < sizeof(crcbuf); i++) {
+        crcbuf[i] = (unsigned char)(i * 131 + (i >> 8));
+    }
+    uint32_t crcpart = crc32cHash(crcbuf + 33333, sizeof(crcbuf) - 33333, crc32cHash(crcbuf, 33333, 0));
+    printf("crc32c of 100000 bytes (%s): split 0x%08x, table 0x%08x\n", crcImplName(), crcpart,
+           crc32cHashPortable(crcbuf, sizeof(crcbuf), 0));
+
+    // 示例1：批量哈希与逐个计算的结果相同
+    const char *batchkeys = "key0key1key2key3key4key5key6key7key8";
+    uint32_t batchout[9];
+    murmurHash3_32Batch(batchkeys, 4, 9, 0, batchout);
+    const void *varkeys[5] = {"a", "hello", "hash table", "batch", "interleaved keys"};
+    size_t varlens[5];
+    uint32_t varout[5];
+    for (int i = 0; i < 5; i++) {
+        varlens[i] = strlen((const char *)varkeys[i]);
+    }
+    murmurHash3_32BatchVar(varkeys, varlens, 5, 0, varout);
+    int batchok = batchout[8] == murmurHash3_32(batchkeys + 32, 4, 0) && varout[1] == murhash1;
+    printf("murmur batch: key8 0x%08x, \"hello\" 0x%08x, check %s\n", batchout[8], varout[1], batchok ? "ok" : "FAILED");
+    failed |= !batchok;
+    // 示例2：键紧贴不可访问的页，批量哈希不能读过输入末尾，结果与逐个计算相同
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    uint8_t *guard = mmap(NULL, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (guard != MAP_FAILED && mprotect(guard + page, page, PROT_NONE) == 0) {
+        uint32_t edgeout[40];
+        int edgeok = 1;
+        for (size_t key_len = 1; key_len <= 13; key_len++) {
+            for (size_t n = 1; n <= 40; n++) {
+                uint8_t *edgekeys = guard + page - key_len * n;
+                for (size_t b = 0; b < key_len * n; b++) {
+                    edgekeys[b] = (uint8_t)(b * 37 + key_len);
+                }
+                murmurHash3_32Batch(edgekeys, key_len, n, 7, edgeout);
+                for (size_t k = 0; k < n; k++) {
+                    edgeok &= edgeout[k] == murmurHash3_32(edgekeys + k * key_len, key_len, 7);
+                }
+            }
+        }
+        printf("murmur batch at page end: check %s\n", edgeok ? "ok" : "FAILED");
+        failed |= !edgeok;
+    }
+    if (guard != MAP_FAILED) {
+        munmap(guard, 2 * page);
+    }
+
+    // 示例1：SHA-256 标准测试向量 "abc"
+    unsigned char shaout[SHA256_DIGEST_SIZE];
+    sha256Hash("abc", 3, shaout);
+    printf("sha256 of \"abc\" (%s): ", sha256ImplName());
+    for (int i = 0; i < SHA256_DIGEST_SIZE; i++) {
+        printf("%02x", shaout[i]);
+    }
+    printf("\n"); // 输出 ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad
+    // 示例2：流式分段输入与一次性计算的结果相同
+    sha256_state shastate;
+    sha256Init(&shastate);
+    sha256Update(&shastate, "a", 1);
+    sha256Update(&shastate, "bc", 2);
+    unsigned char shastream[SHA256_DIGEST_SIZE];
+    sha256Final(&shastate, shastream);
+    printf("sha256 streaming: check %s\n", memcmp(shaout, shastream, SHA256_DIGEST_SIZE) == 0 ? "ok" : "FAILED");
+    failed |= memcmp(shaout, shastream, SHA256_DIGEST_SIZE) != 0;
+
+    return failed;
+}
+#endif
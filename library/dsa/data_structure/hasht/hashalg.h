@@ -0,0 +1,171 @@
+#ifndef DSA_HASHT_HASHALG_H
+#define DSA_HASHT_HASHALG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+哈希算法声明，算法说明与实现见 hashalg.c
+hashalg.c 中的示例 main 仅在定义 HASHALG_MAIN 时编译，其余模块可以直接链接 hashalg.o
+*/
+
+// times33 哈希，输入以 '\0' 结尾
+unsigned int times33Hash(const char* key);
+
+// MurmurHash3 32 位哈希
+uint32_t murmurHash3_32(const void *key, size_t len, uint32_t seed);
+
+// SAX 哈希，输入以 '\0' 结尾
+uint32_t saxHash(const char* key);
+
+// FNV-1a 32 位哈希
+uint32_t fnvHash(const char* key, size_t len);
+
+// OAT 哈希
+uint32_t oatHash(const char* key, size_t len);
+
+// Jenkins lookup3 哈希
+uint32_t jenHash(const char* key, size_t len, uint32_t seed);
+
+/*
+XXH3 64/128 位哈希，输出与官方 xxHash 0.8 的 XXH3_64bits_withSeed / XXH3_128bits_withSeed 一致
+长输入按 CPU 支持情况选择 AVX2、SSE2 或标量实现，流式接口可分多次输入，结果与一次性计算相同
+*/
+
+// 默认密钥字节数
+#define XXH3_SECRET_SIZE 192
+// 流式接口的内部缓冲区字节数
+#define XXH3_BUFFER_SIZE 256
+
+typedef struct {
+    uint64_t low;
+    uint64_t high;
+} xxh3_128;
+
+// 流式计算状态，由调用者分配，不申请堆内存
+typedef struct {
+    uint64_t acc[8];                         // 长输入累加器
+    unsigned char secret[XXH3_SECRET_SIZE];  // 按种子派生的密钥
+    unsigned char buffer[XXH3_BUFFER_SIZE];  // 未处理的输入
+    size_t buffered;                         // buffer 中的字节数
+    size_t stripes;                          // 当前块内已处理的条带数
+    uint64_t total_len;
+    uint64_t seed;
+} xxh3_state;
+
+// XXH3 64 位哈希
+uint64_t xxh3Hash64(const void *key, size_t len, uint64_t seed);
+
+// XXH3 128 位哈希
+xxh3_128 xxh3Hash128(const void *key, size_t len, uint64_t seed);
+
+// 流式计算：xxh3Init 后多次 xxh3Update，xxh3Final64/xxh3Final128 不改变状态，可以继续追加输入
+void xxh3Init(xxh3_state *state, uint64_t seed);
+void xxh3Update(xxh3_state *state, const void *data, size_t len);
+uint64_t xxh3Final64(const xxh3_state *state);
+xxh3_128 xxh3Final128(const xxh3_state *state);
+
+/*
+CRC 校验：CRC32（IEEE，同 zlib）、CRC32C（Castagnoli）、CRC64（ECMA-182 反射位序，同 xz）
+第一次调用时检测 CPU：CRC32C 使用 SSE4.2 crc32 指令（有 PCLMULQDQ 时三路交错），CRC32/CRC64 使用 PCLMULQDQ 折叠，
+不支持时使用查表实现
+crc 参数传入前一段的结果，首段传 0
+*/
+
+uint32_t crc32Hash(const void *data, size_t len, uint32_t crc);
+uint32_t crc32cHash(const void *data, size_t len, uint32_t crc);
+uint64_t crc64Hash(const void *data, size_t len, uint64_t crc);
+
+// 查表（slicing-by-8）实现，结果与上面相同，用于对照测试
+uint32_t crc32HashPortable(const void *data, size_t len, uint32_t crc);
+uint32_t crc32cHashPortable(const void *data, size_t len, uint32_t crc);
+uint64_t crc64HashPortable(const void *data, size_t len, uint64_t crc);
+
+// 当前使用的实现："sse4.2+pclmul"、"pclmul"、"sse4.2" 或 "table"，第一次调用 CRC 函数时按 CPU 选择
+const char *crcImplName(void);
+
+/*
+批量 MurmurHash3 32 位哈希，结果与逐个调用 murmurHash3_32 相同
+定长键用 AVX2 的 8 个通道同时计算，变长键按组交错、掩码丢弃已结束的键，CPU 不支持 AVX2 时使用标量实现
+*/
+void murmurHash3_32Batch(const void *keys, size_t key_len, size_t n, uint32_t seed, uint32_t *out);
+void murmurHash3_32BatchVar(const void *const *keys, const size_t *lens, size_t n, uint32_t seed, uint32_t *out);
+
+/*
+SHA-256（FIPS 180-4），不依赖 OpenSSL，结果与 OpenSSL SHA256() 相同
+第一次调用时检测 CPU：支持 SHA 扩展时使用 SHA-NI，否则使用便携实现；批量接口有 AVX2 时 8 条消息同时计算（有 SHA-NI 时只用于短消息）
+*/
+
+#define SHA256_BLOCK_SIZE  64
+#define SHA256_DIGEST_SIZE 32
+
+// 流式计算状态，由调用者分配，不申请堆内存
+typedef struct {
+    uint32_t h[8];                            // 中间哈希值
+    unsigned char buffer[SHA256_BLOCK_SIZE];  // 不足一块的输入
+    size_t buffered;                          // buffer 中的字节数
+    uint64_t total_len;
+} sha256_state;
+
+void sha256Hash(const void *data, size_t len, unsigned char hash[SHA256_DIGEST_SIZE]);
+
+// 便携实现，结果与 sha256Hash 相同，用于对照测试
+void sha256HashPortable(const void *data, size_t len, unsigned char hash[SHA256_DIGEST_SIZE]);
+
+// 流式计算：sha256Init 后多次 sha256Update，sha256Final 不改变状态，可以继续追加输入
+void sha256Init(sha256_state *state);
+void sha256Update(sha256_state *state, const void *data, size_t len);
+void sha256Final(const sha256_state *state, unsigned char hash[SHA256_DIGEST_SIZE]);
+
+// n 条独立消息的摘要，第 i 条写入 hashes + 32 * i
+void sha256HashBatch(const void *const *data, const size_t *lens, size_t n, unsigned char *hashes);
+
+// 当前使用的实现："sha-ni+avx2"、"sha-ni"、"portable+avx2" 或 "portable"，"+avx2" 表示批量接口使用多缓冲
+const char *sha256ImplName(void);
+
+/*
+各模块共用的小工具，static inline，不必链接 hashalg.o
+*/
+
+// splitmix64 伪随机数：state 每次加黄金比例常数后混合，用于生成测试数据与派生种子
+static inline uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// MurmurHash3 的 64 位最终混合，把已有的 64 位哈希值充分打散
+static inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+// 按小端序读写 64 位整数，序列化结果与机器字节序无关
+static inline void put_u64(unsigned char *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (unsigned char)(v >> (8 * i));
+    }
+}
+
+static inline uint64_t get_u64(const unsigned char *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = v << 8 | p[i];
+    }
+    return v;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_HASHT_HASHALG_H
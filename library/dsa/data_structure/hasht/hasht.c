@@ -77,14 +77,456 @@
 哈希表通过巧妙的哈希函数和冲突处理机制，在大多数场景下提供了接近常数时间的操作效率，是现代软件开发中最常用的数据结构之一。其设计需权衡哈希函数质量、冲突策略、负载因子和内存消耗，合理选择参数可实现高性能存储与检索 
 */
 
-// 哈希表初始大小
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <stdlib.h>
+#include <string.h>
 
-// 哈希表链表节点结构
+#include "hashalg.h"
+#include "hasht.h"
 
-// 哈希表数组结构
+// 哈希表初始大小：一组槽位
+#define HASHT_MIN_CAPACITY HASHT_GROUP_WIDTH
 
-// 哈希函数
+// 控制字节：空槽、已删除（墓碑），占用时为 H2（0~127）
+#define CTRL_EMPTY ((int8_t)-128)
+#define CTRL_DELETED ((int8_t)-2)
+
+// 最大负载因子 7/8
+#define HASHT_MAX_LOAD(capacity) ((capacity) - (capacity) / 8)
+
+// 哈希函数：hashalg.c 的 32 位结果乘黄金比例常数扩展到 64 位
+#define HASHT_GOLDEN 0x9E3779B97F4A7C15ULL
+
+uint64_t hasht_hash_murmur3(const void *key, size_t len, uint64_t seed) {
+    return murmurHash3_32(key, len, (uint32_t)seed) * HASHT_GOLDEN;
+}
+
+uint64_t hasht_hash_fnv(const void *key, size_t len, uint64_t seed) {
+    return (fnvHash((const char *)key, len) ^ seed) * HASHT_GOLDEN;
+}
+
+uint64_t hasht_hash_oat(const void *key, size_t len, uint64_t seed) {
+    return (oatHash((const char *)key, len) ^ seed) * HASHT_GOLDEN;
+}
+
+uint64_t hasht_hash_jenkins(const void *key, size_t len, uint64_t seed) {
+    return jenHash((const char *)key, len, (uint32_t)seed) * HASHT_GOLDEN;
+}
+
+// XXH3 本身输出 64 位，不需要扩展
+uint64_t hasht_hash_xxh3(const void *key, size_t len, uint64_t seed) {
+    return xxh3Hash64(key, len, seed);
+}
+
+// 哈希值拆分：高 7 位存入控制字节，低位选组
+static inline int8_t hash_h2(uint64_t hash) {
+    return (int8_t)(hash >> 57);
+}
+
+// 组内匹配，返回 16 位掩码，第 i 位表示组内第 i 个槽位
+#ifdef __SSE2__
+static inline uint32_t group_match(const int8_t *ctrl, int8_t h2) {
+    __m128i group = _mm_load_si128((const __m128i *)ctrl);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(h2)));
+}
+
+static inline uint32_t group_match_empty(const int8_t *ctrl) {
+    return group_match(ctrl, CTRL_EMPTY);
+}
+
+// 空槽与墓碑的最高位都是 1，movemask 直接取出
+static inline uint32_t group_match_free(const int8_t *ctrl) {
+    return (uint32_t)_mm_movemask_epi8(_mm_load_si128((const __m128i *)ctrl));
+}
+#else
+static inline uint32_t group_match(const int8_t *ctrl, int8_t h2) {
+    uint32_t mask = 0;
+    for (int i = 0; i < HASHT_GROUP_WIDTH; i++) {
+        mask |= (uint32_t)(ctrl[i] == h2) << i;
+    }
+    return mask;
+}
+
+static inline uint32_t group_match_empty(const int8_t *ctrl) {
+    return group_match(ctrl, CTRL_EMPTY);
+}
+
+static inline uint32_t group_match_free(const int8_t *ctrl) {
+    uint32_t mask = 0;
+    for (int i = 0; i < HASHT_GROUP_WIDTH; i++) {
+        mask |= (uint32_t)(ctrl[i] < 0) << i;
+    }
+    return mask;
+}
+#endif
+
+static inline unsigned char *slot_key(const hasht *t, size_t slot) {
+    return t->slots + slot * t->slot_size;
+}
+
+static inline void *slot_value(const hasht *t, size_t slot) {
+    return t->slots + slot * t->slot_size + t->value_offset;
+}
+
+// 按三角数序列探测组：g, g+1, g+3, g+6 ...，组数为 2 的幂时不重复地遍历所有组
+static size_t find_slot(const hasht *t, const void *key, uint64_t hash) {
+    size_t group_mask = t->capacity / HASHT_GROUP_WIDTH - 1;
+    size_t group = (size_t)hash & group_mask;
+    int8_t h2 = hash_h2(hash);
+    for (size_t step = 1;; step++) {
+        const int8_t *ctrl = t->ctrl + group * HASHT_GROUP_WIDTH;
+        uint32_t match = group_match(ctrl, h2);
+        while (match) {
+            size_t slot = group * HASHT_GROUP_WIDTH + (size_t)__builtin_ctz(match);
+            if (memcmp(slot_key(t, slot), key, t->key_size) == 0) {
+                return slot;
+            }
+            match &= match - 1;
+        }
+        // 组内有空槽，说明键从未被放到更后面的组
+        if (group_match_empty(ctrl)) {
+            return SIZE_MAX;
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+// 探测序列上第一个空槽或墓碑
+static size_t find_free_slot(const hasht *t, uint64_t hash) {
+    size_t group_mask = t->capacity / HASHT_GROUP_WIDTH - 1;
+    size_t group = (size_t)hash & group_mask;
+    for (size_t step = 1;; step++) {
+        uint32_t match = group_match_free(t->ctrl + group * HASHT_GROUP_WIDTH);
+        if (match) {
+            return group * HASHT_GROUP_WIDTH + (size_t)__builtin_ctz(match);
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+// 重建到 capacity 个槽位，同时清除所有墓碑
+static bool rehash(hasht *t, size_t capacity) {
+    int8_t *ctrl = aligned_alloc(HASHT_GROUP_WIDTH, capacity);
+    unsigned char *slots = malloc(capacity * t->slot_size);
+    if (!ctrl || !slots) {
+        free(ctrl);
+        free(slots);
+        return false;
+    }
+    memset(ctrl, CTRL_EMPTY, capacity);
+
+    hasht old = *t;
+    t->ctrl = ctrl;
+    t->slots = slots;
+    t->capacity = capacity;
+    t->growth_left = HASHT_MAX_LOAD(capacity) - t->size;
+
+    for (size_t i = 0; i < old.capacity; i++) {
+        if (old.ctrl[i] < 0) {
+            continue;
+        }
+        const unsigned char *key = slot_key(&old, i);
+        uint64_t hash = hasht_hash_key(t, key);
+        size_t slot = find_free_slot(t, hash);
+        t->ctrl[slot] = hash_h2(hash);
+        memcpy(slot_key(t, slot), key, t->slot_size);
+    }
+
+    free(old.ctrl);
+    free(old.slots);
+    return true;
+}
+
+// 容足 count 个元素所需的槽位数
+static size_t capacity_for(size_t count) {
+    size_t capacity = HASHT_MIN_CAPACITY;
+    while (HASHT_MAX_LOAD(capacity) < count) {
+        capacity *= 2;
+    }
+    return capacity;
+}
 
 // 创建、销毁
+bool hasht_init(hasht *t, size_t key_size, size_t value_size, hasht_hash_fn hash, uint64_t seed) {
+    if (key_size == 0) {
+        return false;
+    }
+    // 槽位对齐取键、值大小共同的最低 2 的幂，最大 8 字节
+    size_t align = (key_size | value_size | 8) & -(key_size | value_size | 8);
+    memset(t, 0, sizeof(*t));
+    t->key_size = key_size;
+    t->value_size = value_size;
+    t->value_offset = (key_size + align - 1) & ~(align - 1);
+    t->slot_size = (t->value_offset + value_size + align - 1) & ~(align - 1);
+    t->hash = hash ? hash : hasht_hash_murmur3;
+    t->seed = seed;
+    return true;
+}
+
+void hasht_free(hasht *t) {
+    free(t->ctrl);
+    free(t->slots);
+    t->ctrl = NULL;
+    t->slots = NULL;
+    t->capacity = 0;
+    t->size = 0;
+    t->growth_left = 0;
+}
+
+void hasht_clear(hasht *t) {
+    if (t->capacity) {
+        memset(t->ctrl, CTRL_EMPTY, t->capacity);
+    }
+    t->size = 0;
+    t->growth_left = HASHT_MAX_LOAD(t->capacity);
+}
+
+bool hasht_reserve(hasht *t, size_t count) {
+    size_t capacity = capacity_for(count);
+    if (capacity <= t->capacity) {
+        return true;
+    }
+    return rehash(t, capacity);
+}
+
+// 增、删、改、查
+void *hasht_insert_hash(hasht *t, const void *key, const void *value, uint64_t hash) {
+    size_t slot = t->capacity ? find_slot(t, key, hash) : SIZE_MAX;
+    if (slot == SIZE_MAX) {
+        slot = t->capacity ? find_free_slot(t, hash) : 0;
+        // 复用墓碑不消耗空槽；空槽用完时扩容，墓碑过多则原容量重建
+        if (t->capacity == 0 || (t->growth_left == 0 && t->ctrl[slot] == CTRL_EMPTY)) {
+            size_t capacity = t->capacity == 0 ? HASHT_MIN_CAPACITY
+                              : t->size + 1 > HASHT_MAX_LOAD(t->capacity) / 2 ? t->capacity * 2
+                                                                              : t->capacity;
+            if (!rehash(t, capacity)) {
+                return NULL;
+            }
+            slot = find_free_slot(t, hash);
+        }
+        t->growth_left -= t->ctrl[slot] == CTRL_EMPTY;
+        t->ctrl[slot] = hash_h2(hash);
+        t->size++;
+        memcpy(slot_key(t, slot), key, t->key_size);
+    }
+
+    void *slot_val = t->value_size ? slot_value(t, slot) : slot_key(t, slot);
+    if (value && t->value_size) {
+        memcpy(slot_val, value, t->value_size);
+    }
+    return slot_val;
+}
+
+void *hasht_insert(hasht *t, const void *key, const void *value) {
+    return hasht_insert_hash(t, key, value, hasht_hash_key(t, key));
+}
+
+void *hasht_find_hash(const hasht *t, const void *key, uint64_t hash) {
+    if (t->size == 0) {
+        return NULL;
+    }
+    size_t slot = find_slot(t, key, hash);
+    if (slot == SIZE_MAX) {
+        return NULL;
+    }
+    return t->value_size ? slot_value(t, slot) : slot_key(t, slot);
+}
+
+void *hasht_find(const hasht *t, const void *key) {
+    if (t->size == 0) {
+        return NULL;
+    }
+    return hasht_find_hash(t, key, hasht_hash_key(t, key));
+}
+
+size_t hasht_find_batch(const hasht *t, const void *keys, size_t n, void **values) {
+    if (t->size == 0) {
+        memset(values, 0, n * sizeof(void *));
+        return 0;
+    }
+    size_t group_mask = t->capacity / HASHT_GROUP_WIDTH - 1;
+    uint64_t hashes[HASHT_BATCH];
+    uint32_t hashes32[HASHT_BATCH];
+    size_t found = 0;
+    for (size_t base = 0; base < n; base += HASHT_BATCH) {
+        size_t m = n - base < HASHT_BATCH ? n - base : HASHT_BATCH;
+        const unsigned char *k = (const unsigned char *)keys + base * t->key_size;
+        if (t->hash == hasht_hash_murmur3) {
+            murmurHash3_32Batch(k, t->key_size, m, (uint32_t)t->seed, hashes32);
+            for (size_t i = 0; i < m; i++) {
+                hashes[i] = hashes32[i] * HASHT_GOLDEN;
+            }
+        } else {
+            for (size_t i = 0; i < m; i++) {
+                hashes[i] = t->hash(k + i * t->key_size, t->key_size, t->seed);
+            }
+        }
+        // 控制字节与组内第一个槽位各在一条缓存行上
+        for (size_t i = 0; i < m; i++) {
+            size_t group = (size_t)hashes[i] & group_mask;
+            __builtin_prefetch(t->ctrl + group * HASHT_GROUP_WIDTH);
+            __builtin_prefetch(slot_key(t, group * HASHT_GROUP_WIDTH));
+        }
+        for (size_t i = 0; i < m; i++) {
+            size_t slot = find_slot(t, k + i * t->key_size, hashes[i]);
+            if (slot == SIZE_MAX) {
+                values[base + i] = NULL;
+                continue;
+            }
+            values[base + i] = t->value_size ? slot_value(t, slot) : slot_key(t, slot);
+            found++;
+        }
+    }
+    return found;
+}
+
+bool hasht_erase_hash(hasht *t, const void *key, uint64_t hash) {
+    if (t->size == 0) {
+        return false;
+    }
+    size_t slot = find_slot(t, key, hash);
+    if (slot == SIZE_MAX) {
+        return false;
+    }
+    // 组内还有空槽时没有探测序列越过该组，可以直接置空，否则留墓碑
+    const int8_t *group = t->ctrl + slot / HASHT_GROUP_WIDTH * HASHT_GROUP_WIDTH;
+    if (group_match_empty(group)) {
+        t->ctrl[slot] = CTRL_EMPTY;
+        t->growth_left++;
+    } else {
+        t->ctrl[slot] = CTRL_DELETED;
+    }
+    t->size--;
+    return true;
+}
+
+bool hasht_erase(hasht *t, const void *key) {
+    if (t->size == 0) {
+        return false;
+    }
+    return hasht_erase_hash(t, key, hasht_hash_key(t, key));
+}
+
+bool hasht_next(const hasht *t, size_t *pos, void **key, void **value) {
+    for (size_t i = *pos; i < t->capacity; i++) {
+        if (t->ctrl[i] >= 0) {
+            if (key) {
+                *key = slot_key(t, i);
+            }
+            if (value) {
+                *value = t->value_size ? slot_value(t, i) : NULL;
+            }
+            *pos = i + 1;
+            return true;
+        }
+    }
+    *pos = t->capacity;
+    return false;
+}
+
+bool hasht_migrate(hasht *from, hasht *to, size_t *pos, size_t slots) {
+    size_t end = *pos + slots < from->capacity ? *pos + slots : from->capacity;
+    for (size_t i = *pos; i < end; i++) {
+        if (from->ctrl[i] < 0) {
+            continue;
+        }
+        const unsigned char *key = slot_key(from, i);
+        // 迁入失败时元素留在 from，下次从这个槽位重试
+        if (!hasht_insert_hash(to, key, key + from->value_offset, hasht_hash_key(to, key))) {
+            *pos = i;
+            return false;
+        }
+        from->ctrl[i] = CTRL_DELETED;
+        from->size--;
+    }
+    *pos = end;
+    return true;
+}
+
+#ifdef HASHT_MAIN
+// 与线性数组对照随机增删查，验证探测与删除逻辑
+static int self_check(size_t ops, uint32_t key_range) {
+    hasht t;
+    hasht_init(&t, sizeof(uint32_t), sizeof(uint32_t), hasht_hash_murmur3, 0);
+    uint8_t *present = calloc(key_range, 1);
+    uint32_t *values = calloc(key_range, sizeof(uint32_t));
+    size_t expect_size = 0;
+    uint32_t rng = 2463534242u;
+
+    for (size_t i = 0; i < ops; i++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        uint32_t key = rng % key_range;
+        uint32_t *found = hasht_find(&t, &key);
+        if ((found != NULL) != present[key] || (found && *found != values[key])) {
+            printf("mismatch at op %zu key %u\n", i, key);
+            return 1;
+        }
+        switch (rng >> 30) {
+        case 0:
+        case 1:
+            expect_size += !present[key];
+            present[key] = 1;
+            values[key] = (uint32_t)i;
+            hasht_insert(&t, &key, &values[key]);
+            break;
+        case 2:
+            expect_size -= present[key];
+            present[key] = 0;
+            hasht_erase(&t, &key);
+            break;
+        default:
+            break;
+        }
+        if (hasht_size(&t) != expect_size) {
+            printf("size mismatch at op %zu\n", i);
+            return 1;
+        }
+    }
+
+    free(present);
+    free(values);
+    hasht_free(&t);
+    return 0;
+}
+
+int main(void) {
+
+    // 示例1：以字符串为键，值为 int
+    hasht table;
+    char key[16];
+    hasht_init(&table, sizeof(key), sizeof(int), hasht_hash_fnv, 0);
+    const char *words[] = {"apple", "banana", "cherry", "durian", "elder"};
+    for (int i = 0; i < 5; i++) {
+        memset(key, 0, sizeof(key));
+        strncpy(key, words[i], sizeof(key) - 1);
+        hasht_insert(&table, key, &i);
+    }
+
+    // 示例2：查找、删除
+    memset(key, 0, sizeof(key));
+    strcpy(key, "cherry");
+    int *value = hasht_find(&table, key);
+    printf("cherry -> %d\n", value ? *value : -1);
+    hasht_erase(&table, key);
+    printf("cherry after erase -> %s\n", hasht_find(&table, key) ? "found" : "not found");
+
+    // 示例3：遍历
+    size_t pos = 0;
+    void *k;
+    void *v;
+    while (hasht_next(&table, &pos, &k, &v)) {
+        printf("  %s = %d\n", (char *)k, *(int *)v);
+    }
+    hasht_free(&table);
+
+    // 示例4：随机操作自检，小键空间使删除与墓碑频繁出现
+    int failed = self_check(2000000, 5000) | self_check(2000000, 500000);
+    printf("self check: %s\n", failed ? "FAILED" : "ok");
 
-// 增、删、改、查
\ No newline at end of file
+    return failed;
+}
+#endif
@@ -0,0 +1,167 @@
+#ifndef DSA_HASHT_HASHT_H
+#define DSA_HASHT_HASHT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+开放寻址哈希表（Swiss table 风格）
+（1）每个槽位对应一个控制字节：空（0x80）、已删除（0xFE）、占用（0x00~0x7F，保存哈希值的高 7 位 H2）
+（2）槽位按 16 个一组，SSE2 一条比较指令同时检查一组的 16 个控制字节，H2 相同才比较键
+（3）组间按三角数序列探测，组数为 2 的幂时可以遍历所有组
+（4）删除时若所在组内还有空槽，说明没有探测序列经过该组，直接置空，不留墓碑
+（5）键、值为定长字节块，内联保存在槽位数组中，哈希函数由调用者从 hashalg.c 中选择
+*/
+
+// 每组槽位数，等于 SSE2 寄存器字节数
+#define HASHT_GROUP_WIDTH 16
+
+// 批量查找时每组的键数：组内先算哈希、发出预取，再逐个探测
+#define HASHT_BATCH 32
+
+// 哈希函数类型，输出 64 位，高 7 位作为控制字节，低位选组
+typedef uint64_t (*hasht_hash_fn)(const void *key, size_t len, uint64_t seed);
+
+// 开放寻址哈希表
+typedef struct {
+    int8_t *ctrl;           // 控制字节数组，capacity 个，16 字节对齐
+    unsigned char *slots;   // 槽位数组，每个槽位先放键再放值
+    size_t capacity;        // 槽位数，0 或 2 的幂且不小于 HASHT_GROUP_WIDTH
+    size_t size;            // 元素个数
+    size_t growth_left;     // 还能占用多少个空槽，墓碑不计入
+    size_t key_size;
+    size_t value_size;
+    size_t value_offset;    // 值在槽位内的偏移
+    size_t slot_size;
+    hasht_hash_fn hash;
+    uint64_t seed;
+} hasht;
+
+/*
+hashalg.c 中 32 位哈希的适配，乘黄金比例常数扩展到 64 位，使高 7 位也依赖全部输入位
+没有种子参数的算法把种子异或到结果上
+*/
+uint64_t hasht_hash_murmur3(const void *key, size_t len, uint64_t seed);
+uint64_t hasht_hash_fnv(const void *key, size_t len, uint64_t seed);
+uint64_t hasht_hash_oat(const void *key, size_t len, uint64_t seed);
+uint64_t hasht_hash_jenkins(const void *key, size_t len, uint64_t seed);
+// 64 位 XXH3，种子直接参与哈希
+uint64_t hasht_hash_xxh3(const void *key, size_t len, uint64_t seed);
+
+/**
+* @brief             初始化哈希表，初始不分配内存
+* @param   key_size  键的字节数
+* @param   value_size 值的字节数，可以为 0（集合）
+* @param   hash      哈希函数，NULL 时使用 hasht_hash_murmur3
+* @param   seed      哈希种子
+* @return  bool      参数非法返回 false
+*
+* @note              Revision History
+*/
+bool hasht_init(hasht *t, size_t key_size, size_t value_size, hasht_hash_fn hash, uint64_t seed);
+
+/**
+* @brief             释放哈希表内存
+*
+* @note              Revision History
+*/
+void hasht_free(hasht *t);
+
+/**
+* @brief             清空所有元素，保留容量
+*
+* @note              Revision History
+*/
+void hasht_clear(hasht *t);
+
+/**
+* @brief             预留空间，插入 count 个元素前不再扩容
+* @return  bool      申请内存失败返回 false
+*
+* @note              Revision History
+*/
+bool hasht_reserve(hasht *t, size_t count);
+
+// 计算键的哈希值，可与 *_hash 系列接口配合，避免重复计算
+static inline uint64_t hasht_hash_key(const hasht *t, const void *key) {
+    return t->hash(key, t->key_size, t->seed);
+}
+
+/**
+* @brief             插入或覆盖
+* @param   key       键，key_size 字节
+* @param   value     值，value_size 字节，NULL 时只占位不写值
+* @return  void*     表内值的地址，申请内存失败返回 NULL
+*
+* @note              返回的地址在下一次插入或删除前有效
+*/
+void *hasht_insert(hasht *t, const void *key, const void *value);
+void *hasht_insert_hash(hasht *t, const void *key, const void *value, uint64_t hash);
+
+/**
+* @brief             查找
+* @return  void*     表内值的地址，不存在返回 NULL
+*
+* @note              value_size 为 0 时返回键的地址
+*/
+void *hasht_find(const hasht *t, const void *key);
+void *hasht_find_hash(const hasht *t, const void *key, uint64_t hash);
+
+/**
+* @brief             批量查找
+* @param   keys      n 个键连续存放，每个 key_size 字节
+* @param   n         键数
+* @param   values    输出 n 个地址，含义同 hasht_find，不存在为 NULL
+* @return  size_t    找到的个数
+*
+* @note              每 HASHT_BATCH 个键先全部算出哈希并预取首个探测组，再逐个探测，多个缓存未命中可以重叠；
+*                    哈希函数为 hasht_hash_murmur3 时用 murmurHash3_32Batch 一次算一批
+*/
+size_t hasht_find_batch(const hasht *t, const void *keys, size_t n, void **values);
+
+/**
+* @brief             删除
+* @return  bool      键不存在返回 false
+*
+* @note              Revision History
+*/
+bool hasht_erase(hasht *t, const void *key);
+bool hasht_erase_hash(hasht *t, const void *key, uint64_t hash);
+
+/**
+* @brief             遍历，pos 从 0 开始
+* @param   pos       遍历位置，调用后指向下一个位置
+* @param   key       输出键的地址，可为 NULL
+* @param   value     输出值的地址，可为 NULL
+* @return  bool      遍历结束返回 false
+*
+* @note              遍历过程中不能插入或删除
+*/
+bool hasht_next(const hasht *t, size_t *pos, void **key, void **value);
+
+/**
+* @brief             渐进式迁移：把 from 中 [*pos, *pos + slots) 范围内的元素移到 to
+* @param   from      迁出的表，迁出的槽位置为墓碑，迁移期间不应再向其插入
+* @param   to        迁入的表，键、值大小与 from 相同
+* @param   pos       迁移位置，调用后前移 slots 个槽位，等于 from->capacity 时已全部迁完
+* @param   slots     本次最多检查的槽位数
+* @return  bool      向 to 插入时申请内存失败返回 false，*pos 停在失败的槽位，未迁出的元素仍在 from 中
+*
+* @note              每次只迁移少量槽位，把一次性扩容的停顿分摊到多次操作中
+*/
+bool hasht_migrate(hasht *from, hasht *to, size_t *pos, size_t slots);
+
+static inline size_t hasht_size(const hasht *t) {
+    return t->size;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_HASHT_HASHT_H
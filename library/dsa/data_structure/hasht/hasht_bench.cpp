@@ -0,0 +1,211 @@
+// hasht 与 uthash、std::unordered_map 的插入、查找、删除性能对比
+// 用法：./hasht_bench [最大元素数]，默认 10M，100M 约需 12GB 内存
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+
+#include "hashalg.h"
+#include "hasht.h"
+#include "uthash.h"
+
+namespace {
+
+struct item {
+    uint64_t key;
+    uint64_t value;
+    UT_hash_handle hh;
+};
+
+double now_ns() {
+    return std::chrono::duration<double, std::nano>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+struct result {
+    double insert;
+    double hit;
+    double miss;
+    double erase;
+};
+
+// 小规模时重复多轮，使每项计时至少覆盖约 2M 次操作
+size_t rounds_for(size_t n) {
+    return std::max<size_t>(1, 2000000 / n);
+}
+
+result bench_hasht(const std::vector<uint64_t> &keys, const std::vector<uint64_t> &order,
+                   const std::vector<uint64_t> &misses, hasht_hash_fn hash, uint64_t &sink,
+                   bool batch = false) {
+    result r{};
+    size_t n = keys.size();
+    size_t rounds = rounds_for(n);
+    std::vector<void *> values(batch ? n : 0);
+    for (size_t round = 0; round < rounds; round++) {
+        hasht t;
+        hasht_init(&t, sizeof(uint64_t), sizeof(uint64_t), hash, 0);
+
+        double start = now_ns();
+        for (size_t i = 0; i < n; i++) {
+            hasht_insert(&t, &keys[i], &keys[i]);
+        }
+        r.insert += now_ns() - start;
+
+        start = now_ns();
+        if (batch) {
+            hasht_find_batch(&t, order.data(), n, values.data());
+            for (size_t i = 0; i < n; i++) {
+                sink += *(uint64_t *)values[i];
+            }
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                sink += *(uint64_t *)hasht_find(&t, &order[i]);
+            }
+        }
+        r.hit += now_ns() - start;
+
+        start = now_ns();
+        if (batch) {
+            sink += hasht_find_batch(&t, misses.data(), n, values.data());
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                sink += hasht_find(&t, &misses[i]) != nullptr;
+            }
+        }
+        r.miss += now_ns() - start;
+
+        start = now_ns();
+        for (size_t i = 0; i < n; i++) {
+            hasht_erase(&t, &order[i]);
+        }
+        r.erase += now_ns() - start;
+        hasht_free(&t);
+    }
+    double ops = (double)(n * rounds);
+    return {r.insert / ops, r.hit / ops, r.miss / ops, r.erase / ops};
+}
+
+result bench_uthash(const std::vector<uint64_t> &keys, const std::vector<uint64_t> &order,
+                    const std::vector<uint64_t> &misses, uint64_t &sink) {
+    result r{};
+    size_t n = keys.size();
+    size_t rounds = rounds_for(n);
+    // 节点一次性分配，不把 malloc 计入 uthash 的耗时
+    std::vector<item> items(n);
+    for (size_t round = 0; round < rounds; round++) {
+        item *head = nullptr;
+
+        double start = now_ns();
+        for (size_t i = 0; i < n; i++) {
+            items[i].key = keys[i];
+            items[i].value = keys[i];
+            HASH_ADD(hh, head, key, sizeof(uint64_t), &items[i]);
+        }
+        r.insert += now_ns() - start;
+
+        start = now_ns();
+        for (size_t i = 0; i < n; i++) {
+            item *found;
+            HASH_FIND(hh, head, &order[i], sizeof(uint64_t), found);
+            sink += found->value;
+        }
+        r.hit += now_ns() - start;
+
+        start = now_ns();
+        for (size_t i = 0; i < n; i++) {
+            item *found;
+            HASH_FIND(hh, head, &misses[i], sizeof(uint64_t), found);
+            sink += found != nullptr;
+        }
+        r.miss += now_ns() - start;
+
+        start = now_ns();
+        for (size_t i = 0; i < n; i++) {
+            item *found;
+            HASH_FIND(hh, head, &order[i], sizeof(uint64_t), found);
+            HASH_DEL(head, found);
+        }
+        r.erase += now_ns() - start;
+        HASH_CLEAR(hh, head);
+    }
+    double ops = (double)(n * rounds);
+    return {r.insert / ops, r.hit / ops, r.miss / ops, r.erase / ops};
+}
+
+result bench_unordered_map(const std::vector<uint64_t> &keys, const std::vector<uint64_t> &order,
+                           const std::vector<uint64_t> &misses, uint64_t &sink) {
+    result r{};
+    size_t n = keys.size();
+    size_t rounds = rounds_for(n);
+    for (size_t round = 0; round < rounds; round++) {
+        std::unordered_map<uint64_t, uint64_t> map;
+
+        double start = now_ns();
+        for (size_t i = 0; i < n; i++) {
+            map.emplace(keys[i], keys[i]);
+        }
+        r.insert += now_ns() - start;
+
+        start = now_ns();
+        for (size_t i = 0; i < n; i++) {
+            sink += map.find(order[i])->second;
+        }
+        r.hit += now_ns() - start;
+
+        start = now_ns();
+        for (size_t i = 0; i < n; i++) {
+            sink += map.find(misses[i]) != map.end();
+        }
+        r.miss += now_ns() - start;
+
+        start = now_ns();
+        for (size_t i = 0; i < n; i++) {
+            map.erase(order[i]);
+        }
+        r.erase += now_ns() - start;
+    }
+    double ops = (double)(n * rounds);
+    return {r.insert / ops, r.hit / ops, r.miss / ops, r.erase / ops};
+}
+
+void print_row(const char *name, size_t n, const result &r) {
+    std::printf("%-22s %10zu %10.1f %10.1f %10.1f %10.1f\n", name, n, r.insert, r.hit, r.miss,
+                r.erase);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t max_n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    std::printf("%-22s %10s %10s %10s %10s %10s   (ns/op)\n", "table", "entries", "insert", "hit",
+                "miss", "erase");
+    uint64_t sink = 0;
+    for (size_t n = 1000; n <= max_n; n *= 10) {
+        uint64_t state = n;
+        std::vector<uint64_t> keys(n);
+        std::vector<uint64_t> misses(n);
+        for (size_t i = 0; i < n; i++) {
+            keys[i] = splitmix64(&state);
+            misses[i] = splitmix64(&state);
+        }
+        // 查找与删除按打乱后的顺序，避免与插入顺序相关的缓存局部性
+        std::vector<uint64_t> order = keys;
+        for (size_t i = n - 1; i > 0; i--) {
+            std::swap(order[i], order[splitmix64(&state) % (i + 1)]);
+        }
+
+        print_row("hasht/murmur3", n, bench_hasht(keys, order, misses, hasht_hash_murmur3, sink));
+        print_row("hasht/murmur3 batch", n, bench_hasht(keys, order, misses, hasht_hash_murmur3, sink, true));
+        print_row("hasht/fnv", n, bench_hasht(keys, order, misses, hasht_hash_fnv, sink));
+        print_row("hasht/xxh3", n, bench_hasht(keys, order, misses, hasht_hash_xxh3, sink));
+        print_row("uthash", n, bench_uthash(keys, order, misses, sink));
+        print_row("std::unordered_map", n, bench_unordered_map(keys, order, misses, sink));
+        std::printf("\n");
+    }
+    return sink == 42 ? 1 : 0;
+}
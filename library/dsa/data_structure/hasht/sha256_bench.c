@@ -0,0 +1,164 @@
+// SHA-256 测试：便携实现、SHA-NI 与 AVX2 多缓冲批量接口
+// （1）核对：FIPS 180-4 的标准测试向量；随机长度、随机切分的流式计算、批量计算与便携实现一次性计算的结果一致
+// （2）速度：64B~1MB 各长度的 cycles/byte（rdtsc），单条为逐条调用 sha256Hash，批量为每次 sha256HashBatch 64 条同长消息
+// 用法：./sha256_bench
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <x86intrin.h>
+
+#include "hashalg.h"
+
+#define MAX_LEN (1u << 20)
+#define BATCH   64
+
+static volatile unsigned char bench_sink;
+
+static void to_hex(const unsigned char hash[SHA256_DIGEST_SIZE], char hex[2 * SHA256_DIGEST_SIZE + 1]) {
+    for (int i = 0; i < SHA256_DIGEST_SIZE; i++) {
+        snprintf(hex + 2 * i, 3, "%02x", hash[i]);
+    }
+}
+
+// FIPS 180-4 附录与 NIST 示例中的测试向量，最后一个为 100 万个 'a'
+static bool check_vectors(void) {
+    static const struct {
+        const char *input;
+        size_t repeat;
+        const char *digest;
+    } vectors[] = {
+        {"", 1, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+        {"abc", 1, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+        {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+         "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+        {"a", 1000000, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+    };
+    for (size_t v = 0; v < sizeof(vectors) / sizeof(vectors[0]); v++) {
+        size_t unit = strlen(vectors[v].input);
+        size_t len = unit * vectors[v].repeat;
+        unsigned char *msg = malloc(len + 1);
+        for (size_t r = 0; r < vectors[v].repeat; r++) {
+            memcpy(msg + r * unit, vectors[v].input, unit);
+        }
+        unsigned char hash[4][SHA256_DIGEST_SIZE];
+        sha256Hash(msg, len, hash[0]);
+        sha256HashPortable(msg, len, hash[1]);
+        const void *data = msg;
+        sha256HashBatch(&data, &len, 1, hash[2]);
+        sha256_state state;
+        sha256Init(&state);
+        for (size_t r = 0; r < vectors[v].repeat; r++) {
+            sha256Update(&state, msg + r * unit, unit);
+        }
+        sha256Final(&state, hash[3]);
+        free(msg);
+        for (int k = 0; k < 4; k++) {
+            char hex[2 * SHA256_DIGEST_SIZE + 1];
+            to_hex(hash[k], hex);
+            if (strcmp(hex, vectors[v].digest) != 0) {
+                printf("vector %zu mismatch (variant %d): %s\n", v, k, hex);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 随机起点（覆盖非对齐）、随机长度；流式计算随机切成三段，批量计算的消息长短混杂
+static bool check_random(const unsigned char *buf) {
+    enum { N = 3000 };
+    static const void *data[N];
+    static size_t lens[N];
+    static unsigned char batch[N][SHA256_DIGEST_SIZE];
+    uint64_t state = 42;
+    for (size_t i = 0; i < N; i++) {
+        lens[i] = i < 2000 ? splitmix64(&state) % 300 : splitmix64(&state) % 20000;
+        data[i] = buf + splitmix64(&state) % 64;
+    }
+    sha256HashBatch(data, lens, N, batch[0]);
+    for (size_t i = 0; i < N; i++) {
+        unsigned char expect[SHA256_DIGEST_SIZE], got[SHA256_DIGEST_SIZE];
+        const unsigned char *p = data[i];
+        sha256HashPortable(p, lens[i], expect);
+        sha256Hash(p, lens[i], got);
+        bool ok = memcmp(got, expect, SHA256_DIGEST_SIZE) == 0 && memcmp(batch[i], expect, SHA256_DIGEST_SIZE) == 0;
+
+        size_t a = lens[i] ? splitmix64(&state) % (lens[i] + 1) : 0;
+        size_t b = a + (lens[i] > a ? splitmix64(&state) % (lens[i] - a + 1) : 0);
+        sha256_state st;
+        sha256Init(&st);
+        sha256Update(&st, p, a);
+        sha256Final(&st, got);  // 中途取摘要不影响后续输入
+        sha256Update(&st, p + a, b - a);
+        sha256Update(&st, p + b, lens[i] - b);
+        sha256Final(&st, got);
+        ok = ok && memcmp(got, expect, SHA256_DIGEST_SIZE) == 0;
+        if (!ok) {
+            printf("mismatch: len %zu split %zu/%zu\n", lens[i], a, b);
+            return false;
+        }
+    }
+    return true;
+}
+
+typedef enum { MODE_PORTABLE, MODE_SINGLE, MODE_BATCH } bench_mode;
+
+// 每个长度至少处理 64MB（便携实现 16MB），返回 cycles/byte
+static double cycles_per_byte(bench_mode mode, const unsigned char *buf, size_t len) {
+    const void *data[BATCH];
+    size_t lens[BATCH];
+    static unsigned char out[BATCH][SHA256_DIGEST_SIZE];
+    for (int i = 0; i < BATCH; i++) {
+        // 消息首尾相接，批量中的 64 条消息是不同的数据
+        data[i] = buf + (i * len) % (MAX_LEN * 2 - len + 1);
+        lens[i] = len;
+    }
+    size_t total = mode == MODE_PORTABLE ? (16u << 20) : (64u << 20);
+    size_t rounds = total / (len * BATCH) ? total / (len * BATCH) : 1;
+    uint64_t start = __rdtsc();
+    for (size_t r = 0; r < rounds; r++) {
+        if (mode == MODE_BATCH) {
+            sha256HashBatch(data, lens, BATCH, out[0]);
+            continue;
+        }
+        for (int i = 0; i < BATCH; i++) {
+            if (mode == MODE_PORTABLE) {
+                sha256HashPortable(data[i], len, out[i]);
+            } else {
+                sha256Hash(data[i], len, out[i]);
+            }
+        }
+    }
+    uint64_t cycles = __rdtsc() - start;
+    bench_sink = out[BATCH - 1][0];
+    return (double)cycles / ((double)rounds * BATCH * (double)len);
+}
+
+int main(void) {
+    unsigned char *buf = malloc(MAX_LEN * 2 + 64);
+    uint64_t state = 1;
+    for (size_t i = 0; i < MAX_LEN * 2 + 64; i += 8) {
+        uint64_t v = splitmix64(&state);
+        memcpy(buf + i, &v, 8);
+    }
+
+    bool ok = check_vectors() && check_random(buf);
+    printf("implementation %s, check %s\n", sha256ImplName(), ok ? "ok" : "FAILED");
+
+    static const size_t sizes[] = {16, 64, 256, 1024, 4096, 65536, MAX_LEN};
+    printf("%-8s %10s %10s %10s\n", "cyc/B", "portable", "single", "batch");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        char label[16];
+        if (sizes[s] >= MAX_LEN) {
+            snprintf(label, sizeof(label), "1MB");
+        } else {
+            snprintf(label, sizeof(label), "%zuB", sizes[s]);
+        }
+        printf("%-8s %10.2f %10.2f %10.2f\n", label, cycles_per_byte(MODE_PORTABLE, buf, sizes[s]),
+               cycles_per_byte(MODE_SINGLE, buf, sizes[s]), cycles_per_byte(MODE_BATCH, buf, sizes[s]));
+    }
+
+    free(buf);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,244 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "shardht.h"
+
+/*
+一、为什么分片
+（1）全局一把锁（如 uthash/tests/threads 中的 pthread_rwlock）下所有写操作串行，线程越多锁竞争越重
+（2）按哈希值把键分到多个分片，每个分片独立加锁，N 个分片时两个随机操作冲突的概率约为 1/N
+（3）分片结构按缓存行对齐，避免相邻分片的锁落在同一缓存行上产生伪共享
+
+二、渐进式扩容（Redis dict 的做法）
+（1）普通哈希表在负载因子达到阈值时一次性重建，插入第 n 个元素的那一次要搬动全部 n 个元素，表越大停顿越长
+（2）渐进式扩容把搬迁拆成小步：新表建好后，每次插入、删除顺带迁移旧表的 4 个槽位
+（3）新表容量为旧表两倍，旧表共 C 个槽位、最多 7C/8 个元素，迁完需要 C / 4 次写操作，
+    期间新表最多增加 C / 4 个元素，合计 9C/8 小于新表上限 7C/4，迁移期间新表不会因元素数再扩容；
+    但分片仍可能整表重建：删除留下的墓碑耗尽新表的 growth_left 时，hasht 会在那次插入中原地重建新表，
+    渐进式扩容消除的只是容量翻倍时的停顿
+（4）代价是迁移期间查找可能要查两张表，内存短时间内同时占用新旧两张表
+*/
+
+// 分片：一把读写锁保护当前表与迁移中的旧表
+typedef struct {
+    _Alignas(64) pthread_rwlock_t lock;
+    hasht table;        // 接收插入的表
+    hasht old;          // 正在迁出的旧表，capacity 为 0 表示没有迁移
+    size_t migrate_pos; // 旧表的迁移位置
+} shardht_shard;
+
+struct shardht {
+    shardht_shard *shards;
+    unsigned shard_mask;
+    size_t key_size;
+    size_t value_size;
+    hasht_hash_fn hash;
+    uint64_t seed;
+};
+
+// 分片用哈希值的第 32 位起，hasht 组内定位用低位、控制字节用高 7 位，三者互不相关
+static inline shardht_shard *shard_of(const shardht *m, uint64_t hash) {
+    return &m->shards[(hash >> 32) & m->shard_mask];
+}
+
+static inline bool migrating(const shardht_shard *s) {
+    return s->old.capacity != 0;
+}
+
+// 迁移一小步，迁完释放旧表
+// 申请内存失败时保留旧表，未迁出的元素仍可从旧表查到，下次写操作从失败的槽位重试
+static bool migrate_step(shardht_shard *s) {
+    if (!hasht_migrate(&s->old, &s->table, &s->migrate_pos, SHARDHT_MIGRATE_SLOTS)) {
+        return false;
+    }
+    if (s->migrate_pos == s->old.capacity) {
+        hasht_free(&s->old);
+        s->migrate_pos = 0;
+    }
+    return true;
+}
+
+// 当前表没有空槽时开始迁移：当前表转为旧表，新建两倍容量的表
+static bool start_migration(shardht_shard *s) {
+    hasht fresh;
+    hasht_init(&fresh, s->table.key_size, s->table.value_size, s->table.hash, s->table.seed);
+    // 按元素数而不是容量翻倍，墓碑多时新表不必变大
+    size_t count = s->table.size * 2 > HASHT_GROUP_WIDTH ? s->table.size * 2 : HASHT_GROUP_WIDTH;
+    if (!hasht_reserve(&fresh, count)) {
+        return false;
+    }
+    s->old = s->table;
+    s->table = fresh;
+    s->migrate_pos = 0;
+    return true;
+}
+
+shardht *shardht_create(size_t key_size, size_t value_size, hasht_hash_fn hash, uint64_t seed, unsigned shards) {
+    unsigned count = 1;
+    while (count < (shards ? shards : SHARDHT_DEFAULT_SHARDS)) {
+        count *= 2;
+    }
+
+    shardht *m = malloc(sizeof(shardht));
+    shardht_shard *array = aligned_alloc(64, count * sizeof(shardht_shard));
+    if (!m || !array) {
+        free(m);
+        free(array);
+        return NULL;
+    }
+
+    m->shards = array;
+    m->shard_mask = count - 1;
+    m->key_size = key_size;
+    m->value_size = value_size;
+    m->hash = hash ? hash : hasht_hash_murmur3;
+    m->seed = seed;
+    for (unsigned i = 0; i < count; i++) {
+        shardht_shard *s = &array[i];
+        pthread_rwlock_init(&s->lock, NULL);
+        hasht_init(&s->table, key_size, value_size, m->hash, seed);
+        hasht_init(&s->old, key_size, value_size, m->hash, seed);
+        s->migrate_pos = 0;
+    }
+    return m;
+}
+
+void shardht_destroy(shardht *m) {
+    if (!m) {
+        return;
+    }
+    for (unsigned i = 0; i <= m->shard_mask; i++) {
+        shardht_shard *s = &m->shards[i];
+        hasht_free(&s->table);
+        hasht_free(&s->old);
+        pthread_rwlock_destroy(&s->lock);
+    }
+    free(m->shards);
+    free(m);
+}
+
+bool shardht_insert(shardht *m, const void *key, const void *value) {
+    uint64_t hash = m->hash(key, m->key_size, m->seed);
+    shardht_shard *s = shard_of(m, hash);
+    bool ok = true;
+
+    pthread_rwlock_wrlock(&s->lock);
+    if (!migrating(s) && s->table.growth_left == 0) {
+        // 再插入一个新键就会触发整表重建，改为渐进式迁移
+        if (!hasht_find_hash(&s->table, key, hash)) {
+            ok = start_migration(s);
+        }
+    }
+    ok = ok && hasht_insert_hash(&s->table, key, value, hash) != NULL;
+    if (ok && migrating(s)) {
+        // 插入成功后再删掉旧表中的键，保证一个键只在一张表里，插入失败时旧值仍在
+        hasht_erase_hash(&s->old, key, hash);
+        migrate_step(s);
+    }
+    pthread_rwlock_unlock(&s->lock);
+
+    return ok;
+}
+
+bool shardht_find(shardht *m, const void *key, void *value) {
+    uint64_t hash = m->hash(key, m->key_size, m->seed);
+    shardht_shard *s = shard_of(m, hash);
+
+    pthread_rwlock_rdlock(&s->lock);
+    void *found = hasht_find_hash(&s->table, key, hash);
+    if (!found && migrating(s)) {
+        found = hasht_find_hash(&s->old, key, hash);
+    }
+    if (found && value) {
+        memcpy(value, found, m->value_size);
+    }
+    pthread_rwlock_unlock(&s->lock);
+
+    return found != NULL;
+}
+
+bool shardht_erase(shardht *m, const void *key) {
+    uint64_t hash = m->hash(key, m->key_size, m->seed);
+    shardht_shard *s = shard_of(m, hash);
+
+    pthread_rwlock_wrlock(&s->lock);
+    bool erased = hasht_erase_hash(&s->table, key, hash);
+    if (migrating(s)) {
+        erased = erased || hasht_erase_hash(&s->old, key, hash);
+        migrate_step(s);
+    }
+    pthread_rwlock_unlock(&s->lock);
+
+    return erased;
+}
+
+size_t shardht_size(shardht *m) {
+    size_t size = 0;
+    for (unsigned i = 0; i <= m->shard_mask; i++) {
+        shardht_shard *s = &m->shards[i];
+        pthread_rwlock_rdlock(&s->lock);
+        size += hasht_size(&s->table) + hasht_size(&s->old);
+        pthread_rwlock_unlock(&s->lock);
+    }
+    return size;
+}
+
+#ifdef SHARDHT_MAIN
+// 多线程各自操作不相交的键区间，结束后逐个校验
+typedef struct {
+    shardht *map;
+    uint64_t begin;
+    uint64_t end;
+} check_range;
+
+static void *check_worker(void *arg) {
+    check_range *r = arg;
+    for (uint64_t k = r->begin; k < r->end; k++) {
+        uint64_t v = k * 3;
+        shardht_insert(r->map, &k, &v);
+    }
+    // 删除奇数键
+    for (uint64_t k = r->begin | 1; k < r->end; k += 2) {
+        shardht_erase(r->map, &k);
+    }
+    return NULL;
+}
+
+int main(void) {
+
+    // 示例1：8 个线程并发插入、删除，单分片使迁移与锁竞争最频繁
+    enum { THREADS = 8, PER_THREAD = 200000 };
+    int failed = 0;
+    unsigned shard_counts[] = {1, SHARDHT_DEFAULT_SHARDS};
+    for (int c = 0; c < 2; c++) {
+        shardht *map = shardht_create(sizeof(uint64_t), sizeof(uint64_t), NULL, 0, shard_counts[c]);
+        pthread_t threads[THREADS];
+        check_range ranges[THREADS];
+        for (int i = 0; i < THREADS; i++) {
+            ranges[i] = (check_range){map, (uint64_t)i * PER_THREAD, (uint64_t)(i + 1) * PER_THREAD};
+            pthread_create(&threads[i], NULL, check_worker, &ranges[i]);
+        }
+        for (int i = 0; i < THREADS; i++) {
+            pthread_join(threads[i], NULL);
+        }
+
+        // 示例2：校验偶数键的值与奇数键已删除
+        for (uint64_t k = 0; k < THREADS * PER_THREAD; k++) {
+            uint64_t v = 0;
+            bool found = shardht_find(map, &k, &v);
+            if (found != !(k & 1) || (found && v != k * 3)) {
+                printf("mismatch key %llu\n", (unsigned long long)k);
+                failed = 1;
+                break;
+            }
+        }
+        printf("shards %u size %zu check %s\n", shard_counts[c], shardht_size(map),
+               failed ? "FAILED" : "ok");
+        shardht_destroy(map);
+    }
+
+    return failed;
+}
+#endif
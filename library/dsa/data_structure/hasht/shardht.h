@@ -0,0 +1,86 @@
+#ifndef DSA_HASHT_SHARDHT_H
+#define DSA_HASHT_SHARDHT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hasht.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+分片并发哈希表
+（1）按哈希值的第 32 位起选分片，每个分片一把读写锁，不同分片上的操作互不阻塞，查找只加读锁
+（2）分片内是一张 hasht，即将扩容时不在一次插入中重建整张表，而是像 Redis 一样
+    新建一张两倍大小的表，之后每次写操作顺带迁移 SHARDHT_MIGRATE_SLOTS 个槽位，迁完后释放旧表；
+    墓碑过多时分片内的表仍会在一次插入中原地重建
+（3）迁移期间插入只进新表，查找、删除先查新表再查旧表，一个键只会存在于其中一张表
+*/
+
+// 默认分片数
+#define SHARDHT_DEFAULT_SHARDS 64
+// 每次写操作顺带迁移的槽位数，越小单次操作的尾延迟越低，但至少为 2，否则迁完前新表会被填满
+#define SHARDHT_MIGRATE_SLOTS 4
+
+typedef struct shardht shardht;
+
+/**
+* @brief             创建分片哈希表
+* @param   key_size  键的字节数
+* @param   value_size 值的字节数
+* @param   hash      哈希函数，NULL 时使用 hasht_hash_murmur3
+* @param   seed      哈希种子
+* @param   shards    分片数，向上取整为 2 的幂，0 时使用 SHARDHT_DEFAULT_SHARDS
+* @return  shardht*  申请内存失败返回 NULL
+*
+* @note              Revision History
+*/
+shardht *shardht_create(size_t key_size, size_t value_size, hasht_hash_fn hash, uint64_t seed, unsigned shards);
+
+/**
+* @brief             销毁，调用时不能有其他线程在使用
+*
+* @note              Revision History
+*/
+void shardht_destroy(shardht *m);
+
+/**
+* @brief             插入或覆盖
+* @return  bool      申请内存失败返回 false
+*
+* @note              线程安全
+*/
+bool shardht_insert(shardht *m, const void *key, const void *value);
+
+/**
+* @brief             查找并把值拷贝到 value
+* @param   value     输出缓冲区，value_size 字节，可为 NULL
+* @return  bool      键不存在返回 false
+*
+* @note              解锁后表内地址可能失效，所以拷贝输出
+*/
+bool shardht_find(shardht *m, const void *key, void *value);
+
+/**
+* @brief             删除
+* @return  bool      键不存在返回 false
+*
+* @note              线程安全
+*/
+bool shardht_erase(shardht *m, const void *key);
+
+/**
+* @brief             元素总数，并发修改时为近似值
+*
+* @note              Revision History
+*/
+size_t shardht_size(shardht *m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_HASHT_SHARDHT_H
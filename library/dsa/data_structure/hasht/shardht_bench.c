@@ -0,0 +1,169 @@
+// shardht 性能测试
+// （1）扩容期间的插入延迟分布：整表重建的 hasht 与渐进式迁移的 shardht 对比 p50/p99/p99.9/max
+// （2）1~32 线程的吞吐：全局读写锁包一张 hasht（uthash/tests/threads 的做法）与分片表对比
+// 用法：./shardht_bench [插入元素数] [最大线程数]
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hashalg.h"
+#include "hasht.h"
+#include "shardht.h"
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void print_latency(const char *name, uint32_t *lat, size_t n) {
+    qsort(lat, n, sizeof(uint32_t), compare_u32);
+    printf("%-24s p50 %6u  p99 %6u  p99.9 %8u  max %10u  (ns)\n", name, lat[n / 2],
+           lat[n * 99 / 100], lat[n * 999 / 1000], lat[n - 1]);
+}
+
+// 单线程从空表插入 n 个键，逐个记录耗时，期间经历多次扩容
+static void latency_bench(size_t n) {
+    uint32_t *lat = malloc(n * sizeof(uint32_t));
+
+    hasht t;
+    hasht_init(&t, sizeof(uint64_t), sizeof(uint64_t), NULL, 0);
+    uint64_t state = 1;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t key = splitmix64(&state);
+        uint64_t start = now_ns();
+        hasht_insert(&t, &key, &key);
+        lat[i] = (uint32_t)(now_ns() - start);
+    }
+    hasht_free(&t);
+    print_latency("hasht (stop-the-world)", lat, n);
+
+    unsigned shard_counts[] = {1, SHARDHT_DEFAULT_SHARDS};
+    for (int c = 0; c < 2; c++) {
+        shardht *m = shardht_create(sizeof(uint64_t), sizeof(uint64_t), NULL, 0, shard_counts[c]);
+        state = 1;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t key = splitmix64(&state);
+            uint64_t start = now_ns();
+            shardht_insert(m, &key, &key);
+            lat[i] = (uint32_t)(now_ns() - start);
+        }
+        shardht_destroy(m);
+        char name[32];
+        snprintf(name, sizeof(name), "shardht %u shard%s", shard_counts[c], c ? "s" : "");
+        print_latency(name, lat, n);
+    }
+    free(lat);
+}
+
+// 全局读写锁包一张 hasht 作为对照
+typedef struct {
+    pthread_rwlock_t lock;
+    hasht table;
+} locked_table;
+
+typedef struct {
+    shardht *sharded;
+    locked_table *locked;
+    uint64_t key_space;
+    size_t ops;
+    uint64_t seed;
+} worker_arg;
+
+// 80% 查找、10% 插入、10% 删除，键在 key_space 内均匀分布
+static void *worker(void *p) {
+    worker_arg *w = p;
+    uint64_t state = w->seed;
+    uint64_t value = 0;
+    for (size_t i = 0; i < w->ops; i++) {
+        uint64_t r = splitmix64(&state);
+        uint64_t key = (r >> 8) % w->key_space;
+        unsigned op = (unsigned)(r & 0xff) % 10;
+        if (w->sharded) {
+            if (op < 8) {
+                shardht_find(w->sharded, &key, &value);
+            } else if (op == 8) {
+                shardht_insert(w->sharded, &key, &key);
+            } else {
+                shardht_erase(w->sharded, &key);
+            }
+        } else {
+            locked_table *lt = w->locked;
+            if (op < 8) {
+                pthread_rwlock_rdlock(&lt->lock);
+                uint64_t *found = hasht_find(&lt->table, &key);
+                value += found ? *found : 0;
+                pthread_rwlock_unlock(&lt->lock);
+            } else {
+                pthread_rwlock_wrlock(&lt->lock);
+                if (op == 8) {
+                    hasht_insert(&lt->table, &key, &key);
+                } else {
+                    hasht_erase(&lt->table, &key);
+                }
+                pthread_rwlock_unlock(&lt->lock);
+            }
+        }
+    }
+    return (void *)(uintptr_t)value;
+}
+
+static double run_threads(shardht *sharded, locked_table *locked, int threads, uint64_t key_space,
+                          size_t ops_per_thread) {
+    pthread_t tids[threads];
+    worker_arg args[threads];
+    uint64_t start = now_ns();
+    for (int i = 0; i < threads; i++) {
+        args[i] = (worker_arg){sharded, locked, key_space, ops_per_thread, (uint64_t)i + 7};
+        pthread_create(&tids[i], NULL, worker, &args[i]);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    double seconds = (double)(now_ns() - start) / 1e9;
+    return (double)threads * (double)ops_per_thread / seconds / 1e6;
+}
+
+static void throughput_bench(int max_threads) {
+    const uint64_t key_space = 2000000;
+    const size_t ops_per_thread = 2000000;
+
+    printf("\n%8s %16s %16s   (Mops/s, 80%% find / 10%% insert / 10%% erase)\n", "threads",
+           "global rwlock", "shardht");
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        // 两种表都预先填入一半键
+        locked_table locked;
+        pthread_rwlock_init(&locked.lock, NULL);
+        hasht_init(&locked.table, sizeof(uint64_t), sizeof(uint64_t), NULL, 0);
+        shardht *sharded = shardht_create(sizeof(uint64_t), sizeof(uint64_t), NULL, 0, 0);
+        for (uint64_t k = 0; k < key_space; k += 2) {
+            hasht_insert(&locked.table, &k, &k);
+            shardht_insert(sharded, &k, &k);
+        }
+
+        double global = run_threads(NULL, &locked, threads, key_space, ops_per_thread);
+        double shard = run_threads(sharded, NULL, threads, key_space, ops_per_thread);
+        printf("%8d %16.2f %16.2f\n", threads, global, shard);
+
+        hasht_free(&locked.table);
+        pthread_rwlock_destroy(&locked.lock);
+        shardht_destroy(sharded);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+    int max_threads = argc > 2 ? atoi(argv[2]) : 32;
+
+    printf("insert latency while growing to %zu entries\n", n);
+    latency_bench(n);
+    throughput_bench(max_threads);
+    return 0;
+}
@@ -0,0 +1,438 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hashalg.h"
+#include "intern.h"
+
+/*
+一、为什么要驻留
+（1）解析器、日志、配置等场景里同一批标识符反复出现，每次 strdup 一份：每个副本一次 malloc，
+    glibc 每块至少 32 字节（16 字节对齐加 8 字节头），短字符串的开销比内容还大，分散的小块也不利于缓存
+（2）以字符串为键的哈希表（如 uthash 的 HASH_ADD_KEYPTR 用法）每个条目再拷贝一份键，相同的键在多张表中各存一份
+（3）驻留后每个不同的字符串只存一份，之后只传指针或 32 位编号：相等比较是一次整数比较，
+    以编号为键的表键长固定为 4 字节，可以直接用 hasht 或数组
+
+二、内存布局
+（1）arena：字符串紧挨着追加到块中，块用完再申请新块，已分配的块从不移动，所以指针稳定；只能整体释放，不支持删除单个字符串
+（2）超过块大小 1/4 的字符串单独占一块，避免在当前块末尾浪费大量空间
+（3）编号数组 entries 按编号存 (指针, 长度, next)，每个字符串 16 字节，扩容时数组移动，但其中的指针指向 arena，不受影响
+（4）索引表以 64 位哈希值为键、编号为值，槽位 12 字节；hasht 直接用哈希值本身作为键的哈希，不再重复计算
+（5）相比 strdup 加字符串键哈希表，每个不同字符串约省下一次 malloc 的头部与对齐填充，重复出现的字符串不再占内存
+
+三、查找过程
+（1）算一次 xxh3，在 hasht 中按哈希值找到第一个编号，比较长度与内容，不同再沿 next 链继续；64 位哈希值碰撞极少，链通常只有一个节点
+（2）不存在时把内容追加到 arena，分配新编号，若该哈希值已有链则挂到链尾，否则插入索引表
+
+四、并发版本
+（1）与 shardht 相同，按哈希值的第 32 位起选分片，每个分片一个驻留池和一把读写锁，分片结构按缓存行对齐
+（2）解析器输入中绝大多数标识符都已驻留过，先加读锁查找，命中直接返回，多个线程可同时读同一分片
+（3）未命中时换写锁，重新查找一次（两次加锁之间其他线程可能已加入），仍不存在才插入
+（4）编号 = 分片内编号 << 分片位数 | 分片号，按编号取字符串时由低位直接找到分片
+*/
+
+#define INTERN_MIN_ENTRIES 64
+
+struct intern_chunk {
+    intern_chunk *next;
+    size_t used;
+    size_t size;
+    char data[];
+};
+
+// 索引表的键已经是哈希值，直接取出作为 hasht 的哈希
+static uint64_t hash_identity(const void *key, size_t len, uint64_t seed) {
+    (void)len;
+    (void)seed;
+    uint64_t h;
+    memcpy(&h, key, sizeof(h));
+    return h;
+}
+
+static intern_chunk *chunk_new(size_t size) {
+    intern_chunk *c = malloc(sizeof(intern_chunk) + size);
+    if (c) {
+        c->next = NULL;
+        c->used = 0;
+        c->size = size;
+    }
+    return c;
+}
+
+// 在 arena 中复制 len 字节并补 '\0'
+static char *arena_copy(intern_pool *p, const char *s, size_t len) {
+    size_t need = len + 1;
+    intern_chunk *c = p->chunks;
+    if (need > p->chunk_size / 4) {
+        // 大字符串单独一块，挂在当前块之后，当前块继续使用
+        intern_chunk *big = chunk_new(need);
+        if (!big) {
+            return NULL;
+        }
+        if (c) {
+            big->next = c->next;
+            c->next = big;
+        } else {
+            p->chunks = big;
+        }
+        big->used = need;
+        p->arena_bytes += need;
+        memcpy(big->data, s, len);
+        big->data[len] = '\0';
+        return big->data;
+    }
+    if (!c || c->size - c->used < need) {
+        c = chunk_new(p->chunk_size);
+        if (!c) {
+            return NULL;
+        }
+        c->next = p->chunks;
+        p->chunks = c;
+        p->arena_bytes += p->chunk_size;
+    }
+    char *dst = c->data + c->used;
+    c->used += need;
+    memcpy(dst, s, len);
+    dst[len] = '\0';
+    return dst;
+}
+
+bool intern_init(intern_pool *p, size_t chunk_size, uint64_t seed) {
+    memset(p, 0, sizeof(*p));
+    p->chunk_size = chunk_size ? chunk_size : INTERN_DEFAULT_CHUNK;
+    p->seed = seed;
+    return hasht_init(&p->index, sizeof(uint64_t), sizeof(uint32_t), hash_identity, 0);
+}
+
+void intern_free(intern_pool *p) {
+    intern_chunk *c = p->chunks;
+    while (c) {
+        intern_chunk *next = c->next;
+        free(c);
+        c = next;
+    }
+    hasht_free(&p->index);
+    free(p->entries);
+    memset(p, 0, sizeof(*p));
+}
+
+void intern_clear(intern_pool *p) {
+    intern_chunk *keep = NULL;
+    intern_chunk *c = p->chunks;
+    while (c) {
+        intern_chunk *next = c->next;
+        if (!keep && c->size == p->chunk_size) {
+            keep = c;
+        } else {
+            free(c);
+        }
+        c = next;
+    }
+    if (keep) {
+        keep->next = NULL;
+        keep->used = 0;
+    }
+    p->chunks = keep;
+    p->arena_bytes = keep ? keep->size : 0;
+    p->string_bytes = 0;
+    p->count = 0;
+    hasht_clear(&p->index);
+}
+
+uint64_t intern_hash(const intern_pool *p, const char *s, size_t len) {
+    return xxh3Hash64(s, len, p->seed);
+}
+
+static inline bool entry_equal(const intern_entry *e, const char *s, size_t len) {
+    return e->len == len && memcmp(e->str, s, len) == 0;
+}
+
+uint32_t intern_lookup_hash(const intern_pool *p, const char *s, size_t len, uint64_t hash) {
+    const uint32_t *head = hasht_find(&p->index, &hash);
+    if (!head) {
+        return INTERN_NONE;
+    }
+    for (uint32_t id = *head; id != INTERN_NONE; id = p->entries[id].next) {
+        if (entry_equal(&p->entries[id], s, len)) {
+            return id;
+        }
+    }
+    return INTERN_NONE;
+}
+
+uint32_t intern_lookup(const intern_pool *p, const char *s, size_t len) {
+    return intern_lookup_hash(p, s, len, intern_hash(p, s, len));
+}
+
+// 已知不存在时插入
+static uint32_t intern_add_hash(intern_pool *p, const char *s, size_t len, uint64_t hash) {
+    if (len >= UINT32_MAX || p->count >= INTERN_NONE) {
+        return INTERN_NONE;
+    }
+    if (p->count == p->capacity) {
+        size_t capacity = p->capacity ? p->capacity * 2 : INTERN_MIN_ENTRIES;
+        capacity = capacity > INTERN_NONE ? INTERN_NONE : capacity;
+        intern_entry *entries = realloc(p->entries, capacity * sizeof(intern_entry));
+        if (!entries) {
+            return INTERN_NONE;
+        }
+        p->entries = entries;
+        p->capacity = capacity;
+    }
+
+    uint32_t id = (uint32_t)p->count;
+    uint32_t *head = hasht_find(&p->index, &hash);
+    if (!head && !hasht_insert(&p->index, &hash, &id)) {
+        return INTERN_NONE;
+    }
+    const char *str = arena_copy(p, s, len);
+    if (!str) {
+        if (!head) {
+            hasht_erase(&p->index, &hash);
+        }
+        return INTERN_NONE;
+    }
+    if (head) {
+        // 64 位哈希值碰撞，挂到链尾
+        uint32_t tail = *head;
+        while (p->entries[tail].next != INTERN_NONE) {
+            tail = p->entries[tail].next;
+        }
+        p->entries[tail].next = id;
+    }
+    p->entries[id] = (intern_entry){.str = str, .len = (uint32_t)len, .next = INTERN_NONE};
+    p->count++;
+    p->string_bytes += len + 1;
+    return id;
+}
+
+static uint32_t intern_id_hash(intern_pool *p, const char *s, size_t len, uint64_t hash) {
+    uint32_t id = intern_lookup_hash(p, s, len, hash);
+    return id != INTERN_NONE ? id : intern_add_hash(p, s, len, hash);
+}
+
+uint32_t intern_id(intern_pool *p, const char *s, size_t len) {
+    return intern_id_hash(p, s, len, intern_hash(p, s, len));
+}
+
+const char *intern_str(intern_pool *p, const char *s, size_t len) {
+    uint32_t id = intern_id(p, s, len);
+    return id == INTERN_NONE ? NULL : p->entries[id].str;
+}
+
+size_t intern_memory(const intern_pool *p) {
+    return p->arena_bytes + p->capacity * sizeof(intern_entry) +
+           p->index.capacity * (p->index.slot_size + 1);
+}
+
+// 分片：一把读写锁保护一个驻留池
+typedef struct {
+    _Alignas(64) pthread_rwlock_t lock;
+    intern_pool pool;
+} intern_shard;
+
+struct intern_concurrent {
+    intern_shard *shards;
+    unsigned shard_bits;
+    uint64_t seed;
+};
+
+intern_concurrent *intern_concurrent_create(unsigned shards, uint64_t seed) {
+    unsigned bits = 0;
+    while ((1u << bits) < (shards ? shards : 64) && bits < 16) {
+        bits++;
+    }
+    unsigned count = 1u << bits;
+
+    intern_concurrent *c = malloc(sizeof(intern_concurrent));
+    intern_shard *array = aligned_alloc(64, count * sizeof(intern_shard));
+    if (!c || !array) {
+        free(c);
+        free(array);
+        return NULL;
+    }
+    c->shards = array;
+    c->shard_bits = bits;
+    c->seed = seed;
+    for (unsigned i = 0; i < count; i++) {
+        pthread_rwlock_init(&array[i].lock, NULL);
+        // 各分片的种子相同，分片只由哈希值决定
+        intern_init(&array[i].pool, 0, seed);
+    }
+    return c;
+}
+
+void intern_concurrent_destroy(intern_concurrent *c) {
+    if (!c) {
+        return;
+    }
+    for (unsigned i = 0; i < 1u << c->shard_bits; i++) {
+        intern_free(&c->shards[i].pool);
+        pthread_rwlock_destroy(&c->shards[i].lock);
+    }
+    free(c->shards);
+    free(c);
+}
+
+const char *intern_concurrent_str(intern_concurrent *c, const char *s, size_t len, uint32_t *id) {
+    uint64_t hash = xxh3Hash64(s, len, c->seed);
+    unsigned shard = (unsigned)(hash >> 32) & ((1u << c->shard_bits) - 1);
+    intern_shard *sh = &c->shards[shard];
+    const char *str = NULL;
+
+    pthread_rwlock_rdlock(&sh->lock);
+    uint32_t local = intern_lookup_hash(&sh->pool, s, len, hash);
+    if (local != INTERN_NONE) {
+        str = sh->pool.entries[local].str;
+    }
+    pthread_rwlock_unlock(&sh->lock);
+
+    if (!str) {
+        pthread_rwlock_wrlock(&sh->lock);
+        local = intern_id_hash(&sh->pool, s, len, hash);
+        // 编号左移后必须仍小于 INTERN_NONE
+        if (local != INTERN_NONE && local >> (32 - c->shard_bits) == 0) {
+            str = sh->pool.entries[local].str;
+        }
+        pthread_rwlock_unlock(&sh->lock);
+    }
+    if (id) {
+        *id = str ? local << c->shard_bits | shard : INTERN_NONE;
+    }
+    return str;
+}
+
+const char *intern_concurrent_get(intern_concurrent *c, uint32_t id, size_t *len) {
+    if (id == INTERN_NONE) {
+        return NULL;
+    }
+    intern_shard *sh = &c->shards[id & ((1u << c->shard_bits) - 1)];
+    uint32_t local = id >> c->shard_bits;
+    const char *str = NULL;
+
+    pthread_rwlock_rdlock(&sh->lock);
+    if (local < sh->pool.count) {
+        str = sh->pool.entries[local].str;
+        if (len) {
+            *len = sh->pool.entries[local].len;
+        }
+    }
+    pthread_rwlock_unlock(&sh->lock);
+
+    return str;
+}
+
+size_t intern_concurrent_count(intern_concurrent *c) {
+    size_t count = 0;
+    for (unsigned i = 0; i < 1u << c->shard_bits; i++) {
+        pthread_rwlock_rdlock(&c->shards[i].lock);
+        count += c->shards[i].pool.count;
+        pthread_rwlock_unlock(&c->shards[i].lock);
+    }
+    return count;
+}
+
+size_t intern_concurrent_memory(intern_concurrent *c) {
+    size_t bytes = (sizeof(intern_shard) << c->shard_bits) + sizeof(intern_concurrent);
+    for (unsigned i = 0; i < 1u << c->shard_bits; i++) {
+        pthread_rwlock_rdlock(&c->shards[i].lock);
+        bytes += intern_memory(&c->shards[i].pool);
+        pthread_rwlock_unlock(&c->shards[i].lock);
+    }
+    return bytes;
+}
+
+#ifdef INTERN_MAIN
+
+typedef struct {
+    intern_concurrent *pool;
+    const char *const *words;
+    size_t count;
+    const char **out;
+} intern_worker;
+
+static void *intern_worker_run(void *arg) {
+    intern_worker *w = arg;
+    for (size_t i = 0; i < w->count; i++) {
+        w->out[i] = intern_concurrent_str(w->pool, w->words[i], strlen(w->words[i]), NULL);
+    }
+    return NULL;
+}
+
+int main(void) {
+    int failed = 0;
+
+    // 示例1：相同内容返回相同指针与编号，比较只需比较指针
+    intern_pool pool;
+    intern_init(&pool, 0, 0);
+    const char *src = "sin cos sin pow sin cos sqrt";
+    const char *prev[8] = {0};
+    size_t n = 0;
+    for (const char *p = src; *p;) {
+        const char *end = strchr(p, ' ');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        prev[n++] = intern_str(&pool, p, len);
+        p += len + (end != NULL);
+    }
+    failed |= intern_count(&pool) != 4;
+    failed |= prev[0] != prev[2] || prev[0] != prev[4] || prev[1] != prev[5] || prev[0] == prev[1];
+    failed |= strcmp(prev[6], "sqrt") != 0;
+    uint32_t sin_id = intern_lookup(&pool, "sin", 3);
+    failed |= sin_id != 0 || intern_get(&pool, sin_id) != prev[0] || intern_lookup(&pool, "tan", 3) != INTERN_NONE;
+    printf("%zu distinct of %zu, sin id %u, %zu bytes of strings, %zu bytes in total\n", intern_count(&pool), n,
+           sin_id, pool.string_bytes, intern_memory(&pool));
+
+    // 加入大量字符串后，早先返回的指针仍然有效
+    char buf[32];
+    for (int i = 0; i < 100000; i++) {
+        size_t len = (size_t)snprintf(buf, sizeof(buf), "ident_%d", i % 50000);
+        uint32_t id = intern_id(&pool, buf, len);
+        failed |= id != (uint32_t)(4 + i % 50000) || strcmp(intern_get(&pool, id), buf) != 0;
+    }
+    failed |= strcmp(prev[0], "sin") != 0 || intern_str(&pool, "sin", 3) != prev[0];
+    // 含 '\0' 的内容与长度不同的前缀是不同的字符串
+    failed |= intern_id(&pool, "a\0b", 3) == intern_id(&pool, "a", 1);
+    intern_clear(&pool);
+    failed |= intern_count(&pool) != 0 || intern_id(&pool, "x", 1) != 0;
+    intern_free(&pool);
+
+    // 示例2：4 个线程同时驻留同一批字符串，得到的指针完全相同
+    enum { WORDS = 20000, THREADS = 4 };
+    char (*text)[16] = malloc(WORDS * sizeof(*text));
+    const char **words = malloc(WORDS * sizeof(char *));
+    const char **out = malloc(THREADS * WORDS * sizeof(char *));
+    for (int i = 0; i < WORDS; i++) {
+        snprintf(text[i], sizeof(text[i]), "w%d", i % 5000);
+        words[i] = text[i];
+    }
+    intern_concurrent *shared = intern_concurrent_create(8, 0);
+    pthread_t tids[THREADS];
+    intern_worker ws[THREADS];
+    for (int t = 0; t < THREADS; t++) {
+        ws[t] = (intern_worker){.pool = shared, .words = words, .count = WORDS, .out = out + t * WORDS};
+        pthread_create(&tids[t], NULL, intern_worker_run, &ws[t]);
+    }
+    for (int t = 0; t < THREADS; t++) {
+        pthread_join(tids[t], NULL);
+    }
+    for (int i = 0; i < WORDS; i++) {
+        failed |= out[i] == NULL || strcmp(out[i], words[i]) != 0;
+        for (int t = 1; t < THREADS; t++) {
+            failed |= out[t * WORDS + i] != out[i];
+        }
+    }
+    uint32_t id;
+    const char *w = intern_concurrent_str(shared, "w42", 3, &id);
+    size_t len = 0;
+    failed |= intern_concurrent_get(shared, id, &len) != w || len != 3;
+    printf("concurrent: %zu distinct, %zu bytes, check %s\n", intern_concurrent_count(shared),
+           intern_concurrent_memory(shared), failed ? "FAILED" : "ok");
+
+    intern_concurrent_destroy(shared);
+    free(text);
+    free(words);
+    free(out);
+    return failed;
+}
+#endif
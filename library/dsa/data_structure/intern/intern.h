@@ -0,0 +1,174 @@
+#ifndef DSA_INTERN_INTERN_H
+#define DSA_INTERN_INTERN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hasht.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+字符串驻留池（string interning）
+（1）每个不同的字符串只存一份，依次追加在大块连续内存（arena）中，块一旦分配不再移动，返回的指针在池释放前一直有效
+（2）每个字符串有一个从 0 开始连续分配的 32 位编号，可以代替字符串作为其他哈希表、数组的键
+（3）同一个池返回的两个字符串相同当且仅当指针（或编号）相同，比较不再需要 strcmp
+（4）索引是一张 hasht：64 位 xxh3 哈希值 -> 第一个该哈希值的编号，哈希值相同的不同字符串用 next 链接
+（5）intern_concurrent 按哈希值分片，每个分片一个池和一把读写锁，已存在的字符串只加读锁，适合多线程解析器共享符号表
+*/
+
+// 无效编号
+#define INTERN_NONE UINT32_MAX
+// 默认的 arena 块大小
+#define INTERN_DEFAULT_CHUNK (64 * 1024)
+
+// 编号对应的字符串
+typedef struct {
+    const char *str;    // 指向 arena，以 '\0' 结尾
+    uint32_t len;
+    uint32_t next;      // 哈希值相同的下一个编号，INTERN_NONE 结束
+} intern_entry;
+
+typedef struct intern_chunk intern_chunk;
+
+typedef struct {
+    hasht index;            // 哈希值 -> 编号
+    intern_entry *entries;  // 编号 -> 字符串
+    size_t count;
+    size_t capacity;
+    intern_chunk *chunks;   // 当前块在链表头
+    size_t chunk_size;
+    size_t arena_bytes;     // 所有块的字节数
+    size_t string_bytes;    // 字符串本身的字节数，含结尾 '\0'
+    uint64_t seed;
+} intern_pool;
+
+/**
+* @brief             初始化
+* @param   chunk_size arena 块的字节数，0 时使用 INTERN_DEFAULT_CHUNK
+* @param   seed      哈希种子
+* @return  bool      申请内存失败返回 false
+*
+* @note              Revision History
+*/
+bool intern_init(intern_pool *p, size_t chunk_size, uint64_t seed);
+
+/**
+* @brief             释放，之前返回的指针全部失效
+*
+* @note              Revision History
+*/
+void intern_free(intern_pool *p);
+
+/**
+* @brief             清空，保留第一个 arena 块与各数组的容量
+*
+* @note              之前返回的指针与编号全部失效
+*/
+void intern_clear(intern_pool *p);
+
+/**
+* @brief             驻留一个字符串，不存在时加入
+* @param   s         字符串，不要求以 '\0' 结尾，可以包含 '\0'
+* @param   len       字节数，不超过 UINT32_MAX - 1
+* @return  uint32_t  编号，申请内存失败返回 INTERN_NONE
+*
+* @note              Revision History
+*/
+uint32_t intern_id(intern_pool *p, const char *s, size_t len);
+
+/**
+* @brief             驻留一个字符串，返回池内的指针
+* @return  const char* 以 '\0' 结尾，申请内存失败返回 NULL
+*
+* @note              相同内容返回相同指针
+*/
+const char *intern_str(intern_pool *p, const char *s, size_t len);
+
+/**
+* @brief             只查找不加入
+* @return  uint32_t  编号，不存在返回 INTERN_NONE
+*
+* @note              hash 为 intern_hash 的结果，调用者已算过哈希值时可省去一次计算
+*/
+uint32_t intern_lookup_hash(const intern_pool *p, const char *s, size_t len, uint64_t hash);
+uint32_t intern_lookup(const intern_pool *p, const char *s, size_t len);
+
+/**
+* @brief             加入时使用的哈希值
+*
+* @note              Revision History
+*/
+uint64_t intern_hash(const intern_pool *p, const char *s, size_t len);
+
+// 编号对应的字符串与长度，编号必须有效
+static inline const char *intern_get(const intern_pool *p, uint32_t id) {
+    return p->entries[id].str;
+}
+
+static inline size_t intern_len(const intern_pool *p, uint32_t id) {
+    return p->entries[id].len;
+}
+
+static inline size_t intern_count(const intern_pool *p) {
+    return p->count;
+}
+
+/**
+* @brief             池占用的总字节数
+*
+* @note              arena 块、编号数组与索引表的容量之和，不含 malloc 自身的开销
+*/
+size_t intern_memory(const intern_pool *p);
+
+typedef struct intern_concurrent intern_concurrent;
+
+/**
+* @brief             创建多线程共享的驻留池
+* @param   shards    分片数，向上取整为 2 的幂，0 时使用 64
+* @return  intern_concurrent* 申请内存失败返回 NULL
+*
+* @note              编号低位为分片号，不再连续，但仍在 32 位内且互不相同
+*/
+intern_concurrent *intern_concurrent_create(unsigned shards, uint64_t seed);
+
+/**
+* @brief             销毁，调用时不能有其他线程在使用
+*
+* @note              Revision History
+*/
+void intern_concurrent_destroy(intern_concurrent *c);
+
+/**
+* @brief             驻留一个字符串，线程安全
+* @param   id        输出编号，可为 NULL
+* @return  const char* 池内指针，所有线程对相同内容得到相同指针；申请内存失败返回 NULL
+*
+* @note              先加读锁查找，不存在时再加写锁插入
+*/
+const char *intern_concurrent_str(intern_concurrent *c, const char *s, size_t len, uint32_t *id);
+
+/**
+* @brief             编号对应的字符串，线程安全
+* @return  const char* 编号无效返回 NULL
+*
+* @note              Revision History
+*/
+const char *intern_concurrent_get(intern_concurrent *c, uint32_t id, size_t *len);
+
+/**
+* @brief             字符串总数与占用字节数，并发修改时为近似值
+*
+* @note              Revision History
+*/
+size_t intern_concurrent_count(intern_concurrent *c);
+size_t intern_concurrent_memory(intern_concurrent *c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_INTERN_INTERN_H
@@ -0,0 +1,269 @@
+// 字符串驻留池性能测试：标识符流按 Zipf(1.0) 从词表中抽取，模拟解析器的词法输出
+// （1）每个词 strdup 一份（AST 节点复制函数名的做法）、uthash 以字符串为键去重（键 strdup 一份）、驻留池，三者的耗时与内存
+// （2）建好后只查找的耗时：uthash HASH_FIND 与 intern_lookup
+// （3）相邻两个词的相等比较：strcmp 与指针比较
+// （4）多线程共享的并发驻留池，各线程处理一段流，结果与单线程驻留池逐个比较内容
+// 内存取 glibc mallinfo2 的已分配字节数（含 mmap 的大块）之差，包含 malloc 自身的头部与对齐
+// 用法：./intern_bench [词数] [线程数]，默认 10M、4 线程
+#include <malloc.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hashalg.h"
+#include "intern.h"
+#include "uthash.h"
+
+#define VOCAB 200000
+
+static inline double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// 已分配字节数，大块由 mmap 分配，单独统计
+static inline size_t heap_used(void) {
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+// 词流：所有词依次存放在一段文本中，token 记录起点与长度，与词法分析器的输出相同，同一个词每次出现都是不同的地址
+typedef struct {
+    uint32_t offset;
+    uint32_t len;
+} token;
+
+// 词表：长 2~24 的标识符，字母、数字、下划线
+static char **make_vocab(void) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+    char **vocab = malloc(VOCAB * sizeof(char *));
+    uint64_t state = 7;
+    for (size_t i = 0; i < VOCAB; i++) {
+        size_t len = 2 + splitmix64(&state) % 23;
+        vocab[i] = malloc(len + 1);
+        vocab[i][0] = alphabet[splitmix64(&state) % 53];
+        for (size_t j = 1; j < len; j++) {
+            vocab[i][j] = alphabet[splitmix64(&state) % 63];
+        }
+        vocab[i][len] = '\0';
+    }
+    return vocab;
+}
+
+// Zipf(1.0)：按累积分布二分查找
+static token *make_stream(char **vocab, size_t n, char **text_out) {
+    double *cdf = malloc(VOCAB * sizeof(double));
+    double sum = 0;
+    for (size_t k = 0; k < VOCAB; k++) {
+        sum += 1.0 / (double)(k + 1);
+        cdf[k] = sum;
+    }
+    token *tokens = malloc(n * sizeof(token));
+    size_t cap = n * 8, used = 0;
+    char *text = malloc(cap);
+    uint64_t state = 42;
+    for (size_t i = 0; i < n; i++) {
+        double u = (double)(splitmix64(&state) >> 11) / 9007199254740992.0 * sum;
+        size_t lo = 0, hi = VOCAB - 1;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (cdf[mid] < u) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        size_t len = strlen(vocab[lo]);
+        if (used + len + 1 > cap) {
+            cap *= 2;
+            text = realloc(text, cap);
+        }
+        memcpy(text + used, vocab[lo], len);
+        text[used + len] = ' ';
+        tokens[i] = (token){.offset = (uint32_t)used, .len = (uint32_t)len};
+        used += len + 1;
+    }
+    free(cdf);
+    *text_out = text;
+    return tokens;
+}
+
+typedef struct {
+    char *key;
+    UT_hash_handle hh;
+} ut_entry;
+
+typedef struct {
+    intern_concurrent *pool;
+    const char *text;
+    const token *tokens;
+    size_t begin, end;
+    const char **out;
+} worker;
+
+static void *worker_run(void *arg) {
+    worker *w = arg;
+    for (size_t i = w->begin; i < w->end; i++) {
+        w->out[i] = intern_concurrent_str(w->pool, w->text + w->tokens[i].offset, w->tokens[i].len, NULL);
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+    unsigned threads = argc > 2 ? (unsigned)atoi(argv[2]) : 4;
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    char **vocab = make_vocab();
+    char *text;
+    token *tokens = make_stream(vocab, n, &text);
+    size_t text_bytes = 0;
+    for (size_t i = 0; i < n; i++) {
+        text_bytes += tokens[i].len + 1;
+    }
+    printf("%zu tokens, vocabulary %d, %.1f MB of token text\n", n, VOCAB, (double)text_bytes / 1e6);
+    printf("%-28s %10s %12s %14s\n", "", "ns/token", "MB", "bytes/distinct");
+    int failed = 0;
+
+    // 每个词 strdup 一份
+    char **copies = malloc(n * sizeof(char *));
+    size_t before = heap_used();
+    double start = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        copies[i] = strndup(text + tokens[i].offset, tokens[i].len);
+    }
+    double dup_time = now_sec() - start;
+    size_t dup_mem = heap_used() - before;
+    printf("%-28s %10.1f %12.1f %14s\n", "strdup per token", dup_time * 1e9 / (double)n, (double)dup_mem / 1e6, "-");
+
+    // uthash 以字符串为键去重，键 strdup 一份
+    ut_entry *table = NULL;
+    before = heap_used();
+    start = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        ut_entry *e;
+        HASH_FIND(hh, table, text + tokens[i].offset, tokens[i].len, e);
+        if (!e) {
+            e = malloc(sizeof(ut_entry));
+            e->key = strndup(text + tokens[i].offset, tokens[i].len);
+            HASH_ADD_KEYPTR(hh, table, e->key, tokens[i].len, e);
+        }
+    }
+    double ut_time = now_sec() - start;
+    size_t ut_mem = heap_used() - before;
+    size_t distinct = HASH_COUNT(table);
+    printf("%-28s %10.1f %12.1f %14.1f\n", "uthash + strdup key", ut_time * 1e9 / (double)n, (double)ut_mem / 1e6,
+           (double)ut_mem / (double)distinct);
+
+    // 驻留池
+    intern_pool pool;
+    const char **interned = malloc(n * sizeof(char *));
+    before = heap_used();
+    intern_init(&pool, 0, 0);
+    start = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        interned[i] = intern_str(&pool, text + tokens[i].offset, tokens[i].len);
+    }
+    double in_time = now_sec() - start;
+    size_t in_mem = heap_used() - before;
+    failed |= intern_count(&pool) != distinct;
+    printf("%-28s %10.1f %12.1f %14.1f\n", "intern_str", in_time * 1e9 / (double)n, (double)in_mem / 1e6,
+           (double)in_mem / (double)distinct);
+    printf("%zu distinct strings, %.1f MB of string bytes, intern_memory %.1f MB\n\n", distinct,
+           (double)pool.string_bytes / 1e6, (double)intern_memory(&pool) / 1e6);
+
+    // 只查找
+    size_t found = 0;
+    start = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        ut_entry *e;
+        HASH_FIND(hh, table, text + tokens[i].offset, tokens[i].len, e);
+        found += e != NULL;
+    }
+    double ut_find = now_sec() - start;
+    start = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        found += intern_lookup(&pool, text + tokens[i].offset, tokens[i].len) != INTERN_NONE;
+    }
+    double in_find = now_sec() - start;
+    failed |= found != 2 * n;
+    printf("lookup ns/token: uthash %.1f, intern_lookup %.1f\n", ut_find * 1e9 / (double)n, in_find * 1e9 / (double)n);
+
+    // 相邻两个词是否相同
+    size_t same_strcmp = 0, same_ptr = 0;
+    start = now_sec();
+    for (size_t i = 1; i < n; i++) {
+        same_strcmp += strcmp(copies[i - 1], copies[i]) == 0;
+    }
+    double cmp_time = now_sec() - start;
+    start = now_sec();
+    for (size_t i = 1; i < n; i++) {
+        same_ptr += interned[i - 1] == interned[i];
+    }
+    double ptr_time = now_sec() - start;
+    failed |= same_strcmp != same_ptr;
+    printf("equality ns/pair: strcmp %.2f, pointer %.2f (%zu equal pairs)\n\n", cmp_time * 1e9 / (double)n,
+           ptr_time * 1e9 / (double)n, same_ptr);
+
+    // 并发驻留池
+    intern_concurrent *shared = intern_concurrent_create(0, 0);
+    const char **out = malloc(n * sizeof(char *));
+    worker *ws = malloc(threads * sizeof(worker));
+    pthread_t *tids = malloc(threads * sizeof(pthread_t));
+    start = now_sec();
+    for (unsigned t = 0; t < threads; t++) {
+        ws[t] = (worker){.pool = shared, .text = text, .tokens = tokens, .begin = n * t / threads,
+                         .end = n * (t + 1) / threads, .out = out};
+        pthread_create(&tids[t], NULL, worker_run, &ws[t]);
+    }
+    for (unsigned t = 0; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+    }
+    double con_time = now_sec() - start;
+    failed |= intern_concurrent_count(shared) != distinct;
+    // 单线程池中的同一个指针，在并发池中也必须对应同一个指针
+    hasht map;
+    hasht_init(&map, sizeof(char *), sizeof(char *), hasht_hash_xxh3, 0);
+    for (size_t i = 0; i < n; i++) {
+        const char **p = hasht_find(&map, &interned[i]);
+        if (!p) {
+            hasht_insert(&map, &interned[i], &out[i]);
+        } else {
+            failed |= *p != out[i];
+        }
+        failed |= out[i] == NULL || strcmp(out[i], interned[i]) != 0;
+    }
+    printf("intern_concurrent, %u threads: %.1f M tokens/s, %.1f MB\n", threads, (double)n / con_time / 1e6,
+           (double)intern_concurrent_memory(shared) / 1e6);
+    printf("check %s\n", failed ? "FAILED" : "ok");
+
+    hasht_free(&map);
+    intern_concurrent_destroy(shared);
+    intern_free(&pool);
+    ut_entry *e, *tmp;
+    HASH_ITER(hh, table, e, tmp) {
+        HASH_DEL(table, e);
+        free(e->key);
+        free(e);
+    }
+    for (size_t i = 0; i < n; i++) {
+        free(copies[i]);
+    }
+    for (size_t i = 0; i < VOCAB; i++) {
+        free(vocab[i]);
+    }
+    free(copies);
+    free(interned);
+    free(out);
+    free(ws);
+    free(tids);
+    free(vocab);
+    free(tokens);
+    free(text);
+    return failed;
+}
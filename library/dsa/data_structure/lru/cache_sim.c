@@ -0,0 +1,231 @@
+// 缓存 trace 回放：一遍读入 trace，输出 LRU 的完整缺失率曲线与各淘汰策略在若干容量下的缺失率
+// （1）缺失率曲线由重用距离得到（见 mrc.h），SHARDS 采样后内存与时间按采样率缩小，几十亿次访问的 trace 几分钟即可处理完
+// （2）其他策略没有栈性质，每个容量单独模拟；用同样的采样做缩小模拟（miniature simulation）：
+//     采样率为 R 时，只回放被采样的键，容量按 R 缩小，缩小后的缺失率即为原容量的估计；缩小后的容量过小（几十以下）时误差较大，
+//     低于 MIN_SCALED 的容量跳过并给出警告，可用 -r 提高采样率
+//     缺失次数除以期望采样次数 N * R，而不是实际采样次数（SHARDS_adj），热键恰好多采或少采时不致偏差
+// 用法：./cache_sim [-f text|arc|bin64|bin32] [-r 采样率] [-k 样本键数] [-m 最大容量] [-b 直方图格数]
+//                   [-n 曲线点数] [-p 策略,...|none] [-c 容量,...] trace 文件（- 为标准输入）
+// 默认 text 格式、采样率 0.01、最大容量 1M、1000 格、20 个点、全部策略、8 个按对数均匀分布的容量
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cachepolicy.h"
+#include "mrc.h"
+#include "trace.h"
+
+#define MAX_SIZES 32
+#define MAX_POLICIES 8
+#define BATCH 65536
+// 缩小后的容量低于此值时误差过大，不模拟该容量
+#define MIN_SCALED 64
+
+static inline double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s [-f text|arc|bin64|bin32] [-r rate] [-k max_keys] [-m max_size] [-b bins] [-n points]\n"
+            "          [-p policy,...|none] [-c size,...] trace\n",
+            name);
+}
+
+// 逗号分隔的容量
+static size_t parse_sizes(char *arg, size_t *sizes) {
+    size_t n = 0;
+    for (char *tok = strtok(arg, ","); tok && n < MAX_SIZES; tok = strtok(NULL, ",")) {
+        sizes[n++] = strtoull(tok, NULL, 10);
+    }
+    return n;
+}
+
+// 逗号分隔的策略名
+static int parse_policies(char *arg, const cache_policy_ops **ops) {
+    int n = 0;
+    if (strcmp(arg, "none") == 0) {
+        return 0;
+    }
+    for (char *tok = strtok(arg, ","); tok && n < MAX_POLICIES; tok = strtok(NULL, ",")) {
+        ops[n] = cache_policy_find(tok);
+        if (!ops[n]) {
+            fprintf(stderr, "unknown policy %s\n", tok);
+            return -1;
+        }
+        n++;
+    }
+    return n;
+}
+
+int main(int argc, char *argv[]) {
+    trace_format format = TRACE_TEXT;
+    double rate = 0.01;
+    size_t max_keys = 0, max_size = 1000000, bins = 1000, points = 20;
+    size_t sizes[MAX_SIZES], nsizes = 0;
+    const cache_policy_ops *ops[MAX_POLICIES];
+    int npolicies = -1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "f:r:k:m:b:n:p:c:h")) != -1) {
+        switch (opt) {
+        case 'f':
+            if (!trace_format_parse(optarg, &format)) {
+                fprintf(stderr, "unknown trace format %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'r':
+            rate = strtod(optarg, NULL);
+            break;
+        case 'k':
+            max_keys = strtoull(optarg, NULL, 10);
+            break;
+        case 'm':
+            max_size = strtoull(optarg, NULL, 10);
+            break;
+        case 'b':
+            bins = strtoull(optarg, NULL, 10);
+            break;
+        case 'n':
+            points = strtoull(optarg, NULL, 10);
+            break;
+        case 'p':
+            npolicies = parse_policies(optarg, ops);
+            if (npolicies < 0) {
+                return 1;
+            }
+            break;
+        case 'c':
+            nsizes = parse_sizes(optarg, sizes);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (npolicies < 0) {
+        for (npolicies = 0; cache_policy_all[npolicies]; npolicies++) {
+            ops[npolicies] = cache_policy_all[npolicies];
+        }
+    }
+    if (nsizes == 0) {
+        // max_size / 128 到 max_size，每次翻倍
+        for (size_t s = max_size / 128 ? max_size / 128 : 1; s <= max_size && nsizes < 8; s *= 2) {
+            sizes[nsizes++] = s;
+        }
+    }
+
+    shards_mrc mrc;
+    if (!shards_mrc_init(&mrc, rate, max_keys, max_size, bins)) {
+        fprintf(stderr, "invalid sampling parameters\n");
+        return 1;
+    }
+    // 缩小模拟要求采样率不变，固定用 -r 的采样率，-k 只影响缺失率曲线
+    uint64_t threshold = shards_threshold(rate);
+    if (npolicies > 0) {
+        size_t kept = 0;
+        for (size_t s = 0; s < nsizes; s++) {
+            double scaled = (double)sizes[s] * rate;
+            if (scaled < MIN_SCALED) {
+                fprintf(stderr, "warning: size %zu scales to %.1f entries at rate %g (< %d), skipped; raise -r\n",
+                        sizes[s], scaled, rate, MIN_SCALED);
+            } else {
+                sizes[kept++] = sizes[s];
+            }
+        }
+        nsizes = kept;
+    }
+    cache_policy *sims[MAX_POLICIES][MAX_SIZES];
+    uint64_t sim_misses[MAX_POLICIES][MAX_SIZES] = {{0}};
+    uint64_t sim_accesses = 0;
+    for (int p = 0; p < npolicies; p++) {
+        for (size_t s = 0; s < nsizes; s++) {
+            size_t scaled = (size_t)((double)sizes[s] * rate + 0.5);
+            sims[p][s] = cache_policy_create(ops[p], scaled);
+            if (!sims[p][s]) {
+                fprintf(stderr, "cannot simulate %s at size %zu\n", ops[p]->name, sizes[s]);
+                return 1;
+            }
+        }
+    }
+
+    trace_reader reader;
+    if (!trace_open(&reader, argv[optind], format)) {
+        fprintf(stderr, "cannot open %s\n", argv[optind]);
+        return 1;
+    }
+    uint64_t *keys = malloc(BATCH * sizeof(uint64_t));
+    double start = now_sec();
+    size_t n;
+    while ((n = trace_read(&reader, keys, BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (!shards_mrc_access(&mrc, keys[i])) {
+                fprintf(stderr, "out of memory after %llu accesses\n", (unsigned long long)mrc.accesses);
+                return 1;
+            }
+        }
+        if (npolicies == 0) {
+            continue;
+        }
+        // 先挑出被采样的键，再逐个策略回放
+        size_t m = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (threshold == UINT64_MAX || shards_hash(keys[i]) < threshold) {
+                keys[m++] = keys[i];
+            }
+        }
+        sim_accesses += m;
+        for (int p = 0; p < npolicies; p++) {
+            for (size_t s = 0; s < nsizes; s++) {
+                cache_policy *cache = sims[p][s];
+                uint64_t misses = 0;
+                for (size_t i = 0; i < m; i++) {
+                    misses += !cache_policy_access(cache, keys[i]);
+                }
+                sim_misses[p][s] += misses;
+            }
+        }
+    }
+    double elapsed = now_sec() - start;
+    free(keys);
+    trace_close(&reader);
+
+    printf("# %s: %llu accesses, %llu sampled, rate %.6f, %.2f s (%.1f M accesses/s)\n", argv[optind],
+           (unsigned long long)mrc.accesses, (unsigned long long)mrc.sampled, mrc.rate, elapsed,
+           (double)mrc.accesses / elapsed / 1e6);
+    printf("# LRU miss ratio curve (reuse distance, SHARDS)\n%12s %12s\n", "size", "miss_ratio");
+    for (size_t i = 1; i <= points; i++) {
+        size_t size = max_size * i / points;
+        printf("%12zu %12.4f\n", size, shards_mrc_miss_ratio(&mrc, size));
+    }
+
+    if (npolicies > 0) {
+        // 与缺失率曲线相同的 SHARDS_adj 修正：采样次数与期望 N * R 之差按命中计
+        double expected = (double)mrc.accesses * rate;
+        printf("# miss ratio by policy (miniature simulation at rate %.6f, %llu accesses)\n%12s %12s", rate,
+               (unsigned long long)sim_accesses, "size", "lru_mrc");
+        for (int p = 0; p < npolicies; p++) {
+            printf(" %12s", ops[p]->name);
+        }
+        printf("\n");
+        for (size_t s = 0; s < nsizes; s++) {
+            printf("%12zu %12.4f", sizes[s], shards_mrc_miss_ratio(&mrc, sizes[s]));
+            for (int p = 0; p < npolicies; p++) {
+                printf(" %12.4f", expected > 0 ? (double)sim_misses[p][s] / expected : 0.0);
+                cache_policy_destroy(sims[p][s]);
+            }
+            printf("\n");
+        }
+    }
+    shards_mrc_free(&mrc);
+    return 0;
+}
@@ -0,0 +1,883 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cachepolicy.h"
+#include "cms.h"
+
+/*
+一、为什么 LRU 扛不住扫描
+（1）LRU 只看最近一次访问：全表扫描时每个键都是"最近使用"，容量内的热键被依次挤到尾部淘汰，
+    扫描结束后热键全部未命中，要重新预热一轮
+（2）扫描中的键只访问一次，不值得占位置；各策略的区别在于怎样识别"只访问一次"：
+    2Q 与 ARC 要求键在被挤出后（只留键期间）再次出现，CLOCK-Pro 用测试期，W-TinyLFU 直接比较近期频率
+
+二、公共结构
+（1）节点数组在创建时一次分配：常驻节点最多 capacity 个，影子节点（只留键）的上限由各策略决定：
+    2Q 为 capacity / 2，ARC 与 CLOCK-Pro 为 capacity；空闲节点用 next 串成空闲链
+（2）链表用 32 位编号链接，每条链表一个哨兵，放在普通节点之后；哈希桶链与 lrucache.c 相同，
+    桶数为不小于节点数的 2 的幂，桶号由键经 splitmix64 的混合函数打散后取低位（块号这类键本身不均匀）
+（3）槽位 [0, capacity) 用一个栈管理：淘汰时归还，随后的插入立即取走，所以新键总是拿到被淘汰的键的槽位，
+    调用者按槽位保存的键值直接覆盖即可
+
+三、CLOCK-Pro 的实现
+（1）按论文的简化版本（与常见开源实现一致）：冷页不单独记测试标志，被冷指针淘汰的冷页都进入测试期，
+    以非常驻的测试页留在环上，测试页数不超过 capacity
+（2）新页插在热指针之前（环的"头"），三个指针都沿 next 方向推进；删除指针所指的节点时先把指针退到前一个
+（3）冷页目标数 mem_cold 从 capacity 开始：测试页命中时加一，测试页过期（被测试指针删除）时减一
+（4）mem_cold 的下限为 capacity 的 1%：降到 1 时环上只剩一个冷页，冷指针每次淘汰都要绕过整个环上的热页，
+    循环访问下每次插入要走 O(capacity) 步；留 1% 的冷页后冷指针平均走不到 100 步就能遇到冷页
+*/
+
+// 节点元信息，链表与哈希链都用编号
+typedef struct {
+    uint64_t key;
+    uint32_t prev;
+    uint32_t next;
+    uint32_t hnext;         // 同一个桶中的下一个节点
+    uint32_t slot;          // 常驻时的槽位，影子节点为 CACHE_POLICY_NIL
+    uint8_t list;           // 所在链表；CLOCK-Pro 中为页的类型
+    uint8_t ref;            // CLOCK-Pro 的访问位
+} policy_node;
+
+// 每个策略最多用到的链表数
+#define POLICY_MAX_LISTS 4
+
+// 各策略链表的编号
+enum { LRU_LIST = 0 };
+enum { TWOQ_A1IN = 0, TWOQ_AM, TWOQ_A1OUT };
+enum { ARC_T1 = 0, ARC_T2, ARC_B1, ARC_B2 };
+enum { CLOCK_RING = 0 };
+enum { CLOCK_HOT = 0, CLOCK_COLD, CLOCK_TEST };
+enum { TINYLFU_WINDOW = 0, TINYLFU_PROBATION, TINYLFU_PROTECTED };
+
+struct cache_policy {
+    const cache_policy_ops *ops;
+    policy_node *nodes;     // node_count 个普通节点，之后 lists 个哨兵
+    uint32_t node_count;
+    uint32_t lists;
+    uint32_t free_nodes;    // 空闲节点链
+    uint32_t *buckets;
+    size_t bucket_mask;
+    uint32_t *slots;        // 空闲槽位栈
+    size_t free_slots;
+    size_t capacity;
+    size_t size;            // 常驻的键数
+    size_t list_size[POLICY_MAX_LISTS];
+    // 被淘汰的键，由 insert 交给调用者
+    uint64_t evicted;
+    bool has_evicted;
+    // 2Q：A1in 与 A1out 的上限；ARC：T1 的目标大小 target
+    size_t kin;
+    size_t kout;
+    size_t target;
+    // CLOCK-Pro
+    uint32_t hand_hot;
+    uint32_t hand_cold;
+    uint32_t hand_test;
+    size_t count_hot;
+    size_t count_cold;
+    size_t count_test;
+    size_t mem_cold;
+    size_t min_cold;
+    // W-TinyLFU
+    size_t window_cap;
+    size_t protected_cap;
+    size_t sample;          // 草图的访问次数达到它时减半
+    cms sketch;
+};
+
+static inline uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint32_t sentinel(const cache_policy *p, uint32_t list) {
+    return p->node_count + list;
+}
+
+// 哈希桶
+static inline uint32_t node_find(const cache_policy *p, uint64_t key) {
+    for (uint32_t i = p->buckets[mix64(key) & p->bucket_mask]; i != CACHE_POLICY_NIL; i = p->nodes[i].hnext) {
+        if (p->nodes[i].key == key) {
+            return i;
+        }
+    }
+    return CACHE_POLICY_NIL;
+}
+
+// 取一个空闲节点并挂到桶上，不在任何链表中
+static inline uint32_t node_new(cache_policy *p, uint64_t key) {
+    uint32_t i = p->free_nodes;
+    policy_node *n = &p->nodes[i];
+    p->free_nodes = n->next;
+    uint32_t *bucket = &p->buckets[mix64(key) & p->bucket_mask];
+    *n = (policy_node){.key = key, .prev = CACHE_POLICY_NIL, .next = CACHE_POLICY_NIL, .hnext = *bucket,
+                       .slot = CACHE_POLICY_NIL};
+    *bucket = i;
+    return i;
+}
+
+// 从桶上摘下并放回空闲链，调用前节点已不在链表中、槽位已归还
+static inline void node_delete(cache_policy *p, uint32_t i) {
+    uint32_t *link = &p->buckets[mix64(p->nodes[i].key) & p->bucket_mask];
+    while (*link != i) {
+        link = &p->nodes[*link].hnext;
+    }
+    *link = p->nodes[i].hnext;
+    p->nodes[i].next = p->free_nodes;
+    p->free_nodes = i;
+}
+
+// 链表
+static inline void list_insert_before(cache_policy *p, uint32_t list, uint32_t pos, uint32_t i) {
+    policy_node *n = &p->nodes[i];
+    n->next = pos;
+    n->prev = p->nodes[pos].prev;
+    p->nodes[n->prev].next = i;
+    p->nodes[pos].prev = i;
+    n->list = (uint8_t)list;
+    p->list_size[list]++;
+}
+
+static inline void list_push_front(cache_policy *p, uint32_t list, uint32_t i) {
+    list_insert_before(p, list, p->nodes[sentinel(p, list)].next, i);
+}
+
+static inline void list_remove(cache_policy *p, uint32_t i) {
+    policy_node *n = &p->nodes[i];
+    p->nodes[n->prev].next = n->next;
+    p->nodes[n->next].prev = n->prev;
+    p->list_size[n->list]--;
+}
+
+static inline void list_move_front(cache_policy *p, uint32_t list, uint32_t i) {
+    list_remove(p, i);
+    list_push_front(p, list, i);
+}
+
+// 最旧的节点，空链表返回 CACHE_POLICY_NIL
+static inline uint32_t list_back(const cache_policy *p, uint32_t list) {
+    return p->list_size[list] ? p->nodes[sentinel(p, list)].prev : CACHE_POLICY_NIL;
+}
+
+// 槽位
+static inline uint32_t slot_take(cache_policy *p, uint32_t i) {
+    p->nodes[i].slot = p->slots[--p->free_slots];
+    p->size++;
+    return p->nodes[i].slot;
+}
+
+// 归还槽位并记为被淘汰
+static inline void slot_evict(cache_policy *p, uint32_t i) {
+    p->slots[p->free_slots++] = p->nodes[i].slot;
+    p->nodes[i].slot = CACHE_POLICY_NIL;
+    p->size--;
+    p->evicted = p->nodes[i].key;
+    p->has_evicted = true;
+}
+
+static cache_policy *policy_alloc(const cache_policy_ops *ops, size_t capacity, size_t nodes, uint32_t lists) {
+    size_t buckets = 1;
+    while (buckets < nodes) {
+        buckets *= 2;
+    }
+    cache_policy *p = calloc(1, sizeof(cache_policy));
+    if (!p) {
+        return NULL;
+    }
+    p->nodes = malloc((nodes + lists) * sizeof(policy_node));
+    p->buckets = malloc(buckets * sizeof(uint32_t));
+    p->slots = malloc(capacity * sizeof(uint32_t));
+    if (!p->nodes || !p->buckets || !p->slots) {
+        cache_policy_destroy(p);
+        return NULL;
+    }
+    p->ops = ops;
+    p->node_count = (uint32_t)nodes;
+    p->lists = lists;
+    p->capacity = capacity;
+    p->bucket_mask = buckets - 1;
+    memset(p->buckets, 0xFF, buckets * sizeof(uint32_t));
+    for (uint32_t i = 0; i < nodes; i++) {
+        p->nodes[i].next = i + 1 < nodes ? i + 1 : CACHE_POLICY_NIL;
+    }
+    p->free_nodes = 0;
+    for (uint32_t l = 0; l < lists; l++) {
+        uint32_t s = sentinel(p, l);
+        p->nodes[s].prev = p->nodes[s].next = s;
+    }
+    // 栈顶为 0，槽位从小到大分配
+    for (size_t i = 0; i < capacity; i++) {
+        p->slots[i] = (uint32_t)(capacity - 1 - i);
+    }
+    p->free_slots = capacity;
+    p->hand_hot = p->hand_cold = p->hand_test = CACHE_POLICY_NIL;
+    return p;
+}
+
+// 链表类策略的删除：常驻与影子节点都删除，只有常驻时返回 true
+static bool list_policy_erase(cache_policy *p, uint64_t key) {
+    uint32_t i = node_find(p, key);
+    if (i == CACHE_POLICY_NIL) {
+        return false;
+    }
+    bool resident = p->nodes[i].slot != CACHE_POLICY_NIL;
+    if (resident) {
+        p->slots[p->free_slots++] = p->nodes[i].slot;
+        p->size--;
+    }
+    list_remove(p, i);
+    node_delete(p, i);
+    return resident;
+}
+
+static void list_policy_destroy(cache_policy *p) {
+    cms_free(&p->sketch);
+    free(p->nodes);
+    free(p->buckets);
+    free(p->slots);
+    free(p);
+}
+
+// 常驻节点的编号，不常驻返回 CACHE_POLICY_NIL
+static inline uint32_t resident_find(const cache_policy *p, uint64_t key) {
+    uint32_t i = node_find(p, key);
+    return i != CACHE_POLICY_NIL && p->nodes[i].slot != CACHE_POLICY_NIL ? i : CACHE_POLICY_NIL;
+}
+
+/* ---------------- LRU ---------------- */
+
+static cache_policy *lru_create(size_t capacity) {
+    return policy_alloc(&cache_policy_lru, capacity, capacity, 1);
+}
+
+static uint32_t lru_lookup(cache_policy *p, uint64_t key) {
+    uint32_t i = resident_find(p, key);
+    if (i == CACHE_POLICY_NIL) {
+        return CACHE_POLICY_NIL;
+    }
+    list_move_front(p, LRU_LIST, i);
+    return p->nodes[i].slot;
+}
+
+static uint32_t lru_insert(cache_policy *p, uint64_t key) {
+    if (p->size == p->capacity) {
+        uint32_t victim = list_back(p, LRU_LIST);
+        slot_evict(p, victim);
+        list_remove(p, victim);
+        node_delete(p, victim);
+    }
+    uint32_t i = node_new(p, key);
+    list_push_front(p, LRU_LIST, i);
+    return slot_take(p, i);
+}
+
+const cache_policy_ops cache_policy_lru = {
+    .name = "lru",
+    .create = lru_create,
+    .destroy = list_policy_destroy,
+    .lookup = lru_lookup,
+    .insert = lru_insert,
+    .erase = list_policy_erase,
+};
+
+/* ---------------- 2Q ---------------- */
+
+static cache_policy *twoq_create(size_t capacity) {
+    size_t kout = capacity / 2 ? capacity / 2 : 1;
+    cache_policy *p = policy_alloc(&cache_policy_2q, capacity, capacity + kout + 1, 3);
+    if (p) {
+        p->kin = capacity / 4 ? capacity / 4 : 1;
+        p->kout = kout;
+    }
+    return p;
+}
+
+static uint32_t twoq_lookup(cache_policy *p, uint64_t key) {
+    uint32_t i = resident_find(p, key);
+    if (i == CACHE_POLICY_NIL) {
+        return CACHE_POLICY_NIL;
+    }
+    // A1in 是 FIFO，其中的命中不改变顺序：短时间内的重复访问不算"多次访问"
+    if (p->nodes[i].list == TWOQ_AM) {
+        list_move_front(p, TWOQ_AM, i);
+    }
+    return p->nodes[i].slot;
+}
+
+// 腾出一个槽位：A1in 超过 kin 时把它最旧的键移入 A1out，否则淘汰 Am 最久未使用的键
+static void twoq_reclaim(cache_policy *p) {
+    if (p->size < p->capacity) {
+        return;
+    }
+    if (p->list_size[TWOQ_A1IN] > p->kin || p->list_size[TWOQ_AM] == 0) {
+        uint32_t victim = list_back(p, TWOQ_A1IN);
+        slot_evict(p, victim);
+        list_move_front(p, TWOQ_A1OUT, victim);
+        if (p->list_size[TWOQ_A1OUT] > p->kout) {
+            uint32_t old = list_back(p, TWOQ_A1OUT);
+            list_remove(p, old);
+            node_delete(p, old);
+        }
+    } else {
+        uint32_t victim = list_back(p, TWOQ_AM);
+        slot_evict(p, victim);
+        list_remove(p, victim);
+        node_delete(p, victim);
+    }
+}
+
+static uint32_t twoq_insert(cache_policy *p, uint64_t key) {
+    uint32_t i = node_find(p, key);
+    if (i != CACHE_POLICY_NIL) {
+        // 在 A1out 中：先摘下，避免腾位置时被当作最旧的影子删除
+        list_remove(p, i);
+        twoq_reclaim(p);
+        list_push_front(p, TWOQ_AM, i);
+    } else {
+        twoq_reclaim(p);
+        i = node_new(p, key);
+        list_push_front(p, TWOQ_A1IN, i);
+    }
+    return slot_take(p, i);
+}
+
+const cache_policy_ops cache_policy_2q = {
+    .name = "2q",
+    .create = twoq_create,
+    .destroy = list_policy_destroy,
+    .lookup = twoq_lookup,
+    .insert = twoq_insert,
+    .erase = list_policy_erase,
+};
+
+/* ---------------- ARC ---------------- */
+
+static cache_policy *arc_create(size_t capacity) {
+    return policy_alloc(&cache_policy_arc, capacity, 2 * capacity + 1, 4);
+}
+
+static uint32_t arc_lookup(cache_policy *p, uint64_t key) {
+    uint32_t i = resident_find(p, key);
+    if (i == CACHE_POLICY_NIL) {
+        return CACHE_POLICY_NIL;
+    }
+    list_move_front(p, ARC_T2, i);
+    return p->nodes[i].slot;
+}
+
+// 论文中的 REPLACE：T1 超过目标时淘汰 T1 最旧的键到 B1，否则淘汰 T2 最旧的键到 B2
+static void arc_replace(cache_policy *p, bool in_b2) {
+    size_t t1 = p->list_size[ARC_T1];
+    uint32_t victim;
+    if (t1 && ((in_b2 && t1 == p->target) || t1 > p->target || p->list_size[ARC_T2] == 0)) {
+        victim = list_back(p, ARC_T1);
+        list_move_front(p, ARC_B1, victim);
+    } else {
+        victim = list_back(p, ARC_T2);
+        list_move_front(p, ARC_B2, victim);
+    }
+    slot_evict(p, victim);
+}
+
+static void arc_delete_back(cache_policy *p, uint32_t list) {
+    uint32_t i = list_back(p, list);
+    if (p->nodes[i].slot != CACHE_POLICY_NIL) {
+        slot_evict(p, i);
+    }
+    list_remove(p, i);
+    node_delete(p, i);
+}
+
+static uint32_t arc_insert(cache_policy *p, uint64_t key) {
+    size_t c = p->capacity;
+    size_t b1 = p->list_size[ARC_B1], b2 = p->list_size[ARC_B2];
+    uint32_t i = node_find(p, key);
+    if (i != CACHE_POLICY_NIL) {
+        // 影子命中：B1 命中说明 T1 太小，B2 命中说明 T2 太小，调整幅度为另一个影子表与本表的长度比
+        bool in_b2 = p->nodes[i].list == ARC_B2;
+        if (in_b2) {
+            size_t delta = b1 / b2 > 1 ? b1 / b2 : 1;
+            p->target = p->target > delta ? p->target - delta : 0;
+        } else {
+            size_t delta = b2 / b1 > 1 ? b2 / b1 : 1;
+            p->target = p->target + delta < c ? p->target + delta : c;
+        }
+        list_remove(p, i);
+        if (p->size == c) {
+            arc_replace(p, in_b2);
+        }
+        list_push_front(p, ARC_T2, i);
+        return slot_take(p, i);
+    }
+
+    size_t l1 = p->list_size[ARC_T1] + b1;
+    size_t total = l1 + p->list_size[ARC_T2] + b2;
+    if (l1 == c) {
+        if (p->list_size[ARC_T1] < c) {
+            arc_delete_back(p, ARC_B1);
+            if (p->size == c) {
+                arc_replace(p, false);
+            }
+        } else {
+            arc_delete_back(p, ARC_T1);
+        }
+    } else if (total >= c) {
+        if (total == 2 * c) {
+            arc_delete_back(p, ARC_B2);
+        }
+        if (p->size == c) {
+            arc_replace(p, false);
+        }
+    }
+    i = node_new(p, key);
+    list_push_front(p, ARC_T1, i);
+    return slot_take(p, i);
+}
+
+const cache_policy_ops cache_policy_arc = {
+    .name = "arc",
+    .create = arc_create,
+    .destroy = list_policy_destroy,
+    .lookup = arc_lookup,
+    .insert = arc_insert,
+    .erase = list_policy_erase,
+};
+
+/* ---------------- CLOCK-Pro ---------------- */
+
+// 环上的下一个、上一个节点，跳过哨兵
+static inline uint32_t ring_next(const cache_policy *p, uint32_t i) {
+    uint32_t n = p->nodes[i].next;
+    return n == sentinel(p, CLOCK_RING) ? p->nodes[n].next : n;
+}
+
+static inline uint32_t ring_prev(const cache_policy *p, uint32_t i) {
+    uint32_t n = p->nodes[i].prev;
+    return n == sentinel(p, CLOCK_RING) ? p->nodes[n].prev : n;
+}
+
+static void clock_run_hand_cold(cache_policy *p, bool balance);
+static void clock_run_hand_test(cache_policy *p);
+
+// 从环上摘下，指向它的指针退到前一个节点
+static void clock_unlink(cache_policy *p, uint32_t i) {
+    uint32_t prev = ring_prev(p, i);
+    if (prev == i) {
+        prev = CACHE_POLICY_NIL;
+    }
+    if (p->hand_hot == i) {
+        p->hand_hot = prev;
+    }
+    if (p->hand_cold == i) {
+        p->hand_cold = prev;
+    }
+    if (p->hand_test == i) {
+        p->hand_test = prev;
+    }
+    uint8_t type = p->nodes[i].list;
+    p->nodes[i].list = CLOCK_RING;
+    list_remove(p, i);
+    p->nodes[i].list = type;
+}
+
+// 插到热指针之前
+static void clock_link(cache_policy *p, uint32_t i) {
+    uint8_t type = p->nodes[i].list;
+    if (p->hand_hot == CACHE_POLICY_NIL) {
+        list_push_front(p, CLOCK_RING, i);
+        p->hand_hot = p->hand_cold = p->hand_test = i;
+    } else {
+        list_insert_before(p, CLOCK_RING, p->hand_hot, i);
+    }
+    p->nodes[i].list = type;
+    if (p->hand_cold == p->hand_hot) {
+        p->hand_cold = ring_prev(p, p->hand_cold);
+    }
+}
+
+static void clock_run_hand_hot(cache_policy *p) {
+    if (p->hand_hot == p->hand_test) {
+        clock_run_hand_test(p);
+    }
+    policy_node *n = &p->nodes[p->hand_hot];
+    if (n->list == CLOCK_HOT) {
+        if (n->ref) {
+            n->ref = 0;
+        } else {
+            n->list = CLOCK_COLD;
+            p->count_hot--;
+            p->count_cold++;
+        }
+    }
+    p->hand_hot = ring_next(p, p->hand_hot);
+}
+
+// 测试页过期：删除，冷页目标减一
+static void clock_run_hand_test(cache_policy *p) {
+    if (p->hand_test == p->hand_cold) {
+        clock_run_hand_cold(p, false);
+    }
+    uint32_t i = p->hand_test;
+    if (p->nodes[i].list == CLOCK_TEST) {
+        clock_unlink(p, i);
+        node_delete(p, i);
+        p->count_test--;
+        if (p->mem_cold > p->min_cold) {
+            p->mem_cold--;
+        }
+    }
+    if (p->hand_test != CACHE_POLICY_NIL) {
+        p->hand_test = ring_next(p, p->hand_test);
+    }
+}
+
+// 冷页：访问过则转为热页，否则淘汰并进入测试期
+// 测试指针、热指针追上冷指针时会嵌套调用，此时已经腾出了槽位，不再淘汰，保证一次插入最多淘汰一个键
+// 只有最外层（balance 为 true）把热页降到目标以内：嵌套调用本身就在热指针的循环中，再转动热指针会形成
+// 热 -> 测试 -> 冷 -> 热 的无限递归（容量为 1 时热页目标为 0，每次都会触发）
+static void clock_run_hand_cold(cache_policy *p, bool balance) {
+    policy_node *n = &p->nodes[p->hand_cold];
+    if (n->list == CLOCK_COLD) {
+        if (n->ref) {
+            n->list = CLOCK_HOT;
+            n->ref = 0;
+            p->count_cold--;
+            p->count_hot++;
+        } else if (p->count_hot + p->count_cold >= p->capacity) {
+            n->list = CLOCK_TEST;
+            slot_evict(p, p->hand_cold);
+            p->count_cold--;
+            p->count_test++;
+            while (p->count_test > p->capacity) {
+                clock_run_hand_test(p);
+            }
+        }
+    }
+    p->hand_cold = ring_next(p, p->hand_cold);
+    while (balance && p->capacity - p->mem_cold < p->count_hot) {
+        clock_run_hand_hot(p);
+    }
+}
+
+static cache_policy *clock_create(size_t capacity) {
+    cache_policy *p = policy_alloc(&cache_policy_clockpro, capacity, 2 * capacity + 1, 1);
+    if (p) {
+        p->mem_cold = capacity;
+        p->min_cold = capacity / 100 ? capacity / 100 : 1;
+    }
+    return p;
+}
+
+static uint32_t clock_lookup(cache_policy *p, uint64_t key) {
+    uint32_t i = resident_find(p, key);
+    if (i == CACHE_POLICY_NIL) {
+        return CACHE_POLICY_NIL;
+    }
+    p->nodes[i].ref = 1;
+    return p->nodes[i].slot;
+}
+
+static uint32_t clock_insert(cache_policy *p, uint64_t key) {
+    uint32_t i = node_find(p, key);
+    if (i != CACHE_POLICY_NIL) {
+        // 测试期内再次访问：冷页应该更多，转为热页重新插入
+        if (p->mem_cold < p->capacity) {
+            p->mem_cold++;
+        }
+        p->count_test--;
+        clock_unlink(p, i);
+        p->nodes[i].list = CLOCK_HOT;
+        p->nodes[i].ref = 0;
+    } else {
+        i = CACHE_POLICY_NIL;
+    }
+    while (p->capacity <= p->count_hot + p->count_cold) {
+        clock_run_hand_cold(p, true);
+    }
+    if (i == CACHE_POLICY_NIL) {
+        i = node_new(p, key);
+        p->nodes[i].list = CLOCK_COLD;
+        p->nodes[i].ref = 0;
+        p->count_cold++;
+    } else {
+        p->count_hot++;
+    }
+    clock_link(p, i);
+    return slot_take(p, i);
+}
+
+static bool clock_erase(cache_policy *p, uint64_t key) {
+    uint32_t i = node_find(p, key);
+    if (i == CACHE_POLICY_NIL) {
+        return false;
+    }
+    uint8_t type = p->nodes[i].list;
+    if (type == CLOCK_TEST) {
+        p->count_test--;
+    } else {
+        p->slots[p->free_slots++] = p->nodes[i].slot;
+        p->size--;
+        if (type == CLOCK_HOT) {
+            p->count_hot--;
+        } else {
+            p->count_cold--;
+        }
+    }
+    clock_unlink(p, i);
+    node_delete(p, i);
+    return type != CLOCK_TEST;
+}
+
+const cache_policy_ops cache_policy_clockpro = {
+    .name = "clockpro",
+    .create = clock_create,
+    .destroy = list_policy_destroy,
+    .lookup = clock_lookup,
+    .insert = clock_insert,
+    .erase = clock_erase,
+};
+
+/* ---------------- W-TinyLFU ---------------- */
+
+static cache_policy *tinylfu_create(size_t capacity) {
+    cache_policy *p = policy_alloc(&cache_policy_wtinylfu, capacity, capacity, 3);
+    if (!p) {
+        return NULL;
+    }
+    p->window_cap = capacity / 100 ? capacity / 100 : 1;
+    p->protected_cap = (capacity - p->window_cap) * 8 / 10;
+    p->sample = 10 * capacity;
+    // 每个键约 4 个计数器（4 行各 1 个），与 Caffeine 的比例相当
+    if (!cms_init(&p->sketch, capacity > 64 ? capacity : 64, 4, true)) {
+        list_policy_destroy(p);
+        return NULL;
+    }
+    return p;
+}
+
+static inline uint32_t tinylfu_record(cache_policy *p, uint64_t key) {
+    uint32_t freq = cms_add(&p->sketch, mix64(key), 1);
+    if (p->sketch.total >= p->sample) {
+        cms_halve(&p->sketch);
+    }
+    return freq;
+}
+
+static inline uint32_t tinylfu_frequency(const cache_policy *p, uint32_t i) {
+    return cms_estimate(&p->sketch, mix64(p->nodes[i].key));
+}
+
+static uint32_t tinylfu_lookup(cache_policy *p, uint64_t key) {
+    uint32_t i = resident_find(p, key);
+    if (i == CACHE_POLICY_NIL) {
+        return CACHE_POLICY_NIL;
+    }
+    tinylfu_record(p, key);
+    switch (p->nodes[i].list) {
+    case TINYLFU_WINDOW:
+        list_move_front(p, TINYLFU_WINDOW, i);
+        break;
+    case TINYLFU_PROBATION:
+        // 试用段再次命中升入保护段，保护段超出时最旧的键降回试用段
+        list_move_front(p, TINYLFU_PROTECTED, i);
+        if (p->list_size[TINYLFU_PROTECTED] > p->protected_cap) {
+            list_move_front(p, TINYLFU_PROBATION, list_back(p, TINYLFU_PROTECTED));
+        }
+        break;
+    default:
+        list_move_front(p, TINYLFU_PROTECTED, i);
+        break;
+    }
+    return p->nodes[i].slot;
+}
+
+static void tinylfu_evict(cache_policy *p, uint32_t i) {
+    slot_evict(p, i);
+    list_remove(p, i);
+    node_delete(p, i);
+}
+
+static uint32_t tinylfu_insert(cache_policy *p, uint64_t key) {
+    tinylfu_record(p, key);
+    bool window_full = p->list_size[TINYLFU_WINDOW] >= p->window_cap;
+    uint32_t candidate = window_full ? list_back(p, TINYLFU_WINDOW) : CACHE_POLICY_NIL;
+    if (p->size == p->capacity) {
+        uint32_t victim = list_back(p, TINYLFU_PROBATION);
+        if (victim == CACHE_POLICY_NIL) {
+            victim = list_back(p, TINYLFU_PROTECTED);
+        }
+        if (candidate == CACHE_POLICY_NIL) {
+            tinylfu_evict(p, victim != CACHE_POLICY_NIL ? victim : list_back(p, TINYLFU_WINDOW));
+        } else if (victim == CACHE_POLICY_NIL) {
+            tinylfu_evict(p, candidate);
+        } else if (tinylfu_frequency(p, candidate) > tinylfu_frequency(p, victim)) {
+            // 准入：候选的近期频率更高才替换试用段最旧的键，扫描中只出现一次的键频率低，进不了主区
+            tinylfu_evict(p, victim);
+            list_move_front(p, TINYLFU_PROBATION, candidate);
+        } else {
+            tinylfu_evict(p, candidate);
+        }
+    } else if (candidate != CACHE_POLICY_NIL) {
+        // 未满时主区有空位，窗口挤出的键直接进入试用段
+        list_move_front(p, TINYLFU_PROBATION, candidate);
+    }
+    uint32_t i = node_new(p, key);
+    list_push_front(p, TINYLFU_WINDOW, i);
+    return slot_take(p, i);
+}
+
+const cache_policy_ops cache_policy_wtinylfu = {
+    .name = "wtinylfu",
+    .create = tinylfu_create,
+    .destroy = list_policy_destroy,
+    .lookup = tinylfu_lookup,
+    .insert = tinylfu_insert,
+    .erase = list_policy_erase,
+};
+
+/* ---------------- 公共接口 ---------------- */
+
+const cache_policy_ops *const cache_policy_all[] = {
+    &cache_policy_lru, &cache_policy_2q, &cache_policy_arc, &cache_policy_clockpro, &cache_policy_wtinylfu, NULL,
+};
+
+const cache_policy_ops *cache_policy_find(const char *name) {
+    for (size_t i = 0; cache_policy_all[i]; i++) {
+        if (strcmp(cache_policy_all[i]->name, name) == 0) {
+            return cache_policy_all[i];
+        }
+    }
+    return NULL;
+}
+
+cache_policy *cache_policy_create(const cache_policy_ops *ops, size_t capacity) {
+    if (!ops || capacity == 0 || capacity > UINT32_MAX / 4) {
+        return NULL;
+    }
+    return ops->create(capacity);
+}
+
+void cache_policy_destroy(cache_policy *p) {
+    if (p) {
+        p->ops->destroy(p);
+    }
+}
+
+uint32_t cache_policy_lookup(cache_policy *p, uint64_t key) {
+    return p->ops->lookup(p, key);
+}
+
+uint32_t cache_policy_insert(cache_policy *p, uint64_t key, uint64_t *evicted, bool *has_evicted) {
+    uint32_t slot = p->ops->lookup(p, key);
+    p->has_evicted = false;
+    if (slot == CACHE_POLICY_NIL) {
+        slot = p->ops->insert(p, key);
+    }
+    if (evicted && p->has_evicted) {
+        *evicted = p->evicted;
+    }
+    if (has_evicted) {
+        *has_evicted = p->has_evicted;
+    }
+    return slot;
+}
+
+bool cache_policy_erase(cache_policy *p, uint64_t key) {
+    return p->ops->erase(p, key);
+}
+
+bool cache_policy_access(cache_policy *p, uint64_t key) {
+    if (p->ops->lookup(p, key) != CACHE_POLICY_NIL) {
+        return true;
+    }
+    p->ops->insert(p, key);
+    return false;
+}
+
+const char *cache_policy_name(const cache_policy *p) {
+    return p->ops->name;
+}
+
+size_t cache_policy_capacity(const cache_policy *p) {
+    return p->capacity;
+}
+
+size_t cache_policy_size(const cache_policy *p) {
+    return p->size;
+}
+
+#ifdef CACHEPOLICY_MAIN
+int main(void) {
+    int failed = 0;
+
+    // 示例1：热键集合反复访问，其间夹杂同样多只访问一次的键，缓存进入稳定状态后插入一次比容量大得多的顺序扫描，
+    // 统计扫描之后热键的命中率；LRU 被扫描冲掉，其他策略应保住大部分热键
+    enum { CAPACITY = 1000, HOT = 400, SCAN = 20000 };
+    printf("%-10s %12s %12s\n", "policy", "hit before", "hit after");
+    for (size_t k = 0; cache_policy_all[k]; k++) {
+        cache_policy *p = cache_policy_create(cache_policy_all[k], CAPACITY);
+        size_t before = 0, after = 0;
+        for (int round = 0; round < 20; round++) {
+            for (uint64_t key = 0; key < HOT; key++) {
+                before += cache_policy_access(p, key);
+                cache_policy_access(p, 100000 + (uint64_t)round * HOT + key);
+            }
+        }
+        for (uint64_t key = 1000000; key < 1000000 + SCAN; key++) {
+            cache_policy_access(p, key);
+        }
+        for (uint64_t key = 0; key < HOT; key++) {
+            after += cache_policy_access(p, key);
+        }
+        printf("%-10s %11.1f%% %11.1f%%\n", cache_policy_name(p), 100.0 * before / (20 * HOT), 100.0 * after / HOT);
+        failed |= cache_policy_size(p) != CAPACITY;
+        if (cache_policy_all[k] != &cache_policy_lru) {
+            failed |= after < HOT / 2;
+        }
+        cache_policy_destroy(p);
+    }
+
+    // 示例2：槽位在 [0, capacity) 内且不重复，被淘汰的键恰好是槽位原来的键，删除后槽位可再用；
+    // 包括容量为 1、2 这样热页与冷页目标都很小的情况
+    static const size_t capacities[] = {1, 2, 3, 64};
+    for (size_t c = 0; c < sizeof(capacities) / sizeof(capacities[0]); c++) {
+        size_t capacity = capacities[c];
+        for (size_t k = 0; cache_policy_all[k]; k++) {
+            cache_policy *p = cache_policy_create(cache_policy_all[k], capacity);
+            uint64_t owner[64];
+            memset(owner, 0xFF, sizeof(owner));
+            uint64_t state = 1;
+            for (int i = 0; i < 100000; i++) {
+                state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                // 开头两个键交替访问，容量为 1 时 CLOCK-Pro 的测试页立即命中
+                uint64_t key = i < 8 ? (uint64_t)(i & 1) : (state >> 33) % (i % 3 ? 100 : 1000);
+                uint32_t slot = cache_policy_lookup(p, key);
+                if (slot != CACHE_POLICY_NIL) {
+                    failed |= slot >= capacity || owner[slot] != key;
+                    if (i % 17 == 0) {
+                        failed |= !cache_policy_erase(p, key);
+                        owner[slot] = UINT64_MAX;
+                    }
+                    continue;
+                }
+                uint64_t evicted;
+                bool has_evicted;
+                slot = cache_policy_insert(p, key, &evicted, &has_evicted);
+                failed |= slot >= capacity || (has_evicted ? owner[slot] != evicted : owner[slot] != UINT64_MAX);
+                owner[slot] = key;
+            }
+            size_t used = 0;
+            for (size_t s = 0; s < capacity; s++) {
+                used += owner[s] != UINT64_MAX;
+            }
+            failed |= used != cache_policy_size(p);
+            cache_policy_destroy(p);
+        }
+    }
+    printf("check %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
+#endif
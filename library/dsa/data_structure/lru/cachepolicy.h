@@ -0,0 +1,120 @@
+#ifndef DSA_LRU_CACHEPOLICY_H
+#define DSA_LRU_CACHEPOLICY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+可替换的淘汰策略
+（1）策略只管"哪些键留在缓存里"：键为 64 位整数（块号或键的哈希值），每个常驻键占一个槽位 [0, capacity)，
+    键和值由调用者按槽位保存（见 policycache.h），策略自己不存值
+（2）LRU：基准，周期性全表扫描会把热键全部挤出
+（3）2Q：新键先进 FIFO 的 A1in，被挤出后只留键（A1out），在 A1out 期间再次访问才进入 LRU 的 Am
+（4）ARC：最近一次（T1）与多次（T2）两个 LRU，各带一个只记键的影子表（B1、B2），
+    按影子表的命中自适应调整 T1 的目标大小
+（5）CLOCK-Pro：一个时钟环上区分冷热页，冷页被淘汰后在测试期内只留键，测试期内再次访问则转为热页，
+    冷页的目标数量按测试期内的命中自适应
+（6）W-TinyLFU：1% 的窗口 LRU 接收新键，其余为分段 LRU（试用 20%、保护 80%）；
+    窗口挤出的候选与试用段最旧的键比较 Count-Min 草图中的近期频率，频率更高的留下；
+    草图在访问次数达到容量 10 倍时减半，使旧的频率逐渐失效
+（7）所有操作 O(1)（CLOCK-Pro 的指针推进为均摊 O(1)）；节点（包括只留键的影子节点）在创建时一次分配，
+    以 32 位编号链接，之后不再调用 malloc/free
+*/
+
+// 无效槽位
+#define CACHE_POLICY_NIL UINT32_MAX
+
+typedef struct cache_policy cache_policy;
+
+// 策略的函数表，实现见 cachepolicy.c
+typedef struct {
+    const char *name;
+    cache_policy *(*create)(size_t capacity);
+    void (*destroy)(cache_policy *p);
+    uint32_t (*lookup)(cache_policy *p, uint64_t key);
+    uint32_t (*insert)(cache_policy *p, uint64_t key);     // 被淘汰的键记在 cache_policy 中
+    bool (*erase)(cache_policy *p, uint64_t key);
+} cache_policy_ops;
+
+extern const cache_policy_ops cache_policy_lru;
+extern const cache_policy_ops cache_policy_2q;
+extern const cache_policy_ops cache_policy_arc;
+extern const cache_policy_ops cache_policy_clockpro;
+extern const cache_policy_ops cache_policy_wtinylfu;
+
+// 全部策略，以 NULL 结尾
+extern const cache_policy_ops *const cache_policy_all[];
+
+/**
+* @brief             按名字查找策略（lru、2q、arc、clockpro、wtinylfu）
+* @return  const cache_policy_ops* 不存在返回 NULL
+*
+* @note              Revision History
+*/
+const cache_policy_ops *cache_policy_find(const char *name);
+
+/**
+* @brief             创建
+* @param   capacity  最多常驻的键数，范围 [1, UINT32_MAX / 4]
+* @return  cache_policy* 参数非法或申请内存失败返回 NULL
+*
+* @note              全部内存在这里一次分配
+*/
+cache_policy *cache_policy_create(const cache_policy_ops *ops, size_t capacity);
+
+/**
+* @brief             销毁
+*
+* @note              Revision History
+*/
+void cache_policy_destroy(cache_policy *p);
+
+/**
+* @brief             访问一个键：常驻时记一次命中并返回槽位
+* @return  uint32_t  不常驻（包括只留键的影子节点）返回 CACHE_POLICY_NIL
+*
+* @note              未命中时没有副作用，调用者随后用 cache_policy_insert 放入
+*/
+uint32_t cache_policy_lookup(cache_policy *p, uint64_t key);
+
+/**
+* @brief             放入一个不常驻的键
+* @param   evicted   因此被淘汰的键，可为 NULL
+* @param   has_evicted 是否有键被淘汰，可为 NULL
+* @return  uint32_t  分给该键的槽位，其中原有的键即被淘汰的键；键已常驻时返回它的槽位
+*
+* @note              W-TinyLFU 淘汰的可能是刚被窗口挤出的候选，而不是试用段的键
+*/
+uint32_t cache_policy_insert(cache_policy *p, uint64_t key, uint64_t *evicted, bool *has_evicted);
+
+/**
+* @brief             删除常驻的键，槽位归还
+* @return  bool      键不常驻返回 false
+*
+* @note              影子节点一并删除
+*/
+bool cache_policy_erase(cache_policy *p, uint64_t key);
+
+/**
+* @brief             访问并在未命中时放入，用于回放访问序列
+* @return  bool      是否命中
+*
+* @note              Revision History
+*/
+bool cache_policy_access(cache_policy *p, uint64_t key);
+
+const char *cache_policy_name(const cache_policy *p);
+size_t cache_policy_capacity(const cache_policy *p);
+// 当前常驻的键数
+size_t cache_policy_size(const cache_policy *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_LRU_CACHEPOLICY_H
@@ -0,0 +1,481 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hashalg.h"
+#include "lrucache.h"
+
+/*
+一、simplelru.c 的问题
+（1）hashMap[key] 直接用键做下标，calloc(10001) 个指针，键只能是小于 10001 的非负 int，否则越界
+（2）每次插入 malloc 一个 DLinkedNode，每次淘汰 free 一个，稳定运行时每次未命中都要进出分配器一次，
+    节点散落在堆上，链表移动时访问的 prev/next 分布在不同缓存行
+（3）节点之间用 8 字节指针链接，16 字节的 prev/next 比键值本身还大
+
+二、slab 与编号链接
+（1）capacity 个节点在初始化时一次分配：元信息数组 nodes（每个 20 字节）与键值数组 data（每个 stride 字节），
+    节点 i 的键在 data + i * stride，值紧随其后并按 8 字节对齐
+（2）LRU 双向链表与哈希桶链都用 32 位节点编号链接，nodes[capacity] 为链表哨兵，
+    哨兵的 next 为最近使用的节点、prev 为最久未使用的节点，插入和删除都不需要判断边界
+（3）空闲节点用 next 串成空闲链，淘汰的节点直接放回空闲链再取出，稳定运行时 malloc/free 次数为 0
+
+三、哈希
+（1）键为字节串，用 xxh3Hash64 计算，取高 32 位作为 tag 存在节点中，桶号为 tag 的低位
+（2）查找时先比较 tag 与长度，相同再 memcmp，绝大多数不相等的节点只比较一次整数
+（3）桶数为不小于容量的 2 的幂，负载因子不超过 1，链平均长度小于 1；淘汰节点时由 tag 算出桶号，不需要重新计算哈希
+
+四、过期时间
+（1）定时器编号就是节点编号，到期时间存在时间轮的节点中，lrucache_node 不变，不开启时除一次判断外没有开销
+（2）每次 get/put 先把时间轮推进到当前时间，最多处理 LRUCACHE_EXPIRE_BUDGET 个定时器（删除到期的键或下降一层）；
+    过期集中发生时处理不完的留给后面的操作，单次操作的耗时有上界，也不需要后台线程扫描
+（3）时间轮精确到 1 个时钟单位，但推进有回调上限，所以查找时还要比较到期时间（惰性检查），
+    已过期的键不会被返回，get 遇到时顺便删除
+（4）淘汰、删除、覆盖时取消定时器，节点回到空闲链时一定不在时间轮中
+*/
+
+static inline size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+static inline unsigned char *node_key(const lrucache *c, uint32_t i) {
+    return c->data + (size_t)i * c->stride;
+}
+
+static inline unsigned char *node_value(const lrucache *c, uint32_t i) {
+    return c->data + (size_t)i * c->stride + (c->value_size ? c->value_offset : 0);
+}
+
+static inline uint32_t sentinel(const lrucache *c) {
+    return (uint32_t)c->capacity;
+}
+
+static inline uint32_t hash_tag(uint64_t hash) {
+    return (uint32_t)(hash >> 32);
+}
+
+// 节点放回空闲链，prev 置为 LRUCACHE_NIL 表示不在使用中
+static inline void free_push(lrucache *c, uint32_t i) {
+    c->nodes[i].prev = LRUCACHE_NIL;
+    c->nodes[i].next = c->free_list;
+    c->free_list = i;
+}
+
+// 链表操作
+static inline void list_unlink(lrucache *c, uint32_t i) {
+    lrucache_node *n = &c->nodes[i];
+    c->nodes[n->prev].next = n->next;
+    c->nodes[n->next].prev = n->prev;
+}
+
+static inline void list_push_front(lrucache *c, uint32_t i) {
+    uint32_t s = sentinel(c);
+    lrucache_node *n = &c->nodes[i];
+    n->prev = s;
+    n->next = c->nodes[s].next;
+    c->nodes[n->next].prev = i;
+    c->nodes[s].next = i;
+}
+
+// 哈希桶操作
+static inline uint32_t bucket_find(const lrucache *c, uint32_t tag, const void *key, size_t len) {
+    for (uint32_t i = c->buckets[tag & c->bucket_mask]; i != LRUCACHE_NIL; i = c->nodes[i].hnext) {
+        const lrucache_node *n = &c->nodes[i];
+        if (n->tag == tag && n->key_len == len && memcmp(node_key(c, i), key, len) == 0) {
+            return i;
+        }
+    }
+    return LRUCACHE_NIL;
+}
+
+static inline void bucket_remove(lrucache *c, uint32_t i) {
+    uint32_t *link = &c->buckets[c->nodes[i].tag & c->bucket_mask];
+    while (*link != i) {
+        link = &c->nodes[*link].hnext;
+    }
+    *link = c->nodes[i].hnext;
+}
+
+// 节点从链表、哈希桶、时间轮中摘下，放回空闲链
+static void remove_node(lrucache *c, uint32_t i) {
+    list_unlink(c, i);
+    bucket_remove(c, i);
+    if (c->wheel) {
+        timerwheel_cancel(c->wheel, i);
+    }
+    free_push(c, i);
+    c->size--;
+}
+
+// 时间轮的回调，定时器已摘下
+static void on_expire(void *ctx, uint32_t i) {
+    lrucache *c = ctx;
+    list_unlink(c, i);
+    bucket_remove(c, i);
+    free_push(c, i);
+    c->size--;
+    c->expirations++;
+}
+
+static inline bool node_expired(const lrucache *c, uint32_t i, uint64_t now) {
+    return timerwheel_scheduled(c->wheel, i) && timerwheel_expire(c->wheel, i) <= now;
+}
+
+// 读时钟并分摊地删除到期的键，返回当前时间
+static inline uint64_t expire_step(lrucache *c) {
+    uint64_t now = c->clock(c->clock_ctx);
+    timerwheel_advance(c->wheel, now, LRUCACHE_EXPIRE_BUDGET, on_expire, c);
+    return now;
+}
+
+static uint64_t monotonic_ms(void *ctx) {
+    (void)ctx;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+bool lrucache_init(lrucache *c, size_t capacity, size_t key_size, size_t value_size, uint64_t seed) {
+    memset(c, 0, sizeof(*c));
+    if (capacity == 0 || capacity >= LRUCACHE_NIL || key_size == 0 || key_size >= UINT32_MAX) {
+        return false;
+    }
+    size_t buckets = 1;
+    while (buckets < capacity) {
+        buckets *= 2;
+    }
+    c->key_size = key_size;
+    c->value_size = value_size;
+    c->value_offset = align8(key_size);
+    c->stride = align8(c->value_offset + value_size);
+    c->nodes = malloc((capacity + 1) * sizeof(lrucache_node));
+    c->data = malloc(capacity * c->stride);
+    c->buckets = malloc(buckets * sizeof(uint32_t));
+    if (!c->nodes || !c->data || !c->buckets) {
+        lrucache_free(c);
+        return false;
+    }
+    c->capacity = capacity;
+    c->bucket_mask = buckets - 1;
+    c->seed = seed;
+    lrucache_clear(c);
+    return true;
+}
+
+void lrucache_free(lrucache *c) {
+    if (c->wheel) {
+        timerwheel_free(c->wheel);
+        free(c->wheel);
+    }
+    free(c->nodes);
+    free(c->data);
+    free(c->buckets);
+    memset(c, 0, sizeof(*c));
+}
+
+void lrucache_clear(lrucache *c) {
+    uint32_t s = sentinel(c);
+    c->nodes[s].prev = c->nodes[s].next = s;
+    for (uint32_t i = 0; i < s; i++) {
+        c->nodes[i].prev = LRUCACHE_NIL;
+        c->nodes[i].next = i + 1 < s ? i + 1 : LRUCACHE_NIL;
+    }
+    c->free_list = 0;
+    memset(c->buckets, 0xFF, (c->bucket_mask + 1) * sizeof(uint32_t));
+    c->size = 0;
+    c->hits = c->misses = c->evictions = c->expirations = 0;
+    if (c->wheel) {
+        timerwheel_clear(c->wheel, c->clock(c->clock_ctx));
+    }
+}
+
+bool lrucache_enable_ttl(lrucache *c, lrucache_clock_fn clock, void *clock_ctx) {
+    if (c->wheel) {
+        return false;
+    }
+    c->clock = clock ? clock : monotonic_ms;
+    c->clock_ctx = clock_ctx;
+    c->wheel = malloc(sizeof(timerwheel));
+    if (!c->wheel || !timerwheel_init(c->wheel, c->capacity, 0, c->clock(c->clock_ctx))) {
+        free(c->wheel);
+        c->wheel = NULL;
+        return false;
+    }
+    return true;
+}
+
+uint64_t lrucache_hash(const lrucache *c, const void *key, size_t len) {
+    return xxh3Hash64(key, len, c->seed);
+}
+
+static inline uint32_t find(const lrucache *c, const void *key, size_t len, uint64_t hash) {
+    return len <= c->key_size ? bucket_find(c, hash_tag(hash), key, len) : LRUCACHE_NIL;
+}
+
+uint32_t lrucache_lookup_hash(const lrucache *c, const void *key, size_t len, uint64_t hash) {
+    uint32_t i = find(c, key, len, hash);
+    if (i != LRUCACHE_NIL && c->wheel && node_expired(c, i, c->clock(c->clock_ctx))) {
+        return LRUCACHE_NIL;
+    }
+    return i;
+}
+
+void lrucache_touch(lrucache *c, uint32_t node) {
+    if (node < c->capacity && c->nodes[node].prev != LRUCACHE_NIL && c->nodes[sentinel(c)].next != node) {
+        list_unlink(c, node);
+        list_push_front(c, node);
+    }
+}
+
+void *lrucache_get_hash(lrucache *c, const void *key, size_t len, uint64_t hash) {
+    uint64_t now = c->wheel ? expire_step(c) : 0;
+    uint32_t i = find(c, key, len, hash);
+    if (i != LRUCACHE_NIL && c->wheel && node_expired(c, i, now)) {
+        // 时间轮还没来得及删除的过期键
+        remove_node(c, i);
+        c->expirations++;
+        i = LRUCACHE_NIL;
+    }
+    if (i == LRUCACHE_NIL) {
+        c->misses++;
+        return NULL;
+    }
+    c->hits++;
+    lrucache_touch(c, i);
+    return node_value(c, i);
+}
+
+void *lrucache_get(lrucache *c, const void *key, size_t len) {
+    return lrucache_get_hash(c, key, len, lrucache_hash(c, key, len));
+}
+
+void *lrucache_peek(const lrucache *c, const void *key, size_t len) {
+    uint32_t i = lrucache_lookup_hash(c, key, len, lrucache_hash(c, key, len));
+    return i == LRUCACHE_NIL ? NULL : node_value(c, i);
+}
+
+// 插入或覆盖，返回节点编号；键长超过 key_size 返回 LRUCACHE_NIL
+// 开启过期时间时调用者先推进时间轮，到期的键腾出的位置可以免去一次淘汰
+static uint32_t put_node(lrucache *c, const void *key, size_t len, uint64_t hash, const void *value, void *evicted,
+                         size_t *evicted_len) {
+    if (evicted_len) {
+        *evicted_len = 0;
+    }
+    if (len > c->key_size) {
+        return LRUCACHE_NIL;
+    }
+    uint32_t tag = hash_tag(hash);
+    uint32_t i = bucket_find(c, tag, key, len);
+    if (i != LRUCACHE_NIL) {
+        list_unlink(c, i);
+    } else {
+        if (c->size == c->capacity) {
+            // 淘汰最久未使用的节点，放回空闲链
+            uint32_t victim = c->nodes[sentinel(c)].prev;
+            if (evicted) {
+                memcpy(evicted, node_key(c, victim), c->nodes[victim].key_len);
+            }
+            if (evicted_len) {
+                *evicted_len = c->nodes[victim].key_len;
+            }
+            remove_node(c, victim);
+            c->evictions++;
+        }
+        i = c->free_list;
+        c->free_list = c->nodes[i].next;
+        lrucache_node *n = &c->nodes[i];
+        n->tag = tag;
+        n->key_len = (uint32_t)len;
+        n->hnext = c->buckets[tag & c->bucket_mask];
+        c->buckets[tag & c->bucket_mask] = i;
+        memcpy(node_key(c, i), key, len);
+        if (!value && c->value_size) {
+            memset(node_value(c, i), 0, c->value_size);
+        }
+        c->size++;
+    }
+    list_push_front(c, i);
+    if (value && c->value_size) {
+        memcpy(node_value(c, i), value, c->value_size);
+    }
+    return i;
+}
+
+void *lrucache_put_hash(lrucache *c, const void *key, size_t len, uint64_t hash, const void *value, void *evicted,
+                        size_t *evicted_len) {
+    if (c->wheel) {
+        expire_step(c);
+    }
+    uint32_t i = put_node(c, key, len, hash, value, evicted, evicted_len);
+    if (i == LRUCACHE_NIL) {
+        return NULL;
+    }
+    if (c->wheel) {
+        // 不带过期时间的写入覆盖原来的过期时间
+        timerwheel_cancel(c->wheel, i);
+    }
+    return node_value(c, i);
+}
+
+void *lrucache_put(lrucache *c, const void *key, size_t len, const void *value, void *evicted,
+                   size_t *evicted_len) {
+    return lrucache_put_hash(c, key, len, lrucache_hash(c, key, len), value, evicted, evicted_len);
+}
+
+void *lrucache_put_ttl_hash(lrucache *c, const void *key, size_t len, uint64_t hash, const void *value, uint64_t ttl,
+                            void *evicted, size_t *evicted_len) {
+    if (!c->wheel) {
+        if (evicted_len) {
+            *evicted_len = 0;
+        }
+        return NULL;
+    }
+    uint64_t now = expire_step(c);
+    uint32_t i = put_node(c, key, len, hash, value, evicted, evicted_len);
+    if (i == LRUCACHE_NIL) {
+        return NULL;
+    }
+    timerwheel_schedule(c->wheel, i, ttl > UINT64_MAX - now ? UINT64_MAX : now + ttl);
+    return node_value(c, i);
+}
+
+void *lrucache_put_ttl(lrucache *c, const void *key, size_t len, const void *value, uint64_t ttl, void *evicted,
+                       size_t *evicted_len) {
+    return lrucache_put_ttl_hash(c, key, len, lrucache_hash(c, key, len), value, ttl, evicted, evicted_len);
+}
+
+size_t lrucache_expire(lrucache *c, size_t budget) {
+    return c->wheel ? timerwheel_advance(c->wheel, c->clock(c->clock_ctx), budget, on_expire, c) : 0;
+}
+
+bool lrucache_erase_hash(lrucache *c, const void *key, size_t len, uint64_t hash) {
+    uint32_t i = find(c, key, len, hash);
+    if (i == LRUCACHE_NIL) {
+        return false;
+    }
+    // 已过期还没删除的键同样删除，但按不存在返回
+    bool expired = c->wheel && node_expired(c, i, c->clock(c->clock_ctx));
+    remove_node(c, i);
+    return !expired;
+}
+
+bool lrucache_erase(lrucache *c, const void *key, size_t len) {
+    return lrucache_erase_hash(c, key, len, lrucache_hash(c, key, len));
+}
+
+bool lrucache_next(const lrucache *c, uint32_t *pos, const void **key, size_t *len, void **value) {
+    uint32_t i = c->nodes[*pos == LRUCACHE_NIL ? sentinel(c) : *pos].next;
+    if (i == sentinel(c)) {
+        return false;
+    }
+    *pos = i;
+    if (key) {
+        *key = node_key(c, i);
+    }
+    if (len) {
+        *len = c->nodes[i].key_len;
+    }
+    if (value) {
+        *value = node_value(c, i);
+    }
+    return true;
+}
+
+#ifdef LRUCACHE_MAIN
+static uint64_t test_clock(void *ctx) {
+    return *(uint64_t *)ctx;
+}
+
+int main(void) {
+    int failed = 0;
+
+    // 示例1：与 simplelru.c 的 main 相同的操作序列，整数键，容量 2
+    lrucache cache;
+    lrucache_init(&cache, 2, sizeof(uint64_t), sizeof(int), 0);
+    int v;
+    v = 1;
+    lrucache_put_u64(&cache, 1, &v);    // 缓存是 {1=1}
+    v = 2;
+    lrucache_put_u64(&cache, 2, &v);    // 缓存是 {1=1, 2=2}
+    int *got = lrucache_get_u64(&cache, 1);
+    failed |= !got || *got != 1;
+    v = 3;
+    lrucache_put_u64(&cache, 3, &v);    // 淘汰 2
+    failed |= lrucache_get_u64(&cache, 2) != NULL;
+    v = 4;
+    lrucache_put_u64(&cache, 4, &v);    // 淘汰 1
+    failed |= lrucache_get_u64(&cache, 1) != NULL;
+    got = lrucache_get_u64(&cache, 3);
+    failed |= !got || *got != 3;
+    got = lrucache_get_u64(&cache, 4);
+    failed |= !got || *got != 4;
+    // 键不再受 10001 的限制
+    uint64_t big = 0xDEADBEEFCAFEULL;
+    lrucache_put_u64(&cache, big, &v);
+    failed |= lrucache_get_u64(&cache, big) == NULL || lrucache_get_u64(&cache, 3) != NULL;
+    lrucache_free(&cache);
+
+    // 示例2：字符串键，最长 32 字节，淘汰时取回被淘汰的键
+    lrucache_init(&cache, 3, 32, sizeof(double), 0);
+    const char *names[] = {"alpha", "beta", "gamma", "delta"};
+    for (int i = 0; i < 4; i++) {
+        double d = i * 1.5;
+        char evicted[32];
+        size_t evicted_len;
+        lrucache_put(&cache, names[i], strlen(names[i]), &d, evicted, &evicted_len);
+        if (i == 3) {
+            failed |= evicted_len != 5 || memcmp(evicted, "alpha", 5) != 0;
+        }
+    }
+    failed |= lrucache_get(&cache, "gamma", 5) == NULL || lrucache_get(&cache, "alpha", 5) != NULL;
+    failed |= lrucache_erase(&cache, "beta", 4) != true || lrucache_size(&cache) != 2;
+    printf("MRU -> LRU:");
+    uint32_t pos = LRUCACHE_NIL;
+    const void *key;
+    size_t len;
+    void *value;
+    while (lrucache_next(&cache, &pos, &key, &len, &value)) {
+        printf(" %.*s=%.1f", (int)len, (const char *)key, *(double *)value);
+    }
+    printf("\nhits %llu misses %llu evictions %llu\n", (unsigned long long)cache.hits,
+           (unsigned long long)cache.misses, (unsigned long long)cache.evictions);
+    lrucache_free(&cache);
+
+    // 示例3：过期时间，时钟由测试控制，单位毫秒
+    uint64_t now = 0;
+    lrucache_init(&cache, 1000, sizeof(uint64_t), sizeof(int), 0);
+    lrucache_enable_ttl(&cache, test_clock, &now);
+    for (uint64_t k = 0; k < 1000; k++) {
+        v = (int)k;
+        // 偶数键 100ms 后过期，奇数键不过期
+        if (k % 2 == 0) {
+            lrucache_put_ttl(&cache, &k, sizeof(k), &v, 100, NULL, NULL);
+        } else {
+            lrucache_put_u64(&cache, k, &v);
+        }
+    }
+    now = 99;
+    failed |= lrucache_get_u64(&cache, 0) == NULL || lrucache_size(&cache) != 1000;
+    // 到期后查找不到（惰性检查），而 get 每次最多处理 LRUCACHE_EXPIRE_BUDGET 个，其余的还在
+    now = 100;
+    failed |= lrucache_get_u64(&cache, 2) != NULL || lrucache_peek(&cache, &(uint64_t){4}, sizeof(uint64_t)) != NULL;
+    failed |= lrucache_size(&cache) <= 500;
+    // 重新写入的键重新计时，不带过期时间的写入取消过期（它们可能已被删除，此时为新插入）
+    v = -1;
+    lrucache_put_ttl(&cache, &(uint64_t){6}, sizeof(uint64_t), &v, 50, NULL, NULL);
+    lrucache_put_u64(&cache, 8, &v);
+    lrucache_expire(&cache, 0);
+    failed |= lrucache_size(&cache) != 502;
+    now = 149;
+    failed |= lrucache_get_u64(&cache, 6) == NULL || lrucache_get_u64(&cache, 8) == NULL;
+    now = 150;
+    failed |= lrucache_get_u64(&cache, 6) != NULL;
+    now = 1000000;
+    failed |= lrucache_get_u64(&cache, 8) == NULL || lrucache_get_u64(&cache, 999) == NULL;
+    failed |= lrucache_size(&cache) != 501 || cache.wheel->count != 0;
+    printf("size %zu expirations %llu, check %s\n", lrucache_size(&cache), (unsigned long long)cache.expirations,
+           failed ? "FAILED" : "ok");
+    lrucache_free(&cache);
+    return failed;
+}
+#endif
@@ -0,0 +1,212 @@
+#ifndef DSA_LRU_LRUCACHE_H
+#define DSA_LRU_LRUCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "timerwheel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+通用 LRU 缓存，键为任意字节串（最长 key_size 字节）或整数，值为定长字节
+（1）所有节点在初始化时一次分配在 slab 中，链表与哈希链用 32 位节点编号链接，不存指针；
+    初始化之后 get/put/erase 不调用 malloc/free
+（2）哈希为 hashalg.h 的 xxh3Hash64，桶数组为不小于容量的 2 的幂，节点内存哈希值的高 32 位，比较键之前先比较它
+（3）与 simplelru.c 相比：键不再限于小于 10001 的 int，插入不再 malloc 节点，淘汰不再 free
+（4）可选的过期时间（lrucache_enable_ttl）：每个键的到期时间由分层时间轮（timerwheel.h）管理，放置与取消 O(1)；
+    到期的键在之后的 get/put 中分摊删除，每次最多处理 LRUCACHE_EXPIRE_BUDGET 个定时器，查找时再惰性检查，没有后台扫描
+*/
+
+// 无效节点编号
+#define LRUCACHE_NIL UINT32_MAX
+
+// 开启过期时间后每次 get/put 最多处理的定时器数（删除到期的键或在时间轮中下降一层）
+#define LRUCACHE_EXPIRE_BUDGET 8
+
+// 时钟，返回单调递增的当前时间，单位与 ttl 相同
+typedef uint64_t (*lrucache_clock_fn)(void *ctx);
+
+// 节点元信息，键和值在 data 中按节点编号定位
+typedef struct {
+    uint32_t prev;      // 链表中更新一个的节点，头为最近使用；空闲节点为 LRUCACHE_NIL
+    uint32_t next;      // 链表中更旧一个的节点；空闲节点用它串成空闲链
+    uint32_t hnext;     // 同一个桶中的下一个节点
+    uint32_t tag;       // 哈希值的高 32 位
+    uint32_t key_len;
+} lrucache_node;
+
+typedef struct {
+    lrucache_node *nodes;   // capacity + 1 个，最后一个为链表的哨兵
+    unsigned char *data;    // 每个节点 stride 字节：键（key_size 字节）后接值
+    uint32_t *buckets;      // 桶 -> 第一个节点
+    size_t bucket_mask;
+    size_t capacity;
+    size_t size;
+    size_t key_size;        // 键的最大字节数
+    size_t value_size;
+    size_t value_offset;    // 值在 stride 中的偏移，按 8 字节对齐
+    size_t stride;
+    uint32_t free_list;     // 空闲节点链
+    uint64_t seed;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t expirations;   // 因过期删除的键数
+    timerwheel *wheel;      // 过期时间，未开启时为 NULL
+    lrucache_clock_fn clock;
+    void *clock_ctx;
+} lrucache;
+
+/**
+* @brief             初始化
+* @param   capacity  最多缓存的键数，范围 [1, UINT32_MAX - 1]
+* @param   key_size  键的最大字节数，整数键为 sizeof(整数)
+* @param   value_size 值的字节数，可为 0
+* @param   seed      哈希种子
+* @return  bool      参数非法或申请内存失败返回 false
+*
+* @note              全部内存在这里一次分配
+*/
+bool lrucache_init(lrucache *c, size_t capacity, size_t key_size, size_t value_size, uint64_t seed);
+
+/**
+* @brief             释放
+*
+* @note              Revision History
+*/
+void lrucache_free(lrucache *c);
+
+/**
+* @brief             清空，不释放内存
+*
+* @note              Revision History
+*/
+void lrucache_clear(lrucache *c);
+
+/**
+* @brief             开启过期时间，之后可用 lrucache_put_ttl 写入带过期时间的键
+* @param   clock     时钟，NULL 为 CLOCK_MONOTONIC 的毫秒数
+* @param   clock_ctx 传给 clock 的参数
+* @return  bool      已开启或申请内存失败返回 false
+*
+* @note              时间轮有 capacity 个定时器，每个 16 字节；在第一次写入之前调用
+*/
+bool lrucache_enable_ttl(lrucache *c, lrucache_clock_fn clock, void *clock_ctx);
+
+/**
+* @brief             查找并标记为最近使用
+* @return  void*     值的地址，在该键被淘汰、删除或过期前有效；不存在或已过期返回 NULL
+*
+* @note              value_size 为 0 时命中返回键的地址
+*/
+void *lrucache_get(lrucache *c, const void *key, size_t len);
+void *lrucache_get_hash(lrucache *c, const void *key, size_t len, uint64_t hash);
+
+/**
+* @brief             查找，不改变顺序，也不计入命中统计
+*
+* @note              Revision History
+*/
+void *lrucache_peek(const lrucache *c, const void *key, size_t len);
+
+/**
+* @brief             插入或覆盖，并标记为最近使用；已满时淘汰最久未使用的键
+* @param   value     value_size 字节，为 NULL 时新键的值清零、已有键的值不变
+* @param   evicted   被淘汰的键的副本（key_size 字节），可为 NULL
+* @param   evicted_len 被淘汰的键的长度，没有淘汰时为 0，可为 NULL
+* @return  void*     值的地址；键长超过 key_size 返回 NULL
+*
+* @note              已有键原来的过期时间被取消，不再过期
+*/
+void *lrucache_put(lrucache *c, const void *key, size_t len, const void *value, void *evicted,
+                   size_t *evicted_len);
+void *lrucache_put_hash(lrucache *c, const void *key, size_t len, uint64_t hash, const void *value, void *evicted,
+                        size_t *evicted_len);
+
+/**
+* @brief             同 lrucache_put，键在 ttl 个时钟单位后过期
+* @return  void*     值的地址；键长超过 key_size 或未开启过期时间返回 NULL
+*
+* @note              已有键的过期时间重新计算
+*/
+void *lrucache_put_ttl(lrucache *c, const void *key, size_t len, const void *value, uint64_t ttl, void *evicted,
+                       size_t *evicted_len);
+void *lrucache_put_ttl_hash(lrucache *c, const void *key, size_t len, uint64_t hash, const void *value, uint64_t ttl,
+                            void *evicted, size_t *evicted_len);
+
+/**
+* @brief             删除到期的键
+* @param   budget    最多处理的定时器个数（含时间轮内部的下降），0 表示不限
+* @return  size_t    删除的个数
+*
+* @note              get/put 已分摊地删除，一般不需要调用；遍历前可调用它使遍历不包含已过期的键
+*/
+size_t lrucache_expire(lrucache *c, size_t budget);
+
+/**
+* @brief             删除
+* @return  bool      键不存在或已过期返回 false
+*
+* @note              Revision History
+*/
+bool lrucache_erase(lrucache *c, const void *key, size_t len);
+bool lrucache_erase_hash(lrucache *c, const void *key, size_t len, uint64_t hash);
+
+/**
+* @brief             键的哈希值，_hash 系列函数使用
+*
+* @note              调用者已算过哈希值（如分片选择）时可省去重复计算
+*/
+uint64_t lrucache_hash(const lrucache *c, const void *key, size_t len);
+
+/**
+* @brief             查找节点编号，不改变顺序
+* @return  uint32_t  不存在或已过期返回 LRUCACHE_NIL
+*
+* @note              编号在该键被淘汰或删除后可能分配给其他键
+*/
+uint32_t lrucache_lookup_hash(const lrucache *c, const void *key, size_t len, uint64_t hash);
+
+/**
+* @brief             把节点标记为最近使用
+*
+* @note              节点已被淘汰或删除时不做任何事，可用于延迟、批量地应用命中
+*/
+void lrucache_touch(lrucache *c, uint32_t node);
+
+// 节点的值，节点必须在使用中
+static inline void *lrucache_value_at(const lrucache *c, uint32_t node) {
+    return c->data + (size_t)node * c->stride + (c->value_size ? c->value_offset : 0);
+}
+
+/**
+* @brief             从最近使用到最久未使用遍历
+* @param   pos       游标，开始前置为 LRUCACHE_NIL
+* @return  bool      没有更多元素返回 false
+*
+* @note              遍历期间不能修改缓存；包含已过期但还没删除的键
+*/
+bool lrucache_next(const lrucache *c, uint32_t *pos, const void **key, size_t *len, void **value);
+
+static inline size_t lrucache_size(const lrucache *c) {
+    return c->size;
+}
+
+// 整数键
+static inline void *lrucache_get_u64(lrucache *c, uint64_t key) {
+    return lrucache_get(c, &key, sizeof(key));
+}
+
+static inline void *lrucache_put_u64(lrucache *c, uint64_t key, const void *value) {
+    return lrucache_put(c, &key, sizeof(key), value, NULL, NULL);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_LRU_LRUCACHE_H
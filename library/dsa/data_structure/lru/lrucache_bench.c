@@ -0,0 +1,163 @@
+// LRU 缓存性能测试：Zipf(0.99) 访问流，未命中时 put，整数键与字符串键各一轮
+// （1）对照：uthash 加每个节点 malloc 的 LRU（uthash/tests/lru_cache 的做法：命中时删除再插入移到末尾，淘汰时 free）
+// （2）lrucache：slab 节点与编号链接
+// 两者命中率必须相同；lrucache 初始化之后堆上已分配字节数不变
+// 用法：./lrucache_bench [访问次数] [键空间大小] [容量]，默认 10M、1M、100K
+#include <malloc.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hashalg.h"
+#include "lrucache.h"
+#include "uthash.h"
+
+#define KEY_MAX 24
+
+static inline double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// 已分配字节数，大块由 mmap 分配，单独统计
+static inline size_t heap_used(void) {
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+// Zipf(0.99)：按累积分布二分查找，键编号打乱
+static uint64_t *zipf_trace(size_t n, size_t universe) {
+    double *cdf = malloc(universe * sizeof(double));
+    double sum = 0;
+    for (size_t k = 0; k < universe; k++) {
+        sum += 1.0 / pow((double)(k + 1), 0.99);
+        cdf[k] = sum;
+    }
+    uint64_t *trace = malloc(n * sizeof(uint64_t));
+    uint64_t state = 42;
+    for (size_t i = 0; i < n; i++) {
+        double u = (double)(splitmix64(&state) >> 11) / 9007199254740992.0 * sum;
+        size_t lo = 0, hi = universe - 1;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (cdf[mid] < u) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        trace[i] = lo * 0x9E3779B97F4A7C15ULL;
+    }
+    free(cdf);
+    return trace;
+}
+
+// 对照实现：uthash 双向链表保持插入顺序，表头为最久未使用
+typedef struct {
+    char key[KEY_MAX];
+    uint64_t value;
+    UT_hash_handle hh;
+} ut_node;
+
+typedef struct {
+    double seconds;
+    size_t hits;
+    size_t mallocs;
+    size_t heap_growth;
+} result;
+
+// 键：整数键为 8 字节的编号，字符串键为 "object:" 加十进制编号
+static inline size_t make_key(uint64_t id, bool string_key, char *buf) {
+    if (!string_key) {
+        memcpy(buf, &id, sizeof(id));
+        return sizeof(id);
+    }
+    return (size_t)snprintf(buf, KEY_MAX, "object:%llu", (unsigned long long)(id % 100000000000000ULL));
+}
+
+static result run_uthash(const uint64_t *trace, size_t n, size_t capacity, bool string_key) {
+    result r = {0};
+    ut_node *table = NULL;
+    char key[KEY_MAX];
+    double start = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        size_t len = make_key(trace[i], string_key, key);
+        ut_node *e;
+        HASH_FIND(hh, table, key, len, e);
+        if (e) {
+            // 移到末尾
+            HASH_DELETE(hh, table, e);
+            HASH_ADD_KEYPTR(hh, table, e->key, len, e);
+            r.hits++;
+            continue;
+        }
+        if (HASH_COUNT(table) >= capacity) {
+            ut_node *oldest = table;
+            HASH_DELETE(hh, table, oldest);
+            free(oldest);
+        }
+        e = malloc(sizeof(ut_node));
+        r.mallocs++;
+        memcpy(e->key, key, len);
+        e->value = trace[i];
+        HASH_ADD_KEYPTR(hh, table, e->key, len, e);
+    }
+    r.seconds = now_sec() - start;
+    ut_node *e, *tmp;
+    HASH_ITER(hh, table, e, tmp) {
+        HASH_DELETE(hh, table, e);
+        free(e);
+    }
+    return r;
+}
+
+static result run_lrucache(const uint64_t *trace, size_t n, size_t capacity, bool string_key) {
+    result r = {0};
+    lrucache c;
+    lrucache_init(&c, capacity, string_key ? KEY_MAX : sizeof(uint64_t), sizeof(uint64_t), 0);
+    char key[KEY_MAX];
+    size_t before = heap_used();
+    double start = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        size_t len = make_key(trace[i], string_key, key);
+        uint64_t *v = lrucache_get(&c, key, len);
+        if (v) {
+            r.hits += *v == trace[i];
+            continue;
+        }
+        lrucache_put(&c, key, len, &trace[i], NULL, NULL);
+    }
+    r.seconds = now_sec() - start;
+    r.heap_growth = heap_used() - before;
+    lrucache_free(&c);
+    return r;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+    size_t universe = argc > 2 ? strtoull(argv[2], NULL, 10) : 1000000;
+    size_t capacity = argc > 3 ? strtoull(argv[3], NULL, 10) : 100000;
+    uint64_t *trace = zipf_trace(n, universe);
+    int failed = 0;
+
+    printf("Zipf(0.99) trace: %zu accesses over %zu keys, capacity %zu\n", n, universe, capacity);
+    printf("%-10s %-22s %10s %10s %12s %14s\n", "key", "cache", "M ops/s", "hit %", "mallocs", "heap growth");
+    for (int s = 0; s < 2; s++) {
+        bool string_key = s == 1;
+        result a = run_uthash(trace, n, capacity, string_key);
+        result b = run_lrucache(trace, n, capacity, string_key);
+        const char *kind = string_key ? "string" : "uint64";
+        printf("%-10s %-22s %10.1f %10.2f %12zu %14s\n", kind, "uthash + malloc node", (double)n / a.seconds / 1e6,
+               100.0 * (double)a.hits / (double)n, a.mallocs, "-");
+        printf("%-10s %-22s %10.1f %10.2f %12d %14zu\n", kind, "lrucache", (double)n / b.seconds / 1e6,
+               100.0 * (double)b.hits / (double)n, 0, b.heap_growth);
+        failed |= a.hits != b.hits || b.heap_growth != 0;
+    }
+    printf("check %s\n", failed ? "FAILED" : "ok");
+
+    free(trace);
+    return failed;
+}
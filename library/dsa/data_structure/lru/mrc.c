@@ -0,0 +1,328 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mrc.h"
+
+/*
+一、时间戳与树状数组
+（1）每次被采样的访问分配一个递增的时间戳；键的上次访问时间戳 last 处为 1，其余为 0，
+    距离 = (last, now) 内 1 的个数，即 prefix(now) - prefix(last + 1)
+（2）时间戳用到 stamps 时压缩：按顺序把仍为 1 的时间戳重新编号为 0, 1, 2...，线性重建树状数组；
+    存活的时间戳超过一半时 stamps 翻倍，所以两次压缩之间至少有 stamps / 2 次访问，均摊 O(1)
+
+二、两个哈希
+（1）采样用 shards_hash（splitmix64 的混合函数），hasht 的索引用另一个常数混合后的值；
+    若共用一个哈希，被采样的键的哈希值都小于阈值，高位全为 0，会挤在 hasht 的少数几个组里、控制字节也都相同
+*/
+
+static inline uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t shards_hash(uint64_t key) {
+    return mix64(key + 0x9E3779B97F4A7C15ULL);
+}
+
+uint64_t shards_threshold(double rate) {
+    return rate >= 1 ? UINT64_MAX : (uint64_t)(rate * 18446744073709551616.0);
+}
+
+static inline bool sampled(uint64_t threshold, uint64_t hash) {
+    return threshold == UINT64_MAX || hash < threshold;
+}
+
+static uint64_t index_hash(const void *key, size_t len, uint64_t seed) {
+    (void)len;
+    uint64_t k;
+    memcpy(&k, key, sizeof(k));
+    return mix64(k ^ 0xD6E8FEB86659FD93ULL ^ seed);
+}
+
+// 树状数组，pos 从 0 开始
+static inline void tree_add(shards_mrc *m, size_t pos, int32_t delta) {
+    for (size_t i = pos + 1; i <= m->stamps; i += i & -i) {
+        m->tree[i] += (uint32_t)delta;
+    }
+}
+
+// [0, pos) 内 1 的个数
+static inline uint32_t tree_prefix(const shards_mrc *m, size_t pos) {
+    uint32_t sum = 0;
+    for (size_t i = pos; i > 0; i -= i & -i) {
+        sum += m->tree[i];
+    }
+    return sum;
+}
+
+static bool compact(shards_mrc *m) {
+    size_t live = hasht_size(&m->index);
+    if (live > m->stamps / 2) {
+        size_t stamps = m->stamps * 2;
+        uint32_t *tree = realloc(m->tree, (stamps + 1) * sizeof(uint32_t));
+        if (tree) {
+            m->tree = tree;
+        }
+        uint64_t *stamp_key = realloc(m->stamp_key, stamps * sizeof(uint64_t));
+        if (stamp_key) {
+            m->stamp_key = stamp_key;
+        }
+        unsigned char *flags = realloc(m->live, stamps);
+        if (flags) {
+            m->live = flags;
+        }
+        if (!tree || !stamp_key || !flags) {
+            return false;
+        }
+        m->stamps = stamps;
+    }
+    size_t j = 0;
+    for (size_t ts = 0; ts < m->now; ts++) {
+        if (m->live[ts]) {
+            uint64_t key = m->stamp_key[ts];
+            m->stamp_key[j] = key;
+            *(uint64_t *)hasht_find(&m->index, &key) = j;
+            j++;
+        }
+    }
+    m->now = j;
+    memset(m->live, 1, j);
+    memset(m->live + j, 0, m->stamps - j);
+    // 线性建树：每个节点加到父节点
+    memset(m->tree, 0, (m->stamps + 1) * sizeof(uint32_t));
+    for (size_t i = 1; i <= m->stamps; i++) {
+        m->tree[i] += m->live[i - 1];
+        size_t parent = i + (i & -i);
+        if (parent <= m->stamps) {
+            m->tree[parent] += m->tree[i];
+        }
+    }
+    return true;
+}
+
+// 最大堆，按采样哈希值比较
+static void heap_push(shards_mrc *m, uint64_t key) {
+    size_t i = m->heap_size++;
+    uint64_t h = shards_hash(key);
+    while (i > 0 && shards_hash(m->heap[(i - 1) / 2]) < h) {
+        m->heap[i] = m->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    m->heap[i] = key;
+}
+
+static uint64_t heap_pop(shards_mrc *m) {
+    uint64_t top = m->heap[0];
+    uint64_t last = m->heap[--m->heap_size];
+    uint64_t h = shards_hash(last);
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= m->heap_size) {
+            break;
+        }
+        if (child + 1 < m->heap_size && shards_hash(m->heap[child + 1]) > shards_hash(m->heap[child])) {
+            child++;
+        }
+        if (shards_hash(m->heap[child]) <= h) {
+            break;
+        }
+        m->heap[i] = m->heap[child];
+        i = child;
+    }
+    m->heap[i] = last;
+    return top;
+}
+
+bool shards_mrc_init(shards_mrc *m, double rate, size_t max_keys, size_t max_size, size_t bins) {
+    memset(m, 0, sizeof(*m));
+    if (!(rate > 0 && rate <= 1) || max_size == 0 || bins == 0) {
+        return false;
+    }
+    m->threshold = shards_threshold(rate);
+    m->rate = rate;
+    m->max_keys = max_keys;
+    m->bins = bins;
+    m->bin_width = (double)max_size / (double)bins;
+    m->stamps = 1024;
+    m->tree = calloc(m->stamps + 1, sizeof(uint32_t));
+    m->stamp_key = malloc(m->stamps * sizeof(uint64_t));
+    m->live = calloc(m->stamps, 1);
+    m->hist = calloc(bins, sizeof(double));
+    m->heap = max_keys ? malloc((max_keys + 1) * sizeof(uint64_t)) : NULL;
+    if (!hasht_init(&m->index, sizeof(uint64_t), sizeof(uint64_t), index_hash, 0) || !m->tree || !m->stamp_key ||
+        !m->live || !m->hist || (max_keys && !m->heap)) {
+        shards_mrc_free(m);
+        return false;
+    }
+    return true;
+}
+
+void shards_mrc_free(shards_mrc *m) {
+    hasht_free(&m->index);
+    free(m->tree);
+    free(m->stamp_key);
+    free(m->live);
+    free(m->hist);
+    free(m->heap);
+    memset(m, 0, sizeof(*m));
+}
+
+// 从样本中删除一个键
+static void forget(shards_mrc *m, uint64_t key) {
+    uint64_t *ts = hasht_find(&m->index, &key);
+    m->live[*ts] = 0;
+    tree_add(m, *ts, -1);
+    hasht_erase(&m->index, &key);
+}
+
+bool shards_mrc_access(shards_mrc *m, uint64_t key) {
+    m->accesses++;
+    if (!sampled(m->threshold, shards_hash(key))) {
+        return true;
+    }
+    if (m->now == m->stamps && !compact(m)) {
+        return false;
+    }
+    m->sampled++;
+    double weight = 1.0 / m->rate;
+    m->total += weight;
+
+    uint64_t *ts = hasht_find(&m->index, &key);
+    if (ts) {
+        uint32_t distance = tree_prefix(m, m->now) - tree_prefix(m, *ts + 1);
+        m->live[*ts] = 0;
+        tree_add(m, *ts, -1);
+        *ts = m->now;
+        size_t bin = (size_t)((double)distance / m->rate / m->bin_width);
+        if (bin < m->bins) {
+            m->hist[bin] += weight;
+        } else {
+            m->overflow += weight;
+        }
+    } else {
+        if (!hasht_insert(&m->index, &key, &m->now)) {
+            return false;
+        }
+        m->cold += weight;
+    }
+    m->stamp_key[m->now] = key;
+    m->live[m->now] = 1;
+    tree_add(m, m->now, 1);
+    m->now++;
+
+    if (!ts && m->max_keys) {
+        heap_push(m, key);
+        if (m->heap_size > m->max_keys) {
+            // 阈值降到被删除的键的哈希值，之后哈希值不小于它的键都不再采样
+            uint64_t victim = heap_pop(m);
+            m->threshold = shards_hash(victim);
+            m->rate = (double)m->threshold / 18446744073709551616.0;
+            forget(m, victim);
+        }
+    }
+    return true;
+}
+
+double shards_mrc_miss_ratio(const shards_mrc *m, size_t size) {
+    // SHARDS_adj：加权后的采样次数应等于全部访问次数，差额（热键恰好多采或少采造成）按距离 0 计入，
+    // 固定采样率时即为"期望采样次数 N * R 与实际之差"，固定样本数时每次访问按当时的采样率计
+    double total = (double)m->accesses;
+    if (total <= 0) {
+        return 0;
+    }
+    double misses = m->cold + m->overflow;
+    for (size_t i = (size_t)((double)size / m->bin_width); i < m->bins; i++) {
+        misses += m->hist[i];
+    }
+    double ratio = misses / total;
+    return ratio < 1 ? ratio : 1;
+}
+
+#ifdef MRC_MAIN
+#include <time.h>
+
+#include "cachepolicy.h"
+#include "hashalg.h"
+
+int main(void) {
+    int failed = 0;
+    enum { N = 2000000, UNIVERSE = 200000, MAX_SIZE = 100000 };
+
+    // Zipf(0.9) 访问流
+    double *cdf = malloc(UNIVERSE * sizeof(double));
+    double sum = 0;
+    for (size_t k = 0; k < UNIVERSE; k++) {
+        sum += 1.0 / pow((double)(k + 1), 0.9);
+        cdf[k] = sum;
+    }
+    uint64_t *trace = malloc(N * sizeof(uint64_t));
+    uint64_t state = 7;
+    for (size_t i = 0; i < N; i++) {
+        double u = (double)(splitmix64(&state) >> 11) / 9007199254740992.0 * sum;
+        size_t lo = 0, hi = UNIVERSE - 1;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (cdf[mid] < u) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        trace[i] = lo;
+    }
+    free(cdf);
+
+    // 示例1：采样率 1、直方图每格 1 个键时与逐个容量模拟 LRU 的结果完全相同
+    // 示例2：SHARDS 采样率 1%、固定 8000 个样本键，与精确值相差应在 0.02 以内；
+    // 容量小于几倍 1 / R 时样本中的距离只有个位数，误差较大，不检查
+    shards_mrc exact, rated, fixed;
+    shards_mrc_init(&exact, 1.0, 0, MAX_SIZE, MAX_SIZE);
+    shards_mrc_init(&rated, 0.01, 0, MAX_SIZE, 1000);
+    shards_mrc_init(&fixed, 1.0, 8000, MAX_SIZE, 1000);
+    double t0 = (double)clock() / CLOCKS_PER_SEC;
+    for (size_t i = 0; i < N; i++) {
+        failed |= !shards_mrc_access(&exact, trace[i]);
+    }
+    double t1 = (double)clock() / CLOCKS_PER_SEC;
+    for (size_t i = 0; i < N; i++) {
+        failed |= !shards_mrc_access(&rated, trace[i]);
+    }
+    double t2 = (double)clock() / CLOCKS_PER_SEC;
+    for (size_t i = 0; i < N; i++) {
+        failed |= !shards_mrc_access(&fixed, trace[i]);
+    }
+    double t3 = (double)clock() / CLOCKS_PER_SEC;
+
+    printf("%8s %10s %10s %10s %10s\n", "size", "lru sim", "exact", "R=0.01", "8000 keys");
+    size_t sizes[] = {100, 1000, 5000, 10000, 25000, 50000, 100000};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        cache_policy *lru = cache_policy_create(&cache_policy_lru, sizes[s]);
+        size_t misses = 0;
+        for (size_t i = 0; i < N; i++) {
+            misses += !cache_policy_access(lru, trace[i]);
+        }
+        cache_policy_destroy(lru);
+        double sim = (double)misses / N;
+        double e = shards_mrc_miss_ratio(&exact, sizes[s]);
+        double r = shards_mrc_miss_ratio(&rated, sizes[s]);
+        double f = shards_mrc_miss_ratio(&fixed, sizes[s]);
+        printf("%8zu %10.4f %10.4f %10.4f %10.4f\n", sizes[s], sim, e, r, f);
+        failed |= fabs(sim - e) > 1e-9;
+        if (sizes[s] >= 5000) {
+            failed |= fabs(r - e) > 0.02 || fabs(f - e) > 0.02;
+        }
+    }
+    printf("seconds: exact %.2f, R=0.01 %.2f, 8000 keys %.2f (final rate %.4f)\n", t1 - t0, t2 - t1, t3 - t2,
+           fixed.rate);
+    shards_mrc_free(&exact);
+    shards_mrc_free(&rated);
+    shards_mrc_free(&fixed);
+    free(trace);
+    printf("check %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
+#endif
@@ -0,0 +1,98 @@
+#ifndef DSA_LRU_MRC_H
+#define DSA_LRU_MRC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hasht.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+LRU 缺失率曲线（miss ratio curve）：一遍回放得到所有缓存大小下的缺失率
+（1）LRU 的栈性质：容量为 c 的 LRU 命中一次访问，当且仅当该键上次访问以来访问过的不同键少于 c 个（重用距离 < c），
+    所以统计一遍重用距离的直方图，任意 c 的缺失率 = 距离 ≥ c 的访问（含首次访问）所占比例
+（2）重用距离：每个键记上次访问的时间戳，树状数组在每个键最近一次访问的时间戳处记 1，
+    两次访问之间 1 的个数即为距离，每次访问 O(log n)；时间戳用满后按顺序重新编号，均摊 O(1)
+（3）SHARDS 空间采样（Waldspurger et al., FAST 2015）：只处理哈希值小于阈值 T 的键，采样率 R = T / 2^64，
+    采到的键的全部访问都保留，样本中的距离除以 R 即为原始距离的估计；内存与时间都按 R 缩小，
+    R = 0.001 时误差通常在百分之一以内
+（4）按 SHARDS_adj 修正：加权后的采样次数与实际访问次数之差（热键恰好多采或少采）计入距离 0
+（5）固定样本数（max_keys）：样本中的键超过上限时删除哈希值最大的键并把阈值降到它的哈希值，
+    内存有上界；采样率随之下降，每次访问按当时的 1 / R 加权
+*/
+
+typedef struct {
+    uint64_t threshold;     // 键的采样哈希值小于它才处理，UINT64_MAX 表示全部处理
+    double rate;            // threshold / 2^64
+    size_t max_keys;        // 0 表示固定采样率
+    hasht index;            // 键 -> 上次访问的时间戳
+    uint32_t *tree;         // 树状数组，下标从 1 开始
+    uint64_t *stamp_key;    // 时间戳 -> 键
+    unsigned char *live;    // 时间戳是否为某个键最近一次访问
+    size_t stamps;          // 时间戳的容量
+    size_t now;             // 下一个时间戳
+    uint64_t *heap;         // 固定样本数时按采样哈希值的最大堆，存键
+    size_t heap_size;
+    double *hist;           // 距离（已按采样率放大）的直方图，每格 bin_width
+    size_t bins;
+    double bin_width;
+    double cold;            // 首次访问
+    double overflow;        // 距离超出直方图范围
+    double total;           // 加权后的访问次数
+    uint64_t accesses;      // 全部访问次数
+    uint64_t sampled;       // 采样到的访问次数
+} shards_mrc;
+
+/**
+* @brief             初始化
+* @param   rate      采样率 (0, 1]，1 为精确计算
+* @param   max_keys  样本中最多保留的键数，0 表示固定采样率
+* @param   max_size  直方图覆盖的最大缓存大小（键数），更大的距离只计入 overflow
+* @param   bins      直方图格数，缓存大小的分辨率为 max_size / bins
+* @return  bool      参数非法或申请内存失败返回 false
+*
+* @note              Revision History
+*/
+bool shards_mrc_init(shards_mrc *m, double rate, size_t max_keys, size_t max_size, size_t bins);
+
+/**
+* @brief             释放
+*
+* @note              Revision History
+*/
+void shards_mrc_free(shards_mrc *m);
+
+/**
+* @brief             回放一次访问
+* @return  bool      扩大时间戳数组或插入索引时申请内存失败返回 false，之后的结果不可信，只能 free
+*
+* @note              未采样的键只算一次哈希
+*/
+bool shards_mrc_access(shards_mrc *m, uint64_t key);
+
+/**
+* @brief             容量为 size 的 LRU 缓存的缺失率估计
+*
+* @note              size 按直方图的格对齐，超出 max_size 时只计首次访问与 overflow
+*/
+double shards_mrc_miss_ratio(const shards_mrc *m, size_t size);
+
+/**
+* @brief             键的采样哈希值，小于某个阈值即被采样
+*
+* @note              固定采样率的模拟（如 cache_sim 中其他策略的缩小模拟）可用它与 threshold 比较
+*/
+uint64_t shards_hash(uint64_t key);
+
+// 按采样率换算阈值
+uint64_t shards_threshold(double rate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_LRU_MRC_H
@@ -0,0 +1,197 @@
+// 淘汰策略对比：同一访问序列回放到各策略、各容量，输出命中率与吞吐
+// （1）Zipf(0.99)：1M 个键上的热点访问
+// （2）Zipf + 扫描：同样的热点访问，每 1/10 插入一次 300K 行的全表扫描（模拟每小时的全表扫描）
+// （3）循环：顺序循环访问 150K 个键，比所有容量都大，LRU 命中率为 0
+// 用法：./policy_bench [访问次数]，默认 10M
+//       ./policy_bench text|arc|bin64|bin32 文件 [容量...]，回放 trace 文件（见 trace.h），默认容量 1K、10K、100K
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cachepolicy.h"
+#include "hashalg.h"
+#include "trace.h"
+
+#define MAX_CAPACITIES 8
+#define BATCH 65536
+
+static inline double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Zipf(0.99)：按累积分布二分查找，键编号打乱；scan 非 0 时每 n / 10 次访问后插入一次 scan 行的顺序扫描
+static uint64_t *zipf_trace(size_t n, size_t universe, size_t scan, size_t *length) {
+    double *cdf = malloc(universe * sizeof(double));
+    double sum = 0;
+    for (size_t k = 0; k < universe; k++) {
+        sum += 1.0 / pow((double)(k + 1), 0.99);
+        cdf[k] = sum;
+    }
+    uint64_t *trace = malloc((n + 10 * scan) * sizeof(uint64_t));
+    uint64_t state = 42;
+    size_t len = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (scan && i % (n / 10) == n / 20) {
+            for (size_t row = 0; row < scan; row++) {
+                trace[len++] = (1ULL << 62) + row;
+            }
+        }
+        double u = (double)(splitmix64(&state) >> 11) / 9007199254740992.0 * sum;
+        size_t lo = 0, hi = universe - 1;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (cdf[mid] < u) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        trace[len++] = lo * 0x9E3779B97F4A7C15ULL;
+    }
+    free(cdf);
+    *length = len;
+    return trace;
+}
+
+static uint64_t *loop_trace(size_t n, size_t keys) {
+    uint64_t *trace = malloc(n * sizeof(uint64_t));
+    for (size_t i = 0; i < n; i++) {
+        trace[i] = i % keys;
+    }
+    return trace;
+}
+
+// 各策略、各容量的一组缓存，按批回放，trace 文件只读一遍
+typedef struct {
+    size_t policies;
+    size_t capacities;
+    size_t capacity[MAX_CAPACITIES];
+    cache_policy *cache[8][MAX_CAPACITIES];
+    uint64_t hits[8][MAX_CAPACITIES];
+    double seconds[8][MAX_CAPACITIES];
+    uint64_t total;
+} replay;
+
+static void replay_init(replay *r, const size_t *capacity, size_t capacities) {
+    memset(r, 0, sizeof(*r));
+    r->capacities = capacities;
+    memcpy(r->capacity, capacity, capacities * sizeof(size_t));
+    for (size_t p = 0; cache_policy_all[p]; p++, r->policies++) {
+        for (size_t c = 0; c < capacities; c++) {
+            r->cache[p][c] = cache_policy_create(cache_policy_all[p], capacity[c]);
+        }
+    }
+}
+
+static void replay_batch(replay *r, const uint64_t *keys, size_t n) {
+    for (size_t p = 0; p < r->policies; p++) {
+        for (size_t c = 0; c < r->capacities; c++) {
+            cache_policy *cache = r->cache[p][c];
+            uint64_t hits = 0;
+            double start = now_sec();
+            for (size_t i = 0; i < n; i++) {
+                hits += cache_policy_access(cache, keys[i]);
+            }
+            r->seconds[p][c] += now_sec() - start;
+            r->hits[p][c] += hits;
+        }
+    }
+    r->total += n;
+}
+
+// 输出命中率表，最后一列为最大容量下的吞吐；返回 hit[p] 为最大容量下各策略的命中率
+static void replay_report(replay *r, const char *title, double *hit) {
+    printf("\n%s: %llu accesses\n%-10s", title, (unsigned long long)r->total, "policy");
+    for (size_t c = 0; c < r->capacities; c++) {
+        printf(" %10zu", r->capacity[c]);
+    }
+    printf(" %12s\n", "M ops/s");
+    for (size_t p = 0; p < r->policies; p++) {
+        printf("%-10s", cache_policy_all[p]->name);
+        for (size_t c = 0; c < r->capacities; c++) {
+            printf(" %9.2f%%", 100.0 * (double)r->hits[p][c] / (double)(r->total ? r->total : 1));
+            cache_policy_destroy(r->cache[p][c]);
+        }
+        size_t last = r->capacities - 1;
+        printf(" %12.1f\n", (double)r->total / r->seconds[p][last] / 1e6);
+        if (hit) {
+            hit[p] = 100.0 * (double)r->hits[p][last] / (double)(r->total ? r->total : 1);
+        }
+    }
+}
+
+static void replay_array(const char *title, const uint64_t *trace, size_t n, const size_t *capacity,
+                         size_t capacities, double *hit) {
+    replay r;
+    replay_init(&r, capacity, capacities);
+    for (size_t i = 0; i < n; i += BATCH) {
+        replay_batch(&r, trace + i, n - i < BATCH ? n - i : BATCH);
+    }
+    replay_report(&r, title, hit);
+}
+
+static int replay_file(const char *format_name, const char *path, const size_t *capacity, size_t capacities) {
+    trace_format format;
+    trace_reader reader;
+    if (!trace_format_parse(format_name, &format) || !trace_open(&reader, path, format)) {
+        fprintf(stderr, "cannot open %s trace %s\n", format_name, path);
+        return 1;
+    }
+    replay r;
+    replay_init(&r, capacity, capacities);
+    uint64_t *keys = malloc(BATCH * sizeof(uint64_t));
+    size_t n;
+    while ((n = trace_read(&reader, keys, BATCH)) > 0) {
+        replay_batch(&r, keys, n);
+    }
+    free(keys);
+    trace_close(&reader);
+    replay_report(&r, path, NULL);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    size_t capacity[MAX_CAPACITIES] = {1000, 10000, 100000};
+    size_t capacities = 3;
+
+    if (argc > 2) {
+        if (argc > 3) {
+            capacities = 0;
+            for (int i = 3; i < argc && capacities < MAX_CAPACITIES; i++) {
+                capacity[capacities++] = strtoull(argv[i], NULL, 10);
+            }
+        }
+        return replay_file(argv[1], argv[2], capacity, capacities);
+    }
+
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+    size_t length;
+    double zipf_hit[8], scan_hit[8], loop_hit[8];
+    uint64_t *trace = zipf_trace(n, 1000000, 0, &length);
+    replay_array("Zipf(0.99) over 1M keys", trace, length, capacity, capacities, zipf_hit);
+    free(trace);
+    trace = zipf_trace(n, 1000000, 300000, &length);
+    replay_array("Zipf(0.99) + 10 scans of 300K rows", trace, length, capacity, capacities, scan_hit);
+    free(trace);
+    trace = loop_trace(n, 150000);
+    replay_array("loop over 150K keys", trace, n, capacity, capacities, loop_hit);
+    free(trace);
+
+    // 抗扫描：有扫描时其他策略都不应比 LRU 差
+    // 循环访问下 LRU 为 0，W-TinyLFU、2Q、CLOCK-Pro 应能保住一部分；ARC 的 T1 满时直接淘汰、不进 B1，循环下与 LRU 相同
+    int failed = 0;
+    for (size_t p = 1; cache_policy_all[p]; p++) {
+        failed |= scan_hit[p] < scan_hit[0];
+        if (cache_policy_all[p] != &cache_policy_arc) {
+            failed |= loop_hit[p] <= loop_hit[0];
+        }
+    }
+    // W-TinyLFU 在 Zipf 上不应比 LRU 差
+    failed |= zipf_hit[4] < zipf_hit[0];
+    printf("\ncheck %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hashalg.h"
+#include "policycache.h"
+
+static inline size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+static inline unsigned char *slot_key(const policycache *c, uint32_t slot) {
+    return c->data + (size_t)slot * c->stride;
+}
+
+static inline unsigned char *slot_value(const policycache *c, uint32_t slot) {
+    return c->data + (size_t)slot * c->stride + (c->value_size ? c->value_offset : 0);
+}
+
+static inline bool slot_match(const policycache *c, uint32_t slot, const void *key, size_t len) {
+    return c->key_lens[slot] == len && memcmp(slot_key(c, slot), key, len) == 0;
+}
+
+bool policycache_init(policycache *c, const cache_policy_ops *ops, size_t capacity, size_t key_size,
+                      size_t value_size, uint64_t seed) {
+    memset(c, 0, sizeof(*c));
+    if (key_size == 0 || key_size >= UINT32_MAX) {
+        return false;
+    }
+    c->policy = cache_policy_create(ops, capacity);
+    if (!c->policy) {
+        return false;
+    }
+    c->key_size = key_size;
+    c->value_size = value_size;
+    c->value_offset = align8(key_size);
+    c->stride = align8(c->value_offset + value_size);
+    c->data = malloc(capacity * c->stride);
+    c->key_lens = calloc(capacity, sizeof(uint32_t));
+    if (!c->data || !c->key_lens) {
+        policycache_free(c);
+        return false;
+    }
+    c->capacity = capacity;
+    c->seed = seed;
+    return true;
+}
+
+void policycache_free(policycache *c) {
+    cache_policy_destroy(c->policy);
+    free(c->data);
+    free(c->key_lens);
+    memset(c, 0, sizeof(*c));
+}
+
+void *policycache_get(policycache *c, const void *key, size_t len) {
+    uint32_t slot = cache_policy_lookup(c->policy, xxh3Hash64(key, len, c->seed));
+    if (slot == CACHE_POLICY_NIL || !slot_match(c, slot, key, len)) {
+        c->misses++;
+        return NULL;
+    }
+    c->hits++;
+    return slot_value(c, slot);
+}
+
+void *policycache_put(policycache *c, const void *key, size_t len, const void *value) {
+    if (len > c->key_size) {
+        return NULL;
+    }
+    bool evicted;
+    uint32_t slot = cache_policy_insert(c->policy, xxh3Hash64(key, len, c->seed), NULL, &evicted);
+    c->evictions += evicted;
+    if (!slot_match(c, slot, key, len)) {
+        // 新键，或哈希值相同的另一个键
+        memcpy(slot_key(c, slot), key, len);
+        c->key_lens[slot] = (uint32_t)len;
+        if (!value) {
+            memset(slot_value(c, slot), 0, c->value_size);
+        }
+    }
+    if (value) {
+        memcpy(slot_value(c, slot), value, c->value_size);
+    }
+    return slot_value(c, slot);
+}
+
+bool policycache_erase(policycache *c, const void *key, size_t len) {
+    uint64_t hash = xxh3Hash64(key, len, c->seed);
+    uint32_t slot = cache_policy_lookup(c->policy, hash);
+    if (slot == CACHE_POLICY_NIL || !slot_match(c, slot, key, len)) {
+        return false;
+    }
+    c->key_lens[slot] = 0;
+    return cache_policy_erase(c->policy, hash);
+}
+
+#ifdef POLICYCACHE_MAIN
+int main(void) {
+    int failed = 0;
+
+    // 示例1：字符串键，各策略下命中的值都正确，大小不超过容量
+    for (size_t k = 0; cache_policy_all[k]; k++) {
+        policycache cache;
+        policycache_init(&cache, cache_policy_all[k], 100, 16, sizeof(int), 0);
+        char key[16];
+        for (int i = 0; i < 10000; i++) {
+            int n = snprintf(key, sizeof(key), "user:%d", (i * 7919) % (i % 2 ? 50 : 500));
+            int *v = policycache_get(&cache, key, n);
+            if (v) {
+                failed |= *v != (i * 7919) % (i % 2 ? 50 : 500);
+            } else {
+                int value = (i * 7919) % (i % 2 ? 50 : 500);
+                failed |= policycache_put(&cache, key, n, &value) == NULL;
+            }
+        }
+        failed |= policycache_size(&cache) > 100;
+        printf("%-10s size %zu, hits %llu, misses %llu, evictions %llu\n", cache_policy_name(cache.policy),
+               policycache_size(&cache), (unsigned long long)cache.hits, (unsigned long long)cache.misses,
+               (unsigned long long)cache.evictions);
+        policycache_free(&cache);
+    }
+
+    // 示例2：覆盖与删除
+    policycache cache;
+    policycache_init(&cache, &cache_policy_arc, 4, 8, sizeof(int), 0);
+    int one = 1, two = 2;
+    policycache_put(&cache, "a", 1, &one);
+    policycache_put(&cache, "a", 1, &two);
+    int *v = policycache_get(&cache, "a", 1);
+    failed |= !v || *v != 2 || policycache_size(&cache) != 1;
+    failed |= !policycache_erase(&cache, "a", 1) || policycache_erase(&cache, "a", 1);
+    failed |= policycache_get(&cache, "a", 1) != NULL || policycache_size(&cache) != 0;
+    failed |= policycache_put(&cache, "too long key", 12, &one) != NULL;
+    policycache_free(&cache);
+
+    printf("check %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
+#endif
@@ -0,0 +1,90 @@
+#ifndef DSA_LRU_POLICYCACHE_H
+#define DSA_LRU_POLICYCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cachepolicy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+淘汰策略可替换的缓存，接口与 lrucache 相同
+（1）键为任意字节串（最长 key_size 字节），值为定长字节；键的 xxh3Hash64 作为策略中的键，
+    策略给出的槽位即键值在 data 中的位置，键值数组在初始化时一次分配
+（2）两个键的 64 位哈希值相同时（概率约 n^2 / 2^65）策略视为同一个键：get 比较原始键后返回未命中，
+    put 用新键覆盖旧键，不会返回错误的值
+*/
+
+typedef struct {
+    cache_policy *policy;
+    unsigned char *data;    // 每个槽位 stride 字节：键（key_size 字节）后接值
+    uint32_t *key_lens;     // 每个槽位的键长
+    size_t capacity;
+    size_t key_size;
+    size_t value_size;
+    size_t value_offset;    // 值在 stride 中的偏移，按 8 字节对齐
+    size_t stride;
+    uint64_t seed;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} policycache;
+
+/**
+* @brief             初始化
+* @param   ops       淘汰策略，如 &cache_policy_wtinylfu
+* @param   capacity  最多缓存的键数
+* @param   key_size  键的最大字节数
+* @param   value_size 值的字节数，可为 0
+* @return  bool      参数非法或申请内存失败返回 false
+*
+* @note              全部内存在这里一次分配
+*/
+bool policycache_init(policycache *c, const cache_policy_ops *ops, size_t capacity, size_t key_size,
+                      size_t value_size, uint64_t seed);
+
+/**
+* @brief             释放
+*
+* @note              Revision History
+*/
+void policycache_free(policycache *c);
+
+/**
+* @brief             查找，命中计入策略
+* @return  void*     值的地址，在该键被淘汰或删除前有效；不存在返回 NULL
+*
+* @note              Revision History
+*/
+void *policycache_get(policycache *c, const void *key, size_t len);
+
+/**
+* @brief             插入或覆盖，已满时由策略决定淘汰哪个键
+* @param   value     value_size 字节，为 NULL 时新键的值清零、已有键的值不变
+* @return  void*     值的地址；键长超过 key_size 返回 NULL
+*
+* @note              W-TinyLFU 可能淘汰刚被窗口挤出的键，新键本身总能放入
+*/
+void *policycache_put(policycache *c, const void *key, size_t len, const void *value);
+
+/**
+* @brief             删除
+* @return  bool      键不存在返回 false
+*
+* @note              Revision History
+*/
+bool policycache_erase(policycache *c, const void *key, size_t len);
+
+static inline size_t policycache_size(const policycache *c) {
+    return cache_policy_size(c->policy);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_LRU_POLICYCACHE_H
@@ -0,0 +1,270 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lrucache.h"
+#include "shardlru.h"
+
+/*
+一、为什么命中也会串行
+（1）LRU 的命中要把节点移到链表头，是写操作；uthash/tests/lru_cache/cache.c 的 foo_cache_lookup 因此在查找时也加写锁，
+    所有线程的读都互斥，热键越集中，锁竞争越重
+（2）分片只能把冲突降到 1/N，Zipf 分布下最热的几个键落在哪个分片，那个分片的锁仍然是瓶颈
+
+二、批量应用命中（Caffeine 的 read buffer 做法）
+（1）查找只加读锁，多个线程可同时在同一分片上查找；命中时把节点编号写入分片的读缓冲区，用原子加分配位置
+（2）写入最后一个位置的线程尝试加写锁（trylock），一次把整个缓冲区的节点移到链表头；拿不到锁就留给下一个写操作
+（3）put、erase 持写锁时先清空缓冲区，保证淘汰前最近的命中已经生效
+（4）缓冲区满后到清空之前的命中直接丢弃：热键会反复命中，丢掉几次对它的位置几乎没有影响，换来读路径上没有写锁
+（5）缓冲区中的编号可能已被淘汰或分配给别的键，lrucache_touch 对空闲节点不做任何事，
+    对已换成别的键的节点则只是把一个新键提前，不影响正确性
+
+三、布局
+（1）分片按缓存行对齐，读写锁、读缓冲区的计数器各占一行，读缓冲区的写入不会使锁所在的行失效
+（2）命中、未命中计数每个分片各自原子累加，汇总时求和
+*/
+
+typedef struct {
+    _Alignas(64) pthread_rwlock_t lock;
+    lrucache cache;
+    _Alignas(64) uint32_t reads;                    // 读缓冲区已分配的位置数
+    uint32_t buffer[SHARDLRU_READ_BUFFER];          // 待应用的命中节点编号
+    _Alignas(64) uint64_t hits;
+    uint64_t misses;
+} shardlru_shard;
+
+struct shardlru {
+    shardlru_shard *shards;
+    unsigned shard_mask;
+    uint64_t seed;
+};
+
+static inline shardlru_shard *shard_of(const shardlru *m, uint64_t hash) {
+    return &m->shards[(uint32_t)hash & m->shard_mask];
+}
+
+// 持写锁时调用
+static void drain(shardlru_shard *s) {
+    uint32_t n = __atomic_load_n(&s->reads, __ATOMIC_ACQUIRE);
+    n = n < SHARDLRU_READ_BUFFER ? n : SHARDLRU_READ_BUFFER;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t node = __atomic_exchange_n(&s->buffer[i], LRUCACHE_NIL, __ATOMIC_RELAXED);
+        if (node != LRUCACHE_NIL) {
+            lrucache_touch(&s->cache, node);
+        }
+    }
+    __atomic_store_n(&s->reads, 0, __ATOMIC_RELEASE);
+}
+
+shardlru *shardlru_create(size_t capacity, size_t key_size, size_t value_size, unsigned shards, uint64_t seed) {
+    unsigned count = 1;
+    while (count < (shards ? shards : SHARDLRU_DEFAULT_SHARDS)) {
+        count *= 2;
+    }
+    // 每个分片至少一个位置
+    while (count > 1 && count > capacity) {
+        count /= 2;
+    }
+    if (capacity == 0) {
+        return NULL;
+    }
+
+    shardlru *m = malloc(sizeof(shardlru));
+    shardlru_shard *array = aligned_alloc(64, count * sizeof(shardlru_shard));
+    if (!m || !array) {
+        free(m);
+        free(array);
+        return NULL;
+    }
+    memset(array, 0, count * sizeof(shardlru_shard));
+    m->shards = array;
+    m->shard_mask = count - 1;
+    m->seed = seed;
+    for (unsigned i = 0; i < count; i++) {
+        shardlru_shard *s = &array[i];
+        size_t share = capacity / count + (i < capacity % count);
+        // 各分片种子相同，shardlru 算一次哈希，分片号与分片内的桶号用哈希值的不同位
+        if (!lrucache_init(&s->cache, share, key_size, value_size, seed)) {
+            for (unsigned j = 0; j < i; j++) {
+                lrucache_free(&array[j].cache);
+                pthread_rwlock_destroy(&array[j].lock);
+            }
+            free(array);
+            free(m);
+            return NULL;
+        }
+        pthread_rwlock_init(&s->lock, NULL);
+        memset(s->buffer, 0xFF, sizeof(s->buffer));
+    }
+    return m;
+}
+
+void shardlru_destroy(shardlru *m) {
+    if (!m) {
+        return;
+    }
+    for (unsigned i = 0; i <= m->shard_mask; i++) {
+        lrucache_free(&m->shards[i].cache);
+        pthread_rwlock_destroy(&m->shards[i].lock);
+    }
+    free(m->shards);
+    free(m);
+}
+
+bool shardlru_get(shardlru *m, const void *key, size_t len, void *value) {
+    uint64_t hash = lrucache_hash(&m->shards[0].cache, key, len);
+    shardlru_shard *s = shard_of(m, hash);
+
+    pthread_rwlock_rdlock(&s->lock);
+    uint32_t node = lrucache_lookup_hash(&s->cache, key, len, hash);
+    if (node != LRUCACHE_NIL && value) {
+        memcpy(value, lrucache_value_at(&s->cache, node), s->cache.value_size);
+    }
+    pthread_rwlock_unlock(&s->lock);
+
+    if (node == LRUCACHE_NIL) {
+        __atomic_fetch_add(&s->misses, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    __atomic_fetch_add(&s->hits, 1, __ATOMIC_RELAXED);
+    // 缓冲区满之前先看一眼，满了就不再做原子加，热点分片上的命中大多走这条路
+    if (__atomic_load_n(&s->reads, __ATOMIC_RELAXED) < SHARDLRU_READ_BUFFER) {
+        uint32_t pos = __atomic_fetch_add(&s->reads, 1, __ATOMIC_ACQ_REL);
+        if (pos < SHARDLRU_READ_BUFFER) {
+            __atomic_store_n(&s->buffer[pos], node, __ATOMIC_RELAXED);
+        }
+        if (pos == SHARDLRU_READ_BUFFER - 1 && pthread_rwlock_trywrlock(&s->lock) == 0) {
+            drain(s);
+            pthread_rwlock_unlock(&s->lock);
+        }
+    }
+    return true;
+}
+
+bool shardlru_put(shardlru *m, const void *key, size_t len, const void *value) {
+    uint64_t hash = lrucache_hash(&m->shards[0].cache, key, len);
+    shardlru_shard *s = shard_of(m, hash);
+
+    pthread_rwlock_wrlock(&s->lock);
+    drain(s);
+    bool ok = lrucache_put_hash(&s->cache, key, len, hash, value, NULL, NULL) != NULL;
+    pthread_rwlock_unlock(&s->lock);
+
+    return ok;
+}
+
+bool shardlru_erase(shardlru *m, const void *key, size_t len) {
+    uint64_t hash = lrucache_hash(&m->shards[0].cache, key, len);
+    shardlru_shard *s = shard_of(m, hash);
+
+    pthread_rwlock_wrlock(&s->lock);
+    drain(s);
+    bool erased = lrucache_erase_hash(&s->cache, key, len, hash);
+    pthread_rwlock_unlock(&s->lock);
+
+    return erased;
+}
+
+size_t shardlru_size(shardlru *m) {
+    size_t size = 0;
+    for (unsigned i = 0; i <= m->shard_mask; i++) {
+        shardlru_shard *s = &m->shards[i];
+        pthread_rwlock_rdlock(&s->lock);
+        size += lrucache_size(&s->cache);
+        pthread_rwlock_unlock(&s->lock);
+    }
+    return size;
+}
+
+void shardlru_stats(shardlru *m, uint64_t *hits, uint64_t *misses) {
+    uint64_t h = 0, miss = 0;
+    for (unsigned i = 0; i <= m->shard_mask; i++) {
+        h += __atomic_load_n(&m->shards[i].hits, __ATOMIC_RELAXED);
+        miss += __atomic_load_n(&m->shards[i].misses, __ATOMIC_RELAXED);
+    }
+    if (hits) {
+        *hits = h;
+    }
+    if (misses) {
+        *misses = miss;
+    }
+}
+
+#ifdef SHARDLRU_MAIN
+// 多线程各自读写不相交的键区间，值为键的 3 倍
+typedef struct {
+    shardlru *cache;
+    uint64_t begin;
+    uint64_t end;
+    int failed;
+} check_range;
+
+static void *check_worker(void *arg) {
+    check_range *r = arg;
+    for (int round = 0; round < 4; round++) {
+        for (uint64_t k = r->begin; k < r->end; k++) {
+            uint64_t v;
+            if (shardlru_get(r->cache, &k, sizeof(k), &v)) {
+                r->failed |= v != k * 3;
+            } else {
+                v = k * 3;
+                shardlru_put(r->cache, &k, sizeof(k), &v);
+            }
+        }
+    }
+    return NULL;
+}
+
+int main(void) {
+    int failed = 0;
+
+    // 示例1：单线程，命中的值都正确；各分片容量固定，键分布不均时个别分片会提前淘汰
+    // 热键反复命中后不会被淘汰
+    shardlru *cache = shardlru_create(1000, sizeof(uint64_t), sizeof(uint64_t), 4, 0);
+    for (uint64_t k = 0; k < 1000; k++) {
+        uint64_t v = k * 3;
+        shardlru_put(cache, &k, sizeof(k), &v);
+    }
+    uint64_t hits, misses;
+    for (uint64_t k = 0; k < 1000; k++) {
+        uint64_t v;
+        if (shardlru_get(cache, &k, sizeof(k), &v)) {
+            failed |= v != k * 3;
+        }
+    }
+    uint64_t hot = 7;
+    for (uint64_t k = 1000; k < 3000; k++) {
+        uint64_t v = k * 3;
+        for (int i = 0; i < 64; i++) {
+            shardlru_get(cache, &hot, sizeof(hot), NULL);
+        }
+        shardlru_put(cache, &k, sizeof(k), &v);
+    }
+    failed |= !shardlru_get(cache, &hot, sizeof(hot), NULL) || shardlru_size(cache) != 1000;
+    shardlru_stats(cache, &hits, &misses);
+    printf("single thread: size %zu, hits %llu, misses %llu\n", shardlru_size(cache), (unsigned long long)hits,
+           (unsigned long long)misses);
+    shardlru_destroy(cache);
+
+    // 示例2：8 个线程并发读写，读到的值都正确
+    enum { THREADS = 8 };
+    cache = shardlru_create(20000, sizeof(uint64_t), sizeof(uint64_t), 16, 0);
+    pthread_t tids[THREADS];
+    check_range ranges[THREADS];
+    for (int t = 0; t < THREADS; t++) {
+        ranges[t] = (check_range){.cache = cache, .begin = (uint64_t)t * 5000, .end = (uint64_t)(t + 1) * 5000};
+        pthread_create(&tids[t], NULL, check_worker, &ranges[t]);
+    }
+    for (int t = 0; t < THREADS; t++) {
+        pthread_join(tids[t], NULL);
+        failed |= ranges[t].failed;
+    }
+    shardlru_stats(cache, &hits, &misses);
+    failed |= hits + misses != 4 * THREADS * 5000 || shardlru_size(cache) > 20000;
+    printf("%d threads: size %zu, hits %llu, misses %llu, check %s\n", THREADS, shardlru_size(cache),
+           (unsigned long long)hits, (unsigned long long)misses, failed ? "FAILED" : "ok");
+    shardlru_destroy(cache);
+    return failed;
+}
+#endif
@@ -0,0 +1,83 @@
+#ifndef DSA_LRU_SHARDLRU_H
+#define DSA_LRU_SHARDLRU_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+分片并发 LRU 缓存
+（1）键按哈希值的低位分到 N 个分片，每个分片是一个 lrucache 和一把读写锁，容量平均分配
+（2）命中不立即移动节点：读锁下查找并拷贝值，把节点编号记入分片的读缓冲区，缓冲区满时尝试加写锁批量应用；
+    put、erase 本来就持写锁，顺带先应用缓冲区中的命中
+（3）读缓冲区有损：满了且拿不到写锁时丢弃，节点已被淘汰时忽略，只影响淘汰顺序的精确程度，不影响正确性
+*/
+
+// 默认分片数
+#define SHARDLRU_DEFAULT_SHARDS 64
+// 每个分片的读缓冲区长度
+#define SHARDLRU_READ_BUFFER 64
+
+typedef struct shardlru shardlru;
+
+/**
+* @brief             创建
+* @param   capacity  总容量，平均分到各分片
+* @param   key_size  键的最大字节数
+* @param   value_size 值的字节数
+* @param   shards    分片数，向上取整为 2 的幂，0 时使用 SHARDLRU_DEFAULT_SHARDS
+* @return  shardlru* 参数非法或申请内存失败返回 NULL
+*
+* @note              全部内存在这里一次分配
+*/
+shardlru *shardlru_create(size_t capacity, size_t key_size, size_t value_size, unsigned shards, uint64_t seed);
+
+/**
+* @brief             销毁，调用时不能有其他线程在使用
+*
+* @note              Revision History
+*/
+void shardlru_destroy(shardlru *m);
+
+/**
+* @brief             查找并把值拷贝到 value
+* @param   value     输出缓冲区，value_size 字节，可为 NULL
+* @return  bool      不存在返回 false
+*
+* @note              只加读锁，命中记入读缓冲区后批量生效
+*/
+bool shardlru_get(shardlru *m, const void *key, size_t len, void *value);
+
+/**
+* @brief             插入或覆盖，已满时淘汰该分片中最久未使用的键
+* @return  bool      键长超过 key_size 返回 false
+*
+* @note              线程安全
+*/
+bool shardlru_put(shardlru *m, const void *key, size_t len, const void *value);
+
+/**
+* @brief             删除
+* @return  bool      键不存在返回 false
+*
+* @note              线程安全
+*/
+bool shardlru_erase(shardlru *m, const void *key, size_t len);
+
+/**
+* @brief             元素总数与命中、未命中次数，并发修改时为近似值
+*
+* @note              Revision History
+*/
+size_t shardlru_size(shardlru *m);
+void shardlru_stats(shardlru *m, uint64_t *hits, uint64_t *misses);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_LRU_SHARDLRU_H
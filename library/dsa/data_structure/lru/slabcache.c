@@ -0,0 +1,489 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hashalg.h"
+#include "slabcache.h"
+
+/*
+一、为什么按块数限制不够
+（1）lrucache 按条目数限制容量，值为定长；值从十几字节到 1MB 不等时，条目数与内存没有固定关系，
+    同样 10 万个条目可能占几 MB 也可能占几十 GB
+（2）按字节数限制时，如果每个条目单独 malloc，淘汰后空出的内存大小各异，新条目未必放得下，
+    分配器的外部碎片与元数据使实际占用明显超过预算，且难以估计
+
+二、slab 的取舍
+（1）同一级别的块大小相同，淘汰一个条目腾出的块一定放得下同级别的新条目，分配与释放都是摘挂一次空闲链，O(1)
+（2）代价是内部碎片：条目放在块大小不小于它的最小一级，factor 为 1.25 时平均浪费约 10%；
+    requested 与 used * chunk_size 的差即为浪费，按它调整 factor 或按主要的值大小调整 page_size
+（3）页一旦分给某个级别就一直属于它，负载的大小分布变化后，新的大小没有页可用（slab calcification）；
+    本级别没有条目可淘汰时，从其他级别回收一页：选最久未使用的条目最旧（没有条目的级别视为最旧）的级别，
+    淘汰该条目所在的页中的全部条目，重新切块；按页数选会让各有一页的小级别之间反复争抢，每次淘汰上万个条目
+（4）条目的访问时间为 32 位的操作计数，比较的是与当前计数之差，回绕不影响，只要最旧的条目在 2^32 次操作之内被访问过
+*/
+
+static inline size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+static inline unsigned char *item_key(slabcache_item *it) {
+    return (unsigned char *)(it + 1);
+}
+
+static inline unsigned char *item_value(slabcache_item *it) {
+    return item_key(it) + it->key_len;
+}
+
+static inline size_t item_size(size_t key_len, size_t value_len) {
+    return sizeof(slabcache_item) + key_len + value_len;
+}
+
+static inline uint32_t hash_tag(uint64_t hash) {
+    return (uint32_t)(hash >> 32);
+}
+
+// 链表操作，哨兵为 slabcache_class 中的 lru 或 free
+static inline void list_init(slabcache_item *s) {
+    s->prev = s->next = s;
+}
+
+static inline void list_unlink(slabcache_item *it) {
+    it->prev->next = it->next;
+    it->next->prev = it->prev;
+}
+
+static inline void list_push_front(slabcache_item *s, slabcache_item *it) {
+    it->prev = s;
+    it->next = s->next;
+    s->next->prev = it;
+    s->next = it;
+}
+
+// 哈希桶操作
+static slabcache_item *bucket_find(const slabcache *c, uint32_t tag, const void *key, size_t key_len) {
+    for (slabcache_item *it = c->buckets[tag & c->bucket_mask]; it; it = it->hnext) {
+        if (it->tag == tag && it->key_len == key_len && memcmp(item_key(it), key, key_len) == 0) {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+static void bucket_insert(slabcache *c, slabcache_item *it) {
+    slabcache_item **head = &c->buckets[it->tag & c->bucket_mask];
+    it->hnext = *head;
+    *head = it;
+}
+
+static void bucket_remove(slabcache *c, slabcache_item *it) {
+    slabcache_item **link = &c->buckets[it->tag & c->bucket_mask];
+    while (*link != it) {
+        link = &(*link)->hnext;
+    }
+    *link = it->hnext;
+}
+
+// 桶数翻倍，申请失败时保持原样，只是链变长
+static void grow_buckets(slabcache *c) {
+    size_t old = c->bucket_mask + 1;
+    slabcache_item **buckets = calloc(old * 2, sizeof(slabcache_item *));
+    if (!buckets) {
+        return;
+    }
+    slabcache_item **prev = c->buckets;
+    c->buckets = buckets;
+    c->bucket_mask = old * 2 - 1;
+    for (size_t b = 0; b < old; b++) {
+        slabcache_item *it = prev[b];
+        while (it) {
+            slabcache_item *next = it->hnext;
+            bucket_insert(c, it);
+            it = next;
+        }
+    }
+    free(prev);
+}
+
+// 把页切成 k 级的块，放入空闲链
+static void carve(slabcache *c, size_t page, unsigned k) {
+    slabcache_class *cls = &c->classes[k];
+    c->page_class[page] = (unsigned char)k;
+    for (size_t j = 0; j < cls->per_page; j++) {
+        slabcache_item *it = (slabcache_item *)(c->pages[page] + j * cls->chunk_size);
+        it->class_id = (uint8_t)k;
+        it->in_use = 0;
+        list_push_front(&cls->free, it);
+    }
+    cls->pages++;
+    cls->free_chunks += cls->per_page;
+}
+
+// 条目从 LRU 链表与哈希桶中摘下，块放回空闲链
+static void remove_item(slabcache *c, slabcache_item *it) {
+    slabcache_class *cls = &c->classes[it->class_id];
+    list_unlink(it);
+    bucket_remove(c, it);
+    it->in_use = 0;
+    list_push_front(&cls->free, it);
+    cls->used--;
+    cls->free_chunks++;
+    cls->requested -= item_size(it->key_len, it->value_len);
+    c->count--;
+}
+
+static size_t page_of(const slabcache *c, const void *p) {
+    for (size_t i = 0; i < c->page_count; i++) {
+        if ((const unsigned char *)p >= c->pages[i] && (const unsigned char *)p < c->pages[i] + c->page_size) {
+            return i;
+        }
+    }
+    return c->page_count;
+}
+
+// 从最久未使用的条目最旧的其他级别回收一页给 k 级，页中的条目全部淘汰
+static bool reassign_page(slabcache *c, unsigned k) {
+    unsigned victim = SLABCACHE_MAX_CLASSES;
+    uint64_t oldest = 0;
+    for (unsigned i = 0; i < c->nclasses; i++) {
+        const slabcache_class *cls = &c->classes[i];
+        if (i == k || cls->pages == 0) {
+            continue;
+        }
+        // 有页没有条目的级别最先回收
+        uint64_t age = cls->lru.prev == &cls->lru ? UINT64_MAX : (uint32_t)(c->clock - cls->lru.prev->atime);
+        if (victim == SLABCACHE_MAX_CLASSES || age > oldest) {
+            victim = i;
+            oldest = age;
+        }
+    }
+    if (victim == SLABCACHE_MAX_CLASSES) {
+        return false;
+    }
+    slabcache_class *cls = &c->classes[victim];
+    // 优先回收最久未使用的条目所在的页，该级别没有条目时回收它的任意一页
+    size_t page = c->page_count;
+    if (cls->lru.prev != &cls->lru) {
+        page = page_of(c, cls->lru.prev);
+    } else {
+        for (page = 0; page < c->page_count && c->page_class[page] != victim; page++) {
+        }
+    }
+    for (size_t j = 0; j < cls->per_page; j++) {
+        slabcache_item *it = (slabcache_item *)(c->pages[page] + j * cls->chunk_size);
+        if (it->in_use) {
+            remove_item(c, it);
+            cls->evictions++;
+            c->evictions++;
+        }
+        list_unlink(it);
+    }
+    cls->free_chunks -= cls->per_page;
+    cls->pages--;
+    cls->pages_out++;
+    carve(c, page, k);
+    c->classes[k].pages_in++;
+    return true;
+}
+
+// 取 k 级的一个空闲块：空闲链、新页、淘汰本级别最久未使用的条目、回收其他级别的页，依次尝试
+static slabcache_item *alloc_chunk(slabcache *c, unsigned k) {
+    slabcache_class *cls = &c->classes[k];
+    if (cls->free.next == &cls->free) {
+        unsigned char *page = c->page_count < c->page_limit ? malloc(c->page_size) : NULL;
+        if (page) {
+            c->pages[c->page_count++] = page;
+            carve(c, c->page_count - 1, k);
+        } else if (cls->lru.prev != &cls->lru) {
+            remove_item(c, cls->lru.prev);
+            cls->evictions++;
+            c->evictions++;
+        } else if (!reassign_page(c, k)) {
+            return NULL;
+        }
+    }
+    slabcache_item *it = cls->free.next;
+    list_unlink(it);
+    cls->free_chunks--;
+    return it;
+}
+
+bool slabcache_init(slabcache *c, size_t budget, size_t page_size, double factor, uint64_t seed) {
+    memset(c, 0, sizeof(*c));
+    page_size = page_size ? page_size : SLABCACHE_DEFAULT_PAGE_SIZE;
+    factor = factor > 0 ? factor : SLABCACHE_DEFAULT_FACTOR;
+    if (page_size < SLABCACHE_MIN_CHUNK || page_size > UINT32_MAX || page_size % 8 || factor <= 1.0 ||
+        budget < page_size) {
+        return false;
+    }
+    // 块大小按 factor 递增，每级至少大 8 字节；最后一级为整页
+    double size = SLABCACHE_MIN_CHUNK;
+    unsigned n = 0;
+    while (n < SLABCACHE_MAX_CLASSES - 1 && size * factor <= page_size) {
+        size_t chunk = align8((size_t)size);
+        if (n == 0 || chunk > c->classes[n - 1].chunk_size) {
+            c->classes[n++].chunk_size = chunk;
+        }
+        size *= factor;
+    }
+    if (n == 0 || c->classes[n - 1].chunk_size < page_size) {
+        c->classes[n++].chunk_size = page_size;
+    }
+    c->nclasses = n;
+    for (unsigned i = 0; i < n; i++) {
+        c->classes[i].per_page = page_size / c->classes[i].chunk_size;
+        list_init(&c->classes[i].lru);
+        list_init(&c->classes[i].free);
+    }
+    c->page_size = page_size;
+    c->page_limit = budget / page_size;
+    c->pages = malloc(c->page_limit * sizeof(unsigned char *));
+    c->page_class = malloc(c->page_limit);
+    c->buckets = calloc(1024, sizeof(slabcache_item *));
+    if (!c->pages || !c->page_class || !c->buckets) {
+        slabcache_free(c);
+        return false;
+    }
+    c->bucket_mask = 1023;
+    c->seed = seed;
+    return true;
+}
+
+void slabcache_free(slabcache *c) {
+    for (size_t i = 0; i < c->page_count; i++) {
+        free(c->pages[i]);
+    }
+    free(c->pages);
+    free(c->page_class);
+    free(c->buckets);
+    memset(c, 0, sizeof(*c));
+}
+
+int slabcache_class_of(const slabcache *c, size_t key_len, size_t value_len) {
+    size_t size = item_size(key_len, value_len);
+    // 二分找块大小不小于 size 的最小一级
+    unsigned lo = 0, hi = c->nclasses;
+    while (lo < hi) {
+        unsigned mid = (lo + hi) / 2;
+        if (c->classes[mid].chunk_size < size) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < c->nclasses ? (int)lo : -1;
+}
+
+const void *slabcache_get(slabcache *c, const void *key, size_t key_len, size_t *value_len) {
+    slabcache_item *it = NULL;
+    if (key_len <= SLABCACHE_KEY_MAX) {
+        it = bucket_find(c, hash_tag(xxh3Hash64(key, key_len, c->seed)), key, key_len);
+    }
+    if (!it) {
+        c->misses++;
+        return NULL;
+    }
+    slabcache_class *cls = &c->classes[it->class_id];
+    c->hits++;
+    cls->hits++;
+    it->atime = c->clock++;
+    list_unlink(it);
+    list_push_front(&cls->lru, it);
+    if (value_len) {
+        *value_len = it->value_len;
+    }
+    return item_value(it);
+}
+
+bool slabcache_put(slabcache *c, const void *key, size_t key_len, const void *value, size_t value_len) {
+    int k = key_len <= SLABCACHE_KEY_MAX ? slabcache_class_of(c, key_len, value_len) : -1;
+    if (k < 0) {
+        return false;
+    }
+    slabcache_class *cls = &c->classes[k];
+    uint32_t tag = hash_tag(xxh3Hash64(key, key_len, c->seed));
+    slabcache_item *it = bucket_find(c, tag, key, key_len);
+    if (it && it->class_id == k) {
+        // 同一级别原地覆盖
+        cls->requested += value_len;
+        cls->requested -= it->value_len;
+        list_unlink(it);
+    } else {
+        // 先取新块再删旧条目，取不到块时原来的值保留；回收页时旧条目可能已被淘汰，重新查找
+        slabcache_item *chunk = alloc_chunk(c, (unsigned)k);
+        if (!chunk) {
+            return false;
+        }
+        if (it && (it = bucket_find(c, tag, key, key_len)) != NULL) {
+            remove_item(c, it);
+        }
+        it = chunk;
+        it->tag = tag;
+        it->key_len = (uint16_t)key_len;
+        it->in_use = 1;
+        memcpy(item_key(it), key, key_len);
+        bucket_insert(c, it);
+        cls->used++;
+        cls->requested += item_size(key_len, value_len);
+        if (++c->count > c->bucket_mask + 1) {
+            grow_buckets(c);
+        }
+    }
+    it->value_len = (uint32_t)value_len;
+    it->atime = c->clock++;
+    memcpy(item_value(it), value, value_len);
+    list_push_front(&cls->lru, it);
+    cls->sets++;
+    return true;
+}
+
+bool slabcache_erase(slabcache *c, const void *key, size_t key_len) {
+    if (key_len > SLABCACHE_KEY_MAX) {
+        return false;
+    }
+    slabcache_item *it = bucket_find(c, hash_tag(xxh3Hash64(key, key_len, c->seed)), key, key_len);
+    if (!it) {
+        return false;
+    }
+    remove_item(c, it);
+    return true;
+}
+
+void slabcache_print_stats(const slabcache *c, FILE *fp) {
+    fprintf(fp, "%5s %10s %8s %6s %10s %10s %12s %7s %10s %10s %8s %8s\n", "class", "chunk", "perpage", "pages",
+            "used", "free", "requested", "waste", "hits", "evictions", "pg_in", "pg_out");
+    for (unsigned i = 0; i < c->nclasses; i++) {
+        const slabcache_class *cls = &c->classes[i];
+        if (cls->pages == 0 && cls->pages_out == 0) {
+            continue;
+        }
+        uint64_t chunk_bytes = (uint64_t)cls->used * cls->chunk_size;
+        double waste = chunk_bytes ? 100.0 * (double)(chunk_bytes - cls->requested) / (double)chunk_bytes : 0.0;
+        fprintf(fp, "%5u %10zu %8zu %6zu %10zu %10zu %12llu %6.1f%% %10llu %10llu %8llu %8llu\n", i, cls->chunk_size,
+                cls->per_page, cls->pages, cls->used, cls->free_chunks, (unsigned long long)cls->requested, waste,
+                (unsigned long long)cls->hits, (unsigned long long)cls->evictions, (unsigned long long)cls->pages_in,
+                (unsigned long long)cls->pages_out);
+    }
+    fprintf(fp, "items %zu, pages %zu / %zu (%zu bytes each), hits %llu, misses %llu, evictions %llu\n", c->count,
+            c->page_count, c->page_limit, c->page_size, (unsigned long long)c->hits, (unsigned long long)c->misses,
+            (unsigned long long)c->evictions);
+}
+
+#ifdef SLABCACHE_MAIN
+static uint64_t rng = 0x9E3779B97F4A7C15ULL;
+
+// 值的内容由键与长度决定，读出时可校验
+static void fill(unsigned char *buf, uint64_t key, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (unsigned char)(key * 31 + i * 7 + len);
+    }
+}
+
+static bool verify(const unsigned char *buf, uint64_t key, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] != (unsigned char)(key * 31 + i * 7 + len)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 各级别的统计与全局一致，内存不超过预算
+static bool consistent(const slabcache *c, size_t budget) {
+    size_t used = 0, pages = 0;
+    for (unsigned i = 0; i < c->nclasses; i++) {
+        const slabcache_class *cls = &c->classes[i];
+        used += cls->used;
+        pages += cls->pages;
+        if (cls->used + cls->free_chunks != cls->pages * cls->per_page ||
+            cls->requested > (uint64_t)cls->used * cls->chunk_size) {
+            return false;
+        }
+    }
+    return used == c->count && pages == c->page_count && slabcache_memory(c) <= budget;
+}
+
+int main(void) {
+    int failed = 0;
+    static unsigned char buf[SLABCACHE_DEFAULT_PAGE_SIZE];
+
+    // 示例1：4 页、每页 64KB，相邻级别块大小翻倍
+    slabcache cache;
+    size_t budget = 4 * 65536;
+    slabcache_init(&cache, budget, 65536, 2.0, 0);
+    failed |= !slabcache_put(&cache, "small", 5, "0123456789abcdef", 16);
+    fill(buf, 1, 30000);
+    failed |= !slabcache_put(&cache, "large", 5, buf, 30000);
+    size_t len;
+    const unsigned char *got = slabcache_get(&cache, "small", 5, &len);
+    failed |= !got || len != 16 || memcmp(got, "0123456789abcdef", 16) != 0;
+    got = slabcache_get(&cache, "large", 5, &len);
+    failed |= !got || len != 30000 || !verify(got, 1, 30000);
+    // 覆盖为另一个级别的大小，原来的块放回空闲链
+    fill(buf, 2, 1000);
+    failed |= !slabcache_put(&cache, "small", 5, buf, 1000);
+    got = slabcache_get(&cache, "small", 5, &len);
+    failed |= !got || len != 1000 || !verify(got, 2, 1000) || slabcache_count(&cache) != 2;
+    // 条目超过一页放不下
+    failed |= slabcache_put(&cache, "huge", 4, buf, 65536) || slabcache_erase(&cache, "huge", 4);
+    failed |= !slabcache_erase(&cache, "large", 5) || slabcache_get(&cache, "large", 5, NULL) != NULL;
+    failed |= !consistent(&cache, budget);
+    slabcache_free(&cache);
+
+    // 示例2：小条目占满全部页后只写大条目，大条目所在级别没有页，从小条目的级别回收
+    slabcache_init(&cache, budget, 65536, 2.0, 0);
+    for (uint64_t k = 0; k < 10000; k++) {
+        fill(buf, k, 100);
+        slabcache_put(&cache, &k, sizeof(k), buf, 100);
+    }
+    int small = slabcache_class_of(&cache, sizeof(uint64_t), 100);
+    failed |= cache.classes[small].pages != 4 || cache.classes[small].evictions == 0;
+    for (uint64_t k = 20000; k < 20010; k++) {
+        fill(buf, k, 20000);
+        failed |= !slabcache_put(&cache, &k, sizeof(k), buf, 20000);
+        got = slabcache_get(&cache, &k, sizeof(k), &len);
+        failed |= !got || len != 20000 || !verify(got, k, 20000);
+    }
+    int large = slabcache_class_of(&cache, sizeof(uint64_t), 20000);
+    failed |= cache.classes[large].pages_in == 0 || cache.classes[small].pages_out == 0;
+    failed |= !consistent(&cache, budget);
+    slabcache_free(&cache);
+
+    // 只有一页时换级别覆盖：新块来自回收旧条目所在的页，旧条目在回收时已被淘汰，不能再删一次
+    slabcache_init(&cache, 65536, 65536, 2.0, 0);
+    failed |= !slabcache_put(&cache, "key", 3, "abc", 3);
+    fill(buf, 3, 20000);
+    failed |= !slabcache_put(&cache, "key", 3, buf, 20000);
+    got = slabcache_get(&cache, "key", 3, &len);
+    failed |= !got || len != 20000 || !verify(got, 3, 20000) || slabcache_count(&cache) != 1;
+    failed |= !consistent(&cache, 65536);
+    slabcache_free(&cache);
+
+    // 示例3：默认页与级别，随机键、16B 到 1MB 的随机大小（小值居多），随机覆盖、删除，逐次校验内容
+    budget = 96 << 20;
+    slabcache_init(&cache, budget, 0, 0, 42);
+    size_t corrupted = 0;
+    for (int round = 0; round < 200000; round++) {
+        uint64_t r = splitmix64(&rng);
+        uint64_t k = r % 5000;
+        if (r >> 60 == 0) {
+            slabcache_erase(&cache, &k, sizeof(k));
+            continue;
+        }
+        got = slabcache_get(&cache, &k, sizeof(k), &len);
+        if (got) {
+            corrupted += !verify(got, k, len);
+        } else {
+            // 长度的对数在 [4, 20] 上偏向小值，同一个键每次写入的长度可能不同
+            double u = (double)(splitmix64(&rng) >> 11) / 9007199254740992.0;
+            len = (size_t)(16.0 * exp2(16.0 * u * u * u));
+            fill(buf, k, len);
+            failed |= !slabcache_put(&cache, &k, sizeof(k), buf, len);
+        }
+    }
+    failed |= corrupted != 0 || !consistent(&cache, budget);
+    slabcache_print_stats(&cache, stdout);
+    printf("memory %zu / %zu bytes, check %s\n", slabcache_memory(&cache), budget, failed ? "FAILED" : "ok");
+    slabcache_free(&cache);
+    return failed;
+}
+#endif
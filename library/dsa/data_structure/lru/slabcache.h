@@ -0,0 +1,153 @@
+#ifndef DSA_LRU_SLABCACHE_H
+#define DSA_LRU_SLABCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+按字节数限制内存的缓存，值为变长字节串，存放在按大小分级的 slab 中（memcached 的做法）
+（1）内存按页（默认 1MB + 4KB）分配，总页数不超过 budget / page_size；每页属于一个大小级别（slab class），
+    切成该级别大小相同的块（chunk），一个条目（头部 + 键 + 值）占一块
+（2）级别的块大小从 SLABCACHE_MIN_CHUNK 起按 factor（默认 1.25）递增并按 8 字节对齐，最大一级为整页；
+    条目放在能容纳它的最小一级，块内剩余的字节为内部碎片，但块在同级别内复用，不会有外部碎片
+（3）每个级别有自己的 LRU 链表与空闲块链；放不下时按顺序：取空闲块、分配新页、淘汰本级别最久未使用的条目
+    （腾出的块正好放得下新条目），本级别没有条目时从最久未使用的条目最旧的其他级别回收该条目所在的一页
+    （页中的条目全部淘汰）重新切块；有页而没有条目的级别最先被回收
+（4）键最长 SLABCACHE_KEY_MAX 字节，按 hashalg.h 的 xxh3Hash64 哈希，桶数组按条目数翻倍扩容
+（5）每个级别的统计（块大小、页数、已用块、请求的字节数、淘汰次数等）在 classes 中，可据此调整 factor 与 page_size
+*/
+
+#define SLABCACHE_MAX_CLASSES 64
+#define SLABCACHE_KEY_MAX 250
+#define SLABCACHE_MIN_CHUNK 64
+// 1MB 的值加上头部与键仍放得下一页
+#define SLABCACHE_DEFAULT_PAGE_SIZE ((1 << 20) + 4096)
+#define SLABCACHE_DEFAULT_FACTOR 1.25
+
+// 条目头部，键与值紧随其后
+typedef struct slabcache_item {
+    struct slabcache_item *prev;    // LRU 链表中更新一个的条目，或空闲块链
+    struct slabcache_item *next;
+    struct slabcache_item *hnext;   // 同一个桶中的下一个条目
+    uint32_t tag;                   // 哈希值的高 32 位
+    uint32_t value_len;
+    uint32_t atime;                 // 最近一次访问时的操作计数，回收页时比较各级别最久未使用的条目
+    uint16_t key_len;
+    uint8_t class_id;
+    uint8_t in_use;
+} slabcache_item;
+
+typedef struct {
+    size_t chunk_size;          // 块的字节数
+    size_t per_page;            // 每页的块数
+    size_t pages;
+    size_t used;                // 已用块数
+    size_t free_chunks;         // 空闲块数
+    uint64_t requested;         // 已用块中条目实际的字节数，与 used * chunk_size 之差为内部碎片
+    uint64_t sets;
+    uint64_t hits;
+    uint64_t evictions;         // 为放入新条目淘汰的条目数（含回收页时淘汰的）
+    uint64_t pages_in;          // 从其他级别回收来的页数
+    uint64_t pages_out;         // 被其他级别回收走的页数
+    slabcache_item lru;         // LRU 链表哨兵，next 为最近使用
+    slabcache_item free;        // 空闲块链哨兵
+} slabcache_class;
+
+typedef struct {
+    slabcache_class classes[SLABCACHE_MAX_CLASSES];
+    unsigned nclasses;
+    size_t page_size;
+    size_t page_limit;          // budget / page_size
+    size_t page_count;          // 已分配的页数
+    unsigned char **pages;      // 已分配的页
+    unsigned char *page_class;  // 页 -> 级别
+    slabcache_item **buckets;
+    size_t bucket_mask;
+    size_t count;               // 条目数
+    uint32_t clock;             // 操作计数，每次 get/put 加一
+    uint64_t seed;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} slabcache;
+
+/**
+* @brief             初始化
+* @param   budget    内存上限（字节），不少于一页
+* @param   page_size 页的字节数，也是单个条目（头部 + 键 + 值）的上限，0 时使用 SLABCACHE_DEFAULT_PAGE_SIZE
+* @param   factor    相邻级别块大小之比，大于 1，0 时使用 SLABCACHE_DEFAULT_FACTOR
+* @param   seed      哈希种子
+* @return  bool      参数非法或申请内存失败返回 false
+*
+* @note              页在用到时才分配
+*/
+bool slabcache_init(slabcache *c, size_t budget, size_t page_size, double factor, uint64_t seed);
+
+/**
+* @brief             释放
+*
+* @note              Revision History
+*/
+void slabcache_free(slabcache *c);
+
+/**
+* @brief             查找并标记为最近使用
+* @param   value_len 值的字节数，可为 NULL
+* @return  void*     值的地址，在下一次 put 或 erase 之前有效；不存在返回 NULL
+*
+* @note              Revision History
+*/
+const void *slabcache_get(slabcache *c, const void *key, size_t key_len, size_t *value_len);
+
+/**
+* @brief             插入或覆盖，值拷贝到 slab 中，必要时淘汰
+* @return  bool      键长超过 SLABCACHE_KEY_MAX 或条目大于一页返回 false
+*
+* @note              淘汰只发生在新条目所在的级别，或被回收的页中；先为新值取到块再删除旧条目，
+*                    失败时原来的值不变
+*/
+bool slabcache_put(slabcache *c, const void *key, size_t key_len, const void *value, size_t value_len);
+
+/**
+* @brief             删除
+* @return  bool      键不存在返回 false
+*
+* @note              Revision History
+*/
+bool slabcache_erase(slabcache *c, const void *key, size_t key_len);
+
+/**
+* @brief             条目所在的级别
+* @return  int       条目大于一页返回 -1
+*
+* @note              条目的字节数为 sizeof(slabcache_item) + key_len + value_len
+*/
+int slabcache_class_of(const slabcache *c, size_t key_len, size_t value_len);
+
+/**
+* @brief             按级别输出统计，每行一个有页的级别
+*
+* @note              Revision History
+*/
+void slabcache_print_stats(const slabcache *c, FILE *fp);
+
+static inline size_t slabcache_count(const slabcache *c) {
+    return c->count;
+}
+
+// 已分配的内存（页），不超过 budget
+static inline size_t slabcache_memory(const slabcache *c) {
+    return c->page_count * c->page_size;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_LRU_SLABCACHE_H
@@ -0,0 +1,196 @@
+// 按字节数限制的缓存性能测试：Zipf(0.99) 访问流，每个键的值大小固定，16B 到 1MB 对数分布并偏向小值，未命中时 put
+// （1）对照：每个条目单独 malloc，uthash 索引，全局 LRU，放入前从最久未使用的一端淘汰直到条目的字节数之和不超过预算
+// （2）slabcache：按大小分级的 slab，预算为页数上限
+// 统计命中率、吞吐与运行中堆上已分配字节数的峰值；slabcache 的峰值不能超过预算加哈希桶的开销，命中的值必须完整
+// 用法：./slabcache_bench [访问次数] [键空间大小] [预算 MB]，默认 5M、100K、256
+#include <malloc.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hashalg.h"
+#include "slabcache.h"
+#include "uthash.h"
+
+#define MAX_VALUE (1 << 20)
+#define SAMPLE 1024
+#define CHECK_BYTES 64
+
+static inline double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// 已分配字节数，大块由 mmap 分配，单独统计
+static inline size_t heap_used(void) {
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+// Zipf(0.99)：按累积分布二分查找
+static uint64_t *zipf_trace(size_t n, size_t universe) {
+    double *cdf = malloc(universe * sizeof(double));
+    double sum = 0;
+    for (size_t k = 0; k < universe; k++) {
+        sum += 1.0 / pow((double)(k + 1), 0.99);
+        cdf[k] = sum;
+    }
+    uint64_t *trace = malloc(n * sizeof(uint64_t));
+    uint64_t state = 42;
+    for (size_t i = 0; i < n; i++) {
+        double u = (double)(splitmix64(&state) >> 11) / 9007199254740992.0 * sum;
+        size_t lo = 0, hi = universe - 1;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (cdf[mid] < u) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        trace[i] = lo;
+    }
+    free(cdf);
+    return trace;
+}
+
+// 键的值取自 blob 中按键偏移的一段，命中时比较开头，可发现取错条目或内容被覆盖
+static inline const unsigned char *value_of(const unsigned char *blob, uint64_t key) {
+    return blob + (key & 4095);
+}
+
+static inline bool value_ok(const unsigned char *v, size_t len, const unsigned char *blob, uint64_t key,
+                            size_t expected) {
+    return len == expected && memcmp(v, value_of(blob, key), len < CHECK_BYTES ? len : CHECK_BYTES) == 0;
+}
+
+// 键的值大小：长度的对数在 [4, 20] 上按 u^3 偏向小值，与键的热度无关
+static inline size_t value_size(uint64_t key) {
+    uint64_t state = key;
+    double u = (double)(splitmix64(&state) >> 11) / 9007199254740992.0;
+    size_t len = (size_t)(16.0 * exp2(16.0 * u * u * u));
+    return len < MAX_VALUE ? len : MAX_VALUE;
+}
+
+typedef struct {
+    double seconds;
+    size_t hits;
+    size_t corrupted;       // 命中但值的长度或开头与写入时不同
+    size_t peak_heap;       // 运行中堆上已分配字节数的峰值（相对开始时）
+} result;
+
+// 对照实现：uthash 双向链表保持插入顺序，表头为最久未使用
+typedef struct {
+    uint64_t key;
+    size_t len;
+    UT_hash_handle hh;
+    unsigned char value[];
+} ut_node;
+
+static result run_malloc(const uint64_t *trace, size_t n, size_t budget, const unsigned char *blob) {
+    result r = {0};
+    ut_node *table = NULL;
+    size_t bytes = 0;
+    size_t before = heap_used();
+    double start = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        uint64_t key = trace[i];
+        ut_node *e;
+        HASH_FIND(hh, table, &key, sizeof(key), e);
+        if (e) {
+            HASH_DELETE(hh, table, e);
+            HASH_ADD(hh, table, key, sizeof(key), e);
+            r.hits++;
+            r.corrupted += !value_ok(e->value, e->len, blob, key, value_size(key));
+        } else {
+            size_t len = value_size(key);
+            size_t size = sizeof(ut_node) + len;
+            while (table && bytes + size > budget) {
+                ut_node *oldest = table;
+                HASH_DELETE(hh, table, oldest);
+                bytes -= sizeof(ut_node) + oldest->len;
+                free(oldest);
+            }
+            e = malloc(size);
+            e->key = key;
+            e->len = len;
+            memcpy(e->value, value_of(blob, key), len);
+            HASH_ADD(hh, table, key, sizeof(key), e);
+            bytes += size;
+        }
+        if (i % SAMPLE == 0 && heap_used() - before > r.peak_heap) {
+            r.peak_heap = heap_used() - before;
+        }
+    }
+    r.seconds = now_sec() - start;
+    ut_node *e, *tmp;
+    HASH_ITER(hh, table, e, tmp) {
+        HASH_DELETE(hh, table, e);
+        free(e);
+    }
+    return r;
+}
+
+static result run_slabcache(const uint64_t *trace, size_t n, size_t budget, const unsigned char *blob,
+                            bool print_stats) {
+    result r = {0};
+    size_t before = heap_used();
+    slabcache c;
+    slabcache_init(&c, budget, 0, 0, 0);
+    double start = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        uint64_t key = trace[i];
+        size_t len;
+        const unsigned char *v = slabcache_get(&c, &key, sizeof(key), &len);
+        if (v) {
+            r.hits++;
+            r.corrupted += !value_ok(v, len, blob, key, value_size(key));
+        } else {
+            slabcache_put(&c, &key, sizeof(key), value_of(blob, key), value_size(key));
+        }
+        if (i % SAMPLE == 0 && heap_used() - before > r.peak_heap) {
+            r.peak_heap = heap_used() - before;
+        }
+    }
+    r.seconds = now_sec() - start;
+    if (print_stats) {
+        slabcache_print_stats(&c, stdout);
+    }
+    slabcache_free(&c);
+    return r;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 5000000;
+    size_t universe = argc > 2 ? strtoull(argv[2], NULL, 10) : 100000;
+    size_t budget = (argc > 3 ? strtoull(argv[3], NULL, 10) : 256) << 20;
+    uint64_t *trace = zipf_trace(n, universe);
+    unsigned char *blob = malloc(MAX_VALUE + 4096);
+    uint64_t state = 7;
+    for (size_t i = 0; i < MAX_VALUE + 4096; i++) {
+        blob[i] = (unsigned char)splitmix64(&state);
+    }
+    double total = 0;
+    for (size_t k = 0; k < universe; k++) {
+        total += (double)value_size(k);
+    }
+
+    printf("Zipf(0.99) trace: %zu accesses over %zu keys (%.0f MB of values), budget %zu MB\n", n, universe,
+           total / (1 << 20), budget >> 20);
+    result a = run_malloc(trace, n, budget, blob);
+    result b = run_slabcache(trace, n, budget, blob, true);
+    printf("%-24s %10s %10s %16s\n", "cache", "M ops/s", "hit %", "peak heap MB");
+    printf("%-24s %10.2f %10.2f %16.1f\n", "malloc per item + LRU", (double)n / a.seconds / 1e6,
+           100.0 * (double)a.hits / (double)n, (double)a.peak_heap / (1 << 20));
+    printf("%-24s %10.2f %10.2f %16.1f\n", "slabcache", (double)n / b.seconds / 1e6, 100.0 * (double)b.hits / (double)n,
+           (double)b.peak_heap / (1 << 20));
+    // 哈希桶每个条目不超过 16 字节
+    int failed = a.corrupted || b.corrupted || b.peak_heap > budget + universe * 16 + (1 << 20);
+    printf("check %s\n", failed ? "FAILED" : "ok");
+    free(blob);
+    free(trace);
+    return failed;
+}
@@ -0,0 +1,301 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "timerwheel.h"
+
+/*
+一、为什么不用最小堆
+（1）最小堆放置与取消都是 O(log n)，取消还要维护每个定时器在堆中的位置；
+    缓存中的过期时间绝大多数在到期前就被覆盖或随淘汰取消，取消与放置一样频繁
+（2）时间轮放置与取消都是摘挂一次链表；代价是到期时间只精确到第 0 层的一个桶，
+    以及高层的定时器下降时重新放置，每个定时器最多 TIMERWHEEL_LEVELS 次
+
+二、扫描的范围
+（1）第 i 层的刻度为时间右移 tick_shift + 6 * i 位，上次推进到的刻度 pt 与 now 的刻度 ct 之间（含两端）的桶都要检查，
+    ct - pt 超过 63 时整层 64 个桶都检查；第 i 层刻度不变时更高层的刻度也不变，不再检查
+（2）放置时到期时间与参考时间之差小于第 i + 1 层一个桶的宽度就放在第 i 层，桶的刻度与参考时间的刻度之差不超过 64，
+    参考时间不早于上次推进到的时间，所以在刻度到达之前桶都在下次检查的范围内，不会被跳过
+（3）桶中的定时器先整体移到暂存链再逐个处理，重新放置时即使放回同一个桶也不会被本轮重复处理；
+    没有到期的定时器以 now 为参考重新放置，到期的回调
+（4）一轮扫描开始时 time 即置为 now，之后放置的定时器（包括回调中放置的）都以 now 为参考，
+    落在已扫描过的桶中的，刻度不早于 now 的刻度，下一轮从 now 的刻度开始扫描，仍会检查到
+（5）上限同时计入回调与重新放置：高层的一个桶可能有整层跨度内的大量定时器，一次全部下降会造成长时间停顿；
+    达到上限时扫描位置（层、桶）与暂存链都保留，下次调用先把这一轮做完再开始新的一轮，已做的工作不会重做，
+    每次调用的耗时有上界，只要调用的频率跟得上放置的频率就不会积压
+*/
+
+static inline unsigned level_shift(const timerwheel *w, unsigned level) {
+    return w->tick_shift + 6 * level;
+}
+
+static inline uint32_t bucket_of(const timerwheel *w, unsigned level, uint64_t t) {
+    return (uint32_t)(w->capacity + level * TIMERWHEEL_BUCKETS + ((t >> level_shift(w, level)) & (TIMERWHEEL_BUCKETS - 1)));
+}
+
+static inline uint32_t pending(const timerwheel *w) {
+    return (uint32_t)(w->capacity + TIMERWHEEL_LEVELS * TIMERWHEEL_BUCKETS);
+}
+
+static inline void list_init(timerwheel *w, uint32_t s) {
+    w->nodes[s].prev = w->nodes[s].next = s;
+}
+
+static inline void list_unlink(timerwheel *w, uint32_t id) {
+    timerwheel_node *n = &w->nodes[id];
+    w->nodes[n->prev].next = n->next;
+    w->nodes[n->next].prev = n->prev;
+    n->prev = TIMERWHEEL_NIL;
+}
+
+static inline void list_push_back(timerwheel *w, uint32_t s, uint32_t id) {
+    timerwheel_node *n = &w->nodes[id];
+    n->next = s;
+    n->prev = w->nodes[s].prev;
+    w->nodes[n->prev].next = id;
+    w->nodes[s].prev = id;
+}
+
+// 把 from 的整条链表接到 to 的尾部，from 置空
+static void list_splice(timerwheel *w, uint32_t from, uint32_t to) {
+    uint32_t first = w->nodes[from].next;
+    if (first == from) {
+        return;
+    }
+    uint32_t last = w->nodes[from].prev;
+    uint32_t tail = w->nodes[to].prev;
+    w->nodes[tail].next = first;
+    w->nodes[first].prev = tail;
+    w->nodes[last].next = to;
+    w->nodes[to].prev = last;
+    list_init(w, from);
+}
+
+// 以 ref 为参考时间放置，定时器必须未放置
+static void place(timerwheel *w, uint32_t id, uint64_t ref) {
+    uint64_t expire = w->nodes[id].expire;
+    // 已经到期的放在当前刻度的桶，下次推进时首先检查
+    uint64_t t = expire > ref ? expire : ref;
+    uint64_t delta = t - ref;
+    unsigned level = 0;
+    while (level + 1 < TIMERWHEEL_LEVELS && delta >> level_shift(w, level + 1)) {
+        level++;
+    }
+    if (level == TIMERWHEEL_LEVELS - 1) {
+        // 超出最高层跨度的先放在最远的桶，到时再重新放置
+        uint64_t horizon = (uint64_t)(TIMERWHEEL_BUCKETS - 1) << level_shift(w, level);
+        if (delta > horizon) {
+            t = ref + horizon;
+        }
+    }
+    list_push_back(w, bucket_of(w, level, t), id);
+    w->count++;
+}
+
+bool timerwheel_init(timerwheel *w, size_t capacity, unsigned tick_shift, uint64_t now) {
+    memset(w, 0, sizeof(*w));
+    if (capacity == 0 || capacity >= TIMERWHEEL_NIL - TIMERWHEEL_LEVELS * TIMERWHEEL_BUCKETS - 1 ||
+        tick_shift + 6 * TIMERWHEEL_LEVELS >= 64) {
+        return false;
+    }
+    w->nodes = malloc((capacity + TIMERWHEEL_LEVELS * TIMERWHEEL_BUCKETS + 1) * sizeof(timerwheel_node));
+    if (!w->nodes) {
+        return false;
+    }
+    w->capacity = capacity;
+    w->tick_shift = tick_shift;
+    timerwheel_clear(w, now);
+    return true;
+}
+
+void timerwheel_free(timerwheel *w) {
+    free(w->nodes);
+    memset(w, 0, sizeof(*w));
+}
+
+void timerwheel_clear(timerwheel *w, uint64_t now) {
+    for (size_t i = 0; i < w->capacity; i++) {
+        w->nodes[i].prev = TIMERWHEEL_NIL;
+    }
+    for (uint32_t s = (uint32_t)w->capacity; s <= pending(w); s++) {
+        list_init(w, s);
+    }
+    w->count = 0;
+    w->time = now;
+    w->scanning = false;
+}
+
+void timerwheel_schedule(timerwheel *w, uint32_t id, uint64_t expire) {
+    timerwheel_cancel(w, id);
+    w->nodes[id].expire = expire;
+    place(w, id, w->time);
+}
+
+bool timerwheel_cancel(timerwheel *w, uint32_t id) {
+    if (w->nodes[id].prev == TIMERWHEEL_NIL) {
+        return false;
+    }
+    list_unlink(w, id);
+    w->count--;
+    return true;
+}
+
+// 扫描中的下一个桶接到暂存链，扫描结束返回 false
+static bool next_bucket(timerwheel *w) {
+    while (w->scan_level < TIMERWHEEL_LEVELS) {
+        uint64_t pt = w->scan_from >> level_shift(w, w->scan_level);
+        uint64_t ct = w->time >> level_shift(w, w->scan_level);
+        if (pt == ct) {
+            break;
+        }
+        uint64_t steps = ct - pt + 1 < TIMERWHEEL_BUCKETS ? ct - pt + 1 : TIMERWHEEL_BUCKETS;
+        if (w->scan_step < steps) {
+            list_splice(w, bucket_of(w, w->scan_level, (pt + w->scan_step) << level_shift(w, w->scan_level)), pending(w));
+            w->scan_step++;
+            return true;
+        }
+        w->scan_level++;
+        w->scan_step = 0;
+    }
+    w->scanning = false;
+    return false;
+}
+
+size_t timerwheel_advance(timerwheel *w, uint64_t now, size_t budget, timerwheel_fn fn, void *ctx) {
+    size_t fired = 0, work = 0;
+    uint32_t p = pending(w);
+    for (;;) {
+        uint32_t id;
+        while ((id = w->nodes[p].next) != p) {
+            if (budget && work == budget) {
+                // 暂存链与扫描位置保留，下次从这里继续
+                return fired;
+            }
+            work++;
+            list_unlink(w, id);
+            w->count--;
+            if (w->nodes[id].expire <= now || w->nodes[id].expire <= w->time) {
+                fired++;
+                fn(ctx, id);
+            } else {
+                place(w, id, w->time);
+            }
+        }
+        if (w->scanning && next_bucket(w)) {
+            continue;
+        }
+        if (now <= w->time) {
+            return fired;
+        }
+        // 开始新的一轮扫描，time 先置为 now，之后放置的定时器以 now 为参考
+        w->scan_from = w->time;
+        w->time = now;
+        w->scan_level = 0;
+        w->scan_step = 0;
+        w->scanning = true;
+    }
+}
+
+#ifdef TIMERWHEEL_MAIN
+#include "hashalg.h"
+
+#define N 20000
+
+static uint64_t rng = 0x9E3779B97F4A7C15ULL;
+
+typedef struct {
+    uint64_t now;
+    uint64_t *expire;       // 期望的到期时间，0 表示未放置
+    size_t fired;
+    size_t early;           // 没到期就回调
+    uint64_t prev;          // 上一次推进到的时间
+    bool check_late;        // 上一次推进没有因回调上限停下
+    size_t late;            // 上一次推进时已到期却没有回调
+    size_t unexpected;      // 未放置却回调
+} check_ctx;
+
+static void on_expire(void *arg, uint32_t id) {
+    check_ctx *ctx = arg;
+    ctx->fired++;
+    if (ctx->expire[id] == 0) {
+        ctx->unexpected++;
+        return;
+    }
+    ctx->early += ctx->expire[id] > ctx->now;
+    ctx->late += ctx->check_late && ctx->expire[id] <= ctx->prev;
+    ctx->expire[id] = 0;
+}
+
+int main(void) {
+    int failed = 0;
+
+    // 示例1：三个定时器，单位毫秒，第 0 层每桶 1ms
+    timerwheel w;
+    timerwheel_init(&w, 4, 0, 1000);
+    uint64_t expire[N] = {0};
+    check_ctx ctx = {.now = 1000, .expire = expire};
+    expire[0] = 1050;
+    expire[1] = 1000 + 5000;
+    expire[2] = 1000 + 3600 * 1000;
+    for (uint32_t i = 0; i < 3; i++) {
+        timerwheel_schedule(&w, i, expire[i]);
+    }
+    timerwheel_cancel(&w, 1);
+    expire[1] = 0;
+    ctx.now = 1049;
+    failed |= timerwheel_advance(&w, ctx.now, 0, on_expire, &ctx) != 0;
+    ctx.now = 1050;
+    failed |= timerwheel_advance(&w, ctx.now, 0, on_expire, &ctx) != 1 || timerwheel_count(&w) != 1;
+    ctx.now = 1000 + 3600 * 1000;
+    failed |= timerwheel_advance(&w, ctx.now, 0, on_expire, &ctx) != 1 || timerwheel_count(&w) != 0;
+    failed |= ctx.early || ctx.late || ctx.unexpected;
+    timerwheel_free(&w);
+
+    // 示例2：大量随机定时器，随机步长推进，一部分中途取消或重新放置，部分推进限制回调个数；
+    //        与逐个比较的结果对照：每个定时器恰好回调一次，不早于到期时间，
+    //        第 0 层每桶 1ms 时在到期后的第一次推进中回调（前一次推进因处理上限停下的除外）
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.expire = expire;
+    ctx.now = 1;
+    timerwheel_init(&w, N, 0, ctx.now);
+    size_t scheduled = 0, cancelled = 0, replaced = 0;
+    bool stopped = false;
+    for (int round = 0; round < 200000; round++) {
+        uint32_t id = (uint32_t)(splitmix64(&rng) % N);
+        uint64_t r = splitmix64(&rng);
+        if (r % 4 == 0) {
+            // 跨度从毫秒到 20 天，覆盖所有层以及超出最高层
+            uint64_t span = 1ULL << (r >> 8) % 31;
+            replaced += expire[id] != 0;
+            expire[id] = ctx.now + 1 + (r >> 40) % span;
+            timerwheel_schedule(&w, id, expire[id]);
+            scheduled++;
+        } else if (r % 4 == 1) {
+            cancelled += expire[id] != 0;
+            failed |= timerwheel_cancel(&w, id) != (expire[id] != 0);
+            expire[id] = 0;
+        } else {
+            uint64_t step = r % 16 == 2 ? (r >> 8) % 100000000 : (r >> 8) % 8;
+            size_t budget = r % 8 == 3 ? 4 : 0;
+            ctx.check_late = !stopped;
+            ctx.prev = ctx.now;
+            ctx.now += step;
+            timerwheel_advance(&w, ctx.now, budget, on_expire, &ctx);
+            stopped = w.scanning;
+        }
+    }
+    // 推进到最远的到期时间，全部回调
+    ctx.check_late = false;
+    ctx.now += 1ULL << 31;
+    timerwheel_advance(&w, ctx.now, 0, on_expire, &ctx);
+    for (int i = 0; i < N; i++) {
+        failed |= expire[i] != 0;
+    }
+    failed |= timerwheel_count(&w) != 0 || ctx.fired + cancelled + replaced != scheduled;
+    failed |= ctx.early || ctx.late || ctx.unexpected;
+    printf("scheduled %zu, cancelled %zu, fired %zu, early %zu, late %zu, check %s\n", scheduled, cancelled, ctx.fired,
+           ctx.early, ctx.late, failed ? "FAILED" : "ok");
+    timerwheel_free(&w);
+    return failed;
+}
+#endif
@@ -0,0 +1,121 @@
+#ifndef DSA_LRU_TIMERWHEEL_H
+#define DSA_LRU_TIMERWHEEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+分层时间轮（hierarchical timing wheel，Varghese & Lauck 1987），定时器为编号 [0, capacity) 的整数，
+如 lrucache 的节点编号
+（1）TIMERWHEEL_LEVELS 层，每层 64 个桶；第 0 层每桶 2^tick_shift 个时间单位，上一层每桶是下一层整层的跨度，
+    5 层、单位毫秒、tick_shift 为 0 时依次为 64ms、4.1s、4.4min、4.7h、12.4 天，更远的定时器放在最高层，到期前重新放置
+（2）schedule 按到期时间与当前时间之差选层，桶号为到期时间在该层的刻度取低 6 位，挂到桶的双向链表上，O(1)；
+    cancel 直接从链表摘下，O(1)
+（3）advance 推进到 now：每层只扫描当前时间与 now 之间的桶（最多 64 个），桶中到期的定时器回调，
+    没到期的（高层的桶跨度大）按新的时间重新放到更低的层；每个定时器最多下降 TIMERWHEEL_LEVELS 次
+（4）advance 可以限制一次处理（回调或重新放置）的定时器个数，把过期处理分摊到各次操作中；
+    达到上限时记下扫描位置，下次从同一处继续
+（5）定时器与桶都用 32 位编号链接：编号 [0, capacity) 为定时器，其后 TIMERWHEEL_LEVELS * 64 个为桶的哨兵，
+    最后一个为 advance 暂存一个桶的哨兵；初始化之后不调用 malloc/free
+*/
+
+#define TIMERWHEEL_LEVELS 5
+#define TIMERWHEEL_BUCKETS 64
+#define TIMERWHEEL_NIL UINT32_MAX
+
+typedef struct {
+    uint64_t expire;    // 到期时间
+    uint32_t prev;      // 未放置的定时器为 TIMERWHEEL_NIL
+    uint32_t next;
+} timerwheel_node;
+
+typedef struct {
+    timerwheel_node *nodes;     // capacity 个定时器，之后为桶的哨兵
+    size_t capacity;
+    size_t count;               // 已放置的定时器个数
+    uint64_t time;              // 已推进到的时间，扫描中为这一轮的目标时间
+    unsigned tick_shift;        // 第 0 层每桶 2^tick_shift 个时间单位
+    bool scanning;              // 上次 advance 达到处理上限，这一轮扫描还没做完
+    unsigned scan_level;        // 扫描位置：层与层内的第几个桶
+    uint64_t scan_step;
+    uint64_t scan_from;         // 这一轮扫描开始时的时间
+} timerwheel;
+
+// 到期回调，回调时定时器已摘下；回调中可以放置或取消任意定时器
+typedef void (*timerwheel_fn)(void *ctx, uint32_t id);
+
+/**
+* @brief             初始化
+* @param   capacity  定时器个数，编号为 [0, capacity)
+* @param   tick_shift 第 0 层每桶 2^tick_shift 个时间单位，决定到期的精度
+* @param   now       当前时间，时间单位由调用者决定
+* @return  bool      参数非法或申请内存失败返回 false
+*
+* @note              Revision History
+*/
+bool timerwheel_init(timerwheel *w, size_t capacity, unsigned tick_shift, uint64_t now);
+
+/**
+* @brief             释放
+*
+* @note              Revision History
+*/
+void timerwheel_free(timerwheel *w);
+
+/**
+* @brief             取消全部定时器，时间置为 now
+*
+* @note              Revision History
+*/
+void timerwheel_clear(timerwheel *w, uint64_t now);
+
+/**
+* @brief             放置定时器，已放置的先取消
+* @param   expire    到期时间，不晚于当前时间的在下一次 advance 时回调
+*
+* @note              O(1)
+*/
+void timerwheel_schedule(timerwheel *w, uint32_t id, uint64_t expire);
+
+/**
+* @brief             取消定时器
+* @return  bool      定时器未放置返回 false
+*
+* @note              O(1)
+*/
+bool timerwheel_cancel(timerwheel *w, uint32_t id);
+
+/**
+* @brief             推进到 now，对到期的定时器回调 fn
+* @param   budget    最多处理（回调或重新放置）的定时器个数，0 表示不限；
+*                    达到上限时 scanning 为 true，剩下的下次继续
+* @return  size_t    回调的个数
+*
+* @note              定时器在到期后的第一次 advance 中回调（前一次 advance 达到上限的除外），精度为第 0 层的一个桶；
+*                    now 早于已推进到的时间时只继续没做完的扫描
+*/
+size_t timerwheel_advance(timerwheel *w, uint64_t now, size_t budget, timerwheel_fn fn, void *ctx);
+
+static inline bool timerwheel_scheduled(const timerwheel *w, uint32_t id) {
+    return w->nodes[id].prev != TIMERWHEEL_NIL;
+}
+
+// 定时器的到期时间，定时器必须已放置
+static inline uint64_t timerwheel_expire(const timerwheel *w, uint32_t id) {
+    return w->nodes[id].expire;
+}
+
+static inline size_t timerwheel_count(const timerwheel *w) {
+    return w->count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_LRU_TIMERWHEEL_H
@@ -0,0 +1,107 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "hashalg.h"
+#include "trace.h"
+
+// 一行的最大长度，更长的行截断后剩余部分作为下一行处理
+#define TRACE_LINE_MAX 4096
+
+bool trace_format_parse(const char *name, trace_format *format) {
+    if (strcmp(name, "text") == 0) {
+        *format = TRACE_TEXT;
+    } else if (strcmp(name, "arc") == 0) {
+        *format = TRACE_ARC;
+    } else if (strcmp(name, "bin64") == 0) {
+        *format = TRACE_BIN64;
+    } else if (strcmp(name, "bin32") == 0) {
+        *format = TRACE_BIN32;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool trace_open(trace_reader *r, const char *path, trace_format format) {
+    memset(r, 0, sizeof(*r));
+    r->fp = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    r->format = format;
+    return r->fp != NULL;
+}
+
+void trace_close(trace_reader *r) {
+    if (r->fp && r->fp != stdin) {
+        fclose(r->fp);
+    }
+    memset(r, 0, sizeof(*r));
+}
+
+// 去掉行尾换行与空白，返回长度
+static size_t trim(char *line) {
+    size_t len = strlen(line);
+    while (len && (line[len - 1] == '\n' || line[len - 1] == '\r' || line[len - 1] == ' ' || line[len - 1] == '\t')) {
+        line[--len] = '\0';
+    }
+    return len;
+}
+
+// text 格式的一行：整数直接作为键，其他哈希
+static bool parse_text(const char *line, size_t len, uint64_t *key) {
+    if (len == 0 || line[0] == '#' || line[0] == '*') {
+        return false;
+    }
+    char *end;
+    uint64_t v = strtoull(line, &end, 10);
+    *key = end != line && *end == '\0' ? v : xxh3Hash64(line, len, 0);
+    return true;
+}
+
+// 二进制格式按小端解释，与主机字节序无关
+static size_t read_binary(trace_reader *r, uint64_t *keys, size_t max) {
+    size_t width = r->format == TRACE_BIN64 ? 8 : 4;
+    unsigned char *buf = (unsigned char *)keys;
+    // 4 字节的键读到数组后半部分，从前往后展开时不会覆盖还没展开的数据
+    unsigned char *src = width == 8 ? buf : buf + max * 4;
+    size_t n = fread(src, width, max, r->fp);
+    for (size_t i = 0; i < n; i++) {
+        const unsigned char *p = src + i * width;
+        uint64_t v = 0;
+        for (size_t b = width; b > 0; b--) {
+            v = v << 8 | p[b - 1];
+        }
+        keys[i] = v;
+    }
+    return n;
+}
+
+size_t trace_read(trace_reader *r, uint64_t *keys, size_t max) {
+    if (r->format == TRACE_BIN64 || r->format == TRACE_BIN32) {
+        size_t n = read_binary(r, keys, max);
+        r->count += n;
+        return n;
+    }
+    char line[TRACE_LINE_MAX];
+    size_t n = 0;
+    while (n < max) {
+        if (r->blocks_left) {
+            keys[n++] = r->next_block++;
+            r->blocks_left--;
+            continue;
+        }
+        if (!fgets(line, sizeof(line), r->fp)) {
+            break;
+        }
+        size_t len = trim(line);
+        if (r->format == TRACE_TEXT) {
+            n += parse_text(line, len, &keys[n]);
+        } else {
+            unsigned long long start, count;
+            if (sscanf(line, "%llu %llu", &start, &count) == 2) {
+                r->next_block = start;
+                r->blocks_left = count;
+            }
+        }
+    }
+    r->count += n;
+    return n;
+}
@@ -0,0 +1,72 @@
+#ifndef DSA_LRU_TRACE_H
+#define DSA_LRU_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+缓存访问序列（trace）的流式读取，每次读出一批 64 位键，不把整个文件读入内存
+（1）text：每行一个键，整数行（LIRS 论文的 trace 即为每行一个块号）直接作为键，
+    其他内容按 xxh3Hash64 哈希为键；空行和以 # 或 * 开头的行跳过
+（2）arc：ARC 论文（Megiddo & Modha）的 trace，每行"起始块号 块数 忽略 请求号"，展开为连续的块号
+（3）bin64、bin32：每个键 8 或 4 字节小端整数，没有文件头；解析最快，几十亿次访问的 trace 建议先转成这种格式
+*/
+
+typedef enum {
+    TRACE_TEXT,
+    TRACE_ARC,
+    TRACE_BIN64,
+    TRACE_BIN32,
+} trace_format;
+
+typedef struct {
+    FILE *fp;
+    trace_format format;
+    uint64_t next_block;    // arc：当前请求还没读出的块
+    uint64_t blocks_left;
+    uint64_t count;         // 已读出的键数
+} trace_reader;
+
+/**
+* @brief             按名字（text、arc、bin64、bin32）取格式
+* @return  bool      名字不认识返回 false
+*
+* @note              Revision History
+*/
+bool trace_format_parse(const char *name, trace_format *format);
+
+/**
+* @brief             打开
+* @param   path      文件名，"-" 为标准输入
+* @return  bool      打开失败返回 false
+*
+* @note              Revision History
+*/
+bool trace_open(trace_reader *r, const char *path, trace_format format);
+
+/**
+* @brief             读出最多 max 个键
+* @return  size_t    读出的键数，0 表示结束
+*
+* @note              格式错误的行跳过
+*/
+size_t trace_read(trace_reader *r, uint64_t *keys, size_t max);
+
+/**
+* @brief             关闭
+*
+* @note              Revision History
+*/
+void trace_close(trace_reader *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_LRU_TRACE_H
@@ -0,0 +1,137 @@
+// 过期时间性能测试：均匀访问流，未命中时以随机的过期时间写入（cache-aside），时钟为虚拟时间，每 100 次访问前进 1ms
+// （1）对照：值中存到期时间，get 时惰性检查，另外每 1000ms 遍历整个缓存删除到期的键（O(n) 扫描）
+// （2）lrucache_enable_ttl：分层时间轮，到期的键在 get/put 中分摊删除
+// 容量不小于键空间，没有淘汰，两者命中次数必须相同；同时统计最慢的 1000 次访问的耗时与结束时残留的过期键数
+// 用法：./ttl_bench [访问次数] [键空间大小] [最长过期时间 ms]，默认 20M、1M、30000
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hashalg.h"
+#include "lrucache.h"
+
+#define BATCH 1000
+#define OPS_PER_MS 100
+#define SCAN_INTERVAL 1000
+
+static inline double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t virtual_clock(void *ctx) {
+    return *(uint64_t *)ctx;
+}
+
+typedef struct {
+    double seconds;
+    double worst_batch;     // 最慢的 BATCH 次访问，秒
+    size_t hits;
+    size_t stale;           // 结束时仍在缓存中的过期键
+} result;
+
+typedef struct {
+    uint64_t expire;
+    uint64_t payload;
+} scan_value;
+
+// 遍历删除到期的键：先收集再删除，遍历期间不能修改缓存
+static void scan_expired(lrucache *c, uint64_t now, uint64_t *keys) {
+    size_t n = 0;
+    uint32_t pos = LRUCACHE_NIL;
+    const void *key;
+    void *value;
+    while (lrucache_next(c, &pos, &key, NULL, &value)) {
+        if (((scan_value *)value)->expire <= now) {
+            memcpy(&keys[n++], key, sizeof(uint64_t));
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        lrucache_erase(c, &keys[i], sizeof(uint64_t));
+    }
+}
+
+static result run(bool wheel, size_t n, size_t universe, uint64_t max_ttl) {
+    result r = {0};
+    lrucache c;
+    uint64_t now = 1;
+    lrucache_init(&c, universe, sizeof(uint64_t), sizeof(scan_value), 0);
+    uint64_t *keys = wheel ? NULL : malloc(universe * sizeof(uint64_t));
+    if (wheel) {
+        lrucache_enable_ttl(&c, virtual_clock, &now);
+    }
+    uint64_t state = 42;
+    uint64_t next_scan = SCAN_INTERVAL;
+    double start = now_sec(), batch_start = start;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t r64 = splitmix64(&state);
+        uint64_t key = r64 % universe;
+        uint64_t ttl = 1 + (r64 >> 32) % max_ttl;
+        if (wheel) {
+            if (lrucache_get(&c, &key, sizeof(key))) {
+                r.hits++;
+            } else {
+                scan_value v = {0, key};
+                lrucache_put_ttl(&c, &key, sizeof(key), &v, ttl, NULL, NULL);
+            }
+        } else {
+            scan_value *v = lrucache_get(&c, &key, sizeof(key));
+            if (v && v->expire <= now) {
+                lrucache_erase(&c, &key, sizeof(key));
+                v = NULL;
+            }
+            if (v) {
+                r.hits++;
+            } else {
+                scan_value nv = {now + ttl, key};
+                lrucache_put(&c, &key, sizeof(key), &nv, NULL, NULL);
+            }
+        }
+        if ((i + 1) % OPS_PER_MS == 0) {
+            now++;
+            if (!wheel && now >= next_scan) {
+                scan_expired(&c, now, keys);
+                next_scan += SCAN_INTERVAL;
+            }
+        }
+        if ((i + 1) % BATCH == 0) {
+            double t = now_sec();
+            if (t - batch_start > r.worst_batch) {
+                r.worst_batch = t - batch_start;
+            }
+            batch_start = t;
+        }
+    }
+    r.seconds = now_sec() - start;
+    // 残留的过期键
+    uint32_t pos = LRUCACHE_NIL;
+    const void *key;
+    void *value;
+    while (lrucache_next(&c, &pos, &key, NULL, &value)) {
+        uint64_t expire = wheel ? timerwheel_expire(c.wheel, pos) : ((scan_value *)value)->expire;
+        r.stale += (!wheel || timerwheel_scheduled(c.wheel, pos)) && expire <= now;
+    }
+    free(keys);
+    lrucache_free(&c);
+    return r;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 20000000;
+    size_t universe = argc > 2 ? strtoull(argv[2], NULL, 10) : 1000000;
+    uint64_t max_ttl = argc > 3 ? strtoull(argv[3], NULL, 10) : 30000;
+    printf("accesses %zu, keys %zu, ttl 1..%llu ms, %d accesses per ms\n", n, universe, (unsigned long long)max_ttl,
+           OPS_PER_MS);
+    printf("%-18s %10s %10s %14s %10s\n", "", "M ops/s", "hit %", "worst 1K us", "stale");
+    result scan = run(false, n, universe, max_ttl);
+    printf("%-18s %10.2f %10.2f %14.1f %10zu\n", "scan every 1000ms", n / scan.seconds / 1e6, 100.0 * scan.hits / n,
+           scan.worst_batch * 1e6, scan.stale);
+    result tw = run(true, n, universe, max_ttl);
+    printf("%-18s %10.2f %10.2f %14.1f %10zu\n", "timer wheel", n / tw.seconds / 1e6, 100.0 * tw.hits / n,
+           tw.worst_batch * 1e6, tw.stale);
+    int failed = scan.hits != tw.hits;
+    printf("check %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
@@ -0,0 +1,565 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "hashalg.h"
+#include "mphf.h"
+
+/*
+一、为什么用最小完美哈希
+（1）只读字典启动时逐个插入链式哈希表：每个键一次 malloc，键与指针各存一份，5000 万个键要几秒到几十秒和数 GB 内存
+（2）键集合固定时，可以离线算出一个把这些键一一映射到 [0, n) 的函数，值按索引存在数组里，查询时不需要比较键
+（3）函数本身只需约 3 bits/key，与键长无关；整个结构是几段连续数组，直接 mmap 文件即可使用，没有加载过程
+
+二、BBHash 的构造（Limasset 等，2017）
+（1）第 0 层：位图 A 大小为 gamma * n，每个键用第 0 层的哈希落到一位，只有一个键落到的位置 1，
+    多个键落到同一位的都清 0，这些冲突的键进入下一层
+（2）第 i 层对剩余的键重复，位图大小为 gamma * 剩余键数；gamma = 1 时一个键独占一位的概率约为 e^-1 ≈ 37%，
+    约 63% 的键进入下一层，层数为 log(n) 量级，总位数约 n / e^-1 = e * n，加上 rank 表共约 3 bits/key
+（3）查询时依次看各层，第一次落到 1 的层即命中，索引 = 该位之前所有层的 1 的个数（rank），
+    rank 每 512 位预存一个累计值，查询最多再做 8 次 popcount
+（4）并行：同一层中各线程分段处理键，置位用原子 or，第二个落到同一位的键在冲突位图 C 中置位，
+    结束后 A &= ~C；收集下一层的键时各线程先计数、求前缀和，再写到各自的位置，结果与单线程相同
+
+三、哈希
+（1）每个键只用 xxh3Hash64 算一次 64 位哈希，各层的位置由它与层号再混合一次得到，后续层不需要再读键
+（2）两个不同的键 64 位哈希相同时，每层都落在同一位，永远冲突，层数超过上限后换种子重建；
+    5000 万个键出现这种情况的概率约为 7e-5
+（3）位置用 64 位乘法取高位映射到 [0, size)，代替取模
+
+四、文件格式
+（1）头部 64 字节，之后依次为各层位数（MPHF_MAX_LEVELS 个）、位图、rank 表、指纹、值，每段按 8 字节对齐
+（2）构造时直接在一块内存中生成这个映像，保存即整块写出，打开即整块映射，两者使用同一段解析代码
+*/
+
+#define MPHF_MAGIC "MPH1"
+#define MPHF_HEADER_SIZE 64
+#define MPHF_MAX_RETRIES 4
+
+typedef struct {
+    char magic[4];
+    uint32_t levels;
+    uint64_t seed;
+    uint64_t count;
+    uint64_t total_bits;
+    uint32_t value_size;
+    uint32_t fingerprint_bits;
+    uint64_t image_size;
+    uint64_t reserved[2];
+} mphf_header;
+
+_Static_assert(sizeof(mphf_header) == MPHF_HEADER_SIZE, "mphf header size");
+
+static inline size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+static inline uint64_t level_hash(uint64_t h, unsigned level) {
+    return fmix64(h ^ (uint64_t)(level + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+static inline uint64_t fast_range(uint64_t h, uint64_t size) {
+    return (uint64_t)(((unsigned __int128)h * size) >> 64);
+}
+
+// 整个映像的字节数与各段偏移
+typedef struct {
+    size_t levels_off, bits_off, ranks_off, fps_off, values_off, size;
+} mphf_layout;
+
+static mphf_layout layout_of(uint64_t total_bits, size_t count, size_t value_size, unsigned fp_bits) {
+    mphf_layout l;
+    l.levels_off = MPHF_HEADER_SIZE;
+    l.bits_off = l.levels_off + MPHF_MAX_LEVELS * sizeof(uint64_t);
+    l.ranks_off = l.bits_off + total_bits / 8;
+    l.fps_off = l.ranks_off + (total_bits / 512 + 1) * sizeof(uint64_t);
+    l.values_off = l.fps_off + align8(count * (fp_bits / 8));
+    l.size = l.values_off + align8(count * value_size);
+    return l;
+}
+
+// 解析映像，构造与打开共用
+static bool attach(mphf *m, void *image, size_t size) {
+    const unsigned char *p = image;
+    mphf_header h;
+    if (size < MPHF_HEADER_SIZE + MPHF_MAX_LEVELS * sizeof(uint64_t)) {
+        return false;
+    }
+    memcpy(&h, p, sizeof(h));
+    if (memcmp(h.magic, MPHF_MAGIC, 4) != 0 || h.levels > MPHF_MAX_LEVELS || h.image_size != size ||
+        (h.fingerprint_bits != 0 && h.fingerprint_bits != 8 && h.fingerprint_bits != 16 &&
+         h.fingerprint_bits != 32)) {
+        return false;
+    }
+    const uint64_t *sizes = (const uint64_t *)(p + MPHF_HEADER_SIZE);
+    uint64_t total = 0;
+    m->level_offset[0] = 0;
+    for (unsigned i = 0; i < h.levels; i++) {
+        if (sizes[i] == 0 || sizes[i] % 64 != 0 || sizes[i] > UINT64_MAX / 2 - total) {
+            return false;
+        }
+        total += sizes[i];
+        m->level_offset[i + 1] = total;
+    }
+    if (total != h.total_bits || h.count > total || h.value_size > SIZE_MAX / (h.count ? h.count : 1)) {
+        return false;
+    }
+    mphf_layout l = layout_of(total, h.count, h.value_size, h.fingerprint_bits);
+    if (l.size != size) {
+        return false;
+    }
+    m->bits = (const uint64_t *)(p + l.bits_off);
+    m->ranks = (const uint64_t *)(p + l.ranks_off);
+    m->fingerprints = p + l.fps_off;
+    m->values = p + l.values_off;
+    m->levels = h.levels;
+    m->fingerprint_bits = h.fingerprint_bits;
+    m->seed = h.seed;
+    m->count = h.count;
+    m->value_size = h.value_size;
+    m->image = image;
+    m->image_size = size;
+    return true;
+}
+
+static inline size_t rank(const mphf *m, uint64_t pos) {
+    uint64_t word = pos >> 6;
+    size_t r = m->ranks[pos >> 9];
+    for (uint64_t w = (pos >> 9) << 3; w < word; w++) {
+        r += (size_t)__builtin_popcountll(m->bits[w]);
+    }
+    return r + (size_t)__builtin_popcountll(m->bits[word] & ((1ULL << (pos & 63)) - 1));
+}
+
+static size_t index_of_hash(const mphf *m, uint64_t h) {
+    for (unsigned l = 0; l < m->levels; l++) {
+        uint64_t pos = m->level_offset[l] + fast_range(level_hash(h, l), m->level_offset[l + 1] - m->level_offset[l]);
+        if (m->bits[pos >> 6] >> (pos & 63) & 1) {
+            return rank(m, pos);
+        }
+    }
+    return MPHF_NONE;
+}
+
+static inline uint32_t fingerprint_of(uint64_t h, unsigned bits) {
+    return (uint32_t)h & (uint32_t)((1ULL << bits) - 1);
+}
+
+static inline uint32_t load_fingerprint(const mphf *m, size_t idx) {
+    const unsigned char *p = m->fingerprints + idx * (m->fingerprint_bits / 8);
+    uint32_t fp = 0;
+    for (unsigned i = 0; i < m->fingerprint_bits / 8; i++) {
+        fp |= (uint32_t)p[i] << (8 * i);
+    }
+    return fp;
+}
+
+size_t mphf_index(const mphf *m, const void *key, size_t len) {
+    uint64_t h = xxh3Hash64(key, len, m->seed);
+    size_t idx = index_of_hash(m, h);
+    if (idx != MPHF_NONE && m->fingerprint_bits &&
+        load_fingerprint(m, idx) != fingerprint_of(h, m->fingerprint_bits)) {
+        return MPHF_NONE;
+    }
+    return idx;
+}
+
+const void *mphf_find(const mphf *m, const void *key, size_t len) {
+    size_t idx = mphf_index(m, key, len);
+    return idx == MPHF_NONE ? NULL : m->values + idx * m->value_size;
+}
+
+double mphf_bits_per_key(const mphf *m) {
+    uint64_t bits = m->level_offset[m->levels];
+    return m->count ? (double)(bits + (bits / 512 + 1) * 64) / (double)m->count : 0;
+}
+
+// 多线程分段执行，第 t 个线程处理 [n * t / threads, n * (t + 1) / threads)
+typedef void (*range_fn)(void *ctx, unsigned t, size_t begin, size_t end);
+
+typedef struct {
+    range_fn fn;
+    void *ctx;
+    unsigned t;
+    size_t begin, end;
+} range_task;
+
+static void *range_run(void *arg) {
+    range_task *task = arg;
+    task->fn(task->ctx, task->t, task->begin, task->end);
+    return NULL;
+}
+
+static void parallel_for(unsigned threads, size_t n, range_fn fn, void *ctx) {
+    range_task tasks[threads];
+    pthread_t tids[threads];
+    for (unsigned t = 0; t < threads; t++) {
+        tasks[t] = (range_task){.fn = fn, .ctx = ctx, .t = t, .begin = n * t / threads, .end = n * (t + 1) / threads};
+    }
+    // 第 0 段在当前线程执行，创建线程失败时也在当前线程执行
+    bool spawned[threads];
+    for (unsigned t = 1; t < threads; t++) {
+        spawned[t] = pthread_create(&tids[t], NULL, range_run, &tasks[t]) == 0;
+        if (!spawned[t]) {
+            range_run(&tasks[t]);
+        }
+    }
+    range_run(&tasks[0]);
+    for (unsigned t = 1; t < threads; t++) {
+        if (spawned[t]) {
+            pthread_join(tids[t], NULL);
+        }
+    }
+}
+
+typedef struct {
+    const void *const *keys;
+    const size_t *lens;
+    uint64_t seed;
+    uint64_t *hashes;       // 全部键的哈希，按键的顺序
+    const uint64_t *cur;    // 本层的键
+    uint64_t *next;         // 下一层的键
+    uint64_t *seen;         // 本层位图 A
+    uint64_t *collide;      // 本层冲突位图 C
+    uint64_t size;          // 本层位数
+    unsigned level;
+    size_t *counts;         // 各线程留到下一层的键数，之后改为写入位置
+    // 填充指纹与值
+    mphf *m;
+    unsigned char *fps;
+    unsigned char *values;
+    const unsigned char *src_values;
+    int failed;
+} build_ctx;
+
+static void hash_range(void *arg, unsigned t, size_t begin, size_t end) {
+    build_ctx *c = arg;
+    (void)t;
+    for (size_t i = begin; i < end; i++) {
+        c->hashes[i] = xxh3Hash64(c->keys[i], c->lens[i], c->seed);
+    }
+}
+
+static void mark_range(void *arg, unsigned t, size_t begin, size_t end) {
+    build_ctx *c = arg;
+    (void)t;
+    for (size_t i = begin; i < end; i++) {
+        uint64_t pos = fast_range(level_hash(c->cur[i], c->level), c->size);
+        uint64_t bit = 1ULL << (pos & 63);
+        uint64_t old = __atomic_fetch_or(&c->seen[pos >> 6], bit, __ATOMIC_RELAXED);
+        if ((old & bit) && !(__atomic_load_n(&c->collide[pos >> 6], __ATOMIC_RELAXED) & bit)) {
+            __atomic_fetch_or(&c->collide[pos >> 6], bit, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void clear_range(void *arg, unsigned t, size_t begin, size_t end) {
+    build_ctx *c = arg;
+    (void)t;
+    for (size_t w = begin; w < end; w++) {
+        c->seen[w] &= ~c->collide[w];
+    }
+}
+
+static inline bool placed(const build_ctx *c, uint64_t h) {
+    uint64_t pos = fast_range(level_hash(h, c->level), c->size);
+    return c->seen[pos >> 6] >> (pos & 63) & 1;
+}
+
+static void count_range(void *arg, unsigned t, size_t begin, size_t end) {
+    build_ctx *c = arg;
+    size_t left = 0;
+    for (size_t i = begin; i < end; i++) {
+        left += !placed(c, c->cur[i]);
+    }
+    c->counts[t] = left;
+}
+
+static void collect_range(void *arg, unsigned t, size_t begin, size_t end) {
+    build_ctx *c = arg;
+    size_t out = c->counts[t];
+    for (size_t i = begin; i < end; i++) {
+        if (!placed(c, c->cur[i])) {
+            c->next[out++] = c->cur[i];
+        }
+    }
+}
+
+static void fill_range(void *arg, unsigned t, size_t begin, size_t end) {
+    build_ctx *c = arg;
+    const mphf *m = c->m;
+    unsigned fp_bytes = m->fingerprint_bits / 8;
+    (void)t;
+    for (size_t i = begin; i < end; i++) {
+        size_t idx = index_of_hash(m, c->hashes[i]);
+        if (idx >= m->count) {
+            __atomic_store_n(&c->failed, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        uint32_t fp = fingerprint_of(c->hashes[i], m->fingerprint_bits);
+        for (unsigned b = 0; b < fp_bytes; b++) {
+            c->fps[idx * fp_bytes + b] = (unsigned char)(fp >> (8 * b));
+        }
+        if (m->value_size) {
+            memcpy(c->values + idx * m->value_size, c->src_values + i * m->value_size, m->value_size);
+        }
+    }
+}
+
+// 逐层构造位图，成功时 level_bits 与 level_sizes 为各层结果
+static bool build_levels(build_ctx *c, size_t n, double gamma, unsigned threads, uint64_t **level_bits,
+                         uint64_t *level_sizes, unsigned *levels) {
+    size_t remaining = n;
+    const uint64_t *cur = c->hashes;
+    uint64_t *owned = NULL;     // cur 不是 hashes 时由这里释放
+    unsigned l = 0;
+    bool ok = true;
+    while (remaining > 0 && ok) {
+        if (l == MPHF_MAX_LEVELS) {
+            ok = false;
+            break;
+        }
+        double want = gamma * (double)remaining;
+        uint64_t size = ((uint64_t)want + 63) / 64 * 64;
+        size = size < 64 ? 64 : size;
+        c->seen = calloc(size / 64, sizeof(uint64_t));
+        c->collide = calloc(size / 64, sizeof(uint64_t));
+        if (!c->seen || !c->collide) {
+            free(c->seen);
+            free(c->collide);
+            ok = false;
+            break;
+        }
+        c->cur = cur;
+        c->size = size;
+        c->level = l;
+        // 键数少时单线程，避免建线程的开销超过计算本身
+        unsigned t = remaining < 65536 ? 1 : threads;
+        parallel_for(t, remaining, mark_range, c);
+        parallel_for(t, size / 64, clear_range, c);
+        free(c->collide);
+        parallel_for(t, remaining, count_range, c);
+        size_t left = 0;
+        for (unsigned i = 0; i < t; i++) {
+            size_t count = c->counts[i];
+            c->counts[i] = left;
+            left += count;
+        }
+        uint64_t *next = left ? malloc(left * sizeof(uint64_t)) : NULL;
+        if (left && !next) {
+            free(c->seen);
+            ok = false;
+            break;
+        }
+        c->next = next;
+        parallel_for(t, remaining, collect_range, c);
+        level_bits[l] = c->seen;
+        level_sizes[l] = size;
+        l++;
+        free(owned);
+        owned = next;
+        cur = next;
+        remaining = left;
+    }
+    free(owned);
+    *levels = l;
+    return ok;
+}
+
+static bool build_once(mphf *m, build_ctx *c, size_t n, double gamma, unsigned threads, size_t value_size,
+                       unsigned fp_bits) {
+    uint64_t *level_bits[MPHF_MAX_LEVELS] = {0};
+    uint64_t level_sizes[MPHF_MAX_LEVELS] = {0};
+    unsigned levels = 0;
+    parallel_for(n < 65536 ? 1 : threads, n, hash_range, c);
+    bool ok = build_levels(c, n, gamma, threads, level_bits, level_sizes, &levels);
+
+    unsigned char *image = NULL;
+    if (ok) {
+        uint64_t total = 0;
+        for (unsigned l = 0; l < levels; l++) {
+            total += level_sizes[l];
+        }
+        mphf_layout lay = layout_of(total, n, value_size, fp_bits);
+        image = calloc(1, lay.size);
+        ok = image != NULL;
+        if (ok) {
+            mphf_header h = {.levels = levels, .seed = c->seed, .count = n, .total_bits = total,
+                             .value_size = (uint32_t)value_size, .fingerprint_bits = fp_bits, .image_size = lay.size};
+            memcpy(h.magic, MPHF_MAGIC, 4);
+            memcpy(image, &h, sizeof(h));
+            memcpy(image + lay.levels_off, level_sizes, sizeof(level_sizes));
+            uint64_t *bits = (uint64_t *)(image + lay.bits_off);
+            uint64_t *ranks = (uint64_t *)(image + lay.ranks_off);
+            size_t word = 0;
+            for (unsigned l = 0; l < levels; l++) {
+                memcpy(bits + word, level_bits[l], level_sizes[l] / 8);
+                word += level_sizes[l] / 64;
+            }
+            size_t ones = 0;
+            for (size_t w = 0; w < total / 64; w++) {
+                if (w % 8 == 0) {
+                    ranks[w / 8] = ones;
+                }
+                ones += (size_t)__builtin_popcountll(bits[w]);
+            }
+            ranks[total / 512] = total / 64 % 8 == 0 ? ones : ranks[total / 512];
+            ok = ones == n && attach(m, image, lay.size);
+        }
+    }
+    for (unsigned l = 0; l < levels; l++) {
+        free(level_bits[l]);
+    }
+    if (ok) {
+        c->m = m;
+        c->fps = (unsigned char *)m->fingerprints;
+        c->values = (unsigned char *)m->values;
+        c->failed = 0;
+        parallel_for(n < 65536 ? 1 : threads, n, fill_range, c);
+        ok = !c->failed;
+    }
+    if (!ok) {
+        free(image);
+        memset(m, 0, sizeof(*m));
+    }
+    return ok;
+}
+
+bool mphf_build(mphf *m, const void *const *keys, const size_t *lens, size_t n, const void *values,
+                size_t value_size, const mphf_config *config) {
+    mphf_config cfg = config ? *config : (mphf_config){0};
+    double gamma = cfg.gamma > 0 ? cfg.gamma : MPHF_DEFAULT_GAMMA;
+    unsigned threads = cfg.threads ? cfg.threads : 1;
+    memset(m, 0, sizeof(*m));
+    if ((cfg.fingerprint_bits != 0 && cfg.fingerprint_bits != 8 && cfg.fingerprint_bits != 16 &&
+         cfg.fingerprint_bits != 32) ||
+        value_size > UINT32_MAX || (value_size && !values) || gamma < 0.5 || threads > 1024) {
+        return false;
+    }
+
+    build_ctx c = {.keys = keys, .lens = lens, .src_values = values};
+    c.hashes = malloc((n ? n : 1) * sizeof(uint64_t));
+    c.counts = malloc(threads * sizeof(size_t));
+    bool ok = c.hashes && c.counts;
+    if (ok) {
+        ok = false;
+        for (int retry = 0; retry < MPHF_MAX_RETRIES && !ok; retry++) {
+            c.seed = cfg.seed + (uint64_t)retry * 0x9E3779B97F4A7C15ULL;
+            ok = build_once(m, &c, n, gamma, threads, value_size, cfg.fingerprint_bits);
+        }
+    }
+    free(c.hashes);
+    free(c.counts);
+    return ok;
+}
+
+void mphf_free(mphf *m) {
+    if (m->mapped) {
+        munmap(m->image, m->image_size);
+    } else {
+        free(m->image);
+    }
+    memset(m, 0, sizeof(*m));
+}
+
+bool mphf_save(const mphf *m, const char *path) {
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        return false;
+    }
+    bool ok = fwrite(m->image, 1, m->image_size, fp) == m->image_size;
+    ok = fclose(fp) == 0 && ok;
+    return ok;
+}
+
+bool mphf_open(mphf *m, const char *path) {
+    memset(m, 0, sizeof(*m));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    void *image = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        image = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    // 映射建立后即可关闭文件描述符
+    close(fd);
+    if (image == MAP_FAILED) {
+        return false;
+    }
+    if (!attach(m, image, (size_t)st.st_size)) {
+        munmap(image, (size_t)st.st_size);
+        memset(m, 0, sizeof(*m));
+        return false;
+    }
+    m->mapped = true;
+    return true;
+}
+
+#ifdef MPHF_MAIN
+int main(void) {
+
+    // 示例1：10 万个字符串键，值为键的编号，16 位指纹
+    enum { N = 100000 };
+    char (*text)[16] = malloc(N * sizeof(*text));
+    const void **keys = malloc(N * sizeof(void *));
+    size_t *lens = malloc(N * sizeof(size_t));
+    uint32_t *values = malloc(N * sizeof(uint32_t));
+    for (uint32_t i = 0; i < N; i++) {
+        lens[i] = (size_t)snprintf(text[i], sizeof(text[i]), "word:%u", i);
+        keys[i] = text[i];
+        values[i] = i;
+    }
+    mphf m;
+    mphf_config cfg = {.threads = 2, .fingerprint_bits = 16};
+    int failed = !mphf_build(&m, keys, lens, N, values, sizeof(uint32_t), &cfg);
+
+    // 每个键的索引互不相同，值与编号一致
+    unsigned char *used = calloc(N, 1);
+    for (uint32_t i = 0; i < N && !failed; i++) {
+        size_t idx = mphf_index(&m, keys[i], lens[i]);
+        const uint32_t *v = mphf_find(&m, keys[i], lens[i]);
+        failed |= idx >= N || used[idx] || !v || *v != i;
+        used[idx < N ? idx : 0] = 1;
+    }
+    size_t false_hits = 0;
+    char other[16];
+    for (uint32_t i = 0; i < N; i++) {
+        size_t len = (size_t)snprintf(other, sizeof(other), "miss:%u", i);
+        false_hits += mphf_find(&m, other, len) != NULL;
+    }
+    printf("%d keys, %u levels, %.2f bits/key, file %zu bytes, non-member hits %zu\n", N, m.levels,
+           mphf_bits_per_key(&m), m.image_size, false_hits);
+
+    // 示例2：写到文件后映射打开，结果与内存中的相同
+    const char *path = "/tmp/mphf_demo.bin";
+    failed |= !mphf_save(&m, path);
+    mphf mapped;
+    failed |= !mphf_open(&mapped, path);
+    for (uint32_t i = 0; i < N && !failed; i++) {
+        failed |= mphf_index(&mapped, keys[i], lens[i]) != mphf_index(&m, keys[i], lens[i]);
+    }
+    // 重复的键无法构造
+    keys[1] = keys[0];
+    lens[1] = lens[0];
+    mphf dup;
+    failed |= mphf_build(&dup, keys, lens, N, NULL, 0, NULL);
+    printf("mmap open and duplicate key rejection, check %s\n", failed ? "FAILED" : "ok");
+
+    mphf_free(&mapped);
+    mphf_free(&m);
+    unlink(path);
+    free(used);
+    free(text);
+    free(keys);
+    free(lens);
+    free(values);
+    return failed;
+}
+#endif
@@ -0,0 +1,113 @@
+#ifndef DSA_MPHF_MPHF_H
+#define DSA_MPHF_MPHF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+最小完美哈希（BBHash）与定长值数组，面向只读的大字典
+（1）n 个互不相同的键映射到 [0, n) 且没有冲突，索引本身约 3 bits/key（gamma = 1），不存键
+（2）值按索引放在定长数组中，可选每个键 8/16/32 位指纹，用于以 1/2^bits 的误判率拒绝不在集合中的键
+（3）构造在内存中直接生成文件映像，mphf_save 原样写出；mphf_open 把文件 mmap 为只读后立即可查，
+    没有反序列化与建表过程，多个进程映射同一个文件时共享页缓存
+（4）构造可多线程：各线程分段计算哈希、在同一层的位图上原子置位，再并行收集冲突键进入下一层
+（5）键为任意字节串，哈希为 hashalg.h 的 xxh3Hash64；文件按小端存储
+*/
+
+// 最多层数，超过时换种子重建
+#define MPHF_MAX_LEVELS 64
+// 默认每层位图大小与剩余键数之比，越大构造和查询越快，但占用越多
+#define MPHF_DEFAULT_GAMMA 1.0
+// 不在集合中
+#define MPHF_NONE SIZE_MAX
+
+typedef struct {
+    const uint64_t *bits;               // 各层位图首尾相接
+    const uint64_t *ranks;              // 每 512 位之前的 1 的个数
+    const unsigned char *fingerprints;  // count 个，每个 fingerprint_bits / 8 字节
+    const unsigned char *values;        // count 个，每个 value_size 字节
+    uint64_t level_offset[MPHF_MAX_LEVELS + 1];  // 各层在 bits 中的起始位，最后一个为总位数
+    unsigned levels;
+    unsigned fingerprint_bits;
+    uint64_t seed;
+    size_t count;
+    size_t value_size;
+    void *image;                        // 整个文件映像：构造得到的为 malloc 的内存，打开得到的为 mmap 的内存
+    size_t image_size;
+    bool mapped;
+} mphf;
+
+// 构造参数，传 NULL 时全部取默认值
+typedef struct {
+    double gamma;               // 0 时取 MPHF_DEFAULT_GAMMA
+    unsigned threads;           // 0 时取 1
+    unsigned fingerprint_bits;  // 0、8、16 或 32
+    uint64_t seed;
+} mphf_config;
+
+/**
+* @brief             构造
+* @param   keys      n 个键，互不相同
+* @param   lens      每个键的字节数
+* @param   values    n 个值按键的顺序排列，每个 value_size 字节；value_size 为 0 时可为 NULL
+* @param   config    构造参数，可为 NULL
+* @return  bool      参数非法、申请内存失败或键有重复时返回 false
+*
+* @note              哈希值重复导致层数超过 MPHF_MAX_LEVELS 时换种子重试，键本身重复时最终失败
+*/
+bool mphf_build(mphf *m, const void *const *keys, const size_t *lens, size_t n, const void *values,
+                size_t value_size, const mphf_config *config);
+
+/**
+* @brief             释放构造或打开的结构
+*
+* @note              Revision History
+*/
+void mphf_free(mphf *m);
+
+/**
+* @brief             把文件映像写到文件
+* @return  bool      写入失败返回 false
+*
+* @note              Revision History
+*/
+bool mphf_save(const mphf *m, const char *path);
+
+/**
+* @brief             只读映射文件，映射后即可查询
+* @return  bool      文件不存在或格式错误返回 false
+*
+* @note              只校验头部与各段长度，不读取位图，打开时间与文件大小无关
+*/
+bool mphf_open(mphf *m, const char *path);
+
+/**
+* @brief             键的索引
+* @return  size_t    [0, count)；键不在集合中时返回 MPHF_NONE，
+*                    没有指纹时不在集合中的键也可能得到某个索引
+*
+* @note              Revision History
+*/
+size_t mphf_index(const mphf *m, const void *key, size_t len);
+
+/**
+* @brief             键对应的值
+* @return  const void* 指向值数组（可能在映射的文件中），键不在集合中返回 NULL
+*
+* @note              Revision History
+*/
+const void *mphf_find(const mphf *m, const void *key, size_t len);
+
+// 索引部分（位图与 rank）的位数除以键数
+double mphf_bits_per_key(const mphf *m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_MPHF_MPHF_H
@@ -0,0 +1,216 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cms.h"
+#include "hashalg.h"
+
+/*
+一、为什么估计值只会偏大
+（1）每个计数器是所有映射到它的键的次数之和，包含目标键的次数，其余键只会使它更大
+（2）取 depth 行的最小值：只要有一行没有别的大键碰撞，估计就接近真实值
+
+二、保守更新
+（1）加入 (x, c) 时，先求 x 当前的估计 m = min(C[i][h_i(x)])，x 的真实次数不超过 m + c
+（2）每行只把计数器提高到 m + c：C[i][h_i(x)] = max(C[i][h_i(x)], m + c)，低于它的才改动，
+    所有计数器仍是各自键集合次数之和的上界，查询结论不变，而多余的累加被去掉了
+（3）对高度倾斜（Zipf）的流，中低频键的误差通常能减小数倍
+
+三、位置计算
+（1）Kirsch-Mitzenmacher：g_i(x) = h1(x) + i * h2(x) 与 depth 个独立哈希函数的误差界相同，只需计算一次哈希
+（2）32 位值乘宽度取高 32 位映射到 [0, width)，代替取模，宽度不必是 2 的幂
+*/
+
+#define CMS_MAGIC "CMS1"
+#define CMS_HEADER_SIZE 32
+// 每行计数器个数的上限，位置由 32 位值乘宽度取高位得到
+#define CMS_MAX_WIDTH ((size_t)UINT32_MAX)
+#define CMS_MAX_DEPTH 32
+
+static inline size_t cms_pos(const cms *s, uint64_t hash, size_t row) {
+    uint32_t h1 = (uint32_t)hash, h2 = (uint32_t)(hash >> 32) | 1;
+    uint32_t g = h1 + (uint32_t)row * h2;
+    return row * s->width + (size_t)(((uint64_t)g * s->width) >> 32);
+}
+
+static inline uint32_t sat_add(uint32_t a, uint32_t b) {
+    return a + (b < ~a ? b : ~a);
+}
+
+bool cms_init(cms *s, size_t width, size_t depth, bool conservative) {
+    memset(s, 0, sizeof(*s));
+    if (width == 0 || width > CMS_MAX_WIDTH || depth == 0 || depth > CMS_MAX_DEPTH) {
+        return false;
+    }
+    s->counters = calloc(width * depth, sizeof(uint32_t));
+    if (!s->counters) {
+        return false;
+    }
+    s->width = width;
+    s->depth = depth;
+    s->conservative = conservative;
+    return true;
+}
+
+bool cms_init_error(cms *s, double epsilon, double delta, bool conservative) {
+    if (!(epsilon > 0 && epsilon < 1 && delta > 0 && delta < 1)) {
+        memset(s, 0, sizeof(*s));
+        return false;
+    }
+    return cms_init(s, (size_t)ceil(exp(1.0) / epsilon), (size_t)ceil(log(1.0 / delta)), conservative);
+}
+
+void cms_free(cms *s) {
+    free(s->counters);
+    memset(s, 0, sizeof(*s));
+}
+
+void cms_clear(cms *s) {
+    memset(s->counters, 0, s->width * s->depth * sizeof(uint32_t));
+    s->total = 0;
+}
+
+uint32_t cms_add(cms *s, uint64_t hash, uint32_t count) {
+    size_t pos[CMS_MAX_DEPTH];
+    for (size_t i = 0; i < s->depth; i++) {
+        pos[i] = cms_pos(s, hash, i);
+        __builtin_prefetch(&s->counters[pos[i]], 1);
+    }
+    s->total += count;
+    uint32_t est = UINT32_MAX;
+    if (s->conservative) {
+        for (size_t i = 0; i < s->depth; i++) {
+            est = s->counters[pos[i]] < est ? s->counters[pos[i]] : est;
+        }
+        est = sat_add(est, count);
+        for (size_t i = 0; i < s->depth; i++) {
+            if (s->counters[pos[i]] < est) {
+                s->counters[pos[i]] = est;
+            }
+        }
+        return est;
+    }
+    for (size_t i = 0; i < s->depth; i++) {
+        uint32_t c = sat_add(s->counters[pos[i]], count);
+        s->counters[pos[i]] = c;
+        est = c < est ? c : est;
+    }
+    return est;
+}
+
+uint32_t cms_estimate(const cms *s, uint64_t hash) {
+    uint32_t est = UINT32_MAX;
+    for (size_t i = 0; i < s->depth; i++) {
+        uint32_t c = s->counters[cms_pos(s, hash, i)];
+        est = c < est ? c : est;
+    }
+    return est;
+}
+
+void cms_halve(cms *s) {
+    for (size_t i = 0; i < s->width * s->depth; i++) {
+        s->counters[i] >>= 1;
+    }
+    s->total >>= 1;
+}
+
+bool cms_merge(cms *dst, const cms *src) {
+    if (dst->width != src->width || dst->depth != src->depth) {
+        return false;
+    }
+    // 形式简单，编译器可以向量化
+    for (size_t i = 0; i < dst->width * dst->depth; i++) {
+        dst->counters[i] = sat_add(dst->counters[i], src->counters[i]);
+    }
+    dst->total += src->total;
+    return true;
+}
+
+size_t cms_serialized_size(const cms *s) {
+    return CMS_HEADER_SIZE + s->width * s->depth * sizeof(uint32_t);
+}
+
+size_t cms_serialize(const cms *s, void *buf, size_t cap) {
+    size_t size = cms_serialized_size(s);
+    if (cap < size) {
+        return 0;
+    }
+    unsigned char *p = buf;
+    memcpy(p, CMS_MAGIC, 4);
+    p[4] = s->conservative;
+    p[5] = p[6] = p[7] = 0;
+    put_u64(p + 8, s->width);
+    put_u64(p + 16, s->depth);
+    put_u64(p + 24, s->total);
+    p += CMS_HEADER_SIZE;
+    for (size_t i = 0; i < s->width * s->depth; i++) {
+        uint32_t c = s->counters[i];
+        p[4 * i] = (unsigned char)c;
+        p[4 * i + 1] = (unsigned char)(c >> 8);
+        p[4 * i + 2] = (unsigned char)(c >> 16);
+        p[4 * i + 3] = (unsigned char)(c >> 24);
+    }
+    return size;
+}
+
+bool cms_deserialize(cms *s, const void *buf, size_t len) {
+    const unsigned char *p = buf;
+    memset(s, 0, sizeof(*s));
+    if (len < CMS_HEADER_SIZE || memcmp(p, CMS_MAGIC, 4) != 0 || p[4] > 1) {
+        return false;
+    }
+    uint64_t width = get_u64(p + 8), depth = get_u64(p + 16);
+    if (width == 0 || width > CMS_MAX_WIDTH || depth == 0 || depth > CMS_MAX_DEPTH ||
+        len != CMS_HEADER_SIZE + width * depth * sizeof(uint32_t) || !cms_init(s, width, depth, p[4])) {
+        return false;
+    }
+    s->total = get_u64(p + 24);
+    p += CMS_HEADER_SIZE;
+    for (size_t i = 0; i < s->width * s->depth; i++) {
+        s->counters[i] = (uint32_t)p[4 * i] | (uint32_t)p[4 * i + 1] << 8 | (uint32_t)p[4 * i + 2] << 16 |
+                         (uint32_t)p[4 * i + 3] << 24;
+    }
+    return true;
+}
+
+#ifdef CMS_MAIN
+int main(void) {
+
+    // 示例1：键 k 出现 1000 / (k + 1) 次的倾斜流，ε = 0.1%
+    cms plain, cu;
+    cms_init_error(&plain, 0.001, 0.01, false);
+    cms_init_error(&cu, 0.001, 0.01, true);
+    char key[32];
+    const size_t keys = 100000;
+    for (size_t k = 0; k < keys; k++) {
+        size_t len = (size_t)snprintf(key, sizeof(key), "page:%zu", k);
+        uint64_t h = xxh3Hash64(key, len, 0);
+        uint32_t times = (uint32_t)(1000 / (k + 1)) + 1;
+        for (uint32_t t = 0; t < times; t++) {
+            cms_add(&plain, h, 1);
+            cms_add(&cu, h, 1);
+        }
+    }
+
+    // 示例2：估计值不小于真实值，统计两种更新方式的平均误差
+    int failed = 0;
+    double err_plain = 0, err_cu = 0;
+    for (size_t k = 0; k < keys; k++) {
+        size_t len = (size_t)snprintf(key, sizeof(key), "page:%zu", k);
+        uint64_t h = xxh3Hash64(key, len, 0);
+        uint32_t truth = (uint32_t)(1000 / (k + 1)) + 1;
+        uint32_t a = cms_estimate(&plain, h), b = cms_estimate(&cu, h);
+        failed |= a < truth || b < truth || b > a;
+        err_plain += a - truth;
+        err_cu += b - truth;
+    }
+    printf("width %zu depth %zu, total %llu, mean overestimate: plain %.2f, conservative %.2f, check %s\n",
+           plain.width, plain.depth, (unsigned long long)plain.total, err_plain / (double)keys,
+           err_cu / (double)keys, failed ? "FAILED" : "ok");
+
+    cms_free(&plain);
+    cms_free(&cu);
+    return failed;
+}
+#endif
@@ -0,0 +1,115 @@
+#ifndef DSA_SKETCH_CMS_H
+#define DSA_SKETCH_CMS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+Count-Min 草图：估计每个键出现的次数
+（1）depth 行、每行 width 个计数器，键在每行各对应一个计数器，加入时累加，查询取 depth 个计数器的最小值
+（2）估计值不会偏小；宽度 e / ε、深度 ln(1/δ) 时，以 1 - δ 的概率偏大不超过 ε * 总次数
+（3）保守更新（conservative update）：只把计数器提高到"最小值 + 增量"，已经偏大的计数器不再增加，
+    误差通常减小数倍，代价是不能处理负增量；两个草图逐计数器相加即可合并（结果仍不会偏小）
+（4）输入为 64 位哈希值，每行的位置由哈希值的两半按 h1 + i * h2 派生；计数器为 32 位，加满后保持最大值
+*/
+
+typedef struct {
+    uint32_t *counters;     // depth * width 个，第 i 行从 counters + i * width 开始
+    size_t width;
+    size_t depth;
+    uint64_t total;         // 全部增量之和
+    bool conservative;
+} cms;
+
+/**
+* @brief             按宽度和深度初始化
+* @param   width     每行计数器个数
+* @param   depth     行数
+* @param   conservative 是否使用保守更新
+* @return  bool      参数非法或申请内存失败返回 false
+*
+* @note              Revision History
+*/
+bool cms_init(cms *s, size_t width, size_t depth, bool conservative);
+
+/**
+* @brief             按误差要求初始化
+* @param   epsilon   允许偏大的比例（相对总次数）
+* @param   delta     超出误差的概率
+* @return  bool      参数非法或申请内存失败返回 false
+*
+* @note              width = ceil(e / epsilon)，depth = ceil(ln(1 / delta))
+*/
+bool cms_init_error(cms *s, double epsilon, double delta, bool conservative);
+
+/**
+* @brief             释放
+*
+* @note              Revision History
+*/
+void cms_free(cms *s);
+
+/**
+* @brief             清零
+*
+* @note              Revision History
+*/
+void cms_clear(cms *s);
+
+/**
+* @brief             累加
+* @param   hash      键的 64 位哈希值
+* @param   count     增量
+* @return  uint32_t  加入后该键的估计值
+*
+* @note              Revision History
+*/
+uint32_t cms_add(cms *s, uint64_t hash, uint32_t count);
+
+// 估计值，不小于实际次数
+uint32_t cms_estimate(const cms *s, uint64_t hash);
+
+/**
+* @brief             衰减：所有计数器与总次数减半
+*
+* @note              用于只关心近期频率的场合（如 W-TinyLFU 的准入），减半后估计值不再保证不偏小
+*/
+void cms_halve(cms *s);
+
+/**
+* @brief             合并，dst 变为两个流之和的草图
+* @return  bool      宽度或深度不同返回 false
+*
+* @note              Revision History
+*/
+bool cms_merge(cms *dst, const cms *src);
+
+// 序列化后的字节数
+size_t cms_serialized_size(const cms *s);
+
+/**
+* @brief             序列化
+* @return  size_t    写入的字节数，缓冲区不够返回 0
+*
+* @note              头部为魔数 "CMS1"、是否保守更新、宽度、深度与总次数，整数均为小端
+*/
+size_t cms_serialize(const cms *s, void *buf, size_t cap);
+
+/**
+* @brief             由序列化数据构造草图
+* @return  bool      数据格式错误或申请内存失败返回 false
+*
+* @note              s 不需要先初始化，成功后需要 cms_free
+*/
+bool cms_deserialize(cms *s, const void *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_SKETCH_CMS_H
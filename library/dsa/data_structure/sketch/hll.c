@@ -0,0 +1,385 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "hll.h"
+
+/*
+一、HyperLogLog 的原理
+（1）均匀哈希值以 k 个 0 开头的概率为 2^-(k+1)，见过的最大前导 0 个数约为 log2(n)，单个值方差太大
+（2）按哈希高 p 位分到 m = 2^p 个寄存器，各自记录最大值，再取调和平均，标准误差 1.04 / sqrt(m)
+（3）原始估计量在基数小于 2.5m 左右时偏差很大，经典做法是切换到线性计数，HLL++ 再加一张经验偏差修正表
+
+二、本实现与 HLL++ 论文的差异
+（1）稀疏模式与 HLL++ 相同：25 位索引相当于 2^25 个寄存器，基数小时线性计数几乎没有误差
+（2）稠密估计用 Ertl（2017）的改进估计量：由寄存器值的直方图直接算出，全量程无偏，不需要 200 多项的偏差表和切换阈值
+（3）寄存器不压缩为 6 位而是每个 1 字节：多用 1/4 的内存，换来单字节读写与 SIMD 合并
+
+三、稀疏记录的换算
+（1）记录 = 哈希高 25 位的索引 idx' 与其余 39 位的前导 0 个数加 1（rho'）
+（2）转为 p 位索引时 idx = idx' 的高 p 位；idx' 的低 25 - p 位不全为 0 时 rho 由这几位决定，
+    否则 rho = 25 - p + rho'，与直接由哈希值计算的结果相同
+*/
+
+#define HLL_MAGIC "HLL1"
+#define HLL_HEADER_SIZE 12
+
+static inline size_t hll_registers(unsigned precision) {
+    return (size_t)1 << precision;
+}
+
+// 哈希值去掉高 bits 位后的前导 0 个数加 1，全为 0 时为 65 - bits
+static inline uint8_t hll_rho(uint64_t hash, unsigned bits) {
+    uint64_t w = (hash << bits) | ((uint64_t)1 << (bits - 1));
+    return (uint8_t)(__builtin_clzll(w) + 1);
+}
+
+static inline uint32_t hll_sparse_encode(uint64_t hash) {
+    uint32_t idx = (uint32_t)(hash >> (64 - HLL_SPARSE_PRECISION));
+    return idx << 6 | hll_rho(hash, HLL_SPARSE_PRECISION);
+}
+
+static inline void hll_sparse_decode(uint32_t rec, unsigned precision, size_t *idx, uint8_t *rho) {
+    const unsigned shift = HLL_SPARSE_PRECISION - precision;
+    uint32_t sidx = rec >> 6;
+    uint32_t low = sidx & ((1U << shift) - 1);
+    *idx = sidx >> shift;
+    *rho = low ? (uint8_t)(__builtin_clz(low) - (32 - shift) + 1) : (uint8_t)(shift + (rec & 63));
+}
+
+bool hll_init(hll *h, unsigned precision) {
+    memset(h, 0, sizeof(*h));
+    if (precision < HLL_MIN_PRECISION || precision > HLL_MAX_PRECISION) {
+        return false;
+    }
+    size_t m = hll_registers(precision);
+    h->registers = malloc(m);
+    // 稀疏区与稠密寄存器同样大小，整理后最多保留一半，另一半存放未整理的新记录
+    h->sparse_capacity = m / sizeof(uint32_t);
+    h->sparse = malloc(h->sparse_capacity * sizeof(uint32_t));
+    if (!h->registers || !h->sparse) {
+        hll_free(h);
+        return false;
+    }
+    h->precision = precision;
+    hll_clear(h);
+    return true;
+}
+
+void hll_free(hll *h) {
+    free(h->registers);
+    free(h->sparse);
+    memset(h, 0, sizeof(*h));
+}
+
+void hll_clear(hll *h) {
+    memset(h->registers, 0, hll_registers(h->precision));
+    h->sparse_count = 0;
+    h->sparse_sorted = 0;
+    h->dense = false;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// 排序后同一索引只保留 rho' 最大的记录（低 6 位最大，排在最后）
+static void hll_compact(hll *h) {
+    if (h->sparse_sorted == h->sparse_count) {
+        return;
+    }
+    qsort(h->sparse, h->sparse_count, sizeof(uint32_t), cmp_u32);
+    size_t out = 0;
+    for (size_t i = 0; i < h->sparse_count; i++) {
+        if (out > 0 && (h->sparse[out - 1] >> 6) == (h->sparse[i] >> 6)) {
+            h->sparse[out - 1] = h->sparse[i];
+        } else {
+            h->sparse[out++] = h->sparse[i];
+        }
+    }
+    h->sparse_count = out;
+    h->sparse_sorted = out;
+}
+
+static void hll_to_dense(hll *h) {
+    for (size_t i = 0; i < h->sparse_count; i++) {
+        size_t idx;
+        uint8_t rho;
+        hll_sparse_decode(h->sparse[i], h->precision, &idx, &rho);
+        if (rho > h->registers[idx]) {
+            h->registers[idx] = rho;
+        }
+    }
+    h->sparse_count = 0;
+    h->sparse_sorted = 0;
+    h->dense = true;
+}
+
+static void hll_sparse_add(hll *h, uint32_t rec) {
+    if (h->sparse_count == h->sparse_capacity) {
+        hll_compact(h);
+        if (h->sparse_count > h->sparse_capacity / 2) {
+            hll_to_dense(h);
+            size_t idx;
+            uint8_t rho;
+            hll_sparse_decode(rec, h->precision, &idx, &rho);
+            if (rho > h->registers[idx]) {
+                h->registers[idx] = rho;
+            }
+            return;
+        }
+    }
+    h->sparse[h->sparse_count++] = rec;
+}
+
+void hll_add(hll *h, uint64_t hash) {
+    if (h->dense) {
+        size_t idx = (size_t)(hash >> (64 - h->precision));
+        uint8_t rho = hll_rho(hash, h->precision);
+        if (rho > h->registers[idx]) {
+            h->registers[idx] = rho;
+        }
+        return;
+    }
+    hll_sparse_add(h, hll_sparse_encode(hash));
+}
+
+// Ertl 估计量的两个修正函数，分别处理值为 0 和值为 q + 1（溢出）的寄存器
+static double hll_sigma(double x) {
+    if (x == 1.0) {
+        return INFINITY;
+    }
+    double y = 1.0, z = x, prev;
+    do {
+        x *= x;
+        prev = z;
+        z += x * y;
+        y += y;
+    } while (z != prev);
+    return z;
+}
+
+static double hll_tau(double x) {
+    if (x == 0.0 || x == 1.0) {
+        return 0.0;
+    }
+    double y = 1.0, z = 1.0 - x, prev;
+    do {
+        x = sqrt(x);
+        prev = z;
+        y *= 0.5;
+        z -= (1.0 - x) * (1.0 - x) * y;
+    } while (z != prev);
+    return z / 3.0;
+}
+
+double hll_estimate(hll *h) {
+    if (!h->dense) {
+        hll_compact(h);
+        const double ms = (double)((size_t)1 << HLL_SPARSE_PRECISION);
+        return ms * log(ms / (ms - (double)h->sparse_count));
+    }
+    const size_t m = hll_registers(h->precision);
+    const unsigned q = 64 - h->precision;
+    size_t hist[66] = {0};
+    for (size_t i = 0; i < m; i++) {
+        hist[h->registers[i]]++;
+    }
+    double md = (double)m;
+    double z = md * hll_tau(1.0 - (double)hist[q + 1] / md);
+    for (unsigned k = q; k >= 1; k--) {
+        z = 0.5 * (z + (double)hist[k]);
+    }
+    z += md * hll_sigma((double)hist[0] / md);
+    return md * md / (2.0 * log(2.0)) / z;
+}
+
+static void hll_max_registers(uint8_t *dst, const uint8_t *src, size_t m) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= m; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(dst + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_max_epu8(a, b));
+    }
+#endif
+    for (; i < m; i++) {
+        dst[i] = dst[i] > src[i] ? dst[i] : src[i];
+    }
+}
+
+bool hll_merge(hll *dst, const hll *src) {
+    if (dst->precision != src->precision) {
+        return false;
+    }
+    if (src->dense) {
+        if (!dst->dense) {
+            hll_to_dense(dst);
+        }
+        hll_max_registers(dst->registers, src->registers, hll_registers(dst->precision));
+        return true;
+    }
+    for (size_t i = 0; i < src->sparse_count; i++) {
+        if (dst->dense) {
+            size_t idx;
+            uint8_t rho;
+            hll_sparse_decode(src->sparse[i], dst->precision, &idx, &rho);
+            if (rho > dst->registers[idx]) {
+                dst->registers[idx] = rho;
+            }
+        } else {
+            hll_sparse_add(dst, src->sparse[i]);
+        }
+    }
+    return true;
+}
+
+static inline void put_u32(unsigned char *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (unsigned char)(v >> (8 * i));
+    }
+}
+
+static inline uint32_t get_u32(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+size_t hll_serialized_size(hll *h) {
+    if (h->dense) {
+        return HLL_HEADER_SIZE + hll_registers(h->precision);
+    }
+    hll_compact(h);
+    return HLL_HEADER_SIZE + h->sparse_count * sizeof(uint32_t);
+}
+
+size_t hll_serialize(hll *h, void *buf, size_t cap) {
+    size_t size = hll_serialized_size(h);
+    if (cap < size) {
+        return 0;
+    }
+    unsigned char *p = buf;
+    memcpy(p, HLL_MAGIC, 4);
+    p[4] = (unsigned char)h->precision;
+    p[5] = h->dense;
+    p[6] = p[7] = 0;
+    put_u32(p + 8, h->dense ? 0 : (uint32_t)h->sparse_count);
+    p += HLL_HEADER_SIZE;
+    if (h->dense) {
+        memcpy(p, h->registers, hll_registers(h->precision));
+    } else {
+        for (size_t i = 0; i < h->sparse_count; i++) {
+            put_u32(p + 4 * i, h->sparse[i]);
+        }
+    }
+    return size;
+}
+
+bool hll_deserialize(hll *h, const void *buf, size_t len) {
+    const unsigned char *p = buf;
+    if (len < HLL_HEADER_SIZE || memcmp(p, HLL_MAGIC, 4) != 0 || p[5] > 1 || !hll_init(h, p[4])) {
+        return false;
+    }
+    const size_t m = hll_registers(h->precision);
+    const uint32_t count = get_u32(p + 8);
+    const uint8_t max_rho = (uint8_t)(65 - h->precision);
+    bool ok;
+    if (p[5]) {
+        ok = len == HLL_HEADER_SIZE + m;
+        for (size_t i = 0; ok && i < m; i++) {
+            ok = p[HLL_HEADER_SIZE + i] <= max_rho;
+        }
+        if (ok) {
+            memcpy(h->registers, p + HLL_HEADER_SIZE, m);
+            h->dense = true;
+        }
+    } else {
+        // 稀疏记录须有序、索引不重复且小于 2^25（转为稠密时按索引写寄存器）、rho' 在 [1, 40] 内
+        ok = count <= h->sparse_capacity / 2 && len == HLL_HEADER_SIZE + (size_t)count * sizeof(uint32_t);
+        for (uint32_t i = 0; ok && i < count; i++) {
+            uint32_t rec = get_u32(p + HLL_HEADER_SIZE + 4 * i);
+            ok = (rec & 63) >= 1 && (rec & 63) <= 64 - HLL_SPARSE_PRECISION + 1 &&
+                 (rec >> 6) < (1u << HLL_SPARSE_PRECISION) && (i == 0 || (rec >> 6) > (h->sparse[i - 1] >> 6));
+            h->sparse[i] = rec;
+        }
+        h->sparse_count = h->sparse_sorted = ok ? count : 0;
+    }
+    if (!ok) {
+        hll_free(h);
+    }
+    return ok;
+}
+
+#ifdef HLL_MAIN
+#include "hashalg.h"
+
+int main(void) {
+
+    // 示例1：统计 100 万个用户 ID 中不同 ID 的个数，每个 ID 出现 3 次
+    hll h;
+    hll_init(&h, 14);
+    char key[32];
+    const size_t n = 1000000;
+    for (size_t r = 0; r < 3; r++) {
+        for (size_t i = 0; i < n; i++) {
+            size_t len = (size_t)snprintf(key, sizeof(key), "user:%zu", i);
+            hll_add(&h, xxh3Hash64(key, len, 0));
+        }
+    }
+    double est = hll_estimate(&h);
+    printf("distinct users: estimate %.0f, error %.3f%%\n", est, 100.0 * (est - (double)n) / (double)n);
+
+    // 示例2：两个线程各统计一半再合并，序列化后还原，估计值不变
+    hll a, b;
+    hll_init(&a, 14);
+    hll_init(&b, 14);
+    for (size_t i = 0; i < n; i++) {
+        size_t len = (size_t)snprintf(key, sizeof(key), "user:%zu", i);
+        hll_add(i % 2 ? &a : &b, xxh3Hash64(key, len, 0));
+    }
+    hll_merge(&a, &b);
+    size_t size = hll_serialized_size(&a);
+    unsigned char *buf = malloc(size);
+    hll_serialize(&a, buf, size);
+    hll c;
+    int failed = !hll_deserialize(&c, buf, size) || hll_estimate(&c) != est;
+
+    // 示例3：小基数时为稀疏模式，几乎精确
+    hll s;
+    hll_init(&s, 14);
+    for (size_t i = 0; i < 1000; i++) {
+        size_t len = (size_t)snprintf(key, sizeof(key), "item:%zu", i);
+        hll_add(&s, xxh3Hash64(key, len, 0));
+    }
+    // 示例4：损坏的序列化数据被拒绝：稀疏记录的索引超出 2^25、rho' 为 0、长度与记录数不符
+    size_t sparse_size = hll_serialized_size(&s);
+    unsigned char *sparse_buf = malloc(sparse_size);
+    hll_serialize(&s, sparse_buf, sparse_size);
+    hll bad;
+    failed |= s.dense || !hll_deserialize(&bad, sparse_buf, sparse_size);
+    hll_free(&bad);
+    unsigned char *last = sparse_buf + sparse_size - 4;
+    put_u32(last, 0xFFFFFFC1u);
+    failed |= hll_deserialize(&bad, sparse_buf, sparse_size);
+    put_u32(last, get_u32(last) & ~63u);
+    failed |= hll_deserialize(&bad, sparse_buf, sparse_size);
+    failed |= hll_deserialize(&bad, sparse_buf, sparse_size - 4);
+    free(sparse_buf);
+
+    printf("merged %.0f, serialized %zu bytes, small set %.1f (%s), check %s\n", hll_estimate(&c), size,
+           hll_estimate(&s), s.dense ? "dense" : "sparse", failed ? "FAILED" : "ok");
+
+    free(buf);
+    hll_free(&h);
+    hll_free(&a);
+    hll_free(&b);
+    hll_free(&c);
+    hll_free(&s);
+    return failed;
+}
+#endif
@@ -0,0 +1,267 @@
+// 流式统计草图测试：HyperLogLog++、Count-Min、Space-Saving
+// （1）HLL：不同基数下的相对误差（多个种子取均方根），与理论值 1.04 / sqrt(2^p) 对照；加入速度；稀疏/稠密的序列化大小
+// （2）Zipf(1.0) 流上 Count-Min 普通更新与保守更新的平均偏大量，Space-Saving 前 100 个键的召回率，与精确计数对照
+// （3）多线程各自统计一段流再合并，合并结果与单线程统计相同（HLL、Count-Min 逐字节相同）
+// 用法：./sketch_bench [流长度] [线程数]，默认 10M、4 线程
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cms.h"
+#include "hashalg.h"
+#include "hasht.h"
+#include "hll.h"
+#include "spacesaving.h"
+
+#define UNIVERSE 1000000
+#define TOPK     100
+
+static inline double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static inline uint64_t key_hash(uint64_t key) {
+    return xxh3Hash64(&key, sizeof(key), 0);
+}
+
+static void hll_accuracy(void) {
+    const unsigned p = 14;
+    const int trials = 20;
+    printf("HLL p=%u, theoretical error %.3f%%\n", p, 104.0 / sqrt((double)(1u << p)));
+    printf("%12s %10s %10s %8s %12s\n", "cardinality", "rms err", "max err", "mode", "bytes");
+    static const size_t cards[] = {100, 1000, 5000, 20000, 100000, 1000000, 10000000};
+    uint64_t seed = 1;
+    for (size_t c = 0; c < sizeof(cards) / sizeof(cards[0]); c++) {
+        int reps = cards[c] >= 10000000 ? 3 : trials;
+        double sq = 0, worst = 0;
+        hll h;
+        hll_init(&h, p);
+        for (int t = 0; t < reps; t++) {
+            hll_clear(&h);
+            for (size_t i = 0; i < cards[c]; i++) {
+                hll_add(&h, splitmix64(&seed));
+            }
+            double err = (hll_estimate(&h) - (double)cards[c]) / (double)cards[c];
+            sq += err * err;
+            worst = fabs(err) > worst ? fabs(err) : worst;
+        }
+        printf("%12zu %9.3f%% %9.3f%% %8s %12zu\n", cards[c], 100 * sqrt(sq / reps), 100 * worst,
+               h.dense ? "dense" : "sparse", hll_serialized_size(&h));
+        hll_free(&h);
+    }
+}
+
+// Zipf(1.0)：按累积分布二分查找
+static uint32_t *zipf_stream(size_t n) {
+    double *cdf = malloc(UNIVERSE * sizeof(double));
+    double sum = 0;
+    for (size_t k = 0; k < UNIVERSE; k++) {
+        sum += 1.0 / (double)(k + 1);
+        cdf[k] = sum;
+    }
+    uint32_t *stream = malloc(n * sizeof(uint32_t));
+    uint64_t state = 42;
+    for (size_t i = 0; i < n; i++) {
+        double u = (double)(splitmix64(&state) >> 11) / 9007199254740992.0 * sum;
+        size_t lo = 0, hi = UNIVERSE - 1;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (cdf[mid] < u) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        // 键编号打乱，避免热键集中在小编号
+        stream[i] = (uint32_t)((lo * 2654435761u) % UNIVERSE);
+    }
+    free(cdf);
+    return stream;
+}
+
+typedef struct {
+    const uint32_t *stream;
+    size_t begin, end;
+    hll h;
+    cms plain, cu;
+    spacesaving ss;
+    double seconds[4];      // 四种草图各自的耗时
+} worker;
+
+static void worker_init(worker *w) {
+    hll_init(&w->h, 14);
+    cms_init_error(&w->plain, 0.0001, 0.01, false);
+    cms_init_error(&w->cu, 0.0001, 0.01, true);
+    spacesaving_init(&w->ss, 10 * TOPK);
+}
+
+static void worker_free(worker *w) {
+    hll_free(&w->h);
+    cms_free(&w->plain);
+    cms_free(&w->cu);
+    spacesaving_free(&w->ss);
+}
+
+// 四种草图依次各扫一遍，分别计时；哈希计算计入每一种
+static void *worker_run(void *arg) {
+    worker *w = arg;
+    double start = now_sec();
+    for (size_t i = w->begin; i < w->end; i++) {
+        hll_add(&w->h, key_hash(w->stream[i]));
+    }
+    w->seconds[0] = now_sec() - start;
+    start = now_sec();
+    for (size_t i = w->begin; i < w->end; i++) {
+        cms_add(&w->plain, key_hash(w->stream[i]), 1);
+    }
+    w->seconds[1] = now_sec() - start;
+    start = now_sec();
+    for (size_t i = w->begin; i < w->end; i++) {
+        cms_add(&w->cu, key_hash(w->stream[i]), 1);
+    }
+    w->seconds[2] = now_sec() - start;
+    start = now_sec();
+    for (size_t i = w->begin; i < w->end; i++) {
+        spacesaving_add(&w->ss, w->stream[i], 1);
+    }
+    w->seconds[3] = now_sec() - start;
+    return NULL;
+}
+
+// 高 32 位为次数、低 32 位为键，降序
+static int cmp_u64_desc(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x < y) - (x > y);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+    unsigned threads = argc > 2 ? (unsigned)atoi(argv[2]) : 4;
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    hll_accuracy();
+
+    // 单个草图的加入速度
+    hll h;
+    hll_init(&h, 14);
+    uint64_t seed = 3;
+    double start = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        hll_add(&h, splitmix64(&seed));
+    }
+    printf("hll_add: %.1f M/s\n\n", (double)n / (now_sec() - start) / 1e6);
+    hll_free(&h);
+
+    // 精确计数
+    uint32_t *stream = zipf_stream(n);
+    uint32_t *exact = calloc(UNIVERSE, sizeof(uint32_t));
+    size_t distinct = 0;
+    for (size_t i = 0; i < n; i++) {
+        distinct += exact[stream[i]]++ == 0;
+    }
+
+    // 单线程与多线程
+    worker single = {.stream = stream, .begin = 0, .end = n};
+    worker_init(&single);
+    worker_run(&single);
+    worker *ws = calloc(threads, sizeof(worker));
+    pthread_t *tids = malloc(threads * sizeof(pthread_t));
+    start = now_sec();
+    for (unsigned t = 0; t < threads; t++) {
+        ws[t] = (worker){.stream = stream, .begin = n * t / threads, .end = n * (t + 1) / threads};
+        worker_init(&ws[t]);
+        pthread_create(&tids[t], NULL, worker_run, &ws[t]);
+    }
+    for (unsigned t = 0; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+    }
+    double ingest = now_sec() - start;
+    start = now_sec();
+    for (unsigned t = 1; t < threads; t++) {
+        hll_merge(&ws[0].h, &ws[t].h);
+        cms_merge(&ws[0].plain, &ws[t].plain);
+        cms_merge(&ws[0].cu, &ws[t].cu);
+        spacesaving_merge(&ws[0].ss, &ws[t].ss);
+    }
+    double merge = now_sec() - start;
+    printf("Zipf(1.0) stream: %zu items, %zu distinct keys\n", n, distinct);
+    printf("1 thread M/s: hll %.1f, cms plain %.1f, cms conservative %.1f, space-saving %.1f\n",
+           (double)n / single.seconds[0] / 1e6, (double)n / single.seconds[1] / 1e6,
+           (double)n / single.seconds[2] / 1e6, (double)n / single.seconds[3] / 1e6);
+    printf("%u threads, all four sketches: %.1f M/s, merge %.2f ms\n", threads, (double)n / ingest / 1e6,
+           merge * 1e3);
+
+    int failed = 0;
+    double hll_est = hll_estimate(&ws[0].h);
+    failed |= hll_est != hll_estimate(&single.h);
+    failed |= memcmp(ws[0].plain.counters, single.plain.counters,
+                     single.plain.width * single.plain.depth * sizeof(uint32_t)) != 0;
+    printf("hll: estimate %.0f, error %.3f%%, merged == single %s\n", hll_est,
+           100.0 * (hll_est - (double)distinct) / (double)distinct, failed ? "no" : "yes");
+
+    // Count-Min：所有出现过的键的平均偏大量，以及偏大超过 ε * N 的键的比例（应低于 δ = 1%）；保守更新的合并结果只是上界，不要求与单线程相同
+    cms *sketches[3] = {&single.plain, &single.cu, &ws[0].cu};
+    const char *names[3] = {"cms plain", "cms conservative", "cms conservative merged"};
+    for (int s = 0; s < 3; s++) {
+        double sum = 0;
+        double bound = (double)n * exp(1.0) / (double)sketches[s]->width;
+        size_t over = 0;
+        for (uint32_t k = 0; k < UNIVERSE; k++) {
+            if (!exact[k]) {
+                continue;
+            }
+            uint32_t est = cms_estimate(sketches[s], key_hash(k));
+            failed |= est < exact[k];
+            sum += est - exact[k];
+            over += est - exact[k] > bound;
+        }
+        printf("%-24s width %zu depth %zu: mean overestimate %.2f, over eps * N (%.0f) %.3f%%\n", names[s],
+               sketches[s]->width, sketches[s]->depth, sum / (double)distinct, bound,
+               100.0 * (double)over / (double)distinct);
+    }
+
+    // Space-Saving：与精确的前 100 个键比较
+    uint64_t *order = malloc(UNIVERSE * sizeof(uint64_t));
+    for (uint32_t k = 0; k < UNIVERSE; k++) {
+        order[k] = (uint64_t)exact[k] << 32 | k;
+    }
+    qsort(order, UNIVERSE, sizeof(uint64_t), cmp_u64_desc);
+    spacesaving *ssk[2] = {&single.ss, &ws[0].ss};
+    for (int s = 0; s < 2; s++) {
+        spacesaving_item top[TOPK];
+        size_t got = spacesaving_topk(ssk[s], top, TOPK);
+        hasht truth;
+        hasht_init(&truth, sizeof(uint64_t), 0, hasht_hash_xxh3, 0);
+        for (size_t i = 0; i < TOPK; i++) {
+            uint64_t k = (uint32_t)order[i];
+            hasht_insert(&truth, &k, NULL);
+        }
+        size_t hit = 0;
+        for (size_t i = 0; i < got; i++) {
+            hit += hasht_find(&truth, &top[i].key) != NULL;
+            failed |= top[i].count < exact[top[i].key];
+        }
+        printf("space-saving %-6s capacity %zu: top-%d recall %.1f%%\n", s ? "merged" : "single", ssk[s]->capacity,
+               TOPK, 100.0 * (double)hit / TOPK);
+        hasht_free(&truth);
+    }
+    printf("check %s\n", failed ? "FAILED" : "ok");
+
+    worker_free(&single);
+    for (unsigned t = 0; t < threads; t++) {
+        worker_free(&ws[t]);
+    }
+    free(ws);
+    free(tids);
+    free(order);
+    free(exact);
+    free(stream);
+    return failed;
+}
@@ -0,0 +1,319 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hashalg.h"
+#include "spacesaving.h"
+
+/*
+一、Space-Saving（Metwally 等，2005）
+（1）监视 m 个键：已监视的键计数加 c；未监视且未满时加入；已满时把计数最小的键 (y, c_min) 换成 (x, c_min + c)，误差记 c_min
+（2）任一时刻 m 个计数之和等于总次数 N，所以最小计数不超过 N / m，被替换掉的键真实次数不超过它，
+    于是真实次数超过 N / m 的键不会被换出；被监视键的计数偏大不超过进入时继承的最小计数
+（3）原论文用 Stream-Summary 链表做到每次 O(1)，但只支持单位增量；这里用最小堆，支持任意增量，每次 O(log m)
+
+二、合并（Agarwal 等，Mergeable Summaries）
+（1）一方没有监视某个键，只能知道它在该方的真实次数不超过该方的最小计数（未满时为 0），按这个上界补上
+（2）合并后每个键的计数仍是真实次数的上界，保留计数最大的 m 个；多线程各自统计一段流，最后合并
+*/
+
+#define SPS_MAGIC "SPS1"
+#define SPS_HEADER_SIZE 32
+
+static inline uint64_t item_count(const spacesaving *s, size_t heap_index) {
+    return s->items[s->heap[heap_index]].count;
+}
+
+static inline void heap_swap(spacesaving *s, size_t i, size_t j) {
+    uint32_t a = s->heap[i], b = s->heap[j];
+    s->heap[i] = b;
+    s->heap[j] = a;
+    s->heap_pos[b] = (uint32_t)i;
+    s->heap_pos[a] = (uint32_t)j;
+}
+
+// 计数只会增加，只需要下沉
+static void heap_down(spacesaving *s, size_t i) {
+    for (;;) {
+        size_t l = 2 * i + 1, smallest = i;
+        if (l < s->size && item_count(s, l) < item_count(s, smallest)) {
+            smallest = l;
+        }
+        if (l + 1 < s->size && item_count(s, l + 1) < item_count(s, smallest)) {
+            smallest = l + 1;
+        }
+        if (smallest == i) {
+            return;
+        }
+        heap_swap(s, i, smallest);
+        i = smallest;
+    }
+}
+
+static void heap_up(spacesaving *s, size_t i) {
+    while (i > 0 && item_count(s, (i - 1) / 2) > item_count(s, i)) {
+        heap_swap(s, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+bool spacesaving_init(spacesaving *s, size_t capacity) {
+    memset(s, 0, sizeof(*s));
+    if (capacity == 0 || capacity > UINT32_MAX) {
+        return false;
+    }
+    s->items = malloc(capacity * sizeof(spacesaving_item));
+    s->heap = malloc(capacity * sizeof(uint32_t));
+    s->heap_pos = malloc(capacity * sizeof(uint32_t));
+    // 预留两倍空间：键数不超过容量加一，不会扩容；但替换键留下的墓碑过多时索引按原容量重建，
+    // 重建时临时申请同样大小的一份内存
+    if (!s->items || !s->heap || !s->heap_pos ||
+        !hasht_init(&s->index, sizeof(uint64_t), sizeof(uint32_t), hasht_hash_xxh3, 0) ||
+        !hasht_reserve(&s->index, 2 * capacity)) {
+        spacesaving_free(s);
+        return false;
+    }
+    s->capacity = capacity;
+    return true;
+}
+
+void spacesaving_free(spacesaving *s) {
+    free(s->items);
+    free(s->heap);
+    free(s->heap_pos);
+    hasht_free(&s->index);
+    memset(s, 0, sizeof(*s));
+}
+
+void spacesaving_clear(spacesaving *s) {
+    // 清空后没有墓碑，且已预留两倍容量，插入不会重建索引
+    hasht_clear(&s->index);
+    s->size = 0;
+    s->total = 0;
+}
+
+bool spacesaving_add(spacesaving *s, uint64_t key, uint64_t count) {
+    uint64_t hash = hasht_hash_key(&s->index, &key);
+    uint32_t *slot = hasht_find_hash(&s->index, &key, hash);
+    if (slot) {
+        s->total += count;
+        s->items[*slot].count += count;
+        heap_down(s, s->heap_pos[*slot]);
+        return true;
+    }
+    // 先插入索引：墓碑过多时索引要重建，申请内存失败则草图不变
+    uint32_t id = s->size < s->capacity ? (uint32_t)s->size : s->heap[0];
+    if (!hasht_insert_hash(&s->index, &key, &id, hash)) {
+        return false;
+    }
+    s->total += count;
+    if (s->size < s->capacity) {
+        s->size++;
+        s->items[id] = (spacesaving_item){key, count, 0};
+        s->heap[id] = id;
+        s->heap_pos[id] = id;
+        heap_up(s, id);
+        return true;
+    }
+    // 替换计数最小的键，新键继承其计数
+    spacesaving_item *item = &s->items[id];
+    hasht_erase(&s->index, &item->key);
+    item->key = key;
+    item->error = item->count;
+    item->count += count;
+    heap_down(s, 0);
+    return true;
+}
+
+uint64_t spacesaving_estimate(const spacesaving *s, uint64_t key, uint64_t *error) {
+    const uint32_t *slot = hasht_find(&s->index, &key);
+    uint64_t min = s->size == s->capacity ? item_count(s, 0) : 0;
+    if (error) {
+        *error = slot ? s->items[*slot].error : min;
+    }
+    return slot ? s->items[*slot].count : min;
+}
+
+static int cmp_item_desc(const void *a, const void *b) {
+    const spacesaving_item *x = a, *y = b;
+    if (x->count != y->count) {
+        return x->count < y->count ? 1 : -1;
+    }
+    return (x->key > y->key) - (x->key < y->key);
+}
+
+size_t spacesaving_topk(const spacesaving *s, spacesaving_item *out, size_t k) {
+    spacesaving_item *all = malloc((s->size ? s->size : 1) * sizeof(spacesaving_item));
+    if (!all) {
+        return 0;
+    }
+    memcpy(all, s->items, s->size * sizeof(spacesaving_item));
+    qsort(all, s->size, sizeof(spacesaving_item), cmp_item_desc);
+    size_t n = k < s->size ? k : s->size;
+    memcpy(out, all, n * sizeof(spacesaving_item));
+    free(all);
+    return n;
+}
+
+// 用 items 中已按计数从大到小排好的前 n 个键重建
+static void rebuild(spacesaving *s, const spacesaving_item *items, size_t n) {
+    hasht_clear(&s->index);
+    s->size = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t id = (uint32_t)i;
+        s->items[id] = items[i];
+        hasht_insert(&s->index, &items[i].key, &id);
+    }
+    s->size = n;
+    // 计数从大到小，倒序放入堆即满足最小堆性质
+    for (size_t i = 0; i < n; i++) {
+        s->heap[i] = (uint32_t)(n - 1 - i);
+        s->heap_pos[n - 1 - i] = (uint32_t)i;
+    }
+}
+
+bool spacesaving_merge(spacesaving *dst, const spacesaving *src) {
+    uint64_t dst_min = dst->size == dst->capacity ? item_count(dst, 0) : 0;
+    uint64_t src_min = src->size == src->capacity ? item_count(src, 0) : 0;
+    spacesaving_item *all = malloc((dst->size + src->size + 1) * sizeof(spacesaving_item));
+    if (!all) {
+        return false;
+    }
+    size_t n = 0;
+    for (size_t i = 0; i < dst->size; i++) {
+        spacesaving_item it = dst->items[i];
+        const uint32_t *slot = hasht_find(&src->index, &it.key);
+        it.count += slot ? src->items[*slot].count : src_min;
+        it.error += slot ? src->items[*slot].error : src_min;
+        all[n++] = it;
+    }
+    for (size_t i = 0; i < src->size; i++) {
+        spacesaving_item it = src->items[i];
+        if (hasht_find(&dst->index, &it.key)) {
+            continue;
+        }
+        it.count += dst_min;
+        it.error += dst_min;
+        all[n++] = it;
+    }
+    qsort(all, n, sizeof(spacesaving_item), cmp_item_desc);
+    rebuild(dst, all, n < dst->capacity ? n : dst->capacity);
+    dst->total += src->total;
+    free(all);
+    return true;
+}
+
+size_t spacesaving_serialized_size(const spacesaving *s) {
+    return SPS_HEADER_SIZE + s->size * 3 * sizeof(uint64_t);
+}
+
+// 键按计数从大到小写出，还原时直接重建堆
+size_t spacesaving_serialize(const spacesaving *s, void *buf, size_t cap) {
+    size_t size = spacesaving_serialized_size(s);
+    spacesaving_item *all = malloc((s->size ? s->size : 1) * sizeof(spacesaving_item));
+    if (cap < size || !all) {
+        free(all);
+        return 0;
+    }
+    size_t n = spacesaving_topk(s, all, s->size);
+    unsigned char *p = buf;
+    memcpy(p, SPS_MAGIC, 4);
+    memset(p + 4, 0, 4);
+    put_u64(p + 8, s->capacity);
+    put_u64(p + 16, n);
+    put_u64(p + 24, s->total);
+    p += SPS_HEADER_SIZE;
+    for (size_t i = 0; i < n; i++, p += 24) {
+        put_u64(p, all[i].key);
+        put_u64(p + 8, all[i].count);
+        put_u64(p + 16, all[i].error);
+    }
+    free(all);
+    return size;
+}
+
+bool spacesaving_deserialize(spacesaving *s, const void *buf, size_t len) {
+    const unsigned char *p = buf;
+    memset(s, 0, sizeof(*s));
+    if (len < SPS_HEADER_SIZE || memcmp(p, SPS_MAGIC, 4) != 0) {
+        return false;
+    }
+    uint64_t capacity = get_u64(p + 8), n = get_u64(p + 16);
+    if (n > capacity || len != SPS_HEADER_SIZE + n * 24 || !spacesaving_init(s, capacity)) {
+        return false;
+    }
+    spacesaving_item *all = malloc((n ? n : 1) * sizeof(spacesaving_item));
+    bool ok = all != NULL;
+    p += SPS_HEADER_SIZE;
+    for (size_t i = 0; ok && i < n; i++, p += 24) {
+        all[i] = (spacesaving_item){get_u64(p), get_u64(p + 8), get_u64(p + 16)};
+        // 须按计数从大到小、键不重复
+        ok = all[i].error <= all[i].count && (i == 0 || all[i].count <= all[i - 1].count);
+    }
+    if (ok) {
+        rebuild(s, all, n);
+        ok = hasht_size(&s->index) == n;
+        s->total = get_u64((const unsigned char *)buf + 24);
+    }
+    free(all);
+    if (!ok) {
+        spacesaving_free(s);
+    }
+    return ok;
+}
+
+#ifdef SPACESAVING_MAIN
+int main(void) {
+    int failed = 0;
+
+    // 示例1：100 万次访问，键的分布为 P(键 >= k) ≈ 1 / k 的长尾，监视 100 个键，找出前 10
+    spacesaving s;
+    spacesaving_init(&s, 100);
+    const uint64_t total = 1000000;
+    uint64_t state = 7;
+    for (uint64_t i = 0; i < total; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        double u = (double)(state >> 11) / 9007199254740992.0;
+        failed |= !spacesaving_add(&s, (uint64_t)(1.0 / (1.0 - u)), 1);
+    }
+    spacesaving_item top[10];
+    size_t n = spacesaving_topk(&s, top, 10);
+    printf("top keys:");
+    for (size_t i = 0; i < n; i++) {
+        printf(" %llu(%llu±%llu)", (unsigned long long)top[i].key, (unsigned long long)top[i].count,
+               (unsigned long long)top[i].error);
+    }
+    printf("\n");
+
+    // 示例2：两半分别统计后合并，与一次统计的前 10 个键相同；序列化后还原
+    spacesaving a, b;
+    spacesaving_init(&a, 100);
+    spacesaving_init(&b, 100);
+    state = 7;
+    for (uint64_t i = 0; i < total; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        double u = (double)(state >> 11) / 9007199254740992.0;
+        failed |= !spacesaving_add(i % 2 ? &a : &b, (uint64_t)(1.0 / (1.0 - u)), 1);
+    }
+    spacesaving_merge(&a, &b);
+    size_t size = spacesaving_serialized_size(&a);
+    unsigned char *buf = malloc(size);
+    spacesaving_serialize(&a, buf, size);
+    spacesaving c;
+    failed |= !spacesaving_deserialize(&c, buf, size);
+    spacesaving_item merged[10];
+    failed |= spacesaving_topk(&c, merged, 10) != n;
+    for (size_t i = 0; !failed && i < n; i++) {
+        failed |= merged[i].key != top[i].key;
+    }
+    printf("merged top-10 %s, serialized %zu bytes, check %s\n", failed ? "differs" : "matches", size,
+           failed ? "FAILED" : "ok");
+
+    free(buf);
+    spacesaving_free(&s);
+    spacesaving_free(&a);
+    spacesaving_free(&b);
+    spacesaving_free(&c);
+    return failed;
+}
+#endif
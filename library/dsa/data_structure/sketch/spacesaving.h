@@ -0,0 +1,123 @@
+#ifndef DSA_SKETCH_SPACESAVING_H
+#define DSA_SKETCH_SPACESAVING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hasht.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+Space-Saving 频繁项（top-K）统计
+（1）最多监视 capacity 个键，新键到来且已满时替换计数最小的键，新键继承其计数并记为误差
+（2）每个被监视键的计数不小于真实次数，且偏大不超过 error；出现次数超过 总次数 / capacity 的键一定在监视中
+（3）计数最小的键用最小堆维护，键到槽位的映射用 hasht，每次更新 O(log capacity)
+（4）键为 64 位整数（编号或字符串的 64 位哈希值），字符串需要由调用者另存一份哈希值到字符串的映射
+（5）两个草图可以合并（Agarwal 等的可合并摘要），合并后的计数仍不小于真实次数
+*/
+
+typedef struct {
+    uint64_t key;
+    uint64_t count;     // 计数，不小于真实次数
+    uint64_t error;     // 计数可能偏大的上限，count - error 不大于真实次数
+} spacesaving_item;
+
+typedef struct {
+    spacesaving_item *items;    // capacity 个槽位
+    uint32_t *heap;             // 槽位编号的最小堆，按计数排序
+    uint32_t *heap_pos;         // 槽位在堆中的位置
+    hasht index;                // 键 -> 槽位编号
+    size_t capacity;
+    size_t size;
+    uint64_t total;             // 全部增量之和
+} spacesaving;
+
+/**
+* @brief             初始化
+* @param   capacity  监视的键数，通常取所需 K 的数倍
+* @return  bool      参数非法或申请内存失败返回 false
+*
+* @note              槽位与堆在初始化时一次分配，大小固定；键的索引预留两倍容量不会扩容，
+*                    但替换键留下的墓碑过多时按原容量重建，此时临时多占一份索引的内存
+*/
+bool spacesaving_init(spacesaving *s, size_t capacity);
+
+/**
+* @brief             释放
+*
+* @note              Revision History
+*/
+void spacesaving_free(spacesaving *s);
+
+/**
+* @brief             清空
+*
+* @note              Revision History
+*/
+void spacesaving_clear(spacesaving *s);
+
+/**
+* @brief             累加
+* @param   key       键
+* @param   count     增量，大于 0
+* @return  bool      新键插入索引时重建索引失败返回 false，草图不变
+*
+* @note              Revision History
+*/
+bool spacesaving_add(spacesaving *s, uint64_t key, uint64_t count);
+
+/**
+* @brief             估计一个键的次数
+* @param   error     输出可能偏大的上限，可为 NULL
+* @return  uint64_t  计数上界；键不在监视中时为当前最小计数（未满时为 0）
+*
+* @note              Revision History
+*/
+uint64_t spacesaving_estimate(const spacesaving *s, uint64_t key, uint64_t *error);
+
+/**
+* @brief             计数最大的 k 个键
+* @param   out       输出，按计数从大到小
+* @param   k         最多输出的个数
+* @return  size_t    输出的个数
+*
+* @note              Revision History
+*/
+size_t spacesaving_topk(const spacesaving *s, spacesaving_item *out, size_t k);
+
+/**
+* @brief             合并，dst 变为两个流之和的摘要
+* @return  bool      申请内存失败返回 false，dst 不变
+*
+* @note              一方未监视的键按该方的最小计数补上（计数与误差都加），再保留计数最大的 capacity 个
+*/
+bool spacesaving_merge(spacesaving *dst, const spacesaving *src);
+
+// 序列化后的字节数
+size_t spacesaving_serialized_size(const spacesaving *s);
+
+/**
+* @brief             序列化
+* @return  size_t    写入的字节数，缓冲区不够返回 0
+*
+* @note              头部为魔数 "SPS1"、容量、键数与总次数，整数均为小端
+*/
+size_t spacesaving_serialize(const spacesaving *s, void *buf, size_t cap);
+
+/**
+* @brief             由序列化数据构造
+* @return  bool      数据格式错误或申请内存失败返回 false
+*
+* @note              s 不需要先初始化，成功后需要 spacesaving_free
+*/
+bool spacesaving_deserialize(spacesaving *s, const void *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !DSA_SKETCH_SPACESAVING_H
@@ -3,14 +3,20 @@
 
 #include "ast.h"
 #include "logfmt.h"
+#include "profile.h"
 
 ast_node *ast_create_number(double value) {
   log_info("AST 创建数值节点：%f", value);
   // 创建 数值类型节点
   ast_node *an = malloc(sizeof(ast_node));
+  PROF_COUNT(PROF_CNT_NODES);
+  PROF_COUNT(PROF_CNT_MALLOCS);
   an->op = OP_NUM;
   an->number = value;
   an->func_name = NULL;
+  an->func = NULL;
+  an->agg = NULL;
+  an->agg_state = NULL;
   an->left = NULL;
   an->right = NULL;
   an->args = NULL;
@@ -24,9 +30,14 @@ ast_node *ast_create_unary(oper_type type, ast_node *left) {
   log_info("AST 创建一元操作符节点：%d, %d", type, left->op);
   // 创建 一元操作节点
   ast_node *an = malloc(sizeof(ast_node));
+  PROF_COUNT(PROF_CNT_NODES);
+  PROF_COUNT(PROF_CNT_MALLOCS);
   an->op = type;
   an->number = 0;
   an->func_name = NULL;
+  an->func = NULL;
+  an->agg = NULL;
+  an->agg_state = NULL;
   an->left = left;
   an->right = NULL;
   an->args = NULL;
@@ -40,9 +51,14 @@ ast_node *ast_create_binary(oper_type type, ast_node *left, ast_node *right) {
   log_info("AST 创建二元操作符节点：%d, %d, %d", type, left->op, right->op);
   // 创建 二元操作节点
   ast_node *an = malloc(sizeof(ast_node));
+  PROF_COUNT(PROF_CNT_NODES);
+  PROF_COUNT(PROF_CNT_MALLOCS);
   an->op = type;
   an->number = 0;
   an->func_name = NULL;
+  an->func = NULL;
+  an->agg = NULL;
+  an->agg_state = NULL;
   an->left = left;
   an->right = right;
   an->args = NULL;
@@ -52,13 +68,24 @@ ast_node *ast_create_binary(oper_type type, ast_node *left, ast_node *right) {
   return an;
 }
 
-ast_node *ast_create_function(char *func_name, ast_node **args, int count) {
+ast_node *ast_create_function(const char *func_name, ast_node **args, int count) {
   log_info("AST 创建函数节点：%s, %d", func_name, count);
   // 创建 函数操作节点
   ast_node *an = malloc(sizeof(ast_node));
+  PROF_COUNT(PROF_CNT_NODES);
+  PROF_COUNT(PROF_CNT_MALLOCS);
   an->op = OP_FUNC;
   an->number = 0;
-  an->func_name = strdup(func_name);
+  // 解析时绑定函数表条目，求值时直接调用
+  an->func = calc_function_find(func_name, count);
+  if (!an->func) {
+    log_fatal("未知的函数匹配失败：%s/%d", func_name, count);
+    exit(1);
+  }
+  // 函数名指向函数表中的名字，函数表中每个名字只存一份，节点不再复制
+  an->func_name = an->func->name;
+  an->agg = NULL;
+  an->agg_state = NULL;
   an->left = NULL;
   an->right = NULL;
   an->args = args;
@@ -72,9 +99,14 @@ ast_node *ast_create_args(ast_node *expr) {
   log_info("AST 创建函数参数节点，子节点操作符为：%d", expr->op);
   // 创建 expr 表达式节点
   ast_node *an = malloc(sizeof(ast_node));
+  PROF_COUNT(PROF_CNT_NODES);
+  PROF_COUNT(PROF_CNT_MALLOCS);
   an->op = OP_EXPR_GROUP;
   an->number = 0;
   an->func_name = NULL;
+  an->func = NULL;
+  an->agg = NULL;
+  an->agg_state = NULL;
   an->left = expr;
   an->right = NULL;
   an->args = NULL;
@@ -84,6 +116,55 @@ ast_node *ast_create_args(ast_node *expr) {
   return an;
 }
 
+ast_node *ast_create_variable(void) {
+  log_info("AST 创建列变量节点：%s", CALC_COLUMN_VAR);
+  // 创建 列变量节点
+  ast_node *an = malloc(sizeof(ast_node));
+  PROF_COUNT(PROF_CNT_NODES);
+  PROF_COUNT(PROF_CNT_MALLOCS);
+  an->op = OP_VAR;
+  an->number = 0;
+  an->func_name = NULL;
+  an->func = NULL;
+  an->agg = NULL;
+  an->agg_state = NULL;
+  an->left = NULL;
+  an->right = NULL;
+  an->args = NULL;
+  an->args_count = 0;
+  an->parent = NULL;
+
+  return an;
+}
+
+ast_node *ast_create_aggregate(const char *func_name, ast_node **args, int count) {
+  log_info("AST 创建聚合函数节点：%s, %d", func_name, count);
+  const calc_aggregate *agg = calc_aggregate_find(func_name);
+  // quantile 的第一个参数是分位点，不计入数据
+  int min_count = agg->kind == AGG_QUANTILE ? 2 : 1;
+  if (count < min_count) {
+    log_fatal("聚合函数缺少参数：%s/%d", func_name, count);
+    exit(1);
+  }
+  // 创建 聚合函数节点
+  ast_node *an = malloc(sizeof(ast_node));
+  PROF_COUNT(PROF_CNT_NODES);
+  PROF_COUNT(PROF_CNT_MALLOCS);
+  an->op = OP_AGGREGATE;
+  an->number = 0;
+  an->func_name = agg->name;
+  an->func = NULL;
+  an->agg = agg;
+  an->agg_state = NULL;
+  an->left = NULL;
+  an->right = NULL;
+  an->args = args;
+  an->args_count = count;
+  an->parent = NULL;
+
+  return an;
+}
+
 void ast_tree_free(ast_node *node) {
   // 递归推出条件
   if (!node) {
@@ -98,14 +179,17 @@ void ast_tree_free(ast_node *node) {
     ast_tree_free(node->right);
   }
   // 释放函数节点
-  if (node->op == OP_FUNC) {
+  if (node->op == OP_FUNC || node->op == OP_AGGREGATE) {
     if (node->args) {
       for (int i = 0; i < node->args_count; i++) {
         ast_tree_free(node->args[i]);
       }
     }
     free(node->args);
-    free(node->func_name);
+  }
+  if (node->agg_state) {
+    calc_aggregate_free(node->agg_state);
+    free(node->agg_state);
   }
 
   log_info("释放节点操作符为：%d", node->op);
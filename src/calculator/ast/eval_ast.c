@@ -3,6 +3,7 @@
 #include "token.h"
 
 #include <math.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -29,46 +30,82 @@ double number_div(double left, double right) {
   exit(1);
 }
 
+// 第 row 行的函数参数均为数值但结果为 NaN，视为定义域错误
+static bool function_domain_error(const double **in, int args_count, size_t row,
+                                  double value) {
+  if (!isnan(value)) {
+    return false;
+  }
+  for (int i = 0; i < args_count; i++) {
+    if (isnan(in[i][row])) {
+      return false;
+    }
+  }
+  return true;
+}
+
 double evaluate_function(ast_node *ast_func) {
-  char func_name[FUNC_MAX_CHAR];
-  strncpy(func_name, ast_func->func_name, sizeof(func_name) - 1);
-  func_name[sizeof(func_name) - 1] = '\0';
   // 求 参数列表的值
   int args_count = ast_func->args_count;
-  double args_values[args_count];
+  double args_values[args_count > 0 ? args_count : 1];
+  const double *in[args_count > 0 ? args_count : 1];
   for (int i = 0; i < args_count; i++) {
     args_values[i] = evaluate_ast(ast_func->args[i]);
+    in[i] = &args_values[i];
   }
 
-  // 根据参数个数调用函数 参数为 1 个
-  if (args_count == 1) {
-    // 判断函数类型，调用函数
-    if (strcmp(func_name, "sin") == 0) {
-      return sin(args_values[0]);
-    }
-    if (strcmp(func_name, "cos") == 0) {
-      return cos(args_values[0]);
-    }
-    if (strcmp(func_name, "tan") == 0) {
-      return tan(args_values[0]);
-    }
-    if (strcmp(func_name, "sqrt") == 0) {
-      return sqrt(args_values[0]);
-    }
-    if (strcmp(func_name, "log") == 0 && args_values[0] >= 0) {
-      return log(args_values[0]);
-    }
+  // 标量求值即行数为 1 的批量调用
+  double value = 0;
+  ast_func->func->fn(in, &value, 1);
+  if (function_domain_error(in, args_count, 0, value)) {
+    log_fatal("函数结果不是数值：%s", ast_func->func_name);
+    exit(1);
   }
-  // 根据参数个数调用函数 参数为 2 个
-  if (args_count == 2) {
-    if (strcmp(func_name, "pow") == 0 &&
-        !isnan(pow(args_values[0], args_values[1]))) {
-      return pow(args_values[0], args_values[1]);
+  return value;
+}
+
+// quantile 的第一个参数为分位点，其余为数据
+static int aggregate_first_value(const ast_node *node) {
+  return node->agg->kind == AGG_QUANTILE ? 1 : 0;
+}
+
+// 聚合结果为 NaN 时区分分位点越界
+static double aggregate_result(ast_node *node, calc_aggregate_state *state) {
+  double p = 0;
+  if (node->agg->kind == AGG_QUANTILE) {
+    p = evaluate_ast(node->args[0]);
+    if (!(p >= 0 && p <= 1)) {
+      log_fatal("分位点超出 [0, 1]：%f", p);
+      exit(1);
     }
   }
+  return calc_aggregate_result(state, p);
+}
 
-  log_fatal("未知的函数匹配失败：%s", func_name);
-  exit(1);
+double evaluate_aggregate(ast_node *ast_agg) {
+  // 列求值已把整列送入状态，直接取结果
+  if (ast_agg->agg_state) {
+    return aggregate_result(ast_agg, ast_agg->agg_state);
+  }
+
+  // 标量求值：参数逐个求值，攒满一块送入状态，参数再多也不占额外内存
+  calc_aggregate_state state;
+  calc_aggregate_init(&state, ast_agg->agg);
+  double values[CALC_BLOCK_SIZE];
+  size_t n = 0;
+  for (int i = aggregate_first_value(ast_agg); i < ast_agg->args_count; i++) {
+    values[n++] = evaluate_ast(ast_agg->args[i]);
+    if (n == CALC_BLOCK_SIZE || i == ast_agg->args_count - 1) {
+      if (!calc_aggregate_add(&state, values, n)) {
+        log_fatal("聚合函数申请内存失败：%s", ast_agg->func_name);
+        exit(1);
+      }
+      n = 0;
+    }
+  }
+  double value = aggregate_result(ast_agg, &state);
+  calc_aggregate_free(&state);
+  return value;
 }
 
 double evaluate_ast(ast_node *ast_head) {
@@ -111,11 +148,297 @@ double evaluate_ast(ast_node *ast_head) {
   case OP_FUNC:
     return evaluate_function(ast_head);
 
+  case OP_AGGREGATE:
+    return evaluate_aggregate(ast_head);
+
   case OP_EXPR_GROUP:
     return evaluate_ast(ast_head->left);
 
+  case OP_VAR:
+    log_fatal("标量求值不支持列变量 %s，请使用 --column", CALC_COLUMN_VAR);
+    exit(1);
+
   default:
     log_fatal("未知的 AST 节点匹配失败：%d", ast_head->op);
     exit(1);
   }
-}
\ No newline at end of file
+}
+// 列求值的临时空间：每次求值按表达式树一次分配，递归中不再占用栈上的整列数组
+typedef struct {
+  double *columns;            // 若干列，每列 CALC_BLOCK_SIZE 个值
+  const double **pointers;    // 函数调用的参数指针
+} block_scratch;
+
+// 子树求值同时占用的临时列数：二元运算的右子树占一列，第 i 个函数参数占第 i 列，
+// 子树的求值从已占用的列之后开始
+static size_t block_columns(const ast_node *node) {
+  if (!node) {
+    return 0;
+  }
+  switch (node->op) {
+  case OP_ADD:
+  case OP_SUB:
+  case OP_MUL:
+  case OP_DIV:
+  case OP_POW: {
+    size_t left = block_columns(node->left);
+    size_t right = 1 + block_columns(node->right);
+    return left > right ? left : right;
+  }
+  case OP_FUNC: {
+    size_t need = 0;
+    for (int i = 0; i < node->args_count; i++) {
+      size_t arg = (size_t)i + 1 + block_columns(node->args[i]);
+      need = need > arg ? need : arg;
+    }
+    return need;
+  }
+  default:
+    return block_columns(node->left);
+  }
+}
+
+// 子树求值同时占用的参数指针数
+static size_t block_pointers(const ast_node *node) {
+  if (!node) {
+    return 0;
+  }
+  switch (node->op) {
+  case OP_ADD:
+  case OP_SUB:
+  case OP_MUL:
+  case OP_DIV:
+  case OP_POW: {
+    size_t left = block_pointers(node->left);
+    size_t right = block_pointers(node->right);
+    return left > right ? left : right;
+  }
+  case OP_FUNC: {
+    size_t need = 0;
+    for (int i = 0; i < node->args_count; i++) {
+      size_t arg = block_pointers(node->args[i]);
+      need = need > arg ? need : arg;
+    }
+    return (size_t)node->args_count + need;
+  }
+  default:
+    return block_pointers(node->left);
+  }
+}
+
+static block_scratch block_scratch_alloc(const ast_node *node) {
+  size_t columns = block_columns(node);
+  size_t pointers = block_pointers(node);
+  block_scratch scratch = {
+      columns ? malloc(columns * CALC_BLOCK_SIZE * sizeof(double)) : NULL,
+      pointers ? malloc(pointers * sizeof(const double *)) : NULL};
+  if ((columns && !scratch.columns) || (pointers && !scratch.pointers)) {
+    log_fatal("列求值申请内存失败");
+    exit(1);
+  }
+  return scratch;
+}
+
+static void block_scratch_free(block_scratch *scratch) {
+  free(scratch->columns);
+  free(scratch->pointers);
+}
+
+// 对一块（最多 CALC_BLOCK_SIZE 行）求值，每个节点产出一列结果；scratch 为本子树可用的临时空间
+static void evaluate_block(ast_node *node, const double *x, size_t n,
+                           double *out, block_scratch scratch) {
+  double *right = scratch.columns;
+
+  switch (node->op) {
+  case OP_NUM:
+    for (size_t i = 0; i < n; i++) {
+      out[i] = node->number;
+    }
+    return;
+
+  case OP_VAR:
+    memcpy(out, x, n * sizeof(double));
+    return;
+
+  case OP_EXPR_GROUP:
+    evaluate_block(node->left, x, n, out, scratch);
+    return;
+
+  case OP_NEGATE:
+    evaluate_block(node->left, x, n, out, scratch);
+    for (size_t i = 0; i < n; i++) {
+      out[i] = -out[i];
+    }
+    return;
+
+  case OP_FACT:
+    evaluate_block(node->left, x, n, out, scratch);
+    for (size_t i = 0; i < n; i++) {
+      out[i] = factorial(out[i]);
+    }
+    return;
+
+  case OP_ADD:
+  case OP_SUB:
+  case OP_MUL:
+  case OP_DIV:
+  case OP_POW: {
+    evaluate_block(node->left, x, n, out, scratch);
+    block_scratch rest = {scratch.columns + CALC_BLOCK_SIZE, scratch.pointers};
+    evaluate_block(node->right, x, n, right, rest);
+    break;
+  }
+
+  case OP_FUNC: {
+    // 每个参数求出一列，整块只调用一次用户函数
+    int args_count = node->args_count;
+    const double **in = scratch.pointers;
+    for (int i = 0; i < args_count; i++) {
+      double *column = scratch.columns + (size_t)i * CALC_BLOCK_SIZE;
+      block_scratch rest = {column + CALC_BLOCK_SIZE,
+                            scratch.pointers + args_count};
+      evaluate_block(node->args[i], x, n, column, rest);
+      in[i] = column;
+    }
+    node->func->fn(in, out, n);
+    // 与标量求值相同的定义域检查，逐行进行
+    for (size_t i = 0; i < n; i++) {
+      if (function_domain_error(in, args_count, i, out[i])) {
+        log_fatal("函数结果不是数值：%s", node->func_name);
+        exit(1);
+      }
+    }
+    return;
+  }
+
+  case OP_AGGREGATE:
+    log_fatal("列表达式中的聚合函数不能嵌套：%s", node->func_name);
+    exit(1);
+
+  default:
+    log_fatal("未知的 AST 节点匹配失败：%d", node->op);
+    exit(1);
+  }
+
+  // 二元运算，循环体无分支便于向量化
+  switch (node->op) {
+  case OP_ADD:
+    for (size_t i = 0; i < n; i++) {
+      out[i] += right[i];
+    }
+    break;
+  case OP_SUB:
+    for (size_t i = 0; i < n; i++) {
+      out[i] -= right[i];
+    }
+    break;
+  case OP_MUL:
+    for (size_t i = 0; i < n; i++) {
+      out[i] *= right[i];
+    }
+    break;
+  case OP_DIV:
+    // 除数为 0 的行按 IEEE 754 得到 inf 或 NaN，不中断整列
+    for (size_t i = 0; i < n; i++) {
+      out[i] /= right[i];
+    }
+    break;
+  default:
+    for (size_t i = 0; i < n; i++) {
+      out[i] = pow(out[i], right[i]);
+    }
+    break;
+  }
+}
+
+void evaluate_ast_column(ast_node *ast_head, const double *x, size_t n,
+                         double *out) {
+  block_scratch scratch = block_scratch_alloc(ast_head);
+  for (size_t done = 0; done < n; done += CALC_BLOCK_SIZE) {
+    size_t block = n - done < CALC_BLOCK_SIZE ? n - done : CALC_BLOCK_SIZE;
+    evaluate_block(ast_head, x + done, block, out + done, scratch);
+  }
+  block_scratch_free(&scratch);
+}
+
+// 子树中是否引用了聚合函数之外的列变量
+static bool column_outside_aggregate(const ast_node *node) {
+  if (!node || node->op == OP_AGGREGATE) {
+    return false;
+  }
+  if (node->op == OP_VAR) {
+    return true;
+  }
+  for (int i = 0; i < node->args_count; i++) {
+    if (column_outside_aggregate(node->args[i])) {
+      return true;
+    }
+  }
+  return column_outside_aggregate(node->left) ||
+         column_outside_aggregate(node->right);
+}
+
+static bool has_aggregate(const ast_node *node) {
+  if (!node) {
+    return false;
+  }
+  if (node->op == OP_AGGREGATE) {
+    return true;
+  }
+  for (int i = 0; i < node->args_count; i++) {
+    if (has_aggregate(node->args[i])) {
+      return true;
+    }
+  }
+  return has_aggregate(node->left) || has_aggregate(node->right);
+}
+
+bool ast_is_aggregate_query(ast_node *ast_head) {
+  if (!has_aggregate(ast_head)) {
+    return false;
+  }
+  if (column_outside_aggregate(ast_head)) {
+    log_fatal("聚合查询中列变量 %s 只能出现在聚合函数参数里", CALC_COLUMN_VAR);
+    exit(1);
+  }
+  return true;
+}
+
+void evaluate_ast_accumulate(ast_node *ast_head, const double *x, size_t n) {
+  if (!ast_head) {
+    return;
+  }
+  if (ast_head->op != OP_AGGREGATE) {
+    for (int i = 0; i < ast_head->args_count; i++) {
+      evaluate_ast_accumulate(ast_head->args[i], x, n);
+    }
+    evaluate_ast_accumulate(ast_head->left, x, n);
+    evaluate_ast_accumulate(ast_head->right, x, n);
+    return;
+  }
+
+  // 状态挂在节点上，跨块累积
+  if (!ast_head->agg_state) {
+    ast_head->agg_state = malloc(sizeof(calc_aggregate_state));
+    if (!ast_head->agg_state) {
+      log_fatal("聚合函数申请内存失败：%s", ast_head->func_name);
+      exit(1);
+    }
+    calc_aggregate_init(ast_head->agg_state, ast_head->agg);
+  }
+
+  // 每个数据参数按块求出一列后送入状态
+  double values[CALC_BLOCK_SIZE];
+  for (int i = aggregate_first_value(ast_head); i < ast_head->args_count; i++) {
+    block_scratch scratch = block_scratch_alloc(ast_head->args[i]);
+    for (size_t done = 0; done < n; done += CALC_BLOCK_SIZE) {
+      size_t block = n - done < CALC_BLOCK_SIZE ? n - done : CALC_BLOCK_SIZE;
+      evaluate_block(ast_head->args[i], x + done, block, values, scratch);
+      if (!calc_aggregate_add(ast_head->agg_state, values, block)) {
+        log_fatal("聚合函数申请内存失败：%s", ast_head->func_name);
+        exit(1);
+      }
+    }
+    block_scratch_free(&scratch);
+  }
+}
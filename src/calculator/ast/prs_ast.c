@@ -1,13 +1,12 @@
 #include "ast.h"
 #include "lexer.h"
 #include "logfmt.h"
+#include "profile.h"
 #include "token.h"
 #include <stdlib.h>
 #include <limits.h>
 #include <string.h>
 
-#define FUNC_ARGS_MAX 4
-
 // 表达式解析函数
 ast_node* parser_expression_ast(const char **input);
 ast_node* parser_term_ast(const char **input);
@@ -136,7 +135,7 @@ ast_node* parser_base_ast(const char **input) {
     ast_node* parser_expression = parser_expression_ast(input);
     // 获取下一个字符，判断是否右括号 )
     if (get_next_token(input).token_type != TOK_RPAREN) {
-      log_fatal("右获取缺失括号不匹配：%s", *input);        
+      log_fatal("右获取缺失括号不匹配：%.*s", token_excerpt_len(*input), *input);        
       exit(1);
     }
     return ast_create_args(parser_expression);
@@ -144,13 +143,20 @@ ast_node* parser_base_ast(const char **input) {
 
   // 判断 function 函数
   if (tok.token_type == TOK_FUNC) {
+    // 列变量 x：标识符后面不是左括号
+    if (strcmp(tok.func_value, CALC_COLUMN_VAR) == 0) {
+      const char *next = *input;
+      if (get_next_token(&next).token_type != TOK_LPAREN) {
+        return ast_create_variable();
+      }
+    }
     // 回退 token
     *input -= tok.tok_length;
     // 调用 function call 解析 函数
     return parser_function_call_ast(input);
   }
 
-  log_fatal("未知的 base 项：%s", *input);
+  log_fatal("未知的 base 项：%.*s", token_excerpt_len(*input), *input);
   exit(1);
 }
 
@@ -167,7 +173,7 @@ ast_node* parser_function_call_ast(const char **input){
   // 处理 () 括号里的内容 先判断 括号
   // 判断是否括号，先判断左括号 (
   if (get_next_token(input).token_type != TOK_LPAREN) {
-    log_fatal("函数左括号匹配失败：%s", *input);
+    log_fatal("函数左括号匹配失败：%.*s", token_excerpt_len(*input), *input);
     exit(1);
   }
 
@@ -178,9 +184,13 @@ ast_node* parser_function_call_ast(const char **input){
   parser_arguments_ast(input, &args, &args_count);
   // 获取下一个字符，判断是否右括号 )
   if (get_next_token(input).token_type != TOK_RPAREN) {
-    log_fatal("函数右括号匹配失败：%s", *input);
+    log_fatal("函数右括号匹配失败：%.*s", token_excerpt_len(*input), *input);
     exit(1);
   }
+  // 聚合函数参数个数不限，单独建节点
+  if (calc_aggregate_find(func_name)) {
+    return ast_create_aggregate(func_name, args, args_count);
+  }
   // 创建函数 ast 节点 
   return ast_create_function(func_name, args, args_count);
 }
@@ -193,7 +203,10 @@ void parser_arguments_ast(const char **input, ast_node*** args, int* count) {
   // -> *args 结构体数组 **args 结构体指针 ***args 结构体本身
 
   // 必须动态创建 源调用者非堆内存作用域失效回回收
-  *args = malloc(4 * sizeof(ast_node*)); // 最多4个参数
+  // 聚合函数参数个数不限，容量不足时倍增
+  int capacity = 4;
+  *args = malloc(capacity * sizeof(ast_node*));
+  PROF_COUNT(PROF_CNT_MALLOCS);
   *count = 0;
 
   // 获取下一个 token
@@ -202,19 +215,20 @@ void parser_arguments_ast(const char **input, ast_node*** args, int* count) {
   *input -= tok.tok_length;
   // 判断是否为 ) 右括号结束
   while (tok.token_type != TOK_RPAREN) {
-    // 参数个数判断
-    if (*count > FUNC_ARGS_MAX - 1) {
-      log_fatal("函数参数超出了最大个数：%s", *input);
-      exit(1);
+    // 参数数组扩容
+    if (*count == capacity) {
+      capacity *= 2;
+      *args = realloc(*args, capacity * sizeof(ast_node*));
+      PROF_COUNT(PROF_CNT_MALLOCS);
     }
     // 解析计算第 n 个参数，添加到 参数列表
-    ast_node* ast_expression = parser_base_ast(input);
+    ast_node* ast_expression = parser_expression_ast(input);
     (*args)[(*count)++] = ast_expression;
     // 获取下一个 token
     tok = get_next_token(input);
 
     if (tok.token_type != TOK_COMMA && tok.token_type != TOK_RPAREN) {
-      log_fatal("函数参数匹配失败非逗号非右括号项：%s", *input);
+      log_fatal("函数参数匹配失败非逗号非右括号项：%.*s", token_excerpt_len(*input), *input);
       exit(1);
     }
   }
@@ -230,7 +244,7 @@ ast_node* parser_to_ast(const char *expr) {
   ast_node* ast_head = parser_expression_ast(&expr);
   // 判断是否解析完成
   if (get_next_token(&expr).token_type != TOK_END) {
-    log_error("解析未完成，但已结束：%s", &expr);
+    log_error("解析未完成，但已结束：%.*s", token_excerpt_len(expr), expr);
     exit(1);
   }
 
@@ -1,28 +1,144 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "ast.h"
+#include "function.h"
 #include "input.h"
 #include "logfmt.h"
+#include "output.h"
 #include "parser.h"
+#include "profile.h"
 
-int main() {
+// 结果累积到大缓冲区，写满或退出时一次 write 输出
+static output_buffer out;
 
-  while (true) {
-    char *input_expression = get_input_expression();
+// 解析失败 exit 退出时，先把已计算的结果写出
+static void flush_output(void) { output_flush(&out); }
 
-    // double value = evaluate_expression((const char *)input_expression);
-    ast_node *ast = parser_to_ast((const char *)input_expression);
+// 逐行解析并求值表达式
+static void run_expressions(input_reader *reader) {
+  input_view expression;
+  while (input_reader_next(reader, &expression)) {
+    prof_expr_begin();
+
+    // double value = evaluate_expression(expression.ptr);
+    PROF_BEGIN(parse_start);
+    ast_node *ast = parser_to_ast(expression.ptr);
+    PROF_END(PROF_PARSE, parse_start);
+
+    PROF_BEGIN(eval_start);
     double value = evaluate_ast(ast);
+    PROF_END(PROF_EVAL, eval_start);
 
+    PROF_BEGIN(free_start);
     ast_tree_free(ast);
+    PROF_END(PROF_FREE, free_start);
+
+    prof_expr_end();
     log_info("表达式解析完成，值为 %f", value);
 
-    printf("%s = %f.\n", input_expression, value);
+    // 输出格式为 "表达式 = 值"：值是 format_double 的最短往返形式（如 0.30000000000000004、1.5e-7），
+    // 不再是旧版 printf("%s = %f.") 的固定 6 位小数加句点，依赖旧格式的脚本需要调整
+    output_write(&out, expression.ptr, expression.len);
+    output_write(&out, " = ", 3);
+    output_double(&out, value);
+    output_end_line(&out);
+  }
+}
+
+// 每行输入一个数值作为列变量 x，表达式只解析一次，按块求值
+// 含聚合函数时整列流式送入聚合状态，输入结束后只输出一个结果
+static void run_column(input_reader *reader, const char *expr) {
+  ast_node *ast = parser_to_ast(expr);
+  bool aggregate = ast_is_aggregate_query(ast);
+  double x[CALC_BLOCK_SIZE];
+  double y[CALC_BLOCK_SIZE];
+  size_t n = 0;
+
+  input_view line;
+  bool more = true;
+  while (more) {
+    more = input_reader_next(reader, &line);
+    if (more) {
+      char *end = NULL;
+      x[n] = strtod(line.ptr, &end);
+      // strtod 会跳过换行继续读下一行，结束位置必须在本行内
+      if (end == line.ptr || end > line.ptr + line.len) {
+        log_warn("非数值输入行，已跳过：%.*s", (int)line.len, line.ptr);
+        continue;
+      }
+      n++;
+    }
+
+    // 攒满一块或输入结束时求值
+    if (aggregate && (n == CALC_BLOCK_SIZE || !more)) {
+      evaluate_ast_accumulate(ast, x, n);
+      n = 0;
+    } else if (n == CALC_BLOCK_SIZE || (!more && n > 0)) {
+      evaluate_ast_column(ast, x, n, y);
+      for (size_t i = 0; i < n; i++) {
+        output_double(&out, y[i]);
+        output_end_line(&out);
+      }
+      n = 0;
+    }
+  }
+
+  if (aggregate) {
+    output_double(&out, evaluate_ast(ast));
+    output_end_line(&out);
+  }
+  ast_tree_free(ast);
+}
+
+int main(int argc, char *argv[]) {
 
-    log_debug("释放堆内存：%s", input_expression);
-    free(input_expression);
+  // 解析命令行参数：
+  // --profile       开启分阶段耗时统计，退出时打印直方图
+  // --plugin <so>   加载函数插件，可重复指定
+  // --column <expr> 列模式，每行输入作为 x 的一个值
+  // 其余不以 - 开头的参数为输入文件路径（只取第一个），缺省读取标准输入
+  const char *input_path = NULL;
+  const char *column_expr = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--profile") == 0) {
+      prof_enable();
+    } else if (strcmp(argv[i], "--plugin") == 0 && i + 1 < argc) {
+      if (calc_function_load_plugin(argv[++i]) != 0) {
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--column") == 0 && i + 1 < argc) {
+      column_expr = argv[++i];
+    } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      log_warn("未知的命令行参数：%s", argv[i]);
+    } else if (input_path) {
+      log_warn("只能指定一个输入文件，忽略：%s", argv[i]);
+    } else {
+      input_path = argv[i];
+    }
   }
+
+  input_reader *reader = input_reader_open(input_path);
+  if (!reader) {
+    return 1;
+  }
+
+  if (!output_init(&out, STDOUT_FILENO, OUTPUT_BUFFER_SIZE)) {
+    input_reader_close(reader);
+    return 1;
+  }
+  atexit(flush_output);
+
+  if (column_expr) {
+    run_column(reader, column_expr);
+  } else {
+    run_expressions(reader);
+  }
+
+  output_free(&out);
+  input_reader_close(reader);
   return 0;
-}
\ No newline at end of file
+}
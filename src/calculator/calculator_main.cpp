@@ -1,5 +1,49 @@
 #include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "ccpp_pro_pl/calculator/calculator.hpp"
+
+// 编译期解析并求值，运行时只剩常量
+static_assert(calculator::evaluate("2 + 3 * 4") == 14, "2 + 3 * 4");
+static_assert(calculator::evaluate("(2 + 3) * 4") == 20, "(2 + 3) * 4");
+static_assert(calculator::evaluate("2 ^ 3 ^ 2") == 512, "幂运算右结合");
+static_assert(calculator::evaluate("(2 ^ 3) ^ 2") == 64, "(2 ^ 3) ^ 2");
+static_assert(calculator::evaluate("3! + 4!") == 30, "阶乘");
+static_assert(calculator::evaluate("-3 + 5") == 2, "一元负号");
+static_assert(calculator::evaluate("pow(2, 3+2)") == 32, "函数调用");
+static_assert(calculator::evaluate("sqrt(9) + pow(2, 3) * 2") == 19, "复杂表达式");
+static_assert(calculator::evaluate("(sin(0) + cos(0)) * 10") == 10, "三角函数");
+static_assert(calculator::evaluate("1.5e2") == 150, "科学计数法");
+static_assert(calculator::evaluate("0e400") == 0 && calculator::evaluate("1e-400") == 0, "指数超出 double 范围");
+static_assert(calculator::evaluate("1.7976931348623157e308") == std::numeric_limits<double>::max(), "DBL_MAX 不溢出");
+static_assert(calculator::evaluate("1e309") == std::numeric_limits<double>::infinity(), "超出 double 范围");
+static_assert(calculator::evaluate("123456789012345678901234567890") > 1.2345678901e29 &&
+              calculator::evaluate("123456789012345678901234567890") < 1.2345678902e29, "超过 19 位有效数字");
+// 参数很大时先精确取余再缩放，不会因整数转换溢出而未定义
+static_assert(calculator::evaluate("sin(1e20)") >= -1 && calculator::evaluate("sin(1e20)") <= 1, "大参数的三角函数");
+
+// 表达式树本身也是编译期常量，可以在运行时反复求值
+constexpr auto compiled = calculator::parse("(3! - 4) * 5 + 2 ^ 3");
+static_assert(compiled.eval() == 18, "(3! - 4) * 5 + 2 ^ 3");
 
 auto main() -> int {
-  return 0;
-}
\ No newline at end of file
+    std::cout << "编译期表达式 (3! - 4) * 5 + 2 ^ 3 = " << compiled.eval() << std::endl;
+
+    // 运行时字符串使用同一套解析与求值模板
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        try {
+            double value = calculator::evaluate(line);
+            std::cout << line << " = " << value << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "\033[31m错误: " << e.what() << "\033[0m" << std::endl;
+        }
+    }
+
+    return 0;
+}
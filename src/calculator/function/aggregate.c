@@ -0,0 +1,383 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aggregate.h"
+#include "logfmt.h"
+
+// 聚合函数表，参数个数不限
+static const calc_aggregate aggregates[] = {
+    {"count", AGG_COUNT, false},   {"sum", AGG_SUM, false},
+    {"mean", AGG_MEAN, false},     {"var", AGG_VAR, false},
+    {"stdev", AGG_STDEV, false},   {"min", AGG_MIN, false},
+    {"max", AGG_MAX, false},       {"median", AGG_MEDIAN, true},
+    {"quantile", AGG_QUANTILE, true},
+};
+
+void calc_moments_init(calc_moments *m) {
+  m->count = 0;
+  m->mean = 0;
+  m->m2 = 0;
+  m->sum = 0;
+  m->sum_c = 0;
+  m->min = INFINITY;
+  m->max = -INFINITY;
+}
+
+void calc_moments_add(calc_moments *m, const double *x, size_t n) {
+  if (n == 0) {
+    return;
+  }
+
+  // 第一遍：块内均值、最小/最大值，无分支便于向量化
+  double sum = 0;
+  double min = INFINITY;
+  double max = -INFINITY;
+  for (size_t i = 0; i < n; i++) {
+    sum += x[i];
+    min = x[i] < min ? x[i] : min;
+    max = x[i] > max ? x[i] : max;
+  }
+  double mean = sum / (double)n;
+
+  // 第二遍：块内与均值差的平方和，数据仍在缓存中
+  double m2 = 0;
+  for (size_t i = 0; i < n; i++) {
+    double d = x[i] - mean;
+    m2 += d * d;
+  }
+
+  calc_moments block = {.count = n, .mean = mean, .m2 = m2,
+                        .min = min, .max = max};
+
+  // Neumaier 补偿求和，sum 的结果不受块大小影响
+  for (size_t i = 0; i < n; i++) {
+    double t = block.sum + x[i];
+    if (fabs(block.sum) >= fabs(x[i])) {
+      block.sum_c += (block.sum - t) + x[i];
+    } else {
+      block.sum_c += (x[i] - t) + block.sum;
+    }
+    block.sum = t;
+  }
+
+  calc_moments_merge(m, &block);
+}
+
+void calc_moments_merge(calc_moments *dst, const calc_moments *src) {
+  if (src->count == 0) {
+    return;
+  }
+  if (dst->count == 0) {
+    *dst = *src;
+    return;
+  }
+
+  double na = (double)dst->count;
+  double nb = (double)src->count;
+  double n = na + nb;
+  double delta = src->mean - dst->mean;
+  dst->mean += delta * nb / n;
+  dst->m2 += src->m2 + delta * delta * na * nb / n;
+  dst->count += src->count;
+
+  // 补偿求和的两个分量分别相加，最后再合并
+  double t = dst->sum + src->sum;
+  if (fabs(dst->sum) >= fabs(src->sum)) {
+    dst->sum_c += (dst->sum - t) + src->sum;
+  } else {
+    dst->sum_c += (src->sum - t) + dst->sum;
+  }
+  dst->sum = t;
+  dst->sum_c += src->sum_c;
+
+  dst->min = src->min < dst->min ? src->min : dst->min;
+  dst->max = src->max > dst->max ? src->max : dst->max;
+}
+
+double calc_moments_variance(const calc_moments *m) {
+  if (m->count < 2) {
+    return NAN;
+  }
+  return m->m2 / (double)(m->count - 1);
+}
+
+// 第 h 层的压缩阈值：越低的层容量越小，按 2/3 的比例递减，最小为 2
+static uint32_t kll_level_limit(int levels, int h) {
+  double cap = CALC_KLL_K;
+  for (int d = levels - 1 - h; d > 0; d--) {
+    cap *= 2.0 / 3.0;
+  }
+  uint32_t limit = (uint32_t)ceil(cap);
+  return limit < 2 ? 2 : limit;
+}
+
+static void kll_update_limit(calc_kll *kll) {
+  kll->limit = 0;
+  for (int h = 0; h < kll->levels; h++) {
+    kll->limit += kll_level_limit(kll->levels, h);
+  }
+}
+
+// 保证第 h 层还能再放入 extra 个元素
+static bool kll_reserve(calc_kll *kll, int h, uint32_t extra) {
+  uint32_t need = kll->size[h] + extra;
+  if (need <= kll->capacity[h]) {
+    return true;
+  }
+  uint32_t capacity = kll->capacity[h] ? kll->capacity[h] : 16;
+  while (capacity < need) {
+    capacity *= 2;
+  }
+  double *items = realloc(kll->items[h], capacity * sizeof(double));
+  if (!items) {
+    log_error("KLL 草图申请内存失败：%u", capacity);
+    return false;
+  }
+  kll->items[h] = items;
+  kll->capacity[h] = capacity;
+  return true;
+}
+
+static int compare_double(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static uint64_t kll_random(calc_kll *kll) {
+  // xorshift64
+  kll->rng ^= kll->rng << 13;
+  kll->rng ^= kll->rng >> 7;
+  kll->rng ^= kll->rng << 17;
+  return kll->rng;
+}
+
+// 压缩最低的超限层：排序后随机保留奇数或偶数位置的一半，晋升到上一层
+static bool kll_compress(calc_kll *kll) {
+  int h = 0;
+  while (h < kll->levels - 1 &&
+         kll->size[h] < kll_level_limit(kll->levels, h)) {
+    h++;
+  }
+  if (h == kll->levels - 1) {
+    if (kll->levels == CALC_KLL_LEVELS_MAX) {
+      log_error("KLL 草图层数已达上限：%d", kll->levels);
+      return false;
+    }
+    // 顶层也满了，增加一层，各层阈值随之上移
+    kll->levels++;
+    kll_update_limit(kll);
+  }
+
+  uint32_t size = kll->size[h];
+  uint32_t pairs = size / 2;
+  if (!kll_reserve(kll, h + 1, pairs)) {
+    return false;
+  }
+
+  double *items = kll->items[h];
+  qsort(items, size, sizeof(double), compare_double);
+  // 奇数个时保留最大的一个在本层
+  uint32_t offset = (uint32_t)(kll_random(kll) & 1);
+  double *up = kll->items[h + 1] + kll->size[h + 1];
+  for (uint32_t i = 0; i < pairs; i++) {
+    up[i] = items[2 * i + offset];
+  }
+  kll->size[h + 1] += pairs;
+  if (size & 1) {
+    items[0] = items[size - 1];
+  }
+  kll->size[h] = size & 1;
+  kll->retained -= pairs;
+  return true;
+}
+
+void calc_kll_init(calc_kll *kll, uint64_t seed) {
+  memset(kll, 0, sizeof(*kll));
+  kll->levels = 1;
+  kll->rng = seed ? seed : 0x9E3779B97F4A7C15ULL;
+  kll_update_limit(kll);
+}
+
+bool calc_kll_add(calc_kll *kll, const double *x, size_t n) {
+  size_t i = 0;
+  while (i < n) {
+    // 一次放入到阈值为止的一段，再压缩
+    uint32_t room = kll->limit > kll->retained ? kll->limit - kll->retained : 0;
+    if (room == 0) {
+      if (!kll_compress(kll)) {
+        return false;
+      }
+      continue;
+    }
+    size_t chunk = n - i < room ? n - i : room;
+    if (!kll_reserve(kll, 0, (uint32_t)chunk)) {
+      return false;
+    }
+    double *items = kll->items[0] + kll->size[0];
+    uint32_t added = 0;
+    for (size_t j = i; j < i + chunk; j++) {
+      // NaN 无法排序，直接忽略
+      if (!isnan(x[j])) {
+        items[added++] = x[j];
+      }
+    }
+    kll->size[0] += added;
+    kll->retained += added;
+    kll->count += added;
+    i += chunk;
+  }
+  return true;
+}
+
+bool calc_kll_merge(calc_kll *dst, const calc_kll *src) {
+  for (int h = 0; h < src->levels; h++) {
+    if (src->size[h] == 0) {
+      continue;
+    }
+    if (h >= dst->levels) {
+      dst->levels = h + 1;
+      kll_update_limit(dst);
+    }
+    if (!kll_reserve(dst, h, src->size[h])) {
+      return false;
+    }
+    memcpy(dst->items[h] + dst->size[h], src->items[h],
+           src->size[h] * sizeof(double));
+    dst->size[h] += src->size[h];
+    dst->retained += src->size[h];
+  }
+  dst->count += src->count;
+
+  while (dst->retained >= dst->limit) {
+    if (!kll_compress(dst)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// 带权重的样本，第 h 层的元素权重为 2^h
+typedef struct {
+  double value;
+  uint64_t weight;
+} kll_sample;
+
+static int compare_sample(const void *a, const void *b) {
+  return compare_double(&((const kll_sample *)a)->value,
+                        &((const kll_sample *)b)->value);
+}
+
+// 排名为 rank（从 0 开始）的样本值，samples 已排序
+static double kll_value_at(const kll_sample *samples, size_t n, uint64_t rank) {
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < n; i++) {
+    cumulative += samples[i].weight;
+    if (rank < cumulative) {
+      return samples[i].value;
+    }
+  }
+  return samples[n - 1].value;
+}
+
+double calc_kll_quantile(const calc_kll *kll, double p) {
+  if (kll->count == 0 || !(p >= 0 && p <= 1)) {
+    return NAN;
+  }
+
+  kll_sample *samples = malloc(kll->retained * sizeof(kll_sample));
+  if (!samples) {
+    log_error("KLL 分位数申请内存失败：%u", kll->retained);
+    return NAN;
+  }
+  size_t n = 0;
+  for (int h = 0; h < kll->levels; h++) {
+    for (uint32_t i = 0; i < kll->size[h]; i++) {
+      samples[n++] = (kll_sample){kll->items[h][i], (uint64_t)1 << h};
+    }
+  }
+  qsort(samples, n, sizeof(kll_sample), compare_sample);
+
+  // 与 numpy 默认方式一致：在相邻排名之间线性插值，未压缩时结果精确
+  double rank = p * (double)(kll->count - 1);
+  uint64_t lo = (uint64_t)floor(rank);
+  uint64_t hi = (uint64_t)ceil(rank);
+  double lo_value = kll_value_at(samples, n, lo);
+  double hi_value = hi == lo ? lo_value : kll_value_at(samples, n, hi);
+  free(samples);
+
+  return lo_value + (rank - (double)lo) * (hi_value - lo_value);
+}
+
+void calc_kll_free(calc_kll *kll) {
+  for (int h = 0; h < CALC_KLL_LEVELS_MAX; h++) {
+    free(kll->items[h]);
+  }
+  memset(kll, 0, sizeof(*kll));
+}
+
+const calc_aggregate *calc_aggregate_find(const char *name) {
+  for (size_t i = 0; i < sizeof(aggregates) / sizeof(aggregates[0]); i++) {
+    if (strcmp(aggregates[i].name, name) == 0) {
+      return &aggregates[i];
+    }
+  }
+  return NULL;
+}
+
+void calc_aggregate_init(calc_aggregate_state *state,
+                         const calc_aggregate *agg) {
+  state->agg = agg;
+  calc_moments_init(&state->moments);
+  // 种子取状态地址，各线程的状态互不相同
+  calc_kll_init(&state->kll, (uint64_t)(uintptr_t)state);
+}
+
+bool calc_aggregate_add(calc_aggregate_state *state, const double *x,
+                        size_t n) {
+  calc_moments_add(&state->moments, x, n);
+  if (state->agg->sketch) {
+    return calc_kll_add(&state->kll, x, n);
+  }
+  return true;
+}
+
+bool calc_aggregate_merge(calc_aggregate_state *dst,
+                          const calc_aggregate_state *src) {
+  calc_moments_merge(&dst->moments, &src->moments);
+  if (dst->agg->sketch) {
+    return calc_kll_merge(&dst->kll, &src->kll);
+  }
+  return true;
+}
+
+double calc_aggregate_result(const calc_aggregate_state *state, double p) {
+  const calc_moments *m = &state->moments;
+  switch (state->agg->kind) {
+  case AGG_COUNT:
+    return (double)m->count;
+  case AGG_SUM:
+    return m->sum + m->sum_c;
+  case AGG_MEAN:
+    return m->count ? m->mean : NAN;
+  case AGG_VAR:
+    return calc_moments_variance(m);
+  case AGG_STDEV:
+    return sqrt(calc_moments_variance(m));
+  case AGG_MIN:
+    return m->count ? m->min : NAN;
+  case AGG_MAX:
+    return m->count ? m->max : NAN;
+  case AGG_MEDIAN:
+    return calc_kll_quantile(&state->kll, 0.5);
+  case AGG_QUANTILE:
+    return calc_kll_quantile(&state->kll, p);
+  default:
+    return NAN;
+  }
+}
+
+void calc_aggregate_free(calc_aggregate_state *state) {
+  calc_kll_free(&state->kll);
+}
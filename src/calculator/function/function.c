@@ -0,0 +1,119 @@
+#include <ctype.h>
+#include <dlfcn.h>
+#include <math.h>
+#include <string.h>
+
+#include "function.h"
+#include "logfmt.h"
+
+// 内置函数的批量实现，循环体简单，编译器可自动向量化
+static void batch_sin(const double **in, double *out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = sin(in[0][i]);
+  }
+}
+
+static void batch_cos(const double **in, double *out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = cos(in[0][i]);
+  }
+}
+
+static void batch_tan(const double **in, double *out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = tan(in[0][i]);
+  }
+}
+
+static void batch_sqrt(const double **in, double *out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = sqrt(in[0][i]);
+  }
+}
+
+static void batch_log(const double **in, double *out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = in[0][i] >= 0 ? log(in[0][i]) : NAN;
+  }
+}
+
+static void batch_pow(const double **in, double *out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = pow(in[0][i], in[1][i]);
+  }
+}
+
+// 函数表，内置函数静态初始化，插件函数追加在后面
+static calc_function functions[CALC_FUNC_MAX] = {
+    {"sin", 1, batch_sin},   {"cos", 1, batch_cos}, {"tan", 1, batch_tan},
+    {"sqrt", 1, batch_sqrt}, {"log", 1, batch_log}, {"pow", 2, batch_pow},
+};
+static int function_count = 6;
+
+int calc_function_register(const char *name, int arity, calc_batch_fn fn) {
+  size_t len = name ? strlen(name) : 0;
+  if (len == 0 || len >= FUNC_MAX_CHAR || arity < 0 || !fn) {
+    log_error("函数注册参数非法：%s", name ? name : "(null)");
+    return -1;
+  }
+  // 词法分析器只把字母序列识别为函数名
+  for (size_t i = 0; i < len; i++) {
+    if (!isalpha((unsigned char)name[i])) {
+      log_error("函数名只能包含字母：%s", name);
+      return -1;
+    }
+  }
+
+  // 同名同参数个数则覆盖
+  for (int i = 0; i < function_count; i++) {
+    if (functions[i].arity == arity && strcmp(functions[i].name, name) == 0) {
+      functions[i].fn = fn;
+      return 0;
+    }
+  }
+
+  if (function_count == CALC_FUNC_MAX) {
+    log_error("函数表已满，无法注册：%s", name);
+    return -1;
+  }
+  calc_function *f = &functions[function_count++];
+  memcpy(f->name, name, len + 1);
+  f->arity = arity;
+  f->fn = fn;
+  log_info("注册函数：%s/%d", name, arity);
+  return 0;
+}
+
+const calc_function *calc_function_find(const char *name, int arity) {
+  for (int i = 0; i < function_count; i++) {
+    if (functions[i].arity == arity && strcmp(functions[i].name, name) == 0) {
+      return &functions[i];
+    }
+  }
+  return NULL;
+}
+
+int calc_function_load_plugin(const char *path) {
+  void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  if (!handle) {
+    log_error("插件加载失败：%s", dlerror());
+    return -1;
+  }
+
+  calc_plugin_init_fn init = NULL;
+  // 对象指针与函数指针之间的转换通过 memcpy 完成，避免 ISO C 警告
+  void *symbol = dlsym(handle, CALC_PLUGIN_INIT);
+  memcpy(&init, &symbol, sizeof(init));
+  if (!init) {
+    log_error("插件 %s 缺少 %s 入口", path, CALC_PLUGIN_INIT);
+    dlclose(handle);
+    return -1;
+  }
+
+  if (init(calc_function_register) != 0) {
+    log_error("插件 %s 初始化失败", path);
+    return -1;
+  }
+  log_info("插件加载完成：%s", path);
+  return 0;
+}
@@ -0,0 +1,192 @@
+#ifndef CALCULATOR_AGGREGATE_H
+#define CALCULATOR_AGGREGATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+流式聚合：一次遍历输入列，状态大小与数据量无关
+  - 矩统计：Welford 均值/方差，补偿求和，最小/最大值
+  - 分位数：KLL 草图，k 决定精度，排名误差约 1.7/k，内存 O(k log(n/k))
+所有状态都可合并：多个线程各自聚合一段输入，最后 merge 到一起，
+结果与单线程顺序聚合一致（分位数在草图误差范围内一致）
+*/
+
+// KLL 草图的精度参数，默认 200 时排名误差约 1%
+#define CALC_KLL_K 200
+// KLL 最大层数，第 h 层每个元素代表 2^h 个原始值
+#define CALC_KLL_LEVELS_MAX 48
+
+// 矩统计状态
+typedef struct {
+  uint64_t count;
+  double mean;
+  double m2;    // 与均值差的平方和
+  double sum;   // Neumaier 补偿求和
+  double sum_c; // 求和的补偿项
+  double min;
+  double max;
+} calc_moments;
+
+// KLL 分位数草图，每层是一个压缩器
+typedef struct {
+  double *items[CALC_KLL_LEVELS_MAX];
+  uint32_t size[CALC_KLL_LEVELS_MAX];
+  uint32_t capacity[CALC_KLL_LEVELS_MAX]; // 已分配的空间
+  uint32_t retained; // 所有层的元素总数
+  uint32_t limit;    // 元素总数达到该值时压缩
+  int levels;
+  uint64_t count;
+  uint64_t rng; // 压缩时选奇偶位置的随机源
+} calc_kll;
+
+// 聚合函数种类
+typedef enum {
+  AGG_COUNT,
+  AGG_SUM,
+  AGG_MEAN,
+  AGG_VAR,   // 样本方差，n - 1 为分母
+  AGG_STDEV, // 样本标准差
+  AGG_MIN,
+  AGG_MAX,
+  AGG_MEDIAN,
+  AGG_QUANTILE, // quantile(p, ...)，第一个参数为分位点
+  AGG_KIND_MAX
+} calc_aggregate_kind;
+
+// 聚合函数表条目，参数个数不限
+typedef struct {
+  const char *name;
+  calc_aggregate_kind kind;
+  bool sketch; // 是否需要分位数草图
+} calc_aggregate;
+
+// 一个聚合函数调用的完整状态
+typedef struct {
+  const calc_aggregate *agg;
+  calc_moments moments;
+  calc_kll kll;
+} calc_aggregate_state;
+
+/**
+* @brief             初始化矩统计状态
+*
+* @note              Revision History
+*/
+void calc_moments_init(calc_moments *m);
+
+/**
+* @brief             追加一列数值
+* @param   m         矩统计状态
+* @param   x         输入列
+* @param   n         行数
+*
+* @note              块内先两遍求出均值与平方和，再与已有状态合并，比逐个 Welford 更稳定也更易向量化
+*/
+void calc_moments_add(calc_moments *m, const double *x, size_t n);
+
+/**
+* @brief             合并两个状态，结果写入 dst
+*
+* @note              Chan 等人的并行方差合并公式
+*/
+void calc_moments_merge(calc_moments *dst, const calc_moments *src);
+
+/**
+* @brief             样本方差，少于两个值时返回 NaN
+*
+* @note              Revision History
+*/
+double calc_moments_variance(const calc_moments *m);
+
+/**
+* @brief             初始化 KLL 草图
+* @param   kll       草图
+* @param   seed      随机种子，不同线程可以使用不同种子
+*
+* @note              Revision History
+*/
+void calc_kll_init(calc_kll *kll, uint64_t seed);
+
+/**
+* @brief             追加一列数值，NaN 被忽略
+* @return  bool      申请内存失败返回 false
+*
+* @note              Revision History
+*/
+bool calc_kll_add(calc_kll *kll, const double *x, size_t n);
+
+/**
+* @brief             把 src 合并到 dst，src 保持不变
+* @return  bool      申请内存失败返回 false
+*
+* @note              Revision History
+*/
+bool calc_kll_merge(calc_kll *dst, const calc_kll *src);
+
+/**
+* @brief             估计分位数
+* @param   p         分位点，范围 [0, 1]
+* @return  double    草图为空或 p 越界时返回 NaN
+*
+* @note              Revision History
+*/
+double calc_kll_quantile(const calc_kll *kll, double p);
+
+/**
+* @brief             释放草图内存
+*
+* @note              Revision History
+*/
+void calc_kll_free(calc_kll *kll);
+
+/**
+* @brief             按函数名查找聚合函数
+* @return  calc_aggregate*  找不到返回 NULL
+*
+* @note              Revision History
+*/
+const calc_aggregate *calc_aggregate_find(const char *name);
+
+/**
+* @brief             初始化聚合状态
+*
+* @note              Revision History
+*/
+void calc_aggregate_init(calc_aggregate_state *state, const calc_aggregate *agg);
+
+/**
+* @brief             追加一列数值
+* @return  bool      申请内存失败返回 false
+*
+* @note              Revision History
+*/
+bool calc_aggregate_add(calc_aggregate_state *state, const double *x, size_t n);
+
+/**
+* @brief             合并同一聚合函数的两个状态
+* @return  bool      申请内存失败返回 false
+*
+* @note              Revision History
+*/
+bool calc_aggregate_merge(calc_aggregate_state *dst,
+                          const calc_aggregate_state *src);
+
+/**
+* @brief             求出聚合结果
+* @param   p         AGG_QUANTILE 的分位点，其余聚合忽略
+* @return  double    无输入时 count/sum 为 0，其余为 NaN
+*
+* @note              Revision History
+*/
+double calc_aggregate_result(const calc_aggregate_state *state, double p);
+
+/**
+* @brief             释放聚合状态
+*
+* @note              Revision History
+*/
+void calc_aggregate_free(calc_aggregate_state *state);
+
+#endif // !CALCULATOR_AGGREGATE_H
@@ -1,6 +1,14 @@
 #ifndef CALCULATOR_AST_H
 #define CALCULATOR_AST_H
 
+#include <stddef.h>
+
+#include "aggregate.h"
+#include "function.h"
+
+// 列变量名，列求值时表示输入列的当前行
+#define CALC_COLUMN_VAR "x"
+
 typedef enum {
   // number 数值
   OP_NUM,
@@ -16,13 +24,18 @@ typedef enum {
   OP_POW,
   OP_FACT,
   OP_NEGATE,     // 一元负号
-  OP_EXPR_GROUP  // 括号表达式组
+  OP_EXPR_GROUP, // 括号表达式组
+  OP_VAR,        // 列变量 x
+  OP_AGGREGATE   // 聚合函数 mean stdev 等，参数个数不限
 } oper_type;
 
 typedef struct ast_node {
   oper_type op;
   double number; // 数字节点值
-  char* func_name; // 函数名
+  const char* func_name; // 函数名，指向函数表或聚合函数表中的名字，不单独释放
+  const calc_function* func; // 解析时从函数表查到的函数
+  const calc_aggregate* agg; // 聚合函数
+  calc_aggregate_state* agg_state; // 列求值时跨块累积的聚合状态
   struct ast_node* left; // 左操作数/单操作数
   struct ast_node* right; // 右操作数（二元操作）
   struct ast_node** args;  // 函数参数数组,二级指针执行一系列 node 组
@@ -33,8 +46,10 @@ typedef struct ast_node {
 ast_node* ast_create_number(double value); // 创建数值 ast_node 节点
 ast_node* ast_create_unary(oper_type type, ast_node* left); // 创建 一元操作 左结合 ast_node 节点
 ast_node* ast_create_binary(oper_type type, ast_node* left, ast_node* right); // 创建 二元操作 ast_node 节点
-ast_node* ast_create_function(char* func_name, ast_node** args, int count); // 创建 函数操作 ast_node 节点
+ast_node* ast_create_function(const char* func_name, ast_node** args, int count); // 创建 函数操作 ast_node 节点
 ast_node* ast_create_args(ast_node* expr); // 创建 函数参数 ast_node 节点
+ast_node* ast_create_variable(void); // 创建 列变量 ast_node 节点
+ast_node* ast_create_aggregate(const char* func_name, ast_node** args, int count); // 创建 聚合函数 ast_node 节点
 
 void ast_tree_free(ast_node* head); // ast 树节点释放
 
@@ -42,4 +57,34 @@ ast_node* parser_to_ast(const char *expr);
 
 double evaluate_ast(ast_node* ast_head);
 
+/**
+* @brief             对一列输入按块求值，函数节点每 CALC_BLOCK_SIZE 行只调用一次
+* @param   ast_head  AST 根节点，可引用列变量 x
+* @param   x         输入列
+* @param   n         行数
+* @param   out       输出列，长度 n
+*
+* @note              除数为 0 的行得到 inf 或 NaN，不中断整列；函数参数为数值而结果为 NaN 时按定义域错误退出，
+*                    与标量求值相同
+*/
+void evaluate_ast_column(ast_node* ast_head, const double* x, size_t n, double* out);
+
+/**
+* @brief             判断表达式是否为聚合查询
+* @return  bool      含聚合函数返回 true
+*
+* @note              聚合查询中列变量 x 只能出现在聚合函数参数里，否则报错退出
+*/
+bool ast_is_aggregate_query(ast_node* ast_head);
+
+/**
+* @brief             把一块输入送入表达式中所有聚合函数的状态
+* @param   ast_head  聚合查询的 AST 根节点
+* @param   x         输入块
+* @param   n         行数
+*
+* @note              全部输入送完后用 evaluate_ast 求出最终结果，不需要保存整列数据
+*/
+void evaluate_ast_accumulate(ast_node* ast_head, const double* x, size_t n);
+
 #endif // !CALCULATOR_AST_H
@@ -0,0 +1,67 @@
+#ifndef CALCULATOR_FUNCTION_H
+#define CALCULATOR_FUNCTION_H
+
+#include <stddef.h>
+
+#include "token.h"
+
+// 函数表最大容量
+#define CALC_FUNC_MAX 64
+// 列求值时每块的行数，用户函数每块只调用一次
+#define CALC_BLOCK_SIZE 256
+// 插件导出的初始化函数名
+#define CALC_PLUGIN_INIT "calc_plugin_init"
+
+/*
+批量函数 ABI：in[i] 指向第 i 个参数的一列值，out 输出一列结果，n 为行数
+标量求值时 n 为 1，列求值时 n 最多为 CALC_BLOCK_SIZE，函数内部可以自由向量化
+定义域错误写入 NaN，由求值器统一报错
+*/
+typedef void (*calc_batch_fn)(const double **in, double *out, size_t n);
+
+// 函数表条目
+typedef struct calc_function {
+  char name[FUNC_MAX_CHAR];
+  int arity;
+  calc_batch_fn fn;
+} calc_function;
+
+// 注册函数指针类型，插件通过它注册自己的函数
+typedef int (*calc_register_fn)(const char *name, int arity, calc_batch_fn fn);
+
+/*
+插件约定：共享库导出
+  int calc_plugin_init(calc_register_fn register_fn);
+在其中调用 register_fn 注册函数，返回 0 表示成功
+*/
+typedef int (*calc_plugin_init_fn)(calc_register_fn register_fn);
+
+/**
+* @brief             注册一个批量函数，同名同参数个数的函数会被覆盖
+* @param   name      函数名，只能包含字母，长度小于 FUNC_MAX_CHAR
+* @param   arity     参数个数
+* @param   fn        批量回调
+* @return  int       成功返回 0，参数非法或函数表已满返回 -1
+*
+* @note              Revision History
+*/
+int calc_function_register(const char *name, int arity, calc_batch_fn fn);
+
+/**
+* @brief                   按函数名与参数个数查找
+* @return  calc_function*  找不到返回 NULL
+*
+* @note                    解析阶段查找一次并保存在 AST 节点中，求值时不再查表
+*/
+const calc_function *calc_function_find(const char *name, int arity);
+
+/**
+* @brief             dlopen 加载插件并调用其 calc_plugin_init 注册函数
+* @param   path      共享库路径
+* @return  int       成功返回 0，失败返回 -1
+*
+* @note              插件在进程生命周期内不会卸载
+*/
+int calc_function_load_plugin(const char *path);
+
+#endif // !CALCULATOR_FUNCTION_H
@@ -1,12 +1,44 @@
 #ifndef CALCULATOR_INPUT_H
 #define CALCULATOR_INPUT_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
+// 一行表达式的只读视图，指向读取器内部缓冲区或文件映射，不单独申请内存
+// 约定：ptr[len] 一定是 '\n'、'\r' 或 '\0'，词法分析器在这些字符处结束
+typedef struct {
+  const char *ptr;
+  size_t len;
+} input_view;
+
+// 输入读取器：普通文件 mmap 整体映射，管道/终端按大块对齐缓冲读取
+typedef struct input_reader input_reader;
+
+/**
+* @brief                  打开表达式输入源
+* @param   path           文件路径，NULL 或 "-" 表示标准输入
+* @return  input_reader*  返回读取器，失败返回 NULL，由调用者 input_reader_close 释放
+*
+* @note                   Revision History
+*/
+input_reader *input_reader_open(const char *path);
+
+/**
+* @brief             获取下一行非空表达式
+* @param   reader    读取器
+* @param   view      输出行视图，仅在下一次调用 input_reader_next 之前有效
+* @return  bool      成功返回 true，输入流结束返回 false
+*
+* @note              行长度不受限制，空行会被跳过
+*/
+bool input_reader_next(input_reader *reader, input_view *view);
+
 /**
-* @brief             获取 数据表达式的输入 
-* @return  char*     返回输入指针，堆内存由调用者手动 free
+* @brief             关闭读取器，解除映射并释放缓冲区
+* @param   reader    读取器
 *
 * @note              Revision History
 */
-char* get_input_expression();
+void input_reader_close(input_reader *reader);
 
-#endif // !CALCULATOR_INPUT_H
\ No newline at end of file
+#endif // !CALCULATOR_INPUT_H
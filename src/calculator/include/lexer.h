@@ -3,8 +3,19 @@
 
 #include "token.h"
 
+// 报错时引用的输入片段最多这么多个字符，避免把整个输入映射的剩余部分打进日志
+#define TOKEN_EXCERPT_MAX 32
+
 token get_next_token(const char **input);
 
+/**
+* @brief             报错时引用的输入片段长度，配合 "%.*s" 使用
+* @return  int       到行尾为止，不超过 TOKEN_EXCERPT_MAX
+*
+* @note              Revision History
+*/
+int token_excerpt_len(const char *input);
+
 void print_token(const token* t);
 
 #endif // !LEXER_LEXER_H
\ No newline at end of file
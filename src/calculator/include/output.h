@@ -0,0 +1,77 @@
+#ifndef CALCULATOR_OUTPUT_H
+#define CALCULATOR_OUTPUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// format_double 输出的最大长度（含末尾 '\0'）
+#define FMT_DOUBLE_MAX 32
+// 输出缓冲区默认大小
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+// 批量输出缓冲区，写满或显式 flush 时一次 write 系统调用
+typedef struct {
+  int fd;
+  bool line_flush; // 终端输出时每行刷新，保证交互可见
+  char *data;
+  size_t len;
+  size_t capacity;
+} output_buffer;
+
+/**
+* @brief             最短往返的 double 转字符串（Grisu2 算法）
+* @param   value     要格式化的值
+* @param   buf       调用者缓冲区，至少 FMT_DOUBLE_MAX 字节
+* @return  int       写入的字符数（不含末尾 '\0'）
+*
+* @note              输出经 strtod 可精确还原原值，整数不带小数点，过大过小的值使用 1.5e-7 形式
+*/
+int format_double(double value, char *buf);
+
+/**
+* @brief             初始化输出缓冲区
+* @param   out       输出缓冲区
+* @param   fd        目标文件描述符
+* @param   capacity  缓冲区大小
+* @return  bool      申请内存失败返回 false
+*
+* @note              Revision History
+*/
+bool output_init(output_buffer *out, int fd, size_t capacity);
+
+/**
+* @brief             追加任意字节，超过缓冲区大小的数据直接写出
+*
+* @note              Revision History
+*/
+void output_write(output_buffer *out, const char *data, size_t len);
+
+/**
+* @brief             追加一个 double 的最短表示
+*
+* @note              Revision History
+*/
+void output_double(output_buffer *out, double value);
+
+/**
+* @brief             一行结束，终端输出时立即刷新
+*
+* @note              Revision History
+*/
+void output_end_line(output_buffer *out);
+
+/**
+* @brief             把缓冲区内容一次 write 写出
+*
+* @note              Revision History
+*/
+void output_flush(output_buffer *out);
+
+/**
+* @brief             刷新并释放输出缓冲区
+*
+* @note              Revision History
+*/
+void output_free(output_buffer *out);
+
+#endif // !CALCULATOR_OUTPUT_H
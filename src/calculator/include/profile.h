@@ -0,0 +1,104 @@
+#ifndef CALCULATOR_PROFILE_H
+#define CALCULATOR_PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+// 直方图桶个数：第 i 个桶统计 [2^i, 2^(i+1)) 区间的样本
+#define PROF_HIST_BUCKETS 48
+
+// 流水线阶段：词法、语法、求值、释放
+typedef enum {
+  PROF_LEX,
+  PROF_PARSE,
+  PROF_EVAL,
+  PROF_FREE,
+  PROF_PHASE_MAX
+} prof_phase;
+
+// 常开计数器：节点创建数、堆内存申请次数
+typedef enum {
+  PROF_CNT_NODES,
+  PROF_CNT_MALLOCS,
+  PROF_CNT_MAX
+} prof_counter;
+
+// 全局开关，由 --profile 打开，关闭时计时宏只剩一次分支判断
+extern bool prof_enabled;
+// 当前表达式的计数器，计数器常开，只是一次自增
+extern uint64_t prof_counters[PROF_CNT_MAX];
+
+/**
+* @brief             读取时间戳计数器
+* @return  uint64_t  x86 下为 rdtsc 周期数，其他平台退化为单调时钟纳秒数
+*
+* @note              Revision History
+*/
+static inline uint64_t prof_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// 计时开始，未开启时不读取时钟
+#define PROF_BEGIN(start) uint64_t start = prof_enabled ? prof_cycles() : 0
+
+// 计时结束，累加到当前表达式的阶段耗时
+#define PROF_END(phase, start)                                                 \
+  do {                                                                         \
+    if (prof_enabled) {                                                        \
+      prof_add_cycles((phase), prof_cycles() - (start));                       \
+    }                                                                          \
+  } while (0)
+
+// 常开计数器自增
+#define PROF_COUNT(counter) (prof_counters[(counter)]++)
+
+/**
+* @brief             开启性能统计，并注册进程退出时的直方图打印
+*
+* @note              Revision History
+*/
+void prof_enable(void);
+
+/**
+* @brief             累加当前表达式某阶段的耗时
+* @param   phase     阶段
+* @param   cycles    本次耗时
+*
+* @note              词法分析在语法分析内部调用，语法阶段的耗时不包含词法阶段
+*/
+void prof_add_cycles(prof_phase phase, uint64_t cycles);
+
+/**
+* @brief             开始统计一个表达式，清空当前表达式的计数
+*
+* @note              Revision History
+*/
+void prof_expr_begin(void);
+
+/**
+* @brief             结束统计一个表达式，把各阶段耗时和计数写入直方图
+*
+* @note              Revision History
+*/
+void prof_expr_end(void);
+
+/**
+* @brief             打印各阶段与计数器的直方图到 stderr
+*
+* @note              Revision History
+*/
+void prof_report(void);
+
+#endif // !CALCULATOR_PROFILE_H
@@ -1,57 +1,209 @@
+#include <errno.h>
+#include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "input.h"
 #include "logfmt.h"
 
-#define MAX_IN 100
+// 管道/终端的块读取大小，也是缓冲区的对齐粒度
+#define INPUT_BLOCK_SIZE (1 << 20)
+#define INPUT_ALIGN 4096
+
+struct input_reader {
+  int fd;
+  bool interactive; // 终端输入，读取前打印提示符
+  bool mapped;      // 普通文件，data 为 mmap 映射
+  bool eof;         // 底层 fd 已读到结束
+  char *data;       // 映射区域或块缓冲区
+  size_t size;      // 映射长度或缓冲区有效数据长度
+  size_t capacity;  // 块缓冲区容量（不含末尾 '\0' 预留字节）
+  size_t pos;       // 下一行的起始偏移
+  char *tail;       // 映射文件最后一行恰好顶到页尾时的拷贝
+};
 
 /*
-清除缓冲区陷阱
+普通文件直接 mmap，行视图直接指向页缓存，整个文件零拷贝
+最后一行没有换行符时，若文件长度不是页大小整数倍，页内剩余字节由内核补 0 可直接作为结束符；
+否则只把最后这一行拷贝出来补 '\0'
 */
-void clear_input_buffer() {
-  int c = 0;
-  while ((c = getchar()) != '\n' && c != EOF);
+static bool reader_map(input_reader *reader) {
+  struct stat st;
+  if (fstat(reader->fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+    return false;
+  }
+
+  void *addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE,
+                    reader->fd, 0);
+  if (addr == MAP_FAILED) {
+    log_warn("mmap 映射失败，退化为块读取：%s", strerror(errno));
+    return false;
+  }
+  madvise(addr, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+  reader->mapped = true;
+  reader->data = addr;
+  reader->size = (size_t)st.st_size;
+  return true;
 }
 
-char *get_input_expression() {
+/*
+管道/终端按块读取：未处理完的半行搬到缓冲区头部，再接着读取下一块
+一行比整个缓冲区还长时缓冲区翻倍，因此行长度没有上限
+*/
+static bool reader_refill(input_reader *reader) {
+  // 搬移剩余的半行
+  size_t remain = reader->size - reader->pos;
+  if (remain > 0 && reader->pos > 0) {
+    memmove(reader->data, reader->data + reader->pos, remain);
+  }
+  reader->size = remain;
+  reader->pos = 0;
+
+  // 缓冲区已满，扩容为两倍
+  if (reader->size == reader->capacity) {
+    size_t capacity = reader->capacity * 2;
+    char *data = NULL;
+    if (posix_memalign((void **)&data, INPUT_ALIGN, capacity + 1) != 0) {
+      log_fatal("输入缓冲区扩容失败：%zu", capacity);
+      exit(1);
+    }
+    memcpy(data, reader->data, reader->size);
+    free(reader->data);
+    reader->data = data;
+    reader->capacity = capacity;
+  }
+
+  if (reader->interactive) {
+    printf("请输出一个要求值数学表达式：");
+    fflush(stdout);
+  }
 
-  // 申请堆内存
-  char *inputs = malloc(sizeof(char) * MAX_IN);
+  ssize_t n = 0;
+  do {
+    n = read(reader->fd, reader->data + reader->size,
+             reader->capacity - reader->size);
+  } while (n < 0 && errno == EINTR);
 
-  printf("请输出一个要求值数学表达式：");
+  if (n < 0) {
+    log_fatal("read 输入异常：%s", strerror(errno));
+    reader->eof = true;
+    return false;
+  }
+  if (n == 0) {
+    log_info("输入流 EOF 关闭输入.");
+    reader->eof = true;
+    return false;
+  }
+  reader->size += (size_t)n;
+  return true;
+}
 
-  while (true) {
-    // 获取输入
-    if (!fgets(inputs, sizeof(char) * MAX_IN, stdin)) {
-      if (feof(stdin)) {
-        log_error("输入流 EOF 关闭输入.\n");
-        clearerr(stdin);
-      } else {
-        log_fatal("fgets 输入 异常");
-      }
+input_reader *input_reader_open(const char *path) {
+  input_reader *reader = calloc(1, sizeof(input_reader));
+  if (!reader) {
+    return NULL;
+  }
 
-      clear_input_buffer();
-      continue;
+  if (!path || strcmp(path, "-") == 0) {
+    reader->fd = STDIN_FILENO;
+  } else {
+    reader->fd = open(path, O_RDONLY);
+    if (reader->fd < 0) {
+      log_error("打开输入文件失败 %s：%s", path, strerror(errno));
+      free(reader);
+      return NULL;
     }
+  }
+  reader->interactive = isatty(reader->fd);
+
+  if (!reader_map(reader)) {
+    // 多申请一个字节，最后一行没有换行符时补 '\0'
+    if (posix_memalign((void **)&reader->data, INPUT_ALIGN,
+                       INPUT_BLOCK_SIZE + 1) != 0) {
+      log_fatal("输入缓冲区申请失败");
+      if (reader->fd != STDIN_FILENO) {
+        close(reader->fd);
+      }
+      free(reader);
+      return NULL;
+    }
+    reader->capacity = INPUT_BLOCK_SIZE;
+  }
 
-    // 验证输入完整性
-    if (strchr(inputs, '\n') == NULL) {
-      log_warn("输入字符太长, 请重新输入.\n");
-      clear_input_buffer();
+  return reader;
+}
+
+bool input_reader_next(input_reader *reader, input_view *view) {
+  while (true) {
+    const char *start = reader->data + reader->pos;
+    size_t remain = reader->size - reader->pos;
+    // memchr 由 libc 向量化实现，按 16/32 字节一组查找换行符
+    const char *newline = remain ? memchr(start, '\n', remain) : NULL;
+    size_t len = 0;
+
+    if (newline) {
+      len = (size_t)(newline - start);
+      reader->pos += len + 1;
+    } else if (reader->mapped || reader->eof) {
+      // 没有换行符的最后一行
+      if (remain == 0) {
+        return false;
+      }
+      len = remain;
+      reader->pos = reader->size;
+      if (!reader->mapped) {
+        reader->data[reader->size] = '\0';
+      } else if (reader->size % (size_t)sysconf(_SC_PAGESIZE) == 0) {
+        reader->tail = malloc(len + 1);
+        // 与 read 失败相同，记录错误后按输入结束处理
+        if (!reader->tail) {
+          log_fatal("最后一行缓冲区申请失败：%zu", len + 1);
+          return false;
+        }
+        memcpy(reader->tail, start, len);
+        reader->tail[len] = '\0';
+        start = reader->tail;
+      }
+    } else {
+      // 不足一行，继续读取下一块
+      reader_refill(reader);
       continue;
     }
 
-    // 去掉最后的 \n 换行符
-    size_t len = strlen(inputs);
-    if (len > 0 && inputs[len - 1] == '\n') {
-      inputs[len - 1] = '\0';
+    // 兼容 \r\n 换行
+    if (len > 0 && start[len - 1] == '\r') {
       len--;
     }
-    log_info("输入的字符串为：%s", inputs);
-    
-    return inputs;
+    // 跳过空行
+    if (len == 0) {
+      continue;
+    }
+
+    view->ptr = start;
+    view->len = len;
+    log_info("输入的字符串为：%.*s", (int)len, start);
+    return true;
+  }
+}
+
+void input_reader_close(input_reader *reader) {
+  if (!reader) {
+    return;
+  }
+  if (reader->mapped) {
+    munmap(reader->data, reader->size);
+  } else {
+    free(reader->data);
   }
-}
\ No newline at end of file
+  free(reader->tail);
+  if (reader->fd != STDIN_FILENO) {
+    close(reader->fd);
+  }
+  free(reader);
+}
@@ -7,11 +7,12 @@
 #include "lexer.h"
 #include "token.h"
 #include "logfmt.h"
+#include "profile.h"
 
-token get_next_token(const char **input) {
+static token lexer_next_token(const char **input) {
 
-  // 跳过空字符
-  while (isspace(**input)) {
+  // 跳过空字符，换行符作为表达式结束符保留，行视图无需拷贝补 '\0'
+  while (isspace(**input) && **input != '\n' && **input != '\r') {
     (*input)++;
   }
 
@@ -22,7 +23,7 @@ token get_next_token(const char **input) {
       errno = 0;
       double num = strtod(*input, &endptr);
       if (errno == ERANGE) {
-        log_error("strol 数值转换异常：%s", *input);
+        log_error("strol 数值转换异常：%.*s", token_excerpt_len(*input), *input);
       }
       int len = (int)(endptr - *input);
       *input = endptr;
@@ -35,10 +36,14 @@ token get_next_token(const char **input) {
     token tok = {.token_type = TOK_FUNC};
     int i = 0;
     while (isalpha(**input)) {
-      tok.func_value[i++] = (**input); // *(*input)++
+      // 超长函数名截断保存，但仍完整消费，tok_length 用于回退
+      if (i < FUNC_MAX_CHAR - 1) {
+        tok.func_value[i] = (**input); // *(*input)++
+      }
+      i++;
       (*input)++;
     }
-    tok.func_value[i] = '\0';
+    tok.func_value[i < FUNC_MAX_CHAR ? i : FUNC_MAX_CHAR - 1] = '\0';
     tok.tok_length = i;
     return tok;
   }
@@ -66,6 +71,8 @@ token get_next_token(const char **input) {
   case ',':
     return (token){TOK_COMMA, .tok_length = 1};
   case '\0':
+  case '\n':
+  case '\r':
     return (token){TOK_END, .tok_length = 1};
   default:
     return (token){TOK_ERR, .tok_length = 1};
@@ -73,6 +80,22 @@ token get_next_token(const char **input) {
   
 }
 
+token get_next_token(const char **input) {
+  PROF_BEGIN(start);
+  token tok = lexer_next_token(input);
+  PROF_END(PROF_LEX, start);
+  return tok;
+}
+
+int token_excerpt_len(const char *input) {
+  int len = 0;
+  while (len < TOKEN_EXCERPT_MAX && input[len] != '\0' && input[len] != '\n' &&
+         input[len] != '\r') {
+    len++;
+  }
+  return len;
+}
+
 token_type peek_next_token(const char** inputs) {
   // 保存原始指针位置
   const char* original = *inputs;
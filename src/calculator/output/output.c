@@ -0,0 +1,388 @@
+/*
+double 最短往返格式化采用 Grisu2 算法（Florian Loitsch, "Printing Floating-Point Numbers Quickly and
+Accurately with Integers", PLDI 2010），实现参考 Milo Yip 的 dtoa
+- 把 double 拆成 64 位尾数 f 和二进制指数 e，求出相邻两个 double 的中点边界 m- 与 m+
+- 乘以预先计算好的 10^-k 缓存幂，把指数缩放到 [-60, -32]，此后只需 64 位整数运算
+- 在 [m-, m+] 区间内逐位生成十进制数字，区间足够窄时停止，得到的数字串 strtod 可精确还原
+- 绝大多数输入得到最短表示，极少数情况多出一位，但始终可往返
+*/
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logfmt.h"
+#include "output.h"
+
+#define DP_SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFull
+#define DP_EXPONENT_MASK 0x7FF0000000000000ull
+#define DP_HIDDEN_BIT 0x0010000000000000ull
+#define DP_SIGNIFICAND_SIZE 52
+#define DP_EXPONENT_BIAS (0x3FF + DP_SIGNIFICAND_SIZE)
+#define DP_MIN_EXPONENT (-DP_EXPONENT_BIAS)
+
+// 64 位尾数 + 二进制指数，值为 f * 2^e
+typedef struct {
+  uint64_t f;
+  int e;
+} diy_fp;
+
+// 10^k 的归一化近似值，k 从 -348 到 340，步长 8
+static const uint64_t cached_powers_f[] = {
+    0xfa8fd5a0081c0288ull, 0xbaaee17fa23ebf76ull, 0x8b16fb203055ac76ull,
+    0xcf42894a5dce35eaull, 0x9a6bb0aa55653b2dull, 0xe61acf033d1a45dfull,
+    0xab70fe17c79ac6caull, 0xff77b1fcbebcdc4full, 0xbe5691ef416bd60cull,
+    0x8dd01fad907ffc3cull, 0xd3515c2831559a83ull, 0x9d71ac8fada6c9b5ull,
+    0xea9c227723ee8bcbull, 0xaecc49914078536dull, 0x823c12795db6ce57ull,
+    0xc21094364dfb5637ull, 0x9096ea6f3848984full, 0xd77485cb25823ac7ull,
+    0xa086cfcd97bf97f4ull, 0xef340a98172aace5ull, 0xb23867fb2a35b28eull,
+    0x84c8d4dfd2c63f3bull, 0xc5dd44271ad3cdbaull, 0x936b9fcebb25c996ull,
+    0xdbac6c247d62a584ull, 0xa3ab66580d5fdaf6ull, 0xf3e2f893dec3f126ull,
+    0xb5b5ada8aaff80b8ull, 0x87625f056c7c4a8bull, 0xc9bcff6034c13053ull,
+    0x964e858c91ba2655ull, 0xdff9772470297ebdull, 0xa6dfbd9fb8e5b88full,
+    0xf8a95fcf88747d94ull, 0xb94470938fa89bcfull, 0x8a08f0f8bf0f156bull,
+    0xcdb02555653131b6ull, 0x993fe2c6d07b7facull, 0xe45c10c42a2b3b06ull,
+    0xaa242499697392d3ull, 0xfd87b5f28300ca0eull, 0xbce5086492111aebull,
+    0x8cbccc096f5088ccull, 0xd1b71758e219652cull, 0x9c40000000000000ull,
+    0xe8d4a51000000000ull, 0xad78ebc5ac620000ull, 0x813f3978f8940984ull,
+    0xc097ce7bc90715b3ull, 0x8f7e32ce7bea5c70ull, 0xd5d238a4abe98068ull,
+    0x9f4f2726179a2245ull, 0xed63a231d4c4fb27ull, 0xb0de65388cc8ada8ull,
+    0x83c7088e1aab65dbull, 0xc45d1df942711d9aull, 0x924d692ca61be758ull,
+    0xda01ee641a708deaull, 0xa26da3999aef774aull, 0xf209787bb47d6b85ull,
+    0xb454e4a179dd1877ull, 0x865b86925b9bc5c2ull, 0xc83553c5c8965d3dull,
+    0x952ab45cfa97a0b3ull, 0xde469fbd99a05fe3ull, 0xa59bc234db398c25ull,
+    0xf6c69a72a3989f5cull, 0xb7dcbf5354e9beceull, 0x88fcf317f22241e2ull,
+    0xcc20ce9bd35c78a5ull, 0x98165af37b2153dfull, 0xe2a0b5dc971f303aull,
+    0xa8d9d1535ce3b396ull, 0xfb9b7cd9a4a7443cull, 0xbb764c4ca7a44410ull,
+    0x8bab8eefb6409c1aull, 0xd01fef10a657842cull, 0x9b10a4e5e9913129ull,
+    0xe7109bfba19c0c9dull, 0xac2820d9623bf429ull, 0x80444b5e7aa7cf85ull,
+    0xbf21e44003acdd2dull, 0x8e679c2f5e44ff8full, 0xd433179d9c8cb841ull,
+    0x9e19db92b4e31ba9ull, 0xeb96bf6ebadf77d9ull, 0xaf87023b9bf0ee6bull,
+};
+static const int16_t cached_powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+static const uint64_t pow10_u64[] = {1ull,
+                                     10ull,
+                                     100ull,
+                                     1000ull,
+                                     10000ull,
+                                     100000ull,
+                                     1000000ull,
+                                     10000000ull,
+                                     100000000ull,
+                                     1000000000ull,
+                                     10000000000ull,
+                                     100000000000ull,
+                                     1000000000000ull,
+                                     10000000000000ull,
+                                     100000000000000ull,
+                                     1000000000000000ull,
+                                     10000000000000000ull,
+                                     100000000000000000ull,
+                                     1000000000000000000ull,
+                                     10000000000000000000ull};
+
+static diy_fp diy_fp_from_double(double value) {
+  uint64_t u = 0;
+  memcpy(&u, &value, sizeof(u));
+  int biased_e = (int)((u & DP_EXPONENT_MASK) >> DP_SIGNIFICAND_SIZE);
+  uint64_t significand = u & DP_SIGNIFICAND_MASK;
+  // 非规格化数没有隐藏位
+  if (biased_e != 0) {
+    return (diy_fp){significand + DP_HIDDEN_BIT, biased_e - DP_EXPONENT_BIAS};
+  }
+  return (diy_fp){significand, DP_MIN_EXPONENT + 1};
+}
+
+static diy_fp diy_fp_mul(diy_fp a, diy_fp b) {
+  // 128 位乘积取高 64 位并四舍五入
+  unsigned __int128 p = (unsigned __int128)a.f * b.f;
+  uint64_t h = (uint64_t)(p >> 64);
+  uint64_t l = (uint64_t)p;
+  if (l & (1ull << 63)) {
+    h++;
+  }
+  return (diy_fp){h, a.e + b.e + 64};
+}
+
+static diy_fp diy_fp_normalize(diy_fp x) {
+  int s = __builtin_clzll(x.f);
+  return (diy_fp){x.f << s, x.e - s};
+}
+
+// 计算 m- 与 m+ 两个边界，并归一化到同一指数
+static void normalized_boundaries(diy_fp v, diy_fp *minus, diy_fp *plus) {
+  diy_fp pl = {(v.f << 1) + 1, v.e - 1};
+  while (!(pl.f & (DP_HIDDEN_BIT << 1))) {
+    pl.f <<= 1;
+    pl.e--;
+  }
+  pl.f <<= 64 - DP_SIGNIFICAND_SIZE - 2;
+  pl.e -= 64 - DP_SIGNIFICAND_SIZE - 2;
+
+  // 尾数恰为 2 的幂时，下边界距离只有上边界的一半
+  diy_fp mi = (v.f == DP_HIDDEN_BIT) ? (diy_fp){(v.f << 2) - 1, v.e - 2}
+                                     : (diy_fp){(v.f << 1) - 1, v.e - 1};
+  mi.f <<= mi.e - pl.e;
+  mi.e = pl.e;
+
+  *minus = mi;
+  *plus = pl;
+}
+
+// 选取 10^-K 使乘积的二进制指数落在 [-60, -32]
+static diy_fp get_cached_power(int e, int *K) {
+  double dk = (-61 - e) * 0.30102999566398114 + 347;
+  int k = (int)dk;
+  if (dk - k > 0.0) {
+    k++;
+  }
+  unsigned index = (unsigned)((k >> 3) + 1);
+  *K = -(-348 + (int)(index << 3));
+  return (diy_fp){cached_powers_f[index], cached_powers_e[index]};
+}
+
+// 在安全区间内把最后一位向真实值靠近
+static void grisu_round(char *buffer, int len, uint64_t delta, uint64_t rest,
+                        uint64_t ten_kappa, uint64_t wp_w) {
+  while (rest < wp_w && delta - rest >= ten_kappa &&
+         (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+    buffer[len - 1]--;
+    rest += ten_kappa;
+  }
+}
+
+static int count_decimal_digit32(uint32_t n) {
+  int digits = 1;
+  while (digits < 10 && n >= pow10_u64[digits]) {
+    digits++;
+  }
+  return digits;
+}
+
+// 逐位生成 Mp 的十进制数字，误差 delta 内即可停止
+static void digit_gen(diy_fp W, diy_fp Mp, uint64_t delta, char *buffer,
+                      int *len, int *K) {
+  const diy_fp one = {1ull << -Mp.e, Mp.e};
+  const uint64_t wp_w = Mp.f - W.f;
+  uint32_t p1 = (uint32_t)(Mp.f >> -one.e);
+  uint64_t p2 = Mp.f & (one.f - 1);
+  int kappa = count_decimal_digit32(p1);
+  *len = 0;
+
+  // 整数部分
+  while (kappa > 0) {
+    uint32_t div = (uint32_t)pow10_u64[kappa - 1];
+    uint32_t d = p1 / div;
+    p1 %= div;
+    if (d || *len) {
+      buffer[(*len)++] = (char)('0' + d);
+    }
+    kappa--;
+    uint64_t tmp = ((uint64_t)p1 << -one.e) + p2;
+    if (tmp <= delta) {
+      *K += kappa;
+      grisu_round(buffer, *len, delta, tmp, pow10_u64[kappa] << -one.e, wp_w);
+      return;
+    }
+  }
+
+  // 小数部分
+  for (;;) {
+    p2 *= 10;
+    delta *= 10;
+    char d = (char)(p2 >> -one.e);
+    if (d || *len) {
+      buffer[(*len)++] = (char)('0' + d);
+    }
+    p2 &= one.f - 1;
+    kappa--;
+    if (p2 < delta) {
+      *K += kappa;
+      int index = -kappa;
+      grisu_round(buffer, *len, delta, p2, one.f,
+                  wp_w * (index < 20 ? pow10_u64[index] : 0));
+      return;
+    }
+  }
+}
+
+// 生成数字串 buffer 和十进制指数 K，值为 buffer * 10^K
+static void grisu2(double value, char *buffer, int *len, int *K) {
+  const diy_fp v = diy_fp_from_double(value);
+  diy_fp w_m, w_p;
+  normalized_boundaries(v, &w_m, &w_p);
+
+  const diy_fp c_mk = get_cached_power(w_p.e, K);
+  const diy_fp W = diy_fp_mul(diy_fp_normalize(v), c_mk);
+  diy_fp Wp = diy_fp_mul(w_p, c_mk);
+  diy_fp Wm = diy_fp_mul(w_m, c_mk);
+  // 乘法引入的误差各收缩 1 ulp
+  Wm.f++;
+  Wp.f--;
+  digit_gen(W, Wp, Wp.f - Wm.f, buffer, len, K);
+}
+
+static int write_exponent(int k, char *buf) {
+  char *p = buf;
+  if (k < 0) {
+    *p++ = '-';
+    k = -k;
+  }
+  if (k >= 100) {
+    *p++ = (char)('0' + k / 100);
+    k %= 100;
+    *p++ = (char)('0' + k / 10);
+    *p++ = (char)('0' + k % 10);
+  } else if (k >= 10) {
+    *p++ = (char)('0' + k / 10);
+    *p++ = (char)('0' + k % 10);
+  } else {
+    *p++ = (char)('0' + k);
+  }
+  return (int)(p - buf);
+}
+
+// 根据十进制指数选择定点或科学计数法
+static int prettify(char *buf, int len, int k) {
+  // 10^(kk-1) <= v < 10^kk
+  const int kk = len + k;
+
+  if (k >= 0 && kk <= 21) {
+    // 整数：1234e3 -> 1234000
+    memset(buf + len, '0', (size_t)k);
+    return kk;
+  }
+  if (kk > 0 && kk <= 21) {
+    // 1234e-2 -> 12.34
+    memmove(buf + kk + 1, buf + kk, (size_t)(len - kk));
+    buf[kk] = '.';
+    return len + 1;
+  }
+  if (kk > -6 && kk <= 0) {
+    // 1234e-6 -> 0.001234
+    const int offset = 2 - kk;
+    memmove(buf + offset, buf, (size_t)len);
+    buf[0] = '0';
+    buf[1] = '.';
+    memset(buf + 2, '0', (size_t)(offset - 2));
+    return len + offset;
+  }
+  if (len == 1) {
+    // 1e30
+    buf[1] = 'e';
+    return 2 + write_exponent(kk - 1, buf + 2);
+  }
+  // 1234e30 -> 1.234e33
+  memmove(buf + 2, buf + 1, (size_t)(len - 1));
+  buf[1] = '.';
+  buf[len + 1] = 'e';
+  return len + 2 + write_exponent(kk - 1, buf + len + 2);
+}
+
+int format_double(double value, char *buf) {
+  char *p = buf;
+  uint64_t u = 0;
+  memcpy(&u, &value, sizeof(u));
+
+  if ((u & DP_EXPONENT_MASK) == DP_EXPONENT_MASK) {
+    // NaN 与正负无穷
+    const char *special = (u & DP_SIGNIFICAND_MASK) ? "nan"
+                          : (u >> 63)               ? "-inf"
+                                                    : "inf";
+    size_t n = strlen(special);
+    memcpy(buf, special, n + 1);
+    return (int)n;
+  }
+  if (u >> 63) {
+    *p++ = '-';
+    value = -value;
+  }
+  if (value == 0) {
+    *p++ = '0';
+    *p = '\0';
+    return (int)(p - buf);
+  }
+
+  int len = 0, K = 0;
+  grisu2(value, p, &len, &K);
+  p += prettify(p, len, K);
+  *p = '\0';
+  return (int)(p - buf);
+}
+
+static void write_all(int fd, const char *data, size_t len) {
+  while (len > 0) {
+    ssize_t n = write(fd, data, len);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      log_error("输出 write 异常：%s", strerror(errno));
+      return;
+    }
+    data += n;
+    len -= (size_t)n;
+  }
+}
+
+bool output_init(output_buffer *out, int fd, size_t capacity) {
+  out->fd = fd;
+  out->line_flush = isatty(fd);
+  out->len = 0;
+  out->capacity = capacity;
+  out->data = malloc(capacity);
+  return out->data != NULL;
+}
+
+void output_write(output_buffer *out, const char *data, size_t len) {
+  if (out->len + len > out->capacity) {
+    output_flush(out);
+    // 超大数据不经过缓冲区
+    if (len > out->capacity) {
+      write_all(out->fd, data, len);
+      return;
+    }
+  }
+  memcpy(out->data + out->len, data, len);
+  out->len += len;
+}
+
+void output_double(output_buffer *out, double value) {
+  if (out->len + FMT_DOUBLE_MAX > out->capacity) {
+    output_flush(out);
+  }
+  out->len += (size_t)format_double(value, out->data + out->len);
+}
+
+void output_end_line(output_buffer *out) {
+  output_write(out, "\n", 1);
+  if (out->line_flush) {
+    output_flush(out);
+  }
+}
+
+void output_flush(output_buffer *out) {
+  if (out->len > 0) {
+    write_all(out->fd, out->data, out->len);
+    out->len = 0;
+  }
+}
+
+void output_free(output_buffer *out) {
+  output_flush(out);
+  free(out->data);
+  out->data = NULL;
+}
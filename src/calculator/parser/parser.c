@@ -19,6 +19,8 @@ arguments → expression { ',' expression } // 参数列表
 #include <stdlib.h>
 #include <string.h>
 
+#include "aggregate.h"
+#include "function.h"
 #include "logfmt.h"
 #include "lexer.h"
 #include "token.h"
@@ -32,6 +34,7 @@ double parser_factor(const char **input);
 double parser_base(const char **input);
 double parser_function_call(const char **input);
 double parser_arguments(const char **input, double *args_values);
+double parser_aggregate_arguments(const char **input, const calc_aggregate *agg);
 
 // expression → term { ('+' | '-') term } // 加减运算（左结合）
 double parser_expression(const char **input) {
@@ -74,7 +77,7 @@ double parser_term(const char **input) {
     } else if (right != 0) {
       left /= right;
     } else {
-      log_fatal("被除数不能为 0 : %s", *input);        
+      log_fatal("被除数不能为 0 : %.*s", token_excerpt_len(*input), *input);        
       exit(1);
     }
 
@@ -119,14 +122,14 @@ double parser_factor(const char **input) {
       // 判断 base 是否为整数
       int fact = (int)base_value;
       if (fact < 0 || fact != base_value) {
-        log_fatal("获取的阶乘 base 不为整数：%s", *input);    
+        log_fatal("获取的阶乘 base 不为整数：%.*s", token_excerpt_len(*input), *input);    
         exit(1);
       }
       // 计算阶乘
       int fact_value = 1;
       for (int i = 1; i <= fact; i++) {
         if (fact_value > INT_MAX / i) {
-          log_fatal("阶乘结果大于 int 类型最大值：%s", *input);
+          log_fatal("阶乘结果大于 int 类型最大值：%.*s", token_excerpt_len(*input), *input);
           exit(1);
         }
         fact_value *= i;
@@ -168,7 +171,7 @@ double parser_base(const char **input) {
     double expr_value = parser_expression(input);
     // 获取下一个字符，判断是否右括号 )
     if (get_next_token(input).token_type != TOK_RPAREN) {
-      log_fatal("右获取缺失括号不匹配：%s", *input);        
+      log_fatal("右获取缺失括号不匹配：%.*s", token_excerpt_len(*input), *input);        
       exit(1);
     }
     return expr_value;
@@ -183,7 +186,7 @@ double parser_base(const char **input) {
     return function_value;
   }
 
-  log_fatal("未知的 base 项：%s", *input);
+  log_fatal("未知的 base 项：%.*s", token_excerpt_len(*input), *input);
   exit(1);
 }
 
@@ -200,47 +203,46 @@ double parser_function_call(const char **input) {
   // 处理 () 括号里的内容 先判断 括号
   // 判断是否括号，先判断左括号 (
   if (get_next_token(input).token_type != TOK_LPAREN) {
-    log_fatal("函数左括号匹配失败：%s", *input);
+    log_fatal("函数左括号匹配失败：%.*s", token_excerpt_len(*input), *input);
     exit(1);
   }
 
+  // 聚合函数参数个数不限，边解析边送入状态
+  const calc_aggregate *agg = calc_aggregate_find(func_name);
+  if (agg) {
+    double value = parser_aggregate_arguments(input, agg);
+    if (get_next_token(input).token_type != TOK_RPAREN) {
+      log_fatal("函数右括号匹配失败：%.*s", token_excerpt_len(*input), *input);
+      exit(1);
+    }
+    return value;
+  }
+
   // 调用解析表达式计算
   double args_values[FUNC_ARGS_MAX];
   // 解析计算参数列表
   double args_number = parser_arguments(input, args_values);
   // 获取下一个字符，判断是否右括号 )
   if (get_next_token(input).token_type != TOK_RPAREN) {
-    log_fatal("函数右括号匹配失败：%s", *input);
+    log_fatal("函数右括号匹配失败：%.*s", token_excerpt_len(*input), *input);
     exit(1);
   }
 
-  // 根据参数个数调用函数 参数为 1 个
-  if (args_number == 1) {
-    // 判断函数类型，调用函数
-    if (strcmp(func_name, "sin") == 0) {
-      return sin(args_values[0]);
-    }
-    if (strcmp(func_name, "cos") == 0) {
-      return cos(args_values[0]);
-    }
-    if (strcmp(func_name, "tan") == 0) {
-      return tan(args_values[0]);
-    }
-    if (strcmp(func_name, "sqrt") == 0) {
-      return sqrt(args_values[0]);
+  // 从函数表查找并以行数为 1 调用批量函数
+  const calc_function *func = calc_function_find(func_name, (int)args_number);
+  if (func) {
+    const double *in[FUNC_ARGS_MAX];
+    for (int i = 0; i < (int)args_number; i++) {
+      in[i] = &args_values[i];
     }
-    if (strcmp(func_name, "log") == 0 && args_values[0] >= 0) {
-      return log(args_values[0]);
-    }
-  }
-  // 根据参数个数调用函数 参数为 2 个
-  if (args_number == 2) {
-    if (strcmp(func_name, "pow") == 0 && !isnan(pow(args_values[0], args_values[1]))) {
-      return pow(args_values[0], args_values[1]);
+    double value = 0;
+    func->fn(in, &value, 1);
+    if (!isnan(value)) {
+      return value;
     }
   }
 
-  log_fatal("未知的函数匹配失败：%s", *input);
+  log_fatal("未知的函数匹配失败：%.*s", token_excerpt_len(*input), *input);
   exit(1);
 }
 
@@ -257,7 +259,7 @@ double parser_arguments(const char **input, double *args_values) {
   while (tok.token_type != TOK_RPAREN) {
     // 参数个数判断
     if (current_arg > FUNC_ARGS_MAX - 1) {
-      log_fatal("函数参数超出了最大个数：%s", *input);
+      log_fatal("函数参数超出了最大个数：%.*s", token_excerpt_len(*input), *input);
       exit(1);
     }
     // 解析计算第 n 个参数，添加到 参数列表
@@ -266,7 +268,7 @@ double parser_arguments(const char **input, double *args_values) {
     tok = get_next_token(input);
 
     if (tok.token_type != TOK_COMMA && tok.token_type != TOK_RPAREN) {
-      log_fatal("函数参数匹配失败非逗号非右括号项：%s", *input);
+      log_fatal("函数参数匹配失败非逗号非右括号项：%.*s", token_excerpt_len(*input), *input);
       exit(1);
     }
   }
@@ -278,12 +280,56 @@ double parser_arguments(const char **input, double *args_values) {
   return current_arg;
 }
 
+// 聚合函数的参数列表：参数逐个求值，攒满一块送入状态，参数再多也不占额外内存
+double parser_aggregate_arguments(const char **input, const calc_aggregate *agg) {
+  calc_aggregate_state state;
+  calc_aggregate_init(&state, agg);
+  double values[CALC_BLOCK_SIZE];
+  size_t n = 0;
+  // quantile 的第一个参数为分位点
+  bool want_p = agg->kind == AGG_QUANTILE;
+  double p = 0;
+
+  token tok = get_next_token(input);
+  *input -= tok.tok_length;
+  while (tok.token_type != TOK_RPAREN) {
+    double value = parser_expression(input);
+    if (want_p) {
+      p = value;
+      want_p = false;
+    } else {
+      values[n++] = value;
+    }
+    tok = get_next_token(input);
+    if (tok.token_type != TOK_COMMA && tok.token_type != TOK_RPAREN) {
+      log_fatal("函数参数匹配失败非逗号非右括号项：%.*s", token_excerpt_len(*input), *input);
+      exit(1);
+    }
+    if (n == CALC_BLOCK_SIZE || (tok.token_type == TOK_RPAREN && n > 0)) {
+      if (!calc_aggregate_add(&state, values, n)) {
+        log_fatal("聚合函数申请内存失败：%s", agg->name);
+        exit(1);
+      }
+      n = 0;
+    }
+  }
+  *input -= tok.tok_length;
+
+  if (agg->kind == AGG_QUANTILE && !(p >= 0 && p <= 1)) {
+    log_fatal("分位点超出 [0, 1]：%f", p);
+    exit(1);
+  }
+  double result = calc_aggregate_result(&state, p);
+  calc_aggregate_free(&state);
+  return result;
+}
+
 double evaluate_expression(const char *expr) {
 
   double result = parser_expression(&expr);
   // 判断是否解析完成
   if (get_next_token(&expr).token_type != TOK_END) {
-    log_error("解析未完成，但已结束：%s", &expr);
+    log_error("解析未完成，但已结束：%.*s", token_excerpt_len(expr), expr);
     exit(1);
   }
 
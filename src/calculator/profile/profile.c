@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "profile.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PROF_UNIT "cycles"
+#else
+#define PROF_UNIT "ns"
+#endif
+
+// 直方图打印的最大宽度
+#define PROF_BAR_WIDTH 40
+
+// 单个指标的汇总与 log2 直方图
+typedef struct {
+  uint64_t samples;
+  uint64_t total;
+  uint64_t max;
+  uint64_t hist[PROF_HIST_BUCKETS];
+} prof_stat;
+
+bool prof_enabled = false;
+uint64_t prof_counters[PROF_CNT_MAX];
+
+// 当前表达式各阶段的累计耗时
+static uint64_t expr_cycles[PROF_PHASE_MAX];
+// 每个表达式一个样本的统计
+static prof_stat phase_stats[PROF_PHASE_MAX];
+static prof_stat counter_stats[PROF_CNT_MAX];
+
+static const char *phase_names[PROF_PHASE_MAX] = {
+    "lex (get_next_token)", "parse (parser_to_ast)", "eval (evaluate_ast)",
+    "free (ast_tree_free)"};
+static const char *counter_names[PROF_CNT_MAX] = {"ast nodes", "mallocs"};
+
+static int log2_bucket(uint64_t value) {
+  // 0 和 1 都落在第 0 个桶
+  if (value < 2) {
+    return 0;
+  }
+  int bucket = 63 - __builtin_clzll(value);
+  return bucket < PROF_HIST_BUCKETS ? bucket : PROF_HIST_BUCKETS - 1;
+}
+
+static void stat_add(prof_stat *stat, uint64_t value) {
+  stat->samples++;
+  stat->total += value;
+  if (value > stat->max) {
+    stat->max = value;
+  }
+  stat->hist[log2_bucket(value)]++;
+}
+
+static void stat_print(const char *name, const char *unit,
+                       const prof_stat *stat) {
+  if (stat->samples == 0) {
+    return;
+  }
+  fprintf(stderr, "%s: samples=%llu avg=%.1f max=%llu total=%llu %s\n", name,
+          (unsigned long long)stat->samples,
+          (double)stat->total / (double)stat->samples,
+          (unsigned long long)stat->max, (unsigned long long)stat->total,
+          unit);
+
+  uint64_t peak = 0;
+  for (int i = 0; i < PROF_HIST_BUCKETS; i++) {
+    if (stat->hist[i] > peak) {
+      peak = stat->hist[i];
+    }
+  }
+  for (int i = 0; i < PROF_HIST_BUCKETS; i++) {
+    if (stat->hist[i] == 0) {
+      continue;
+    }
+    int width = (int)(stat->hist[i] * PROF_BAR_WIDTH / peak);
+    char bar[PROF_BAR_WIDTH + 1];
+    memset(bar, '#', (size_t)width);
+    bar[width] = '\0';
+    fprintf(stderr, "  [%12llu, %12llu) %10llu %s\n",
+            i == 0 ? 0ull : 1ull << i, 1ull << (i + 1),
+            (unsigned long long)stat->hist[i], bar);
+  }
+}
+
+void prof_enable(void) {
+  if (!prof_enabled) {
+    prof_enabled = true;
+    atexit(prof_report);
+  }
+}
+
+void prof_add_cycles(prof_phase phase, uint64_t cycles) {
+  expr_cycles[phase] += cycles;
+}
+
+void prof_expr_begin(void) {
+  memset(expr_cycles, 0, sizeof(expr_cycles));
+  memset(prof_counters, 0, sizeof(prof_counters));
+}
+
+void prof_expr_end(void) {
+  if (!prof_enabled) {
+    return;
+  }
+  // 词法分析嵌套在语法分析中调用，扣除后得到语法分析自身耗时
+  if (expr_cycles[PROF_PARSE] >= expr_cycles[PROF_LEX]) {
+    expr_cycles[PROF_PARSE] -= expr_cycles[PROF_LEX];
+  }
+  for (int i = 0; i < PROF_PHASE_MAX; i++) {
+    stat_add(&phase_stats[i], expr_cycles[i]);
+  }
+  for (int i = 0; i < PROF_CNT_MAX; i++) {
+    stat_add(&counter_stats[i], prof_counters[i]);
+  }
+}
+
+void prof_report(void) {
+  fprintf(stderr, "\n==== calculator profile (per expression) ====\n");
+  for (int i = 0; i < PROF_PHASE_MAX; i++) {
+    stat_print(phase_names[i], PROF_UNIT, &phase_stats[i]);
+  }
+  for (int i = 0; i < PROF_CNT_MAX; i++) {
+    stat_print(counter_names[i], "", &counter_stats[i]);
+  }
+}
@@ -0,0 +1,96 @@
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "output.h"
+
+static double elapsed_seconds(struct timespec start) {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (double)(end.tv_sec - start.tv_sec) +
+         (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// format_double 的输出经 strtod 还原应与原值逐位相同：count 个随机位模式（跳过 NaN 与无穷）
+int format_roundtrip_test(long count) {
+  uint64_t state = 42;
+  long mismatches = 0;
+  char buf[FMT_DOUBLE_MAX];
+  for (long i = 0; i < count; i++) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint64_t bits = state ^ (state >> 29);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    if (value != value || value - value != 0) {
+      continue;
+    }
+    format_double(value, buf);
+    double back = strtod(buf, NULL);
+    if (memcmp(&back, &value, sizeof(value)) != 0) {
+      if (mismatches++ < 10) {
+        printf("mismatch: %.17g -> %s\n", value, buf);
+      }
+    }
+  }
+  printf("format_double 往返 %ld 个随机位模式，不一致 %ld 个\n", count, mismatches);
+  return mismatches != 0;
+}
+
+// 测试结果格式化吞吐：printf("%f") 与 format_double + 批量 write 对比
+int format_bench(long count) {
+  FILE *null_fp = fopen("/dev/null", "w");
+  int null_fd = open("/dev/null", O_WRONLY);
+  if (!null_fp || null_fd < 0) {
+    return 1;
+  }
+
+  // 伪随机的计算结果，覆盖整数、小数与大小指数
+  double *values = malloc(sizeof(double) * 1024);
+  unsigned seed = 12345;
+  for (int i = 0; i < 1024; i++) {
+    seed = seed * 1103515245 + 12345;
+    values[i] = (double)(seed % 100000) / ((seed >> 8) % 1000 + 1) *
+                ((i % 7 == 0) ? 1e-9 : (i % 5 == 0) ? 1e12 : 1.0);
+  }
+
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long i = 0; i < count; i++) {
+    fprintf(null_fp, "%f\n", values[i & 1023]);
+  }
+  double printf_secs = elapsed_seconds(start);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long i = 0; i < count; i++) {
+    fprintf(null_fp, "%.17g\n", values[i & 1023]);
+  }
+  double printf17_secs = elapsed_seconds(start);
+
+  output_buffer out;
+  output_init(&out, null_fd, OUTPUT_BUFFER_SIZE);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long i = 0; i < count; i++) {
+    output_double(&out, values[i & 1023]);
+    output_write(&out, "\n", 1);
+  }
+  output_flush(&out);
+  double grisu_secs = elapsed_seconds(start);
+  output_free(&out);
+
+  printf("格式化 %ld 个结果：\n", count);
+  printf("printf %%f     : %.3f s, %.1f M results/s\n", printf_secs,
+         count / printf_secs / 1e6);
+  printf("printf %%.17g  : %.3f s, %.1f M results/s\n", printf17_secs,
+         count / printf17_secs / 1e6);
+  printf("format_double : %.3f s, %.1f M results/s\n", grisu_secs,
+         count / grisu_secs / 1e6);
+
+  free(values);
+  fclose(null_fp);
+  close(null_fd);
+  return 0;
+}
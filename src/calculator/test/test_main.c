@@ -0,0 +1,36 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 各测试文件中的测试入口，返回失败个数
+int format_roundtrip_test(long count);
+int format_bench(long count);
+int aggregate_test(void);
+
+static void usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s <command> [count]\n"
+          "  format-roundtrip [count]  format_double 输出经 strtod 还原，随机位模式\n"
+          "  format-bench [count]      printf 与 format_double 格式化吞吐对比\n"
+          "  aggregate                 聚合函数的单线程、分段合并与两个解析器的结果\n",
+          name);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    usage(argv[0]);
+    return 2;
+  }
+  long count = argc > 2 ? strtol(argv[2], NULL, 10) : 0;
+  if (strcmp(argv[1], "format-roundtrip") == 0) {
+    return format_roundtrip_test(count > 0 ? count : 3000000) != 0;
+  }
+  if (strcmp(argv[1], "format-bench") == 0) {
+    return format_bench(count > 0 ? count : 10000000) != 0;
+  }
+  if (strcmp(argv[1], "aggregate") == 0) {
+    return aggregate_test() != 0;
+  }
+  usage(argv[0]);
+  return 2;
+}
@@ -1,8 +1,14 @@
+#include "aggregate.h"
+#include "ast.h"
 #include "lexer.h"
 #include "parser.h"
 #include "token.h"
 
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 void token_test() {
   char *ch = "-2034 + -4.5 * 8 % 10 + sin(10) + 5!";
@@ -27,3 +33,114 @@ void parser_test() {
     printf("%s = %f\n", expressions[i], evaluate_expression(expressions[i]));
   }
 }
+
+// 每个线程聚合输入的一段
+typedef struct {
+  const double *values;
+  size_t count;
+  calc_aggregate_state state;
+} aggregate_slice;
+
+static void *aggregate_slice_run(void *arg) {
+  aggregate_slice *slice = arg;
+  calc_aggregate_add(&slice->state, slice->values, slice->count);
+  return NULL;
+}
+
+// 多线程分段聚合再合并：输入是 1e6 .. 1e6 + COUNT - 1 的一个排列，单线程与合并后的结果都与已知值比较；
+// 再用两个解析器各算一遍参数个数超过普通函数上限的聚合表达式，返回失败个数
+int aggregate_test() {
+  enum { COUNT = 1000000, THREADS = 4 };
+  double *values = malloc(COUNT * sizeof(double));
+  for (size_t i = 0; i < COUNT; i++) {
+    // 2654435761 与 COUNT 互素，i 乘它再取模是 [0, COUNT) 的一个排列
+    values[i] = 1e6 + (double)((i * 2654435761u) % COUNT);
+  }
+
+  const struct {
+    const char *name;
+    double expect;
+  } cases[] = {
+      {"count", COUNT},
+      {"sum", 1499999500000.0},
+      {"mean", 1499999.5},
+      {"stdev", 288675.2789323441}, // 样本标准差 sqrt(N(N+1)/12)
+      {"min", 1e6},
+      {"max", 1999999.0},
+      {"median", 1499999.5},
+  };
+  int failed = 0;
+  for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++) {
+    const calc_aggregate *agg = calc_aggregate_find(cases[k].name);
+
+    calc_aggregate_state whole;
+    calc_aggregate_init(&whole, agg);
+    calc_aggregate_add(&whole, values, COUNT);
+
+    aggregate_slice slices[THREADS];
+    pthread_t threads[THREADS];
+    for (int t = 0; t < THREADS; t++) {
+      slices[t].values = values + (size_t)t * COUNT / THREADS;
+      slices[t].count = COUNT / THREADS;
+      calc_aggregate_init(&slices[t].state, agg);
+      pthread_create(&threads[t], NULL, aggregate_slice_run, &slices[t]);
+    }
+    for (int t = 0; t < THREADS; t++) {
+      pthread_join(threads[t], NULL);
+    }
+    for (int t = 1; t < THREADS; t++) {
+      calc_aggregate_merge(&slices[0].state, &slices[t].state);
+    }
+
+    double expect = cases[k].expect;
+    double single = calc_aggregate_result(&whole, 0.5);
+    double merged = calc_aggregate_result(&slices[0].state, 0.5);
+    // 中位数允许草图约 1% 的排名误差（值连续，排名误差即数值误差），其余应在舍入误差内
+    double tolerance = agg->sketch ? 0.02 * COUNT : 1e-9 * fabs(expect);
+    bool ok = fabs(single - expect) <= tolerance && fabs(merged - expect) <= tolerance;
+    printf("%-6s expect = %.10g whole = %.10g merged = %.10g %s\n", cases[k].name, expect, single, merged,
+           ok ? "ok" : "MISMATCH");
+    failed += !ok;
+
+    calc_aggregate_free(&whole);
+    for (int t = 0; t < THREADS; t++) {
+      calc_aggregate_free(&slices[t].state);
+    }
+  }
+  free(values);
+
+  // 参数个数超过普通函数的上限（parser.c 的 FUNC_ARGS_MAX）
+  const struct {
+    const char *expr;
+    double expect;
+  } exprs[] = {
+      {"sum(1, 2, 3, 4, 5, 6, 7, 8, 9, 10)", 55},
+      {"count(1, 1, 1, 1, 1, 1)", 6},
+      {"min(5, 3, 8, 1, 9, 2) + max(5, 3, 8, 1, 9, 2)", 10},
+      {"mean(2, 4, 6, 8, 10, 12)", 7},
+      {"quantile(0.5, 7, 1, 5, 3, 9)", 5},
+  };
+  for (size_t k = 0; k < sizeof(exprs) / sizeof(exprs[0]); k++) {
+    double direct = evaluate_expression(exprs[k].expr);
+    ast_node *ast = parser_to_ast(exprs[k].expr);
+    double tree = evaluate_ast(ast);
+    ast_tree_free(ast);
+    bool ok = direct == exprs[k].expect && tree == exprs[k].expect;
+    printf("%s = %g / %g %s\n", exprs[k].expr, direct, tree, ok ? "ok" : "MISMATCH");
+    failed += !ok;
+  }
+
+  // 参数多于一块（CALC_BLOCK_SIZE），分块送入状态
+  enum { MANY = 1000 };
+  char *many = malloc(MANY * 2 + 8);
+  size_t len = (size_t)sprintf(many, "sum(1");
+  for (int i = 1; i < MANY; i++) {
+    len += (size_t)sprintf(many + len, ",1");
+  }
+  sprintf(many + len, ")");
+  double direct = evaluate_expression(many);
+  printf("sum of %d ones = %g %s\n", MANY, direct, direct == MANY ? "ok" : "MISMATCH");
+  failed += direct != MANY;
+  free(many);
+  return failed;
+}